@@ -28,7 +28,7 @@ uint32_t (*fp_gtpu_inner_src_ip)(struct rte_mbuf *m);
 struct in6_addr (*fp_gtpu_inner_src_ipv6)(struct rte_mbuf *m);
 void (*fp_gtpu_get_inner_src_dst_ip)(struct rte_mbuf *m, uint32_t *src_ip, uint32_t *dst_ip);
 
-static uint16_t gtpu_seqnb = 0;
+uint16_t gtpu_seqnb = 0;
 
 /**
  * @brief  : Function to construct gtpu header.
@@ -59,8 +59,7 @@ construct_gtpu_hdr_with_seqnb(struct rte_mbuf *m, uint32_t teid, uint16_t tpdu_l
 	*((uint32_t *) gpdu_hdr) = htonl(teid);
 	gpdu_hdr +=sizeof(teid);
 	*((uint32_t *) gpdu_hdr) = GTPU_STATIC_SEQNB |
-								htons(gtpu_seqnb);
-	gtpu_seqnb++;
+								htons(__sync_fetch_and_add(&gtpu_seqnb, 1));
 }
 
 /**
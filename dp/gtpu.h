@@ -205,6 +205,9 @@ int encap_gtpu_hdr_without_seqnb(struct rte_mbuf *m, uint32_t teid, uint8_t ip_t
 
 #define ENCAP_GTPU_HDR(a,b,c) (*fp_encap_gtpu_hdr)(a,b,c)
 
+/* Sequence number of the next encapsulated GTPU packet */
+extern uint16_t gtpu_seqnb;
+
 /**
  * @brief  : Function to get inner dst ip of tunneled packet.
  * @param  : m, mbuf of the incoming packet.
@@ -305,9 +305,9 @@ void send_error_indication_pkt(struct rte_mbuf *gtpu_pkt, uint8_t port_id)
 	}
 #ifdef STATS
 	if(port_id == SGI_PORT_ID) {
-		++epc_app.dl_params[port_id].pkts_err_out;
+		++EPC_DL_PARAMS.pkts_err_out;
 	} else {
-		++epc_app.ul_params[port_id].pkts_err_out;
+		++EPC_UL_PARAMS.pkts_err_out;
 	}
 #endif /* STATS */
 }
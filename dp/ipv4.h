@@ -95,7 +95,8 @@ set_ipv4_hdr(struct rte_mbuf *m, uint16_t len, uint8_t protocol,
 }
 
 /**
- * @brief  : Function to construct ipv4 header.
+ * @brief  : Function to construct ipv4 header, the checksum is left to
+ *           the caller.
  * @param  : m, mbuf pointer
  * @param  : len, len of header
  * @param  : protocol, next protocol id
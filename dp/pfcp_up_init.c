@@ -27,6 +27,8 @@
 #include "gw_adapter.h"
 
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_encap.h"
 #include "pfcp_up_llist.h"
 #include "pfcp_up_struct.h"
 #include "predef_rule_init.h"
@@ -181,6 +183,44 @@ del_sess_info_entry(uint64_t up_sess_id)
 	return 0;
 }
 
+/**
+ * @brief  : Allocate the session data, the hot record read by the UL/DL
+ *           handlers and its cold record of control plane fields
+ * @param  : No param
+ * @return : Returns session data in case of success, NULL otherwise
+ */
+static pfcp_session_datat_t *
+alloc_sess_data(void)
+{
+	pfcp_session_datat_t *sess_data = NULL;
+
+	sess_data = rte_zmalloc("Sess_data_Info", sizeof(pfcp_session_datat_t),
+			RTE_CACHE_LINE_SIZE);
+	if (sess_data == NULL)
+		return NULL;
+
+	sess_data->cold = rte_zmalloc("Sess_data_Cold",
+			sizeof(pfcp_session_datat_cold_t), RTE_CACHE_LINE_SIZE);
+	if (sess_data->cold == NULL) {
+		rte_free(sess_data);
+		return NULL;
+	}
+
+	return sess_data;
+}
+
+/**
+ * @brief  : Free a session data never published in the session tables
+ * @param  : sess_data, session data
+ * @return : Returns nothing
+ */
+static void
+free_sess_data(pfcp_session_datat_t *sess_data)
+{
+	rte_free(sess_data->cold);
+	rte_free(sess_data);
+}
+
 pfcp_session_datat_t *
 get_sess_by_teid_entry(uint32_t teid, pfcp_session_datat_t **head, uint8_t is_mod)
 {
@@ -199,8 +239,7 @@ get_sess_by_teid_entry(uint32_t teid, pfcp_session_datat_t **head, uint8_t is_mo
 		}
 
 		/* allocate memory for session info*/
-		sess_cntxt = rte_zmalloc("Sess_data_Info", sizeof(pfcp_session_datat_t),
-		        RTE_CACHE_LINE_SIZE);
+		sess_cntxt = alloc_sess_data();
 		if (sess_cntxt == NULL){
 		    clLog(clSystemLog, eCLSeverityCritical,
 				LOG_FORMAT"Failed to allocate memory for session data info, Error: %s\n",
@@ -209,15 +248,17 @@ get_sess_by_teid_entry(uint32_t teid, pfcp_session_datat_t **head, uint8_t is_mo
 		}
 
 		/* Session Entry not present. Add new session entry */
+		up_sess_tbl_write_begin();
 		ret = rte_hash_add_key_data(sess_by_teid_hash,
 						&teid, sess_cntxt);
+		up_sess_tbl_write_end();
 		if (ret) {
 			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Failed to add entry for TEID: %u"
 					", Error: %s\n", LOG_VALUE, ntohl(teid),
 					rte_strerror(abs(ret)));
 
 			/* free allocated memory */
-			rte_free(sess_cntxt);
+			free_sess_data(sess_cntxt);
 			sess_cntxt = NULL;
 			return NULL;
 		}
@@ -251,7 +292,9 @@ del_sess_by_teid_entry(uint32_t teid)
 					&teid, (void **)&sess_cntxt);
 	if (ret >= 0) {
 		/* Session Entry is present. Delete Session Entry */
+		up_sess_tbl_write_begin();
 		ret = rte_hash_del_key(sess_by_teid_hash, &teid);
+		up_sess_tbl_write_end();
 
 		if ( ret < 0) {
 			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Entry not found "
@@ -287,8 +330,7 @@ get_sess_by_ueip_entry(ue_ip_t ue_ip, pfcp_session_datat_t **head, uint8_t is_mo
 		}
 
 		/* allocate memory for session info*/
-		sess_cntxt = rte_zmalloc("Sess_data_Info", sizeof(pfcp_session_datat_t),
-		        RTE_CACHE_LINE_SIZE);
+		sess_cntxt = alloc_sess_data();
 		if (sess_cntxt == NULL){
 		    clLog(clSystemLog, eCLSeverityCritical,
 				LOG_FORMAT"Failed to allocate memory for session data info\n", LOG_VALUE);
@@ -296,8 +338,10 @@ get_sess_by_ueip_entry(ue_ip_t ue_ip, pfcp_session_datat_t **head, uint8_t is_mo
 		}
 
 		/* Session Entry not present. Add new session entry */
+		up_sess_tbl_write_begin();
 		ret = rte_hash_add_key_data(sess_by_ueip_hash,
 						&ue_ip, sess_cntxt);
+		up_sess_tbl_write_end();
 		if (ret) {
 			clLog(clSystemLog, eCLSeverityCritical,
 				LOG_FORMAT"Failed to add entry for UE IPv4: "IPV4_ADDR" or IPv6 IP %s"
@@ -305,7 +349,7 @@ get_sess_by_ueip_entry(ue_ip_t ue_ip, pfcp_session_datat_t **head, uint8_t is_mo
 				rte_strerror(abs(ret)));
 
 			/* free allocated memory */
-			rte_free(sess_cntxt);
+			free_sess_data(sess_cntxt);
 			sess_cntxt = NULL;
 			return NULL;
 		}
@@ -342,7 +386,9 @@ del_sess_by_ueip_entry(ue_ip_t ue_ip)
 					&ue_ip, (void **)&sess_cntxt);
 	if (ret >= 0) {
 		/* Session Entry is present. Delete Session Entry */
+		up_sess_tbl_write_begin();
 		ret = rte_hash_del_key(sess_by_ueip_hash, &ue_ip);
+		up_sess_tbl_write_end();
 
 		if ( ret < 0) {
 			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Entry not found "
@@ -586,7 +632,9 @@ del_far_info_entry(uint16_t far_id, peer_addr_t cp_ip, uint64_t cp_seid)
 
 	/* Free data from hash */
 	if (far != NULL) {
-		rte_free(far);
+		/* UL/DL cores may still hold the FAR, free it after a grace period */
+		far_encap_tmpl_free(far);
+		up_rcu_defer_free(far);
 		far = NULL;
 		clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT
 			"free the qer memory successfully with"
@@ -741,6 +789,33 @@ get_qer_info_entry(uint32_t qer_id, qer_info_t **head,  peer_addr_t cp_ip, uint6
 
 }
 
+qer_info_t *
+find_qer_info_entry(uint32_t qer_id, peer_addr_t cp_ip, uint64_t cp_seid)
+{
+	int ret = 0;
+	qer_info_t *qer = NULL;
+	rule_key hash_key = {0};
+
+	hash_key.cp_ip_addr.type = cp_ip.type;
+	if(cp_ip.type == PDN_TYPE_IPV4){
+		hash_key.cp_ip_addr.ip.ipv4_addr = cp_ip.ipv4.sin_addr.s_addr;
+	}else{
+		memcpy(hash_key.cp_ip_addr.ip.ipv6_addr, cp_ip.ipv6.sin6_addr.s6_addr, IPV6_ADDRESS_LEN);
+	}
+	hash_key.id = qer_id;
+	hash_key.cp_seid = cp_seid;
+
+	ret = rte_hash_lookup_data(qer_by_id_hash,
+				&hash_key, (void **)&qer);
+	if (ret < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Entry not found for QER ID: %u\n", LOG_VALUE, qer_id);
+		return NULL;
+	}
+
+	return qer;
+}
+
 int8_t
 del_qer_info_entry(uint32_t qer_id, peer_addr_t cp_ip, uint64_t cp_seid)
 {
@@ -1073,6 +1148,10 @@ init_up_hash_tables(void)
 		}
 	};
 
+	/* One cache line per session lookup on the fast path */
+	RTE_BUILD_BUG_ON(sizeof(pfcp_session_datat_t) > RTE_CACHE_LINE_SIZE);
+	RTE_BUILD_BUG_ON(MAX_ACL_TABLES > UINT16_MAX);
+
 	pdr_by_id_hash = rte_hash_create(&pfcp_hash_params[0]);
 	if (!pdr_by_id_hash) {
 		rte_panic("%s: hash create failed: %s (%u)\n",
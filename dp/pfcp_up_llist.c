@@ -15,7 +15,54 @@
  * limitations under the License.
  */
 
+#include <rte_malloc.h>
+
+#include "up_rcu.h"
+#include "up_mtr.h"
+#include "up_urr.h"
 #include "pfcp_up_llist.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/**
+ * @brief  : Hand the session data node, its cold record and its PDR table
+ *           over to the QSBR
+ * @param  : node, session data node unlinked from the linked list
+ * @return : Returns nothing
+ */
+static void
+free_sess_data_node(pfcp_session_datat_t *node)
+{
+	up_rcu_defer_free(node->pdr_tbl);
+	node->pdr_tbl = NULL;
+	up_rcu_defer_free(node->cold);
+	up_rcu_defer_free(node);
+}
+
+/**
+ * @brief  : Hand the QER node and its meter over to the QSBR
+ * @param  : node, QER node unlinked from the linked list
+ * @return : Returns nothing
+ */
+static void
+free_qer_node(qer_info_t *node)
+{
+	qer_mtr_free(node);
+	up_rcu_defer_free(node);
+}
+
+/**
+ * @brief  : Hand the URR node and its usage counters over to the QSBR
+ * @param  : node, URR node unlinked from the linked list
+ * @return : Returns nothing
+ */
+static void
+free_urr_node(urr_info_t *node)
+{
+	urr_usage_free(node);
+	up_rcu_defer_free(node);
+}
 
 /* Function to add a node in PDR Linked List. */
 int8_t
@@ -64,7 +111,7 @@ remove_sess_data_first_node(pfcp_session_datat_t *head)
 		head = NULL;
 
 	/* Free the 1st node from linked list */
-	rte_free(current);
+	free_sess_data_node(current);
 	current = NULL;
 	return head;
 }
@@ -98,7 +145,7 @@ remove_sess_data_last_node(pfcp_session_datat_t *head)
 		head = NULL;
 
 	/* free the last node from linked list */
-	rte_free(current);
+	free_sess_data_node(current);
 	current = NULL;
 	return head;
 }
@@ -139,7 +186,7 @@ remove_sess_data_node(pfcp_session_datat_t *head,
 		current->next = tmp->next;
 		tmp->next = NULL;
 		/* Free the next node */
-		rte_free(tmp);
+		free_sess_data_node(tmp);
 		tmp = NULL;
 	}
 	return head;
@@ -188,6 +235,70 @@ get_pdr_node(pdr_info_t *head, uint32_t precedence)
 	return NULL;
 }
 
+/* Function to rebuild the precedence ordered PDR table of the session data. */
+int8_t
+update_pdr_prcdnc_tbl(pfcp_session_datat_t *sess_data, pdr_info_t *skip)
+{
+	uint32_t count = 0;
+	uint32_t keys = 0;
+	pdr_info_t *current = NULL;
+	pdr_prcdnc_tbl_t *tbl = NULL;
+	pdr_prcdnc_tbl_t *old = NULL;
+
+	if (sess_data == NULL)
+		return -1;
+
+	for (current = sess_data->pdrs; current != NULL; current = current->next) {
+		if (current != skip)
+			count++;
+	}
+
+	if (count) {
+		/* Keep the PDR pointers 8 bytes aligned after the keys */
+		keys = RTE_ALIGN_CEIL(count, 2);
+		tbl = rte_zmalloc("PDR_PRCDNC_TBL", sizeof(pdr_prcdnc_tbl_t) +
+				(keys * sizeof(uint32_t)) + (count * sizeof(pdr_info_t *)),
+				RTE_CACHE_LINE_SIZE);
+		if (tbl == NULL) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to allocate memory for PDR precedence table, "
+				"Error: %s\n", LOG_VALUE, rte_strerror(rte_errno));
+			/* Readers fall back on the linked list walk */
+			old = sess_data->pdr_tbl;
+			sess_data->pdr_tbl = NULL;
+			up_rcu_defer_free(old);
+			return -1;
+		}
+		tbl->pdr = (pdr_info_t **)&tbl->prcdnc[keys];
+
+		/* Insertion sort, PDRs with same precedence keep the list order */
+		for (current = sess_data->pdrs; current != NULL; current = current->next) {
+			int32_t pos = 0;
+
+			if (current == skip)
+				continue;
+
+			pos = tbl->count;
+			while ((pos > 0) && (tbl->prcdnc[pos - 1] > current->prcdnc_val)) {
+				tbl->prcdnc[pos] = tbl->prcdnc[pos - 1];
+				tbl->pdr[pos] = tbl->pdr[pos - 1];
+				pos--;
+			}
+			tbl->prcdnc[pos] = current->prcdnc_val;
+			tbl->pdr[pos] = current;
+			tbl->count++;
+		}
+	}
+
+	/* Publish the filled table before the readers can pick it up */
+	rte_smp_wmb();
+	old = sess_data->pdr_tbl;
+	sess_data->pdr_tbl = tbl;
+	up_rcu_defer_free(old);
+
+	return 0;
+}
+
 /**
  * @brief  : Function to remove the 1st node from the PDR Linked List.
  * @param  : head, linked list head pointer
@@ -214,7 +325,7 @@ remove_pdr_first_node(pdr_info_t *head)
 		head = NULL;
 
 	/* Free the 1st node from linked list */
-	rte_free(current);
+	up_rcu_defer_free(current);
 	current = NULL;
 	return head;
 }
@@ -248,7 +359,7 @@ remove_pdr_last_node(pdr_info_t *head)
 		head = NULL;
 
 	/* free the last node from linked list */
-	rte_free(current);
+	up_rcu_defer_free(current);
 	current = NULL;
 	return head;
 }
@@ -290,7 +401,7 @@ remove_pdr_node(pdr_info_t *head, pdr_info_t *node)
 		tmp->next = NULL;
 
 		/* Free the next node */
-		rte_free(tmp);
+		up_rcu_defer_free(tmp);
 		tmp = NULL;
 	}
 	return head;
@@ -349,7 +460,7 @@ remove_qer_first_node(qer_info_t *head)
 		head = NULL;
 
 	/* Free the 1st node from linked list */
-	rte_free(current);
+	free_qer_node(current);
 	current = NULL;
 	return head;
 }
@@ -383,7 +494,7 @@ remove_qer_last_node(qer_info_t *head)
 		head = NULL;
 
 	/* free the last node from linked list */
-	rte_free(current);
+	free_qer_node(current);
 	current = NULL;
 	return head;
 }
@@ -425,7 +536,7 @@ remove_qer_node(qer_info_t *head, qer_info_t *node)
 		tmp->next = NULL;
 
 		/* Free the next node */
-		rte_free(tmp);
+		free_qer_node(tmp);
 		tmp = NULL;
 	}
 	return head;
@@ -479,7 +590,7 @@ remove_urr_first_node(urr_info_t *head)
 	current->next = NULL;
 
 	/* Free the 1st node from linked list */
-	rte_free(current);
+	free_urr_node(current);
 	current = NULL;
 	return head;
 }
@@ -513,7 +624,7 @@ remove_urr_last_node(urr_info_t *head)
 		head = NULL;
 
 	/* free the last node from linked list */
-	rte_free(current);
+	free_urr_node(current);
 	current = NULL;
 	return head;
 }
@@ -555,7 +666,7 @@ remove_urr_node(urr_info_t *head, urr_info_t *node)
 		tmp->next = NULL;
 
 		/* Free the next node */
-		rte_free(tmp);
+		free_urr_node(tmp);
 		tmp = NULL;
 	}
 	return head;
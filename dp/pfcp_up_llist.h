@@ -57,6 +57,50 @@ int8_t insert_pdr_node(pdr_info_t *head, pdr_info_t  *pdr);
  */
 pdr_info_t *get_pdr_node(pdr_info_t *head, uint32_t precedence);
 
+/**
+ * @brief  : Function to rebuild the precedence ordered PDR table of the
+ *           session data, the old table is released through the QSBR.
+ * @param  : sess_data, session data holding the PDR linked list
+ * @param  : skip, PDR about to be removed from the list, or NULL
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t update_pdr_prcdnc_tbl(pfcp_session_datat_t *sess_data, pdr_info_t *skip);
+
+/**
+ * @brief  : Function to get the PDR matching the ACL precedence, binary
+ *           search over the session precedence table.
+ * @param  : sess_data, session data
+ * @param  : precedence, precedence value
+ * @return : Returns pdr pointer in case of success, NULL otherwise
+ */
+static inline pdr_info_t *
+get_pdr_by_prcdnc(pfcp_session_datat_t *sess_data, uint32_t precedence)
+{
+	pdr_prcdnc_tbl_t *tbl = sess_data->pdr_tbl;
+	uint32_t low = 0;
+	uint32_t high = 0;
+
+	/* Table not built, walk the linked list */
+	if (unlikely(tbl == NULL))
+		return get_pdr_node(sess_data->pdrs, precedence);
+
+	/* Lower bound, first PDR with the precedence */
+	high = tbl->count;
+	while (low < high) {
+		uint32_t mid = (low + high) >> 1;
+
+		if (tbl->prcdnc[mid] < precedence)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if ((low < tbl->count) && (tbl->prcdnc[low] == precedence))
+		return tbl->pdr[low];
+
+	return NULL;
+}
+
 /**
  * @brief  : Function to remove the node from the PDR Linked List.
  * @param  : head, linked list head pointer
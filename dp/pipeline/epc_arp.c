@@ -65,6 +65,9 @@
 #include "ipv6.h"
 #include "stats.h"
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_adj.h"
+#include "up_li.h"
 #include "epc_arp.h"
 #include "pfcp_util.h"
 #include "epc_packet_framework.h"
@@ -73,8 +76,6 @@
 #include "../rest_timer/gstimer.h"
 #endif /* use_rest */
 
-#include "li_interface.h"
-
 #ifdef DP_BUILD
 #include "gw_adapter.h"
 #endif
@@ -827,6 +828,19 @@ print_mbuf(const char *rx_tx, unsigned portid,
 	fflush(stdout);
 }
 
+struct arp_entry_data *
+lookup_arp_entry(const struct arp_ip_key *arp_key,
+		uint8_t portid)
+{
+	struct arp_entry_data *ret_arp_data = NULL;
+
+	if (rte_hash_lookup_data(arp_hash_handle[portid],
+				(const void *)arp_key, (void **)&ret_arp_data) < 0)
+		return NULL;
+
+	return ret_arp_data;
+}
+
 struct arp_entry_data *
 retrieve_arp_entry(struct arp_ip_key arp_key,
 		uint8_t portid)
@@ -1179,9 +1193,9 @@ arp_send_buffered_pkts(struct rte_ring *queue,
 
 #ifdef STATS
 	if (portid == SGI_PORT_ID) {
-		epc_app.ul_params[S1U_PORT_ID].pkts_out += count;
+		EPC_UL_PARAMS.pkts_out += count;
 	} else if (portid == S1U_PORT_ID) {
-		epc_app.dl_params[SGI_PORT_ID].pkts_out += count;
+		EPC_DL_PARAMS.pkts_out += count;
 	}
 #endif /* STATS */
 
@@ -1306,6 +1320,7 @@ void process_arp_msg(const struct ether_addr *hw_addr,
 			 * Copy hw_addr -> arp_data->eth_addr
 			 * */
 			ether_addr_copy(hw_addr, &arp_data->eth_addr);
+			up_adj_nh_invalidate(arp_data);
 			if (arp_data->status == INCOMPLETE) {
 				if (arp_data->queue) {
 					arp_send_buffered_pkts(
@@ -1358,6 +1373,7 @@ void process_neighbor_advert_msg(const struct ether_addr *hw_addr,
 			 * Copy hw_addr -> arp_data->eth_addr
 			 * */
 			ether_addr_copy(hw_addr, &arp_data->eth_addr);
+			up_adj_nh_invalidate(arp_data);
 			if (ARPICMP_DEBUG)
 				print_ipv6_eth(&arp_data->eth_addr);
 
@@ -1826,7 +1842,7 @@ pkt_work_arp_key(
 									"to IPv6 Addr:"IPv6_FMT"\n",
 									LOG_VALUE, IPv6_PRINT(*(struct in6_addr *)ipv6_hdr->dst_addr));
 #ifdef STATS
-							++epc_app.ul_params[in_port_id].pkts_rs_out;
+							++EPC_UL_PARAMS.pkts_rs_out;
 #endif /* STATS */
 						}
 					} else {
@@ -1845,9 +1861,9 @@ pkt_work_arp_key(
 					LOG_VALUE, IPV4_ADDR_HOST_FORMAT(ip_hdr->src_addr));
 #ifdef STATS
 			if(in_port_id == SGI_PORT_ID) {
-				++epc_app.dl_params[in_port_id].pkts_err_in;
+				++EPC_DL_PARAMS.pkts_err_in;
 			} else {
-				++epc_app.ul_params[in_port_id].pkts_err_in;
+				++EPC_UL_PARAMS.pkts_err_in;
 			}
 #endif /* STATS */
 		}
@@ -2239,7 +2255,7 @@ pkt_work_arp_key(
 									"to IPv6 Addr:"IPv6_FMT"\n",
 									LOG_VALUE, IPv6_PRINT(*(struct in6_addr *)ipv6_hdr->dst_addr));
 #ifdef STATS
-								++epc_app.ul_params[in_port_id].pkts_rs_out;
+								++EPC_UL_PARAMS.pkts_rs_out;
 #endif /* STATS */
 							}
 						} else {
@@ -2260,9 +2276,9 @@ pkt_work_arp_key(
 						LOG_VALUE, IPv6_PRINT(IPv6_CAST(ipv6_hdr->src_addr)));
 #ifdef STATS
 				if(in_port_id == SGI_PORT_ID) {
-					++epc_app.dl_params[in_port_id].pkts_err_in;
+					++EPC_DL_PARAMS.pkts_err_in;
 				} else {
-					++epc_app.ul_params[in_port_id].pkts_err_in;
+					++EPC_UL_PARAMS.pkts_err_in;
 				}
 #endif /* STATS */
 			}
@@ -2780,6 +2796,7 @@ del_route_entry(
 			return -1;
 		}
 
+		up_adj_route_invalidate();
 		printf("Route entry DELETED from hash table :: \n");
 		print_route_entry(info);
 	}
@@ -2849,6 +2866,7 @@ static void add_route_data(
 		}
 
 		gatway_flag = 0;
+		up_adj_route_invalidate();
 
 		printf("Route entry ADDED in hash table :: \n");
 		print_route_entry(info);
@@ -2878,6 +2896,7 @@ static void add_route_data(
 			}
 
 			gatway_flag = 0;
+			up_adj_route_invalidate();
 
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"Route entry ADDED in hash table\n", LOG_VALUE);
@@ -3699,93 +3718,30 @@ static void *handle_kni_process(__rte_unused void *arg)
 
 void process_li_data()
 {
-	int ret = 0;
-	struct ip_addr dummy = {0};
-
-	uint32_t li_ul_cnt = rte_ring_count(li_ul_ring);
-	if(li_ul_cnt){
-		li_data_t *li_data[li_ul_cnt];
-		uint32_t ul_cnt = rte_ring_dequeue_bulk(li_ul_ring,
-				(void**)li_data, li_ul_cnt, NULL);
-
-		for(uint32_t i = 0; i < ul_cnt; i++){
-
-			if (NULL == li_data[i]) {
-				continue;
-			}
-
-			int size = li_data[i]->size;
-			uint64_t id = li_data[i]->id;
-			uint64_t imsi = li_data[i]->imsi;
-
-			if (NULL == li_data[i]->pkts) {
-				continue;
-			}
-
-			create_li_header(li_data[i]->pkts, &size, CC_BASED, id, imsi, dummy, dummy,
-					0, 0, li_data[i]->forward);
-
-			ret = send_li_data_pkt(ddf3_fd, li_data[i]->pkts, size);
-			if (ret < 0) {
-				clLog(clSystemLog, eCLSeverityDebug,
-						LOG_FORMAT"Failed to send UPLINK"
-						" data on TCP sock with error %d\n", LOG_VALUE, ret);
-			}
-			rte_free(li_data[i]->pkts);
-			rte_free(li_data[i]);
-		}
-	}
-
-	uint32_t li_dl_cnt = rte_ring_count(li_dl_ring);
-	if(li_dl_cnt){
-		li_data_t *li_data[li_dl_cnt];
-		uint32_t dl_cnt = rte_ring_dequeue_bulk(li_dl_ring,
-				(void**)li_data, li_dl_cnt, NULL);
-
-		for(uint32_t i = 0; i < dl_cnt; i++){
-			if (li_data[i] == NULL) {
-				continue;
-			}
-
-			int size = li_data[i]->size;
-			uint64_t id = li_data[i]->id;
-			uint64_t imsi = li_data[i]->imsi;
-
-			if (li_data[i]->pkts == NULL) {
-				continue;
-			}
-
-			create_li_header(li_data[i]->pkts, &size, CC_BASED, id, imsi, dummy, dummy,
-					0, 0, li_data[i]->forward);
-
-			ret = send_li_data_pkt(ddf3_fd, li_data[i]->pkts, size);
-			if (ret < 0) {
-				clLog(clSystemLog, eCLSeverityDebug,
-						LOG_FORMAT"Failed to send DOWNLINK"
-						" data on TCP sock with error %d\n", LOG_VALUE, ret);
-			}
-
-			rte_free(li_data[i]->pkts);
-			rte_free(li_data[i]);
-		}
-	}
-	return;
+	/* Runs on its own lcore when one is configured */
+	if (epc_app.core_li == -1)
+		li_process();
 }
 
 void epc_arp(__rte_unused void *arg)
 {
 	struct epc_arp_params *param = &arp_params;
+
+	/* No session reference is held across the polls */
+	up_rcu_quiescent();
+
 	rte_pipeline_run(myP);
 	if (++param->flush_count >= param->flush_max) {
 		rte_pipeline_flush(myP);
 		param->flush_count = 0;
 	}
 	handle_kni_process(NULL);
+	/* Next hops the UL/DL cores could not resolve */
+	up_adj_process_resolve();
 #ifdef NGCORE_SHRINK
 #ifdef STATS
 	epc_stats_core();
 #endif
 #endif
 	process_li_data();
-	store_cdr_into_file_pfcp_sess_rpt_req();
 }
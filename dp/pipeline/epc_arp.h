@@ -104,6 +104,9 @@ struct arp_ip_key {
  * @brief  : ARP table entry.
  */
 struct arp_entry_data {
+	/** generation of eth_addr, bumped on every change, first for
+	 *  its alignment */
+	volatile uint32_t gen;
 	/* IP type */
 	ip_type_t ip_type;
 	/** ipv4 address */
@@ -159,6 +162,16 @@ struct arp_entry_data *retrieve_arp_entry(
 			const struct arp_ip_key arp_key,
 			uint8_t portid);
 
+/**
+ * @brief  : Lookup ARP entry, never creates it.
+ * @param  : arp_key , key.
+ * @param  : portid, port id
+ * @return : arp entry data if found, NULL otherwise.
+ */
+struct arp_entry_data *lookup_arp_entry(
+			const struct arp_ip_key *arp_key,
+			uint8_t portid);
+
 /**
  * @brief  : Queue unresolved arp uplink pkts.
  * @param  : arp_data, arp entry data.
@@ -46,6 +46,9 @@
 
 #include "gtpu.h"
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_dist.h"
+#include "up_prof.h"
 #include "pfcp_util.h"
 #include "epc_packet_framework.h"
 #include "gw_adapter.h"
@@ -62,7 +65,10 @@ extern pcap_dumper_t *pcap_dumper_east;
 extern int clSystemLog;
 extern struct rte_hash *conn_hash_handle;
 extern uint16_t dp_comm_port;
-uint32_t dl_nkni_pkts = 0;
+
+/* Per lcore flags set by epc_dl_set_port_id for the current packet */
+static RTE_DEFINE_PER_LCORE(uint32_t, dl_arp_pkt);
+static RTE_DEFINE_PER_LCORE(uint32_t, dl_sgi_pkt);
 
 #ifdef USE_REST
 /**
@@ -130,7 +136,7 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 			LOG_FORMAT"EB_IN:eh->ether_type==ETHER_TYPE_ARP= 0x%X\n",
 			LOG_VALUE, eh->ether_type);
 
-		dl_arp_pkt = 1;		return;
+		RTE_PER_LCORE(dl_arp_pkt) = 1;		return;
 
 	} else if (eh->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
 		struct ipv4_hdr *ipv4_hdr =
@@ -164,7 +170,7 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 				LOG_FORMAT"EB_IN:ipv4_hdr->next_proto_id= %u \n"
 				"ipv4_hdr->dst_addr(app.eb_ip/IPV4_MCAST/app.eb_bcast_addr)= %s\n",
 				LOG_VALUE, ipv4_hdr->next_proto_id, inet_ntoa(*(struct in_addr *)&ho_addr));
-			dl_arp_pkt = 1;
+			RTE_PER_LCORE(dl_arp_pkt) = 1;
 			return;
 		}
 
@@ -198,8 +204,8 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 				}
 #endif /* USE_REST */
 				*port_id_offset = 0;
-				dl_sgi_pkt = 1;
-				dl_arp_pkt = 0;
+				RTE_PER_LCORE(dl_sgi_pkt) = 1;
+				RTE_PER_LCORE(dl_arp_pkt) = 0;
 		} //GCC_Security flag
 	} else if (eh->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
 		/* Get the IPv6 Header from pkt */
@@ -217,7 +223,7 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 				LOG_VALUE, ipv6_hdr->proto);
 
 			/* Redirect packets to LINUX and Master Core to fill the arp entry */
-			dl_arp_pkt = 1;
+			RTE_PER_LCORE(dl_arp_pkt) = 1;
 			return;
 		}
 
@@ -247,7 +253,7 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 								IPv6_PRINT(app.eb_ipv6), IPv6_PRINT(app.eb_li_ipv6), IPv6_PRINT(ho_addr));
 
 						/* Redirect packets to LINUX and Master Core to fill the arp entry */
-						dl_arp_pkt = 1;
+						RTE_PER_LCORE(dl_arp_pkt) = 1;
 						return;
 					}
 #ifdef USE_REST
@@ -270,8 +276,8 @@ static inline void epc_dl_set_port_id(struct rte_mbuf *m)
 #endif /* USE_REST */
 				}
 				*port_id_offset = 0;
-				dl_sgi_pkt = 1;
-				dl_arp_pkt = 0;
+				RTE_PER_LCORE(dl_sgi_pkt) = 1;
+				RTE_PER_LCORE(dl_arp_pkt) = 0;
 		} //GCC_Security flag
 	}
 }
@@ -292,38 +298,41 @@ static int epc_dl_port_in_ah(struct rte_pipeline *p,
 	TIMER_GET_CURRENT_TP(_init_time);
 #endif /* TIMER_STATS */
 
-	static uint32_t i;
-	RTE_SET_USED(arg);
+	uint32_t i = 0;
+	uint32_t dl_nkni_pkts = 0;
+	struct epc_dl_params *param = (struct epc_dl_params *)arg;
 	RTE_SET_USED(p);
 	/* KNI: Initialize parameters */
 	struct rte_mbuf *kni_pkts_burst[n];
 
-	dl_ndata_pkts = 0;
-	dl_nkni_pkts = 0;
-	dl_arp_pkt = 0;
-	dl_sgi_pkt = 0;
+	param->ndata_pkts = 0;
+	RTE_PER_LCORE(dl_arp_pkt) = 0;
+	RTE_PER_LCORE(dl_sgi_pkt) = 0;
 	for (i = 0; i < n; i++) {
 		struct rte_mbuf *m = pkts[i];
 		epc_dl_set_port_id(m);
-		if (dl_sgi_pkt)	{
-			dl_sgi_pkt = 0;
-			dl_ndata_pkts++;
-		} else if (dl_arp_pkt) {
-			dl_arp_pkt = 0;
+		if (RTE_PER_LCORE(dl_sgi_pkt))	{
+			RTE_PER_LCORE(dl_sgi_pkt) = 0;
+			param->ndata_pkts++;
+		} else if (RTE_PER_LCORE(dl_arp_pkt)) {
+			RTE_PER_LCORE(dl_arp_pkt) = 0;
 			kni_pkts_burst[dl_nkni_pkts++] = pkts[i];
 		}
 	}
 
 	if (dl_nkni_pkts) {
 		RTE_LOG(DEBUG, DP, "KNI: DL send pkts to kni\n");
+		/* KNI tx_q is single producer, shared by all the DL workers */
+		rte_spinlock_lock(&kni_port_params_array[SGI_PORT_ID]->ingress_lock);
 		kni_ingress(kni_port_params_array[SGI_PORT_ID],
 				kni_pkts_burst, dl_nkni_pkts);
+		rte_spinlock_unlock(&kni_port_params_array[SGI_PORT_ID]->ingress_lock);
 
 	}
 #ifdef STATS
-	epc_app.dl_params[SGI_PORT_ID].pkts_in += dl_ndata_pkts;
+	param->pkts_in += param->ndata_pkts;
 #endif /* STATS */
-	dl_pkts_nbrst++;
+	param->pkts_nbrst++;
 
 	/* Capture packets on sgi port. */
 	 up_pcap_dumper(pcap_dumper_east, pkts, n);
@@ -337,25 +346,22 @@ static epc_dl_handler epc_dl_worker_func[NUM_SPGW_PORTS];
  * @param  : p, rte pipeline pointer
  * @param  : pkts, rte mbuf
  * @param  : pkts_mask, packet mask
- * @param  : arg, port number
+ * @param  : arg, downlink worker parameters
  * @return : Returns nothing
  */
 static inline int epc_dl_port_out_ah(struct rte_pipeline *p, struct rte_mbuf **pkts,
 		uint64_t pkts_mask, void *arg)
 {
 	pkts_mask = 0;
-	int worker_index = 0;
 	RTE_SET_USED(p);
-	int portno = (uintptr_t) arg;
-	if (dl_pkts_nbrst == dl_pkts_nbrst_prv)	{
+	struct epc_dl_params *param = (struct epc_dl_params *)arg;
+	if (param->pkts_nbrst == param->pkts_nbrst_prv)	{
 		return 0;
-	} else	if (dl_ndata_pkts)	{
-		dl_pkts_nbrst_prv = dl_pkts_nbrst;
-		epc_dl_handler f = epc_dl_worker_func[portno];
-		/* VS- NGCORE_SHRINK: worker_index:TBC */
-		/* cmntd return f(p, pkts, dl_ndata_pkts, worker_index); */
+	} else	if (param->ndata_pkts)	{
+		param->pkts_nbrst_prv = param->pkts_nbrst;
+		epc_dl_handler f = epc_dl_worker_func[param->rx_port];
 		if(f != NULL){
-			 f(p, pkts, dl_ndata_pkts, &pkts_mask, worker_index);
+			 f(p, pkts, param->ndata_pkts, &pkts_mask, param->worker_id);
 		} else {
 			clLog(clSystemLog, eCLSeverityCritical,
 					LOG_FORMAT"Not Register EB pkts handler, Configured EB MAC was wrong\n",
@@ -366,31 +372,33 @@ static inline int epc_dl_port_out_ah(struct rte_pipeline *p, struct rte_mbuf **p
 #ifndef AUTO_ANALYSIS
 		dl_stat_info.port_in_out_delta = TIMER_GET_ELAPSED_NS(_init_time);
 		/* Export stats into file. */
-		dl_timer_stats(dl_ndata_pkts, &dl_stat_info);
+		dl_timer_stats(param->ndata_pkts, &dl_stat_info);
 #else
 		/* calculate min time, max time, min_burst_sz, max_burst_sz
 		 * perf_stats.op_time[13] = port_in_out_time */
-		SET_PERF_MAX_MIN_TIME(dl_perf_stats.op_time[13], _init_time, dl_ndata_pkts, 1);
+		SET_PERF_MAX_MIN_TIME(dl_perf_stats.op_time[13], _init_time, param->ndata_pkts, 1);
 #endif /* AUTO_ANALYSIS */
 #endif /* TIMER_STATS */
 
 		return 0;
 }
 
-void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint8_t out_port_id)
+void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id,
+		uint8_t out_port_id, uint16_t worker_id)
 {
 	struct rte_pipeline *p;
 	unsigned i;
 
-	dl_pkts_nbrst = 0;
-	dl_pkts_nbrst_prv = 0;
-
 	if (in_port_id != app.eb_port && in_port_id != app.wb_port)
 		rte_exit(EXIT_FAILURE, LOG_FORMAT"Wrong MAC configured for EB interface\n", LOG_VALUE);
 
 	memset(param, 0, sizeof(*param));
 
-	snprintf((char *)param->name, PIPE_NAME_SIZE, "epc_dl_%d", in_port_id);
+	param->worker_id = worker_id;
+	param->rx_port = in_port_id;
+
+	snprintf((char *)param->name, PIPE_NAME_SIZE, "epc_dl_%d_%u",
+			in_port_id, worker_id);
 	param->pipeline_params.socket_id = rte_socket_id();
 	param->pipeline_params.name = param->name;
 	param->pipeline_params.offset_port_id = META_DATA_OFFSET;
@@ -409,9 +417,10 @@ void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint
 			LOG_FORMAT"Performance may be Degradated\n", LOG_VALUE);
 	}
 
+	/* Each worker polls its own RSS queue */
 	struct rte_port_ethdev_reader_params port_ethdev_params = {
 		.port_id = epc_app.ports[in_port_id],
-		.queue_id = 0,
+		.queue_id = worker_id,
 	};
 
 	struct rte_pipeline_port_in_params in_port_params = {
@@ -420,9 +429,18 @@ void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint
 		.burst_size = epc_app.burst_size_rx_read,
 	};
 
+	/* Or reads the ring the distributor steers its sessions to */
+	struct rte_port_ring_reader_params port_ring_reader_params = {
+		.ring = up_dist_ring(in_port_id, worker_id),
+	};
+	if (epc_app.core_dist != -1) {
+		in_port_params.ops = &rte_port_ring_reader_ops;
+		in_port_params.arg_create = (void *)&port_ring_reader_params;
+	}
+
 	if (in_port_id == SGI_PORT_ID) {
 		in_port_params.f_action = epc_dl_port_in_ah;
-		in_port_params.arg_ah = NULL;
+		in_port_params.arg_ah = (void *)param;
 	}
 	if (rte_pipeline_port_in_create
 		(p, &in_port_params, &param->port_in_id))
@@ -438,7 +456,7 @@ void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint
 			struct rte_port_ethdev_writer_nodrop_params port_ethdev_params =
 			{
 				.port_id = epc_app.ports[out_port_id],
-				.queue_id = 0,
+				.queue_id = worker_id,
 				.tx_burst_sz = epc_app.burst_size_tx_write,
 				.n_retries = 0,
 			};
@@ -447,7 +465,7 @@ void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint
 				.ops = &rte_port_ethdev_writer_nodrop_ops,
 				.arg_create = (void *)&port_ethdev_params,
 				.f_action = epc_dl_port_out_ah,
-				.arg_ah = (void *)(uintptr_t) (i+1),
+				.arg_ah = (void *)param,
 			};
 			if (rte_pipeline_port_out_create
 			    (p, &out_port_params, &param->port_out_id[i])) {
@@ -461,7 +479,7 @@ void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint
 				.tx_burst_sz = epc_app.burst_size_rx_write,
 			};
 			struct rte_pipeline_port_out_params out_port_params = {
-				.ops = &rte_port_ring_writer_ops,
+				.ops = &rte_port_ring_multi_writer_ops,
 				.arg_create = (void *)&port_ring_params
 			};
 			port_ring_params.ring = epc_app.epc_mct_rx[in_port_id];
@@ -535,11 +553,21 @@ void epc_dl(void *args)
 {
 	struct epc_dl_params *param = (struct epc_dl_params *)args;
 
+	/* No session reference is held across the polls */
+	up_rcu_quiescent();
+
 	rte_pipeline_run(param->pipeline);
 	if (++param->flush_count >= param->flush_max) {
 		rte_pipeline_flush(param->pipeline);
 		param->flush_count = 0;
 	}
+	/* TX stage of a sampled burst */
+	up_prof_tx_end();
+
+	/* KNI requests, the master core tx ring and the DDN notifications are
+	 * served by worker 0, the owner of TX queue 0 */
+	if (param->worker_id != 0)
+		return;
 
 	/** Handle the request mbufs sent from kernel space,
 	 *  Then analyzes it and calls the specific actions for the specific requests.
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <errno.h>
 #include <string.h>
 #include <sched.h>
 #include <unistd.h>
@@ -36,6 +37,9 @@
 #include <rte_cycles.h>
 #include <rte_timer.h>
 #include <rte_debug.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_pause.h>
 #include <cmdline_rdline.h>
 #include <cmdline_parse.h>
 #include <cmdline_socket.h>
@@ -43,15 +47,33 @@
 
 #include "stats.h"
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_urr.h"
+#include "up_clock.h"
+#include "up_twheel.h"
+#include "up_li.h"
+#include "up_dist.h"
 #include "commands.h"
 #include "interface.h"
 #include "dp_ipc_api.h"
 #include "epc_packet_framework.h"
 #include "gw_adapter.h"
+#ifdef DP_BENCH
+#include "dp_bench.h"
+#endif /* DP_BENCH */
 struct rte_ring *epc_mct_spns_dns_rx;
+
+/* Max wait of a port pause for the port lcores to park, in msec */
+#define EPC_PORTS_PAUSE_MS	100
+
+/* Set while the port queues are reconfigured */
+static volatile uint32_t epc_ports_paused;
+/* Number of port lcores parked */
+static rte_atomic32_t epc_ports_parked;
+/* Number of lcores using the port queues */
+static uint32_t epc_port_lcores;
 struct rte_ring *li_dl_ring;
 struct rte_ring *li_ul_ring;
-struct rte_ring *cdr_pfcp_rpt_req;
 extern int clSystemLog;
 /**
  * @brief  : Maintains epc parameters
@@ -76,16 +98,13 @@ struct epc_app_params epc_app = {
 	.core_iface = -1,
 	.core_stats = -1,
 	.core_spns_dns = -1,
-	.core_ul[S1U_PORT_ID] = -1,
-	.core_dl[SGI_PORT_ID] = -1,
-#ifdef STATS
-	.ul_params[S1U_PORT_ID].pkts_in = 0,
-	.ul_params[S1U_PORT_ID].pkts_out = 0,
-	.dl_params[SGI_PORT_ID].pkts_in = 0,
-	.dl_params[SGI_PORT_ID].pkts_out = 0,
-	.dl_params[SGI_PORT_ID].ddn = 0,
-	.dl_params[SGI_PORT_ID].ddn_buf_pkts = 0,
-#endif
+	.core_li = -1,
+	.core_dist = -1,
+	.core_bench = -1,
+	.core_ul[0 ... EPC_MAX_WORKERS - 1] = -1,
+	.core_dl[0 ... EPC_MAX_WORKERS - 1] = -1,
+	.num_ul_workers = EPC_DEFAULT_WORKERS,
+	.num_dl_workers = EPC_DEFAULT_WORKERS,
 };
 
 /**
@@ -119,6 +138,14 @@ static void epc_iface_core(__rte_unused void *args)
 	 */
 	while (1) {
 		process_dp_msgs();
+		/* Expire the URR time thresholds of the elapsed ticks */
+		up_tw_run();
+		/* Fold the URR usage counters hitting their check points */
+		urr_usage_process(URR_FOLD_BURST);
+		/* Follow the wall clock in the NTP clock of the workers */
+		up_clock_sync();
+		/* Free the session objects released by the readers */
+		up_rcu_reclaim();
 #ifdef NGCORE_SHRINK
 		scan_dns_ring();
 #endif
@@ -126,6 +153,16 @@ static void epc_iface_core(__rte_unused void *args)
 #endif
 }
 
+/**
+ * @brief  : LI exporter pass, on the dedicated LI core
+ * @param  : arg, unused parameter
+ * @return : Returns nothing
+ */
+static void epc_li(__rte_unused void *args)
+{
+	li_process();
+}
+
 /**
  * @brief  : Initialize epc core
  * @param  : No param
@@ -133,13 +170,47 @@ static void epc_iface_core(__rte_unused void *args)
  */
 static void epc_init_lcores(void)
 {
+	unsigned wk = 0;
+	unsigned lcore = 0;
+
+	/* Session table readers, reclaimed objects wait for all of them */
+	up_rcu_register_reader(epc_app.core_mct);
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++)
+		up_rcu_register_reader(epc_app.core_ul[wk]);
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++)
+		up_rcu_register_reader(epc_app.core_dl[wk]);
+
 	epc_alloc_lcore(epc_arp, NULL, epc_app.core_mct);
 	epc_alloc_lcore(epc_iface_core, NULL, epc_app.core_iface);
+	if (epc_app.core_li != -1)
+		epc_alloc_lcore(epc_li, NULL, epc_app.core_li);
+	if (epc_app.core_dist != -1)
+		epc_alloc_lcore(up_dist_run, NULL, epc_app.core_dist);
+#ifdef DP_BENCH
+	if (epc_app.core_bench != -1)
+		epc_alloc_lcore(dp_bench_run, NULL, epc_app.core_bench);
+#endif /* DP_BENCH */
+
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++) {
+		epc_alloc_lcore(epc_ul, &epc_app.ul_params[wk],
+							epc_app.core_ul[wk]);
+	}
+
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++) {
+		epc_alloc_lcore(epc_dl, &epc_app.dl_params[wk],
+							epc_app.core_dl[wk]);
+	}
+
+	/* Lcores parked on a reconfiguration of the ports */
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++)
+		epc_app.lcores[epc_app.core_ul[wk]].port_user = 1;
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++)
+		epc_app.lcores[epc_app.core_dl[wk]].port_user = 1;
+	if (epc_app.core_dist != -1)
+		epc_app.lcores[epc_app.core_dist].port_user = 1;
 
-	epc_alloc_lcore(epc_ul, &epc_app.ul_params[S1U_PORT_ID],
-						epc_app.core_ul[S1U_PORT_ID]);
-	epc_alloc_lcore(epc_dl, &epc_app.dl_params[SGI_PORT_ID],
-						epc_app.core_dl[SGI_PORT_ID]);
+	for (lcore = 0; lcore < DP_MAX_LCORE; lcore++)
+		epc_port_lcores += epc_app.lcores[lcore].port_user;
 }
 
 #define for_each_port(port) for (port = 0; port < epc_app.n_ports; port++)
@@ -160,10 +231,10 @@ static void epc_init_rings(void)
 		char name[32];
 
 		snprintf(name, sizeof(name), "rx_to_mct_%u", port);
+		/* Multi producer, all the UL/DL workers of a port feed this ring */
 		epc_app.epc_mct_rx[port] = rte_ring_create(name,
 		                epc_app.ring_rx_size,
 		                rte_socket_id(),
-		                RING_F_SP_ENQ |
 		                RING_F_SC_DEQ);
 		if (epc_app.epc_mct_rx[port] == NULL)
 		        rte_exit(EXIT_FAILURE, LOG_FORMAT"Cannot create RX ring %u\n", LOG_VALUE, port);
@@ -171,33 +242,76 @@ static void epc_init_rings(void)
 		snprintf(name, sizeof(name), "tx_from_mct_%u", port);
 	}
 
-	/* Creating UL and DL rings for LI*/
+	/* Creating UL and DL rings for LI, filled by all the UL/DL workers */
 	li_dl_ring = rte_ring_create("LI_DL_RING",
 			DL_PKTS_RING_SIZE,
 			rte_socket_id(),
-			RING_F_SP_ENQ | RING_F_SC_DEQ);
+			RING_F_SC_DEQ);
 	if (li_dl_ring == NULL)
 		rte_panic("Cannot create LI DL ring \n");
 
 	li_ul_ring = rte_ring_create("LI_UL_RING",
 			UL_PKTS_RING_SIZE,
 			rte_socket_id(),
-			RING_F_SP_ENQ | RING_F_SC_DEQ);
+			RING_F_SC_DEQ);
 	if (li_ul_ring == NULL)
 		rte_panic("Cannot create LI UL ring \n");
 
-	/* Creating rings for CDR Report Request*/
-	cdr_pfcp_rpt_req = rte_ring_create("CDR_RPT_REQ_RING",
-								DL_PKTS_RING_SIZE,
-								rte_socket_id(),
-								RING_F_SP_ENQ
-								|
-								RING_F_SC_DEQ);
+	/* LI records and clones queued on the LI rings */
+	if (up_li_init() < 0)
+		rte_panic("Cannot create LI pools \n");
 
-	if (cdr_pfcp_rpt_req == NULL)
-		rte_panic("Cannot create DR_RPT_REQ_RING \n");
+	/* Worker rings of the distributor, read in place of the RX queues */
+	if (up_dist_init() < 0)
+		rte_panic("Cannot create distributor rings \n");
 
+}
 
+/**
+ * @brief  : Wait while the port queues are reconfigured, the lcore holds
+ *           no mbuf of the ports and no session reference
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void epc_lcore_park(void)
+{
+	rte_atomic32_inc(&epc_ports_parked);
+	while (epc_ports_paused)
+		rte_pause();
+	rte_atomic32_dec(&epc_ports_parked);
+}
+
+int epc_ports_pause(void)
+{
+	uint32_t others = epc_port_lcores -
+		epc_app.lcores[rte_lcore_id()].port_user;
+	uint64_t deadline = rte_get_tsc_hz() / 1000 * EPC_PORTS_PAUSE_MS +
+		rte_rdtsc();
+
+	if (!rte_atomic32_cmpset(&epc_ports_paused, 0, 1))
+		return -EBUSY;
+
+	while ((uint32_t)rte_atomic32_read(&epc_ports_parked) != others) {
+		if (rte_rdtsc() > deadline) {
+			epc_ports_resume();
+			return -ETIMEDOUT;
+		}
+		rte_pause();
+	}
+	/* Order the port reconfiguration after the parking */
+	rte_smp_mb();
+
+	return 0;
+}
+
+void epc_ports_resume(void)
+{
+	rte_smp_mb();
+	epc_ports_paused = 0;
+
+	/* A next pause counts only the lcores parked for it */
+	while (rte_atomic32_read(&epc_ports_parked) != 0)
+		rte_pause();
 }
 
 /**
@@ -214,6 +328,9 @@ static inline void epc_run_pipeline(void)
 	lcore = rte_lcore_id();
 	config = &epc_app.lcores[lcore];
 
+	if (unlikely(epc_ports_paused) && config->port_user)
+		epc_lcore_park();
+
 #ifdef INSTMNT
 	uint64_t start_tsc, end_tsc;
 
@@ -266,6 +383,8 @@ static int epc_lcore_main_loop(__attribute__ ((unused))
 
 void epc_init_packet_framework(uint8_t east_port_id, uint8_t west_port_id)
 {
+	unsigned wk = 0;
+
 	if (epc_app.n_ports > NUM_SPGW_PORTS) {
 		clLog(clSystemLog, eCLSeverityCritical,
 			LOG_FORMAT"Number of ports exceeds a configured number %u\n",
@@ -276,6 +395,14 @@ void epc_init_packet_framework(uint8_t east_port_id, uint8_t west_port_id)
 	epc_app.ports[EAST_PORT_ID] = east_port_id;
 	printf("ARP-ICMP Core on:\t\t%d\n", epc_app.core_mct);
 	printf("CP-DP IFACE Core on:\t\t%d\n", epc_app.core_iface);
+	printf("LI Export Core on:\t\t%d\n", (epc_app.core_li != -1) ?
+			epc_app.core_li : epc_app.core_mct);
+	if (epc_app.core_dist != -1)
+		printf("Distributor Core on:\t\t%d\n", epc_app.core_dist);
+#ifdef DP_BENCH
+	if (epc_app.core_bench != -1)
+		printf("Benchmark Core on:\t\t%d\n", epc_app.core_bench);
+#endif /* DP_BENCH */
 #ifdef NGCORE_SHRINK
 	epc_app.core_spns_dns = epc_app.core_iface;
 #endif
@@ -297,31 +424,39 @@ void epc_init_packet_framework(uint8_t east_port_id, uint8_t west_port_id)
 	epc_arp_init();
 	epc_spns_dns_init();
 
-	clLog(clSystemLog, eCLSeverityDebug,
-		LOG_FORMAT"Uplink Core on:\t\t\t%d\n", LOG_VALUE, epc_app.core_ul[WEST_PORT_ID]);
-	clLog(clSystemLog, eCLSeverityInfo,
-		LOG_FORMAT"VS- ng-core_shrink:\n\t"
-		"epc_ul_init::epc_app.core_ul[WEST_PORT_ID]= %d\n\t"
-		"WEST_PORT_ID= %d; EAST_PORT_ID= %d\n",
-		LOG_VALUE, epc_app.core_ul[WEST_PORT_ID],
-		WEST_PORT_ID, EAST_PORT_ID);
-
-	epc_ul_init(&epc_app.ul_params[WEST_PORT_ID],
-				epc_app.core_ul[WEST_PORT_ID],
-				WEST_PORT_ID, EAST_PORT_ID);
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Uplink Worker %u Core on:\t\t%d\n", LOG_VALUE,
+			wk, epc_app.core_ul[wk]);
+		clLog(clSystemLog, eCLSeverityInfo,
+			LOG_FORMAT"VS- ng-core_shrink:\n\t"
+			"epc_ul_init::epc_app.core_ul[%u]= %d\n\t"
+			"WEST_PORT_ID= %d; EAST_PORT_ID= %d\n",
+			LOG_VALUE, wk, epc_app.core_ul[wk],
+			WEST_PORT_ID, EAST_PORT_ID);
+
+		epc_app.worker_core_mapping[epc_app.core_ul[wk]] = wk;
+		epc_ul_init(&epc_app.ul_params[wk],
+					epc_app.core_ul[wk],
+					WEST_PORT_ID, EAST_PORT_ID, wk);
+	}
 
-	clLog(clSystemLog, eCLSeverityDebug,
-		LOG_FORMAT"Downlink Core on:\t\t%d\n", LOG_VALUE, epc_app.core_dl[EAST_PORT_ID]);
-	clLog(clSystemLog, eCLSeverityInfo,
-		LOG_FORMAT"VS- ng-core_shrink:\n\t"
-		"epc_dl_init::epc_app.core_dl[EAST_PORT_ID]= %d\n\t"
-		"EAST_PORT_ID= %d; WEST_PORT_ID= %d\n",
-		LOG_VALUE, epc_app.core_dl[EAST_PORT_ID],
-		EAST_PORT_ID, WEST_PORT_ID);
-
-	epc_dl_init(&epc_app.dl_params[EAST_PORT_ID],
-				epc_app.core_dl[EAST_PORT_ID],
-				EAST_PORT_ID, WEST_PORT_ID);
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Downlink Worker %u Core on:\t\t%d\n", LOG_VALUE,
+			wk, epc_app.core_dl[wk]);
+		clLog(clSystemLog, eCLSeverityInfo,
+			LOG_FORMAT"VS- ng-core_shrink:\n\t"
+			"epc_dl_init::epc_app.core_dl[%u]= %d\n\t"
+			"EAST_PORT_ID= %d; WEST_PORT_ID= %d\n",
+			LOG_VALUE, wk, epc_app.core_dl[wk],
+			EAST_PORT_ID, WEST_PORT_ID);
+
+		epc_app.worker_core_mapping[epc_app.core_dl[wk]] = wk;
+		epc_dl_init(&epc_app.dl_params[wk],
+					epc_app.core_dl[wk],
+					EAST_PORT_ID, WEST_PORT_ID, wk);
+	}
 
 	/*
 	 * Assign pipelines to cores
@@ -22,6 +22,7 @@
  * This file contains data structure definitions to describe Data Plane
  * pipeline and function prototypes used to initialize pipeline.
  */
+#include <rte_lcore.h>
 #include <rte_pipeline.h>
 #include <rte_hash_crc.h>
 
@@ -58,8 +59,6 @@ extern uint64_t num_dns_processed;
 /* Per worker macros for DDN */
 /* Macro to specify size of DDN notify_ring */
 #define NOTIFY_RING_SIZE 2048
-/* Macro to specify size of DDN notify_ring */
-#define DL_RING_CONTAINER_SIZE (2048 * 2)
 #define DL_PKT_POOL_SIZE (1024 * 32)
 #define DL_PKT_POOL_CACHE_SIZE 32
 #define DL_PKTS_BUF_RING_SIZE 1024
@@ -123,14 +122,29 @@ struct epc_meta_data {
 
 #define DP_MAX_LCORE RTE_PIPELINE_PORT_OUT_MAX
 
-/** UL pipeline parameters - Per input port */
-uint32_t dl_ndata_pkts;
-uint32_t ul_ndata_pkts;
-uint32_t ul_arp_pkt;
-uint32_t ul_gtpu_pkt;
+/*
+ * Max number of UL/DL workers per direction. Each worker polls its own RX
+ * queue on the ingress port and owns one TX queue on the egress port.
+ */
+#define EPC_MAX_WORKERS		8
+
+/* Default number of UL/DL workers per direction */
+#define EPC_DEFAULT_WORKERS	1
 
-uint32_t ul_pkts_nbrst;
-uint32_t ul_pkts_nbrst_prv;
+/**
+ * @brief  : Reasons a data packet is dropped by the UL/DL handlers
+ */
+enum up_drop_reason {
+	/* No session for the TEID or the UE IP */
+	UP_DROP_SESS,
+	/* No SDF filter or PDR matched */
+	UP_DROP_SDF,
+	/* Gate closed or MBR exceeded */
+	UP_DROP_QER,
+	/* Next hop not resolved */
+	UP_DROP_NEXTHOP,
+	UP_DROP_MAX
+};
 
 /**
  * @brief  : Maintains epc uplink parameters
@@ -158,15 +172,21 @@ struct epc_ul_params {
 	char name[PIPE_NAME_SIZE];
 	/** Number of dns packets cloned by this worker */
 	uint64_t num_dns_packets;
-	/** Holds a set of rings to be used for downlink data buffering */
-	struct rte_ring *dl_ring_container;
-	/** Number of DL rings currently created */
-	uint32_t num_dl_rings;
 	/** For notification of modify_session so that buffered packets
 	 * can be dequeued*/
 	struct rte_ring *notify_ring;
 	/** Pool for notification msg pkts */
 	struct rte_mempool *notify_msg_pool;
+	/** Worker index, also the RX/TX queue owned by this worker */
+	uint16_t worker_id;
+	/** Ethdev port polled by this worker */
+	uint8_t rx_port;
+	/** Number of data packets in the current burst */
+	uint32_t ndata_pkts;
+	/** Number of bursts received */
+	uint32_t pkts_nbrst;
+	/** Number of bursts handed over to the worker function */
+	uint32_t pkts_nbrst_prv;
 	/** Holds number of packets received by uplink */
 	uint32_t pkts_in;
 	/** Holds number of packets sent out after uplink processing */
@@ -181,17 +201,14 @@ struct epc_ul_params {
 	uint32_t pkts_err_in;
 	/** Holds number of error indication packets sent out */
 	uint32_t pkts_err_out;
+	/** Holds number of packets with a bad outer checksum */
+	uint32_t pkts_cksum_bad;
+	/** Holds number of packets dropped per UP_DROP_* reason */
+	uint32_t pkts_drop[UP_DROP_MAX];
 } __rte_cache_aligned;
 typedef int (*epc_ul_handler) (struct rte_pipeline*, struct rte_mbuf **pkts,
 		uint32_t n, uint64_t *pkts_mask, int wk_index);
 
-/** DL pipeline parameters - Per input port */
-uint32_t dl_arp_pkt;
-uint32_t dl_sgi_pkt;
-
-uint32_t dl_pkts_nbrst;
-uint32_t dl_pkts_nbrst_prv;
-
 /**
  * @brief  : Maintains epc downlink parameters
  */
@@ -218,15 +235,21 @@ struct epc_dl_params {
 	char name[PIPE_NAME_SIZE];
 	/** Number of dns packets cloned by this worker */
 	uint64_t num_dns_packets;
-	/** Holds a set of rings to be used for downlink data buffering */
-	struct rte_ring *dl_ring_container;
-	/** Number of DL rings currently created */
-	uint32_t num_dl_rings;
 	/** For notification of modify_session so that buffered packets
 	 * can be dequeued*/
 	struct rte_ring *notify_ring;
 	/** Pool for notification msg pkts */
 	struct rte_mempool *notify_msg_pool;
+	/** Worker index, also the RX/TX queue owned by this worker */
+	uint16_t worker_id;
+	/** Ethdev port polled by this worker */
+	uint8_t rx_port;
+	/** Number of data packets in the current burst */
+	uint32_t ndata_pkts;
+	/** Number of bursts received */
+	uint32_t pkts_nbrst;
+	/** Number of bursts handed over to the worker function */
+	uint32_t pkts_nbrst_prv;
 	/** Holds number of packets received by downlink */
 	uint32_t pkts_in;
 	/** Holds number of packets sent out after downlink processing */
@@ -239,6 +262,8 @@ struct epc_dl_params {
 	uint32_t pkts_err_in;
 	/** Holds number of error indication packets sent out */
 	uint32_t pkts_err_out;
+	/** Holds number of packets dropped per UP_DROP_* reason */
+	uint32_t pkts_drop[UP_DROP_MAX];
 } __rte_cache_aligned;
 typedef int (*epc_dl_handler) (struct rte_pipeline*, struct rte_mbuf **pkts,
 		uint32_t n, uint64_t *pkts_mask, int wk_index);
@@ -266,6 +291,7 @@ struct pipeline_launch {
  */
 struct epc_lcore_config {
 	int allocated;		/* indicates a number of pipelines enebled */
+	uint8_t port_user;	/* polls or sends on the WB/EB port queues */
 	struct pipeline_launch launch[EPC_PIPELINE_MAX];
 };
 
@@ -279,8 +305,17 @@ struct epc_app_params {
 	int core_iface;
 	int core_stats;
 	int core_spns_dns;
-	int core_ul[NUM_SPGW_PORTS];
-	int core_dl[NUM_SPGW_PORTS];
+	/* LI exporter core, -1 when the exporter runs on the mct core */
+	int core_li;
+	/* Distributor core, -1 when the workers poll their own RX queue */
+	int core_dist;
+	/* Benchmark core of the DP_BENCH builds, -1 otherwise */
+	int core_bench;
+	/* UL/DL worker cores, indexed by worker id */
+	int core_ul[EPC_MAX_WORKERS];
+	int core_dl[EPC_MAX_WORKERS];
+	unsigned num_ul_workers;
+	unsigned num_dl_workers;
 	/* NGCORE_SHRINK::NUM_WORKER = 1 */
 	unsigned num_workers;
 	unsigned worker_cores[DP_MAX_LCORE];
@@ -312,13 +347,31 @@ struct epc_app_params {
 	uint32_t burst_size_tx_read;
 	uint32_t burst_size_tx_write;
 
-	/* Pipeline params */
-	struct epc_ul_params ul_params[NUM_SPGW_PORTS];
-	struct epc_dl_params dl_params[NUM_SPGW_PORTS];
+	/* Pipeline params, indexed by worker id */
+	struct epc_ul_params ul_params[EPC_MAX_WORKERS];
+	struct epc_dl_params dl_params[EPC_MAX_WORKERS];
 } __rte_cache_aligned;
 
 extern struct epc_app_params epc_app;
 
+/**
+ * @brief  : Returns the UL/DL worker index of the calling lcore. Master,
+ *           iface and non-EAL threads account on worker 0.
+ * @param  : No param
+ * @return : Returns worker index
+ */
+static inline unsigned
+epc_worker_index(void)
+{
+	unsigned lcore = rte_lcore_id();
+
+	return (lcore < DP_MAX_LCORE) ? epc_app.worker_core_mapping[lcore] : 0;
+}
+
+/** UL/DL pipeline parameters of the worker running on the calling lcore */
+#define EPC_UL_PARAMS	(epc_app.ul_params[epc_worker_index()])
+#define EPC_DL_PARAMS	(epc_app.dl_params[epc_worker_index()])
+
 /**
  * @brief  : Adds pipeline function to core's list of pipelines to run
  * @param  : func, Function to run
@@ -387,9 +440,11 @@ void packet_framework_launch(void);
  *           are in different NUMA domains
  * @param  : in_port_id, Input Port ID
  * @param  : out_port_id, Input Port ID & Output Port ID
+ * @param  : worker_id, UL worker index, selects the RX and TX queue
  * @return : Returns nothing
  */
-void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint8_t out_port_id);
+void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id,
+		uint8_t out_port_id, uint16_t worker_id);
 
 /**
  * @brief  : Initializes DL pipeline
@@ -398,10 +453,12 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
  *           are in different NUMA domains
  * @param  : in_port_id, Input Port ID
  * @param  : out_port_id, Input Port ID & Output Port ID
+ * @param  : worker_id, DL worker index, selects the RX and TX queue
  * @return : Returns nothing
  *
  */
-void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id, uint8_t out_port_id);
+void epc_dl_init(struct epc_dl_params *param, int core, uint8_t in_port_id,
+		uint8_t out_port_id, uint16_t worker_id);
 
 /**
  * @brief  : UL pipeline function
@@ -417,6 +474,22 @@ void epc_ul(void *args);
  */
 void epc_dl(void *args);
 
+/**
+ * @brief  : Park the other lcores using the WB/EB port queues at the top
+ *           of their loop, for a reconfiguration of the ports
+ * @param  : No param
+ * @return : Returns 0 in case of success , -EBUSY if a pause is already in
+ *           progress, -ETIMEDOUT if an lcore did not park in time
+ */
+int epc_ports_pause(void);
+
+/**
+ * @brief  : Release the lcores parked by epc_ports_pause
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void epc_ports_resume(void);
+
 /**
  * @brief  : Registers uplink worker function that is executed from the pipeline
  * @param  : f, Function handler for packet processing
@@ -50,6 +50,9 @@
 #include "ipv6.h"
 #include "gtpu.h"
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_dist.h"
+#include "up_prof.h"
 #include "pfcp_util.h"
 #include "gw_adapter.h"
 #include "epc_packet_framework.h"
@@ -70,7 +73,10 @@ extern struct rte_hash *conn_hash_handle;
 #include "perf_timer.h"
 extern _timer_t _init_time;
 #endif /* TIMER_STATS */
-uint32_t ul_nkni_pkts = 0;
+
+/* Per lcore flags set by epc_ul_set_port_id for the current packet */
+static RTE_DEFINE_PER_LCORE(uint32_t, ul_arp_pkt);
+static RTE_DEFINE_PER_LCORE(uint32_t, ul_gtpu_pkt);
 
 #ifdef USE_REST
 /**
@@ -136,7 +142,7 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 		clLog(clSystemLog, eCLSeverityDebug,
 			LOG_FORMAT"WB_IN:ARP:eh->ether_type==ETHER_TYPE_ARP= 0x%X\n",
 			LOG_VALUE, eh->ether_type);
-		ul_arp_pkt = 1;
+		RTE_PER_LCORE(ul_arp_pkt) = 1;
 
 	} else if (eh->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
 
@@ -176,7 +182,7 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 				"WB_IN:IPv4:Reject or MulticastIP or broadcast IP Pkt ipv4_hdr->dst_addr= %s\n",
 				LOG_VALUE, ipv4_hdr->next_proto_id,
 				inet_ntoa(*(struct in_addr *)&ho_addr));
-			ul_arp_pkt = 1;
+			RTE_PER_LCORE(ul_arp_pkt) = 1;
 			return;
 		}
 
@@ -211,8 +217,8 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"WB: IPv4 GTPU packet\n", LOG_VALUE);
 					*port_id_offset = 0;
-					ul_gtpu_pkt = 1;
-					ul_arp_pkt = 0;
+					RTE_PER_LCORE(ul_gtpu_pkt) = 1;
+					RTE_PER_LCORE(ul_arp_pkt) = 0;
 
 #ifdef SKIP_LB_HASH_CRC
 					*ue_ipv4_hash_offset = p[0] >> 24;
@@ -239,7 +245,7 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 				LOG_VALUE, ipv6_hdr->proto);
 
 			/* Redirect packets to LINUX and Master Core to fill the arp entry */
-			ul_arp_pkt = 1;
+			RTE_PER_LCORE(ul_arp_pkt) = 1;
 			return;
 		}
 
@@ -256,7 +262,7 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 			clLog(clSystemLog, eCLSeverityDebug,
 					LOG_FORMAT"WB_IN:ipv6_hdr->proto= %u: Not for local intf IPv6 dst addr Packet,"
 					"redirect to LINUX..\n", LOG_VALUE, ipv6_hdr->proto);
-			ul_arp_pkt = 1;
+			RTE_PER_LCORE(ul_arp_pkt) = 1;
 			return;
 		}
 
@@ -291,9 +297,9 @@ static inline void epc_ul_set_port_id(struct rte_mbuf *m)
 					/* Default route pkts to ul core, i.e pipeline */
 					*port_id_offset = 0;
 					/* Route packets to fastpath */
-					ul_gtpu_pkt = 1;
+					RTE_PER_LCORE(ul_gtpu_pkt) = 1;
 					/* Not Redirect packets to LINUX */
-					ul_arp_pkt = 0;
+					RTE_PER_LCORE(ul_arp_pkt) = 0;
 				}
 			}
 		}
@@ -317,37 +323,40 @@ static int epc_ul_port_in_ah(struct rte_pipeline *p,
 	TIMER_GET_CURRENT_TP(_init_time);
 #endif /* TIMER_STATS*/
 
-	static uint32_t i;
-	RTE_SET_USED(arg);
+	uint32_t i = 0;
+	uint32_t ul_nkni_pkts = 0;
+	struct epc_ul_params *param = (struct epc_ul_params *)arg;
 	RTE_SET_USED(p);
 	struct rte_mbuf *kni_pkts_burst[n];
 
-	ul_ndata_pkts = 0;
-	ul_nkni_pkts = 0;
-	ul_arp_pkt = 0;
-	ul_gtpu_pkt = 0;
+	param->ndata_pkts = 0;
+	RTE_PER_LCORE(ul_arp_pkt) = 0;
+	RTE_PER_LCORE(ul_gtpu_pkt) = 0;
 	for (i = 0; i < n; i++) {
 		struct rte_mbuf *m = pkts[i];
 		epc_ul_set_port_id(m);
-		if (ul_gtpu_pkt) {
-			ul_gtpu_pkt = 0;
-			ul_ndata_pkts++;
-		} else if(ul_arp_pkt) {
-			ul_arp_pkt = 0;
+		if (RTE_PER_LCORE(ul_gtpu_pkt)) {
+			RTE_PER_LCORE(ul_gtpu_pkt) = 0;
+			param->ndata_pkts++;
+		} else if(RTE_PER_LCORE(ul_arp_pkt)) {
+			RTE_PER_LCORE(ul_arp_pkt) = 0;
 			kni_pkts_burst[ul_nkni_pkts++] = pkts[i];
 		}
 	}
 
 	if (ul_nkni_pkts) {
 		RTE_LOG(DEBUG, DP, "KNI: UL send pkts to kni\n");
+		/* KNI tx_q is single producer, shared by all the UL workers */
+		rte_spinlock_lock(&kni_port_params_array[S1U_PORT_ID]->ingress_lock);
 		kni_ingress(kni_port_params_array[S1U_PORT_ID],
 				kni_pkts_burst, ul_nkni_pkts);
+		rte_spinlock_unlock(&kni_port_params_array[S1U_PORT_ID]->ingress_lock);
 	}
 
 #ifdef STATS
-	epc_app.ul_params[S1U_PORT_ID].pkts_in += ul_ndata_pkts;
+	param->pkts_in += param->ndata_pkts;
 #endif /* STATS */
-	ul_pkts_nbrst++;
+	param->pkts_nbrst++;
 
 	/* Capture packets on s1u_port.*/
 	up_pcap_dumper(pcap_dumper_west, pkts, n);
@@ -361,23 +370,22 @@ static epc_ul_handler epc_ul_worker_func[NUM_SPGW_PORTS];
  * @param  : p, rte pipeline pointer
  * @param  : pkts, rte mbuf
  * @param  : pkts_mask, packet mask
- * @param  : arg, port number
+ * @param  : arg, uplink worker parameters
  * @return : Returns nothing
  */
 static inline int epc_ul_port_out_ah(struct rte_pipeline *p, struct rte_mbuf **pkts,
 		uint64_t pkts_mask, void *arg)
 {
 	pkts_mask = 0;
-	int worker_index = 0, ret = 0;
-	int portno = (uintptr_t) arg;
-	if (ul_pkts_nbrst == ul_pkts_nbrst_prv)	{
+	int ret = 0;
+	struct epc_ul_params *param = (struct epc_ul_params *)arg;
+	if (param->pkts_nbrst == param->pkts_nbrst_prv)	{
 		return 0;
-	} else if (ul_ndata_pkts)	{
-		ul_pkts_nbrst_prv = ul_pkts_nbrst;
-		epc_ul_handler f = epc_ul_worker_func[portno];
-		/* VS- NGCORE_SHRINK: worker_index-TBC */
+	} else if (param->ndata_pkts)	{
+		param->pkts_nbrst_prv = param->pkts_nbrst;
+		epc_ul_handler f = epc_ul_worker_func[param->rx_port];
 		if ( f != NULL) {
-			ret = f(p, pkts, ul_ndata_pkts, &pkts_mask, worker_index);
+			ret = f(p, pkts, param->ndata_pkts, &pkts_mask, param->worker_id);
 		} else {
 			clLog(clSystemLog, eCLSeverityCritical,
 					LOG_FORMAT"Not Register WB pkts handler, Configured WB MAC was wrong\n",
@@ -388,31 +396,33 @@ static inline int epc_ul_port_out_ah(struct rte_pipeline *p, struct rte_mbuf **p
 #ifndef AUTO_ANALYSIS
 	ul_stat_info.port_in_out_delta = TIMER_GET_ELAPSED_NS(_init_time);
 	/* Export stats into file. */
-	ul_timer_stats(ul_ndata_pkts, &ul_stat_info);
+	ul_timer_stats(param->ndata_pkts, &ul_stat_info);
 #else
 	/* calculate min time, max time, min_burst_sz, max_burst_sz
 	 * perf_stats.op_time[12] = port_in_out_time */
-	SET_PERF_MAX_MIN_TIME(ul_perf_stats.op_time[12], _init_time, ul_ndata_pkts, 0);
+	SET_PERF_MAX_MIN_TIME(ul_perf_stats.op_time[12], _init_time, param->ndata_pkts, 0);
 #endif /* AUTO_ANALYSIS */
 #endif /* TIMER_STATS*/
 
 	return ret;
 }
 
-void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint8_t out_port_id)
+void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id,
+		uint8_t out_port_id, uint16_t worker_id)
 {
 	unsigned i;
 	struct rte_pipeline *p;
 
-	ul_pkts_nbrst = 0;
-	ul_pkts_nbrst_prv = 0;
-
 	if (in_port_id != app.eb_port && in_port_id != app.wb_port)
 			rte_exit(EXIT_FAILURE, LOG_FORMAT"Wrong MAC configured for WB interface\n", LOG_VALUE);
 
 	memset(param, 0, sizeof(*param));
 
-	snprintf((char *)param->name, PIPE_NAME_SIZE, "epc_ul_%d", in_port_id);
+	param->worker_id = worker_id;
+	param->rx_port = in_port_id;
+
+	snprintf((char *)param->name, PIPE_NAME_SIZE, "epc_ul_%d_%u",
+			in_port_id, worker_id);
 	param->pipeline_params.socket_id = rte_socket_id();
 	param->pipeline_params.name = param->name;
 	param->pipeline_params.offset_port_id = META_DATA_OFFSET;
@@ -431,9 +441,10 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
 			LOG_FORMAT"Performance may be degradated \n", LOG_VALUE);
 	}
 
+	/* Each worker polls its own RSS queue */
 	struct rte_port_ethdev_reader_params port_ethdev_params = {
 		.port_id = epc_app.ports[in_port_id],
-		.queue_id = 0,
+		.queue_id = worker_id,
 	};
 
 	struct rte_pipeline_port_in_params in_port_params = {
@@ -441,9 +452,19 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
 		.arg_create = (void *)&port_ethdev_params,
 		.burst_size = epc_app.burst_size_rx_read,
 	};
+
+	/* Or reads the ring the distributor steers its sessions to */
+	struct rte_port_ring_reader_params port_ring_reader_params = {
+		.ring = up_dist_ring(in_port_id, worker_id),
+	};
+	if (epc_app.core_dist != -1) {
+		in_port_params.ops = &rte_port_ring_reader_ops;
+		in_port_params.arg_create = (void *)&port_ring_reader_params;
+	}
+
 	if (in_port_id == S1U_PORT_ID)	{
 		in_port_params.f_action = epc_ul_port_in_ah;
-		in_port_params.arg_ah = NULL;
+		in_port_params.arg_ah = (void *)param;
 	}
 	if (rte_pipeline_port_in_create
 			(p, &in_port_params, &param->port_in_id))
@@ -459,7 +480,7 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
 			struct rte_port_ethdev_writer_nodrop_params port_ethdev_params =
 			{
 				.port_id = epc_app.ports[out_port_id],
-				.queue_id = 0,
+				.queue_id = worker_id,
 				.tx_burst_sz = epc_app.burst_size_tx_write,
 				.n_retries = 0,
 			};
@@ -468,7 +489,7 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
 				.ops = &rte_port_ethdev_writer_nodrop_ops,
 				.arg_create = (void *)&port_ethdev_params,
 				.f_action = epc_ul_port_out_ah,
-				.arg_ah = (void *)(uintptr_t) i,
+				.arg_ah = (void *)param,
 			};
 			if (rte_pipeline_port_out_create
 					(p, &out_port_params, &param->port_out_id[i])) {
@@ -484,7 +505,7 @@ void epc_ul_init(struct epc_ul_params *param, int core, uint8_t in_port_id, uint
 			};
 
 			struct rte_pipeline_port_out_params out_port_params = {
-				.ops = &rte_port_ring_writer_ops,
+				.ops = &rte_port_ring_multi_writer_ops,
 				.arg_create = (void *)&port_ring_params
 			};
 			port_ring_params.ring = epc_app.epc_mct_rx[in_port_id];
@@ -558,11 +579,21 @@ void epc_ul(void *args)
 {
 	struct epc_ul_params *param = (struct epc_ul_params *)args;
 
+	/* No session reference is held across the polls */
+	up_rcu_quiescent();
+
 	rte_pipeline_run(param->pipeline);
 	if (++param->flush_count >= param->flush_max) {
 		rte_pipeline_flush(param->pipeline);
 		param->flush_count = 0;
 	}
+	/* TX stage of a sampled burst */
+	up_prof_tx_end();
+
+	/* KNI requests and the master core tx ring are served by worker 0,
+	 * the owner of TX queue 0 */
+	if (param->worker_id != 0)
+		return;
 
 	/** Handle the request mbufs sent from kernel space,
 	 *  Then analyzes it and calls the specific actions for the specific requests.
@@ -13,7 +13,8 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-#Set the Log Level
+#Set the Log Level, lowest severity logged:
+#0 debug, 1 info, 2 startup, 3 minor, 4 major, 5 critical, 6 off
 LOG_LEVEL=0
 
 export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../third_party/libpfcp/lib
@@ -37,6 +38,7 @@ NUMA0_MEMORY=$MEMORY
 NUMA1_MEMORY=0
 
 #set coremask here
+#Needs 2 + UL_WORKERS + DL_WORKERS lcores (see dp.cfg)
 CORELIST=0-3
 
 ARGS="-l $CORELIST -n 4 --socket-mem $NUMA0_MEMORY,$NUMA1_MEMORY	\
@@ -174,14 +174,34 @@ pip_istats(struct rte_pipeline *p, char *name, uint8_t port_id, struct rte_pipel
 void
 pipeline_in_stats(void)
 {
-	ul_param.ULRX = epc_app.ul_params[S1U_PORT_ID].pkts_in;
-	ul_param.RS_RX = epc_app.ul_params[S1U_PORT_ID].pkts_rs_in;
-	dl_param.DLRX = epc_app.dl_params[SGI_PORT_ID].pkts_in;
-	dl_param.ddn_req = epc_app.dl_params[SGI_PORT_ID].ddn;
-	dl_param.ddn_pkts = epc_app.dl_params[SGI_PORT_ID].ddn_buf_pkts;
+	unsigned wk = 0;
+
+	ul_param.ULRX = 0;
+	ul_param.RS_RX = 0;
+	dl_param.ddn_req = 0;
+#ifdef EXSTATS
+	ul_param.GTP_ECHO = 0;
+#endif /* EXSTATS */
+
+	/* Sum up the per worker counters */
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++) {
+		ul_param.ULRX += epc_app.ul_params[wk].pkts_in;
+		ul_param.RS_RX += epc_app.ul_params[wk].pkts_rs_in;
 #ifdef EXSTATS
-	ul_param.GTP_ECHO = epc_app.ul_params[S1U_PORT_ID].pkts_echo;
+		ul_param.GTP_ECHO += epc_app.ul_params[wk].pkts_echo;
 #endif /* EXSTATS */
+	}
+
+	/* Buffered pkts are released by DL worker 0, so a worker's own
+	 * counters may wrap, sum them up in 32 bit */
+	uint32_t dl_rx = 0, ddn_pkts = 0;
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++) {
+		dl_rx += epc_app.dl_params[wk].pkts_in;
+		dl_param.ddn_req += epc_app.dl_params[wk].ddn;
+		ddn_pkts += epc_app.dl_params[wk].ddn_buf_pkts;
+	}
+	dl_param.DLRX = dl_rx;
+	dl_param.ddn_pkts = ddn_pkts;
 }
 
 void
@@ -198,9 +218,20 @@ pip_ostats(struct rte_pipeline *p, char *name, uint8_t port_id, struct rte_pipel
 void
 pipeline_out_stats(void)
 {
-	ul_param.ULTX = epc_app.ul_params[S1U_PORT_ID].pkts_out;
-	ul_param.RS_TX = epc_app.ul_params[S1U_PORT_ID].pkts_rs_out;
-	dl_param.DLTX = epc_app.dl_params[SGI_PORT_ID].pkts_out;
+	unsigned wk = 0;
+
+	ul_param.ULTX = 0;
+	ul_param.RS_TX = 0;
+	dl_param.DLTX = 0;
+
+	/* Sum up the per worker counters */
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++) {
+		ul_param.ULTX += epc_app.ul_params[wk].pkts_out;
+		ul_param.RS_TX += epc_app.ul_params[wk].pkts_rs_out;
+	}
+
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++)
+		dl_param.DLTX += epc_app.dl_params[wk].pkts_out;
 
 }
 
@@ -30,7 +30,9 @@
 #include "ipv6.h"
 #include "util.h"
 #include "up_acl.h"
+#include "up_csum.h"
 #include "up_ether.h"
+#include "up_encap.h"
 #include "pfcp_util.h"
 #include "interface.h"
 #include "gw_adapter.h"
@@ -47,29 +49,22 @@ extern struct rte_hash *conn_hash_handle;
 extern struct app_params app;
 struct in6_addr dp_comm_ipv6;
 
+/**
+ * @brief  : Set the outer IP and UDP checksums, by the NIC of the egress
+ *           port when it has the offload
+ * @param  : m, mbuf pointer
+ * @param  : ip_type, IPV4_TYPE or IPV6_TYPE
+ * @param  : port, egress port
+ * @return : Returns nothing
+ */
 static inline void
-reset_udp_hdr_checksum(struct rte_mbuf *m, uint8_t ip_type)
+set_outer_hdr_checksum(struct rte_mbuf *m, uint8_t ip_type, uint8_t port)
 {
-	struct udp_hdr *udp_hdr;
-
 	/* IF IP_TYPE = 1 i.e IPv4 , 2: IPv6*/
-	if (ip_type == IPV6_TYPE) {
-		udp_hdr = get_mtoudp_v6(m);
-		/* update Udp checksum */
-		udp_hdr->dgram_cksum = 0;
-		struct ipv6_hdr *ipv6_hdr;
-
-		ipv6_hdr = get_mtoip_v6(m);
-		udp_hdr->dgram_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, udp_hdr);
-	} else if (ip_type == IPV4_TYPE) {
-		udp_hdr = get_mtoudp(m);
-		/* update Udp checksum */
-		udp_hdr->dgram_cksum = 0;
-		struct ipv4_hdr *ipv4_hdr;
-
-		ipv4_hdr = get_mtoip(m);
-		udp_hdr->dgram_cksum = rte_ipv4_udptcp_cksum(ipv4_hdr, udp_hdr);
-	}
+	if (ip_type == IPV6_TYPE)
+		up_csum_ipv6_udp(m, get_mtoip_v6(m), get_mtoudp_v6(m), port);
+	else if (ip_type == IPV4_TYPE)
+		up_csum_ipv4_udp(m, get_mtoip(m), get_mtoudp(m), port);
 }
 
 /* Tranlator of the IP header */
@@ -149,6 +144,19 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 		if (!ISSET_BIT(*decap_pkts_mask, i))
 			continue;
 
+		/* Reject the outer checksums found bad by the NIC */
+		if (unlikely(up_csum_rx_bad(pkts[i]))) {
+			RESET_BIT(*pkts_mask, i);
+#ifdef STATS
+			--EPC_UL_PARAMS.pkts_in;
+			++EPC_UL_PARAMS.pkts_cksum_bad;
+#endif /* STATS */
+			clLog(clSystemLog, eCLSeverityDebug,
+				LOG_FORMAT"Bad outer checksum, ol_flags 0x%lx\n",
+				LOG_VALUE, pkts[i]->ol_flags);
+			continue;
+		}
+
 		/* Get the ether header info */
 		ether = (struct ether_hdr *)rte_pktmbuf_mtod(pkts[i], uint8_t *);
 
@@ -178,9 +186,9 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 			gtpu_hdr = get_mtogtpu(pkts[i]);
 			if (gtpu_hdr->teid == 0 || gtpu_hdr->msgtype != GTP_GPDU) {
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #ifdef EXSTATS
-				++epc_app.ul_params[S1U_PORT_ID].pkts_echo;
+				++EPC_UL_PARAMS.pkts_echo;
 #endif /* EXSTATS */
 #endif /* STATS */
 				RESET_BIT(*pkts_mask, i);
@@ -202,7 +210,7 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 			if (ret < 0){
 				RESET_BIT(*pkts_mask, i);
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #endif /* STATS */
 			}
 		} else if (ether->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
@@ -227,9 +235,9 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 			gtpu_hdr = get_mtogtpu_v6(pkts[i]);
 			if (gtpu_hdr->teid == 0 || gtpu_hdr->msgtype != GTP_GPDU) {
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #ifdef EXSTATS
-				++epc_app.ul_params[S1U_PORT_ID].pkts_echo;
+				++EPC_UL_PARAMS.pkts_echo;
 #endif /* EXSTATS */
 #endif /* STATS */
 				RESET_BIT(*pkts_mask, i);
@@ -256,7 +264,7 @@ gtpu_decap(struct rte_mbuf **pkts, uint32_t n,
 			if (ret < 0){
 				RESET_BIT(*pkts_mask, i);
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #endif /* STATS */
 			}
 
@@ -274,6 +282,7 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 	far_info_t *far = NULL;
 	struct rte_mbuf *m = NULL;
 	pfcp_session_datat_t *si = NULL;
+	const struct gtpu_encap_tmpl *tmpl = NULL;
 
 	for (i = 0; i < n; i++) {
 		si = sess_data[i];
@@ -286,14 +295,14 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 		if (!ISSET_BIT(*pkts_mask, i)) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			continue;
 		}
 
 		if (si == NULL) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"Session Data is NULL\n", LOG_VALUE);
@@ -303,7 +312,7 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 		if (pdr == NULL) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"PDR INFO IS NULL\n", LOG_VALUE);
@@ -316,7 +325,7 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 		if (far == NULL) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"FAR INFO IS NULL\n", LOG_VALUE);
@@ -326,8 +335,8 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 /** Check downlink bearer is ACTIVE or IDLE */
 		if (si->sess_state != CONNECTED) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
-			++epc_app.dl_params[SGI_PORT_ID].ddn_buf_pkts;
+			--EPC_DL_PARAMS.pkts_in;
+			++EPC_DL_PARAMS.ddn_buf_pkts;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"Session State is NOT CONNECTED\n", LOG_VALUE);
@@ -338,8 +347,8 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 		if (!far->actions.forw) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
-			++epc_app.dl_params[SGI_PORT_ID].ddn_buf_pkts;
+			--EPC_DL_PARAMS.pkts_in;
+			++EPC_DL_PARAMS.ddn_buf_pkts;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"Action is NOT set to FORW,"
 				" PDR_ID:%u, FAR_ID:%u\n",
@@ -351,7 +360,7 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 		if (!far->frwdng_parms.outer_hdr_creation.teid) {
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"Next hop teid is NULL: "
 				" PDR_ID:%u, FAR_ID:%u\n",
@@ -361,12 +370,26 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 			continue;
 		}
 
+		/* Prebuilt outer header of the FAR */
+		tmpl = far->encap_tmpl;
+		if (likely(tmpl != NULL)) {
+			if (gtpu_encap_tmpl_apply(m, tmpl, app.wb_port) < 0) {
+#ifdef STATS
+				--EPC_DL_PARAMS.pkts_in;
+#endif /* STATS */
+				clLog(clSystemLog, eCLSeverityDebug,
+						LOG_FORMAT"Failed to ENCAP GTPU HEADER \n", LOG_VALUE);
+				RESET_BIT(*pkts_mask, i);
+			}
+			continue;
+		}
+
 		/* Construct the IPv4/IPv6 header */
 		if ((pdr->far)->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc == GTPU_UDP_IPv4) {
 			if (ENCAP_GTPU_HDR(m,
 						(pdr->far)->frwdng_parms.outer_hdr_creation.teid, NOT_PRESENT) < 0) {
 #ifdef STATS
-				--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+				--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 				clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"Failed to ENCAP GTPU HEADER \n", LOG_VALUE);
@@ -423,12 +446,13 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 
 			/* construct udphdr */
 			construct_udp_hdr(m, len, UDP_PORT_GTPU, UDP_PORT_GTPU, NOT_PRESENT);
+			set_outer_hdr_checksum(m, IPV4_TYPE, app.wb_port);
 		} else if ((pdr->far)->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc == GTPU_UDP_IPv6) {
 			/* If next hop support IPv6 */
 			if (ENCAP_GTPU_HDR(m,
 						(pdr->far)->frwdng_parms.outer_hdr_creation.teid, PRESENT) < 0) {
 #ifdef STATS
-				--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+				--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 				clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"Failed to ENCAP GTPU HEADER \n", LOG_VALUE);
@@ -490,6 +514,7 @@ gtpu_encap(pdr_info_t **pdrs, pfcp_session_datat_t **sess_data, struct rte_mbuf
 			construct_ipv6_hdr(m, len, IP_PROTO_UDP, &src_addr, &dst_addr);
 			/* construct udphdr */
 			construct_udp_hdr(m, len, UDP_PORT_GTPU, UDP_PORT_GTPU, PRESENT);
+			set_outer_hdr_checksum(m, IPV6_TYPE, app.wb_port);
 		}
 	}
 }
@@ -522,7 +547,7 @@ ul_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 		if (pkts[j]->data_len == 0) {
 			RESET_BIT(*pkts_mask, j);
 #ifdef STATS
-			--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+			--EPC_UL_PARAMS.pkts_in;
 #endif /* STATS */
 			continue;
 		}
@@ -540,7 +565,7 @@ ul_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 					LOG_FORMAT"IPv4: WB_IP or WB_LI_IP is not valid dst ip address:"IPV4_ADDR"\n",
 					LOG_VALUE, IPV4_ADDR_HOST_FORMAT(ipv4_hdr->dst_addr));
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #endif /* STATS */
 				continue;
 			}
@@ -583,7 +608,7 @@ ul_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 					"is not valid dst ip address:"IPv6_FMT"\n",
 					LOG_VALUE, IPv6_PRINT(app.wb_ipv6), IPv6_PRINT(ho_addr));
 #ifdef STATS
-				--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+				--EPC_UL_PARAMS.pkts_in;
 #endif /* STATS */
 				continue;
 			}
@@ -676,7 +701,7 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 		if (pkts[j]->data_len == 0) {
 			RESET_BIT(*pkts_mask, j);
 #ifdef STATS
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 			continue;
 		}
@@ -704,7 +729,7 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 							IPV4_ADDR_HOST_FORMAT(app.eb_li_ip),
 							IPV4_ADDR_HOST_FORMAT(ntohl(ipv4_hdr->dst_addr)));
 #ifdef STATS
-					--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+					--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 					continue;
 				}
@@ -773,7 +798,7 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 						LOG_VALUE, IPv6_PRINT(app.eb_ipv6), IPv6_PRINT(app.eb_li_ipv6),
 						IPv6_PRINT(ho_addr));
 #ifdef STATS
-					--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+					--EPC_DL_PARAMS.pkts_in;
 #endif /* STATS */
 					continue;
 				}
@@ -844,8 +869,8 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 				/** Check downlink bearer is ACTIVE or IDLE */
 				if (ul_sess_data[j]->sess_state != CONNECTED) {
 #ifdef STATS
-					--epc_app.dl_params[SGI_PORT_ID].pkts_in;
-					++epc_app.dl_params[SGI_PORT_ID].ddn_buf_pkts;
+					--EPC_DL_PARAMS.pkts_in;
+					++EPC_DL_PARAMS.ddn_buf_pkts;
 #endif /* STATS */
 					RESET_BIT(*pkts_mask, ul_index[j]);
 					SET_BIT(*pkts_queue_mask, ul_index[j]);
@@ -896,8 +921,8 @@ dl_sess_info_get(struct rte_mbuf **pkts, uint32_t n,
 						"UE IP:"IPV4_ADDR" or "IPv6_FMT", ACL TABLE Index: %u "
 						"Session State:%u\n", LOG_VALUE,
 					IPV4_ADDR_HOST_FORMAT((dl_sess_data[j])->ue_ip_addr),
-					IPv6_PRINT(IPv6_CAST((dl_sess_data[j])->ue_ipv6_addr)),
-					(dl_sess_data[j])->acl_table_indx, (dl_sess_data[j])->sess_state);
+					IPv6_PRINT(IPv6_CAST((dl_sess_data[j])->cold->ue_ipv6_addr)),
+					(dl_sess_data[j])->acl_table_hot[0], (dl_sess_data[j])->sess_state);
 
 				if ((fwd_pkts_mask != NULL && encap_pkts_mask != NULL) &&
 					((ISSET_BIT(*pkts_mask, dl_index[j])) || (ISSET_BIT(*pkts_queue_mask, dl_index[j])))) {
@@ -1058,7 +1083,6 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 		} else {
 			RESET_BIT(*pkts_mask, i);
 		}
-		/* TODO: Set checksum offload.*/
 	}
 }
 
@@ -1150,8 +1174,9 @@ update_nexts5s8_info(struct rte_mbuf **pkts, uint32_t n,
 						LOG_VALUE, IPV4_ADDR_HOST_FORMAT(src_addr),
 						IPV4_ADDR_HOST_FORMAT(next_hop_addr));
 
-					/* Update the UDP checksum */
-					reset_udp_hdr_checksum(pkts[i], IPV4_TYPE);
+					/* Update the IP and UDP checksums, loopback pkts go back out the WB */
+					set_outer_hdr_checksum(pkts[i], IPV4_TYPE,
+							ISSET_BIT(*loopback_pkts_mask, i) ? app.wb_port : app.eb_port);
 
 				} else if (((sess_data[i]->pdrs)->far)->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc == GTPU_UDP_IPv6) {
 					/* Retrieve Next Hop Destination Address */
@@ -1234,8 +1259,9 @@ update_nexts5s8_info(struct rte_mbuf **pkts, uint32_t n,
 						LOG_FORMAT"IPv6 hdr: SRC ADDR:"IPv6_FMT", DST ADDR:"IPv6_FMT"\n",
 						LOG_VALUE, IPv6_PRINT(src_addr), IPv6_PRINT(next_hop_addr));
 
-					/* Update the UDP checksum */
-					reset_udp_hdr_checksum(pkts[i], IPV6_TYPE);
+					/* Update the UDP checksum, loopback pkts go back out the WB */
+					set_outer_hdr_checksum(pkts[i], IPV6_TYPE,
+							ISSET_BIT(*loopback_pkts_mask, i) ? app.wb_port : app.eb_port);
 
 				} else {
 					RESET_BIT(*pkts_mask, i);
@@ -1319,8 +1345,8 @@ update_enb_info(struct rte_mbuf **pkts, uint32_t n,
 						/* Fill the Source and Destination IP address in the IPv4 Header */
 						construct_ipv4_hdr(pkts[i], len, IP_PROTO_UDP, src_addr, enb_addr);
 
-						/* Update the UDP checksum */
-						reset_udp_hdr_checksum(pkts[i], IPV4_TYPE);
+						/* Update the IP and UDP checksums */
+						set_outer_hdr_checksum(pkts[i], IPV4_TYPE, app.wb_port);
 
 						/* Fill the PDR info form the session data */
 						pdr[i] = sess_data[i]->pdrs;
@@ -1380,7 +1406,7 @@ update_enb_info(struct rte_mbuf **pkts, uint32_t n,
 						construct_ipv6_hdr(pkts[i], len, IP_PROTO_UDP, &src_addr, &enb_addr);
 
 						/* Update the UDP checksum */
-						reset_udp_hdr_checksum(pkts[i], IPV6_TYPE);
+						set_outer_hdr_checksum(pkts[i], IPV6_TYPE, app.wb_port);
 
 						/* Fill the PDR info form the session data */
 						pdr[i] = sess_data[i]->pdrs;
@@ -1571,11 +1597,25 @@ void dump_core_pkts_in_pcap(struct rte_mbuf **pkts, uint32_t n,
 		if (ISSET_BIT(*pkts_mask, i)) {
 			struct pcap_pkthdr pcap_hdr;
 			uint8_t *pkt = rte_pktmbuf_mtod(pkts[i], uint8_t *);
+			uint8_t buf[ETHER_MAX_JUMBO_FRAME_LEN];
 
 			pcap_hdr.len = pkts[i]->pkt_len;
-			pcap_hdr.caplen = pcap_hdr.len;
+			pcap_hdr.caplen = RTE_MIN(pcap_hdr.len,
+					(uint32_t)ETHER_MAX_JUMBO_FRAME_LEN);
 			gettimeofday(&(pcap_hdr.ts), NULL);
 
+			/* Dump the checksums left to the NIC as they are sent */
+			if (pkts[i]->ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_L4_MASK)) {
+				const void *data = rte_pktmbuf_read(pkts[i], 0,
+						pcap_hdr.caplen, buf);
+				if (data != NULL) {
+					if (data != buf)
+						memcpy(buf, data, pcap_hdr.caplen);
+					up_csum_copy_fill(pkts[i], buf, pcap_hdr.caplen);
+					pkt = buf;
+				}
+			}
+
 			pcap_dump((u_char *)pcap_dumper, &pcap_hdr, pkt);
 			pcap_dump_flush((pcap_dumper_t *)pcap_dumper);
 		}
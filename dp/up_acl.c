@@ -17,8 +17,14 @@
 
 #define _GNU_SOURCE     /* Expose declaration of tdestroy() */
 #include <search.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_cycles.h>
 
 #include "up_acl.h"
+#include "up_rcu.h"
 #include "up_main.h"
 #include "gw_adapter.h"
 #define ACL_DENY_SIGNATURE	0x00000000
@@ -70,6 +76,12 @@
  */
 #define FWD_PORT_SHIFT 1
 
+/* Time the builder waits for more rule updates before a rebuild */
+#define ACL_BUILD_COALESCE_US 1000
+
+/* Max number of distinct SDF rules across all the ACL tables */
+#define ACL_RULE_SIG_HASH_SIZE (1 << 15)
+
 static uint32_t acl_table_indx_offset = 1;
 static uint32_t acl_table_indx;
 /* Max number of sdf rules */
@@ -221,10 +233,17 @@ struct acl_search {
  * @brief  : Maintains acl configuration
  */
 struct acl_config {
-	struct rte_acl_ctx *acx_ipv4;
-	struct rte_acl_ctx *acx_ipv6;
+	/* Contexts in use by the data cores, swapped by the builder */
+	struct rte_acl_ctx *volatile acx_ipv4;
+	struct rte_acl_ctx *volatile acx_ipv6;
 	uint8_t acx_ipv4_built;
 	uint8_t acx_ipv6_built;
+	uint8_t is_ipv6;
+	/* Rebuild queued, builder state under acl_build_lock */
+	uint8_t build_pending;
+	/* Last build of the table failed, its previous rules are kept */
+	uint8_t build_failed;
+	uint32_t build_gen;
 	struct acl_search acl_search;
 };
 
@@ -259,6 +278,40 @@ struct acl_rules_table {
 struct acl_config acl_config[MAX_ACL_TABLES];
 struct acl_rules_table acl_rules_table[MAX_ACL_TABLES];
 
+/* Background ACL builder, the local rule trees are shared with it */
+static pthread_t acl_builder;
+static pthread_mutex_t acl_build_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t acl_build_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t acl_build_q[MAX_ACL_TABLES];
+static uint32_t acl_build_q_cnt;
+/* Set while the builder compiles a dequeued batch */
+static uint8_t acl_build_busy;
+/* Context being filled by the builder from the local rule tree */
+static struct rte_acl_ctx *acl_build_ctx;
+
+/**
+ * @brief  : Canonical signature of a parsed SDF rule: 5-tuple values,
+ *           masks and port ranges, precedence and IP family. The rule
+ *           direction is part of the rule string (UL src/dst swapped).
+ */
+struct acl_rule_sig {
+	uint32_t value[NUM_FIELDS_IPV6];
+	uint32_t mask_range[NUM_FIELDS_IPV6];
+	uint32_t userdata;
+	uint32_t is_ipv6;
+};
+
+static void free_node(void *p);
+
+/* Rule signature to ACL table index */
+static struct rte_hash *acl_rule_sig_hash;
+/* Released ACL table indexes, reused before new ones */
+static uint32_t acl_free_tbl[MAX_ACL_TABLES];
+static uint32_t acl_free_tbl_cnt;
+/* Table and family of the rules unlinked by acl_rule_sig_unlink */
+static uint32_t acl_sig_tbl;
+static uint8_t acl_sig_ipv6;
+
 
 /*******************************************************[START]**********************************************************/
 /**
@@ -759,9 +812,7 @@ static void acl_rule_print(const void *nodep, const VISIT which, const int depth
 static void add_single_rule(const void *nodep, const VISIT which, const int depth)
 {
 	struct acl4_rule *r = NULL;
-
-	struct acl_config *pacl_config = &acl_config[acl_table_indx];
-	struct rte_acl_ctx *context = pacl_config->acx_ipv4;
+	struct rte_acl_ctx *context = acl_build_ctx;
 
 #pragma GCC diagnostic push  /* require GCC 4.6 */
 #pragma GCC diagnostic ignored "-Wcast-qual"
@@ -793,9 +844,7 @@ static void add_single_rule(const void *nodep, const VISIT which, const int dept
 static void add_single_ipv6_rule(const void *nodep, const VISIT which, const int depth)
 {
 	struct acl6_rule *r = NULL;
-
-	struct acl_config *pacl_config = &acl_config[acl_table_indx];
-	struct rte_acl_ctx *context = pacl_config->acx_ipv6;
+	struct rte_acl_ctx *context = acl_build_ctx;
 
 #pragma GCC diagnostic push  /* require GCC 4.6 */
 #pragma GCC diagnostic ignored "-Wcast-qual"
@@ -1029,15 +1078,22 @@ static struct rte_acl_ctx *acl_context_init(char *name,
 
 	/*Create the ACL Table */
 	context = rte_acl_create(&acl_param);
-	if (context == NULL)
-		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to create ACL context\n", LOG_VALUE);
+	if (context == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create ACL context %s\n", LOG_VALUE, name);
+		return NULL;
+	}
 
 	if (parm_config.scalar
 			&& rte_acl_set_ctx_classify(context,
 				RTE_ACL_CLASSIFY_SCALAR)
-			!= 0)
-		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to setup classify method for ACL context\n",
-			LOG_VALUE);
+			!= 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to setup classify method for ACL context %s\n",
+			LOG_VALUE, name);
+		rte_acl_free(context);
+		return NULL;
+	}
 
 	return context;
 }
@@ -1059,15 +1115,15 @@ acl_config_init(struct acl_config *acl_config,
 		char *name, uint32_t max_elements, uint8_t is_ipv6)
 {
 
-	memset(acl_config, 0, sizeof(struct acl_config));
+	RTE_SET_USED(name);
+	RTE_SET_USED(max_elements);
 
-	if(!is_ipv6){
-		acl_config->acx_ipv4 =
-		acl_context_init(name, max_elements, 0, is_ipv6);
-	} else{
-		acl_config->acx_ipv6 =
-		acl_context_init(name, max_elements, 0, is_ipv6);
-	}
+	/* The contexts are created and published by the ACL builder, a
+	 * reused table index keeps its builder state */
+	pthread_mutex_lock(&acl_build_lock);
+	acl_config->is_ipv6 = is_ipv6;
+	acl_config->build_failed = 0;
+	pthread_mutex_unlock(&acl_build_lock);
 	return 0;
 }
 
@@ -1081,7 +1137,19 @@ up_sdf_filter_table_create(uint32_t max_elements, uint8_t is_ipv6)
 {
 	char name[NAME_LEN];
 	char *buf = "ACLTable-";
-	acl_table_indx = acl_table_indx_offset;
+	uint8_t reused = 0;
+
+	if (acl_free_tbl_cnt) {
+		acl_table_indx = acl_free_tbl[--acl_free_tbl_cnt];
+		reused = 1;
+	} else if (acl_table_indx_offset < MAX_ACL_TABLES) {
+		acl_table_indx = acl_table_indx_offset;
+	} else {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"All the %u ACL tables are in use\n",
+			LOG_VALUE, MAX_ACL_TABLES - 1);
+		return -1;
+	}
 
 	/* Increment the New Created ACL tables */
 	snprintf(name, NAME_LEN, "%s%u", buf, acl_table_indx);
@@ -1104,7 +1172,8 @@ up_sdf_filter_table_create(uint32_t max_elements, uint8_t is_ipv6)
 	}
 
 	/* Increment the ACL Table index */
-	acl_table_indx_offset++;
+	if (!reused)
+		acl_table_indx_offset++;
 	/* Return New created ACL table index */
 	return acl_table_indx;
 }
@@ -1112,73 +1181,407 @@ up_sdf_filter_table_create(uint32_t max_elements, uint8_t is_ipv6)
 /**
  * @brief  : Add rules from local table to rte acl rules table.
  * @param  : ACL Table Index
+ * @param  : context, acl context to fill
  * @return : Returns nothing
  */
 static void
-add_rules_to_rte_acl(uint8_t indx, uint8_t is_ipv6)
+add_rules_to_rte_acl(uint32_t indx, struct rte_acl_ctx *context, uint8_t is_ipv6)
 {
 	struct acl_rules_table *t = &acl_rules_table[indx];
-	acl_table_indx = indx;
+	acl_build_ctx = context;
 	if(!is_ipv6)
 		twalk(t->root, t->add_entry);
 	else
 		twalk(t->root, t->add_ipv6_entry);
+	acl_build_ctx = NULL;
 }
 
 /**
- * @brief  : To reset and build ACL table.
- *           This funciton reset the acl context rules,
- *           and add the new rules and build table.
- *           This should be called only for standby tables.
- * @param  : ACL Table Index, table index to reset and build.
+ * @brief  : Release a retired ACL context.
+ * @param  : obj, rte acl context
+ * @return : Returns nothing
+ */
+static void
+acl_context_free(void *obj)
+{
+	rte_acl_free((struct rte_acl_ctx *)obj);
+}
+
+/**
+ * @brief  : Build a new ACL context from the local rules table and
+ *           publish it in place of the active one. The old context is
+ *           freed once the data cores have quiesced.
+ *           Runs on the ACL builder thread only.
+ * @param  : ACL Table Index, table index to build.
  * @return : Returns 0 in case of success , -1 otherwise
  */
 static int
-reset_and_build_rules(uint32_t indx, uint8_t is_ipv6)
+acl_build_and_swap(uint32_t indx)
 {
 	int ret = 0;
-	int dim = is_ipv6 ? RTE_DIM(ipv4_defs) : RTE_DIM(ipv4_defs);
+	char name[NAME_LEN];
 	struct rte_acl_config acl_build_param = {0};
 	struct acl_config *pacl_config = &acl_config[indx];
 	struct rte_acl_ctx *context = NULL;
-	if(!is_ipv6)
-		context = pacl_config->acx_ipv4;
-	else
-		context = pacl_config->acx_ipv6;
+	struct rte_acl_ctx *old = NULL;
+	struct rte_acl_ctx *other = NULL;
+	uint8_t is_ipv6 = pacl_config->is_ipv6;
+	uint8_t has_rules = 0;
+	int dim = is_ipv6 ? RTE_DIM(ipv6_defs) : RTE_DIM(ipv4_defs);
+
+	pthread_mutex_lock(&acl_build_lock);
+	has_rules = (acl_rules_table[indx].num_entries != 0);
+	if (has_rules) {
+		/* rte_acl_create returns the existing context for a known name */
+		snprintf(name, NAME_LEN, "ACLTable-%u-%u", indx,
+				++pacl_config->build_gen);
+		context = acl_context_init(name,
+				acl_rules_table[indx].max_entries, 0, is_ipv6);
+		if (context != NULL)
+			add_rules_to_rte_acl(indx, context, is_ipv6);
+	}
+	pthread_mutex_unlock(&acl_build_lock);
+
+	if ((context == NULL) && has_rules)
+		return -1;
 
-	/* Delete all rules from the ACL context. */
-	rte_acl_reset_rules(context);
+	if (context != NULL) {
+		/* Perform builds */
+		acl_build_param.num_categories = DEFAULT_MAX_CATEGORIES;
+		acl_build_param.num_fields = dim;
+		if(!is_ipv6)
+			memcpy(&acl_build_param.defs, ipv4_defs,
+					sizeof(ipv4_defs));
+		else
+			memcpy(&acl_build_param.defs, ipv6_defs,
+					sizeof(ipv6_defs));
+
+		/* Build the ACL run time structure */
+		if ((ret = rte_acl_build(context, &acl_build_param)) != 0) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to build ACL trie, ACL_RULES_TABLE-%u,"
+				" ret:%d, error:%s, keeping the previous rules\n",
+				LOG_VALUE, indx, ret, rte_strerror(rte_errno));
+			rte_acl_free(context);
+			return -1;
+		}
+#ifdef DEBUG_ACL
+		rte_acl_dump(context);
+#endif
+	}
 
-	/* Add the rules from local table to ACL table */
-	add_rules_to_rte_acl(indx, is_ipv6);
+	/* Publish the new context, an empty table has none. A table serves
+	 * one IP family, a reused index drops the other family context. */
+	rte_smp_wmb();
+	if(!is_ipv6) {
+		old = pacl_config->acx_ipv4;
+		other = pacl_config->acx_ipv6;
+		pacl_config->acx_ipv4 = context;
+		pacl_config->acx_ipv4_built = (context != NULL);
+		pacl_config->acx_ipv6 = NULL;
+		pacl_config->acx_ipv6_built = 0;
+	} else {
+		old = pacl_config->acx_ipv6;
+		other = pacl_config->acx_ipv4;
+		pacl_config->acx_ipv6 = context;
+		pacl_config->acx_ipv6_built = (context != NULL);
+		pacl_config->acx_ipv4 = NULL;
+		pacl_config->acx_ipv4_built = 0;
+	}
 
-	/* Perform builds */
-	memset(&acl_build_param, 0, sizeof(acl_build_param));
+	up_rcu_defer_call(old, acl_context_free);
+	up_rcu_defer_call(other, acl_context_free);
+	return 0;
+}
 
-	acl_build_param.num_categories = DEFAULT_MAX_CATEGORIES;
-	acl_build_param.num_fields = dim;
-	if(!is_ipv6)
-		memcpy(&acl_build_param.defs, ipv4_defs,
-				sizeof(ipv4_defs));
-	else
-		memcpy(&acl_build_param.defs, ipv6_defs,
-				sizeof(ipv6_defs));
+/**
+ * @brief  : ACL builder thread, coalesces the queued table updates and
+ *           rebuilds each updated table once.
+ * @param  : arg, unused parameter
+ * @return : Returns nothing
+ */
+static void *
+acl_builder_thread(void *arg)
+{
+	uint32_t batch[MAX_ACL_TABLES];
+	uint32_t cnt = 0;
+	uint32_t i = 0;
+	int ret = 0;
 
-	/* Build the ACL run time structure */
-	if ((ret = rte_acl_build(context, &acl_build_param)) != 0) {
-		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to build ACL trie,"
-				"ACL_RULES_TABLE-%u, ret:%d, error:%s\n",
-				LOG_VALUE, indx, ret, rte_strerror(rte_errno));
+	RTE_SET_USED(arg);
+
+	while (1) {
+		pthread_mutex_lock(&acl_build_lock);
+		while (acl_build_q_cnt == 0)
+			pthread_cond_wait(&acl_build_cond, &acl_build_lock);
+		pthread_mutex_unlock(&acl_build_lock);
+
+		/* Let a PFCP burst queue its rule updates first */
+		usleep(ACL_BUILD_COALESCE_US);
+
+		pthread_mutex_lock(&acl_build_lock);
+		cnt = acl_build_q_cnt;
+		memcpy(batch, acl_build_q, cnt * sizeof(batch[0]));
+		for (i = 0; i < cnt; i++)
+			acl_config[batch[i]].build_pending = 0;
+		acl_build_q_cnt = 0;
+		acl_build_busy = 1;
+		pthread_mutex_unlock(&acl_build_lock);
+
+		for (i = 0; i < cnt; i++) {
+			ret = acl_build_and_swap(batch[i]);
+
+			pthread_mutex_lock(&acl_build_lock);
+			acl_config[batch[i]].build_failed = (ret < 0);
+			pthread_mutex_unlock(&acl_build_lock);
+		}
+
+		pthread_mutex_lock(&acl_build_lock);
+		acl_build_busy = 0;
+		pthread_mutex_unlock(&acl_build_lock);
 	}
 
-	if(!is_ipv6)
-		pacl_config->acx_ipv4_built = 1;
-	else
-		pacl_config->acx_ipv6_built = 1;
+	return NULL;
+}
 
-#ifdef DEBUG_ACL
-	rte_acl_dump(context);
-#endif
+/**
+ * @brief  : To reset and build ACL table.
+ *           Queue the table to the ACL builder, the rules table is
+ *           compiled in the background and swapped in when ready.
+ *           Several updates of a table before the build cost one build.
+ * @param  : ACL Table Index, table index to reset and build.
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+reset_and_build_rules(uint32_t indx, uint8_t is_ipv6)
+{
+	struct acl_config *pacl_config = &acl_config[indx];
+
+	pthread_mutex_lock(&acl_build_lock);
+	pacl_config->is_ipv6 = is_ipv6;
+	if (!pacl_config->build_pending) {
+		pacl_config->build_pending = 1;
+		acl_build_q[acl_build_q_cnt++] = indx;
+		pthread_cond_signal(&acl_build_cond);
+	}
+	pthread_mutex_unlock(&acl_build_lock);
+
+	return 0;
+}
+
+int
+up_acl_init(void)
+{
+	int ret = 0;
+	struct rte_hash_parameters sig_hash_params = {
+		.name = "ACL_RULE_SIG_HASH",
+		.entries = ACL_RULE_SIG_HASH_SIZE,
+		.key_len = sizeof(struct acl_rule_sig),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id()
+	};
+
+	acl_rule_sig_hash = rte_hash_create(&sig_hash_params);
+	if (acl_rule_sig_hash == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create ACL rule signature hash: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	ret = pthread_create(&acl_builder, NULL, &acl_builder_thread, NULL);
+	if (ret != 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create ACL builder thread: %s\n",
+			LOG_VALUE, strerror(ret));
+		return -1;
+	}
+	pthread_setname_np(acl_builder, "acl_builder");
+
+	return 0;
+}
+
+int
+up_acl_build_wait(uint32_t timeout_ms)
+{
+	uint8_t idle = 0;
+	uint64_t deadline = rte_get_tsc_hz() / 1000 * timeout_ms + rte_rdtsc();
+
+	while (1) {
+		pthread_mutex_lock(&acl_build_lock);
+		idle = (acl_build_q_cnt == 0) && !acl_build_busy;
+		pthread_mutex_unlock(&acl_build_lock);
+
+		if (idle)
+			return 0;
+
+		if (rte_rdtsc() > deadline)
+			return -1;
+
+		usleep(ACL_BUILD_COALESCE_US);
+	}
+}
+
+int
+up_acl_table_check(uint32_t indx)
+{
+	uint8_t failed = 0;
+
+	if ((indx == 0) || (indx >= MAX_ACL_TABLES))
+		return -1;
+
+	pthread_mutex_lock(&acl_build_lock);
+	failed = acl_config[indx].build_failed;
+	pthread_mutex_unlock(&acl_build_lock);
+
+	if (failed) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"ACL_RULES_TABLE-%u last build failed\n",
+			LOG_VALUE, indx);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Fill the canonical signature of a parsed rule.
+ * @param  : rule, parsed acl rule with userdata set
+ * @param  : is_ipv6, rule IP family
+ * @param  : sig, signature to fill
+ * @return : Returns nothing
+ */
+static void
+acl_rule_sig_fill(const struct rte_acl_rule *rule, uint8_t is_ipv6,
+		struct acl_rule_sig *sig)
+{
+	uint32_t num = is_ipv6 ? NUM_FIELDS_IPV6 : NUM_FIELDS_IPV4;
+	uint32_t i = 0;
+
+	memset(sig, 0, sizeof(struct acl_rule_sig));
+
+	/* Rules are parsed in zeroed storage, u32 covers the u8/u16 fields */
+	for (i = 0; i < num; i++) {
+		sig->value[i] = rule->field[i].value.u32;
+		sig->mask_range[i] = rule->field[i].mask_range.u32;
+	}
+	sig->userdata = rule->data.userdata;
+	sig->is_ipv6 = is_ipv6;
+}
+
+/**
+ * @brief  : Lookup the ACL table holding a rule.
+ * @param  : rule, parsed acl rule
+ * @param  : is_ipv6, rule IP family
+ * @return : Returns ACL table index, -1 if the rule is not installed
+ */
+static int
+acl_rule_sig_lookup(const struct rte_acl_rule *rule, uint8_t is_ipv6)
+{
+	struct acl_rule_sig sig;
+	void *data = NULL;
+
+	acl_rule_sig_fill(rule, is_ipv6, &sig);
+	if (rte_hash_lookup_data(acl_rule_sig_hash, &sig, &data) < 0)
+		return -1;
+
+	return (int)(uintptr_t)data;
+}
+
+/**
+ * @brief  : Map a rule to the ACL table holding it, the first table
+ *           installing a rule keeps it.
+ * @param  : rule, parsed acl rule
+ * @param  : is_ipv6, rule IP family
+ * @param  : indx, ACL table index
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+acl_rule_sig_add(const struct rte_acl_rule *rule, uint8_t is_ipv6,
+		uint32_t indx)
+{
+	struct acl_rule_sig sig;
+	int ret = 0;
+
+	if (acl_rule_sig_lookup(rule, is_ipv6) >= 0)
+		return 0;
+
+	acl_rule_sig_fill(rule, is_ipv6, &sig);
+	ret = rte_hash_add_key_data(acl_rule_sig_hash, &sig,
+			(void *)(uintptr_t)indx);
+	if (ret < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to add SDF rule signature for"
+			" ACL_Table_Index-%u, Error: %s\n", LOG_VALUE, indx,
+			rte_strerror(abs(ret)));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief  : Unmap the rules of table acl_sig_tbl while walking its tree.
+ * @param  : nodep, rule node
+ * @param  : which, traversal order
+ * @param  : depth, node depth
+ * @return : Returns nothing
+ */
+static void
+acl_rule_sig_unlink(const void *nodep, const VISIT which, const int depth)
+{
+	struct rte_acl_rule *r = NULL;
+	struct acl_rule_sig sig;
+
+	RTE_SET_USED(depth);
+
+#pragma GCC diagnostic push  /* require GCC 4.6 */
+#pragma GCC diagnostic ignored "-Wcast-qual"
+	r = *(struct rte_acl_rule **) nodep;
+#pragma GCC diagnostic pop   /* require GCC 4.6 */
+
+	switch (which) {
+	case leaf:
+	case postorder:
+		if (acl_rule_sig_lookup(r, acl_sig_ipv6) == (int)acl_sig_tbl) {
+			acl_rule_sig_fill(r, acl_sig_ipv6, &sig);
+			rte_hash_del_key(acl_rule_sig_hash, &sig);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief  : Release an ACL table without users: unmap and free its rules,
+ *           let the builder retire its context and recycle the index.
+ * @param  : indx, ACL table index
+ * @param  : is_ipv6, table IP family
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+acl_table_reclaim(uint32_t indx, uint8_t is_ipv6)
+{
+	struct acl_rules_table *t = &acl_rules_table[indx];
+
+	acl_sig_tbl = indx;
+	acl_sig_ipv6 = is_ipv6;
+	twalk(t->root, acl_rule_sig_unlink);
+
+	pthread_mutex_lock(&acl_build_lock);
+	tdestroy(t->root, free_node);
+	t->root = NULL;
+	t->num_entries = 0;
+	pthread_mutex_unlock(&acl_build_lock);
+
+	if (reset_and_build_rules(indx, is_ipv6) < 0)
+		return -1;
+
+	acl_free_tbl[acl_free_tbl_cnt++] = indx;
+
+	clLog(clSystemLog, eCLSeverityDebug,
+		LOG_FORMAT"ACL_Table_Index-%u reclaimed\n", LOG_VALUE, indx);
 	return 0;
 }
 
@@ -1192,6 +1595,8 @@ static int
 up_rules_entry_add(struct acl_rules_table *t,
 				struct acl4_rule *rule, uint8_t is_ipv6)
 {
+	void *node = NULL;
+
 	if (t->num_entries == t->max_entries)
 		clLog(clSystemLog, eCLSeverityDebug,
 			LOG_FORMAT":%s reached max rules entries\n", LOG_VALUE, t->name);
@@ -1205,7 +1610,10 @@ up_rules_entry_add(struct acl_rules_table *t,
 		}
 		memcpy(new, rule, sizeof(struct acl4_rule));
 		/* put node into the tree */
-		if (tsearch(new, &t->root, t->compare_rule) == 0) {
+		pthread_mutex_lock(&acl_build_lock);
+		node = tsearch(new, &t->root, t->compare_rule);
+		pthread_mutex_unlock(&acl_build_lock);
+		if (node == NULL) {
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT":Fail to add acl precedance %d\n", LOG_VALUE,
 				rule->data.userdata - ACL_DENY_SIGNATURE);
@@ -1222,7 +1630,10 @@ up_rules_entry_add(struct acl_rules_table *t,
 		memcpy(new, rule, sizeof(struct acl6_rule));
 
 		/* put node into the tree */
-		if (tsearch(new, &t->root, t->compare_ipv6_rule) == 0) {
+		pthread_mutex_lock(&acl_build_lock);
+		node = tsearch(new, &t->root, t->compare_ipv6_rule);
+		pthread_mutex_unlock(&acl_build_lock);
+		if (node == NULL) {
 			clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT":Fail to add acl precedance %d\n", LOG_VALUE,
 				rule->data.userdata - ACL_DENY_SIGNATURE);
@@ -1230,7 +1641,9 @@ up_rules_entry_add(struct acl_rules_table *t,
 		}
 	}
 
+	pthread_mutex_lock(&acl_build_lock);
 	t->num_entries++;
+	pthread_mutex_unlock(&acl_build_lock);
 	return 0;
 }
 
@@ -1302,6 +1715,7 @@ up_filter_entry_add(uint32_t indx, struct sdf_pkt_filter *pkt_filter)
 			LOG_FORMAT"Up rules entry add failed\n", LOG_VALUE);
 		return -1;
 	}
+	acl_rule_sig_add(next, 0, indx);
 
 	if (reset_and_build_rules(indx, 0) < 0) {
 		clLog(clSystemLog, eCLSeverityCritical,
@@ -1320,7 +1734,7 @@ int
 get_acl_table_indx(struct sdf_pkt_filter *pkt_filter, uint8_t is_create)
 {
 	uint8_t prio = 0;
-	uint32_t it = 0;
+	int it = 0;
 	char *buf = NULL;
 	struct acl4_rule r4 = {0};
 	struct acl6_rule r6 = {0};
@@ -1365,27 +1779,14 @@ get_acl_table_indx(struct sdf_pkt_filter *pkt_filter, uint8_t is_create)
 	print_one_ipv6_rule((struct acl6_rule  *)next, 1);
 
 	/* Find similar rule is present or not */
-	for (uint32_t itr = 1; itr < acl_table_indx_offset; itr++) {
-		struct acl_rules_table *ctx = &acl_rules_table[itr];
-		struct acl_rules_table *t = NULL;
-		if (ctx == NULL)
-			continue;
-
+	it = acl_rule_sig_lookup(next, is_ipv6);
+	if (it > 0) {
 		clLog(clSystemLog, eCLSeverityDebug,
-			LOG_FORMAT"Search SDF Rule in ACL_Table_Index :%u\n",
-			LOG_VALUE, itr);
-		if(!is_ipv6)
-			t = tfind(next, &ctx->root, ctx->compare_rule);
-		else
-			t = tfind(next, &ctx->root, ctx->compare_ipv6_rule);
-		if (t != NULL) {
-			clLog(clSystemLog, eCLSeverityDebug,
-				LOG_FORMAT"SDF Rule match in ACL_Table_Index-%u\nDP: SDF Rule:%s\n",
-				LOG_VALUE, itr, pkt_filter->u.rule_str);
-			if(SESS_CREATE == is_create)
-				acl_rules_table[itr].num_of_ue++;
-			return itr;
-		}
+			LOG_FORMAT"SDF Rule match in ACL_Table_Index-%u\nDP: SDF Rule:%s\n",
+			LOG_VALUE, it, pkt_filter->u.rule_str);
+		if(SESS_CREATE == is_create)
+			acl_rules_table[it].num_of_ue++;
+		return it;
 	}
 
 	if(SESS_CREATE != is_create)
@@ -1403,6 +1804,11 @@ get_acl_table_indx(struct sdf_pkt_filter *pkt_filter, uint8_t is_create)
 				(struct acl4_rule *)next, is_ipv6) < 0) {
 		clLog(clSystemLog, eCLSeverityCritical,
 				LOG_FORMAT"Up rules entry addtion failed\n", LOG_VALUE);
+		acl_free_tbl[acl_free_tbl_cnt++] = it;
+		return -1;
+	}
+	if (acl_rule_sig_add(next, is_ipv6, it) < 0) {
+		acl_table_reclaim(it, is_ipv6);
 		return -1;
 	}
 	acl_rules_table[it].num_of_ue++;
@@ -1442,6 +1848,7 @@ up_rules_entry_delete(struct acl_rules_table *t,
 				struct sdf_pkt_filter *pkt_filter_entry)
 {
 	void **p;
+	void *stored = NULL;
 	struct acl4_rule rule_v4 = {0};
 	uint8_t prio = 0;
 	char *buf = NULL;
@@ -1461,15 +1868,22 @@ up_rules_entry_delete(struct acl_rules_table *t,
 	next->data.priority = prio;
 	next->data.category_mask = -1;
 
-	p = tdelete(next, &t->root, t->compare_rule);
+	/* tdelete returns the parent node, keep the stored rule to free it */
+	pthread_mutex_lock(&acl_build_lock);
+	p = tfind(next, &t->root, t->compare_rule);
+	if (p != NULL) {
+		stored = *p;
+		tdelete(next, &t->root, t->compare_rule);
+		t->num_entries--;
+	}
+	pthread_mutex_unlock(&acl_build_lock);
 	if (p == NULL) {
 		clLog(clSystemLog, eCLSeverityDebug,
 			LOG_FORMAT"Fail to delete acl rule id %d\n", LOG_VALUE,
 			rule_v4.data.userdata - ACL_DENY_SIGNATURE);
 		return -1;
 	}
-	t->num_entries--;
-	rte_free(*p);
+	rte_free(stored);
 	return 0;
 }
 
@@ -1484,6 +1898,7 @@ up_ipv6_rules_entry_delete(struct acl_rules_table *t,
 				struct sdf_pkt_filter *pkt_filter_entry)
 {
 	void **p;
+	void *stored = NULL;
 	struct acl6_rule rule_v6 = {0};
 	uint8_t prio = 0;
 	char *buf = NULL;
@@ -1501,15 +1916,22 @@ up_ipv6_rules_entry_delete(struct acl_rules_table *t,
 	next->data.priority = prio;
 	next->data.category_mask = -1;
 
-	p = tdelete(next, &t->root, t->compare_ipv6_rule);
+	/* tdelete returns the parent node, keep the stored rule to free it */
+	pthread_mutex_lock(&acl_build_lock);
+	p = tfind(next, &t->root, t->compare_ipv6_rule);
+	if (p != NULL) {
+		stored = *p;
+		tdelete(next, &t->root, t->compare_ipv6_rule);
+		t->num_entries--;
+	}
+	pthread_mutex_unlock(&acl_build_lock);
 	if (p == NULL) {
 		clLog(clSystemLog, eCLSeverityDebug,
 			LOG_FORMAT"Fail to delete acl rule id %d\n", LOG_VALUE,
 			next->data.userdata - ACL_DENY_SIGNATURE);
 		return -1;
 	}
-	t->num_entries--;
-	rte_free(*p);
+	rte_free(stored);
 	return 0;
 }
 
@@ -1592,6 +2014,96 @@ uint32_t *sdf_lookup(struct rte_mbuf **m, int nb_rx, uint32_t indx)
 	return acl_lookup(m, indx, &acl_config[indx], &acl_config[indx].acl_search);
 }
 
+/**
+ * @brief  : Classify a group of packets against one ACL context
+ * @param  : context, ACL context of the table
+ * @param  : data, pointers to the packets classification fields
+ * @param  : pkt_idx, position of the packets in the burst
+ * @param  : num, number of packets in the group
+ * @param  : res, per burst packet results to fill
+ * @return : Returns number of rte_acl_classify calls issued
+ */
+static inline uint32_t
+acl_classify_group(struct rte_acl_ctx *context, const uint8_t **data,
+		const uint8_t *pkt_idx, uint32_t num, uint32_t *res)
+{
+	uint32_t grp_res[MAX_BURST_SZ];
+	uint32_t i = 0;
+
+	if ((num == 0) || (context == NULL) || (context->trans_table == NULL))
+		return 0;
+
+	rte_acl_classify(context, data, grp_res, num, DEFAULT_MAX_CATEGORIES);
+
+	for (i = 0; i < num; i++)
+		res[pkt_idx[i]] = grp_res[i];
+
+	return 1;
+}
+
+uint32_t
+sdf_lookup_bulk(struct rte_mbuf **m, uint32_t n, const int *tbl_indx,
+		uint32_t *res)
+{
+	uint8_t order[MAX_BURST_SZ];
+	const uint8_t *data_ipv4[MAX_BURST_SZ];
+	const uint8_t *data_ipv6[MAX_BURST_SZ];
+	uint8_t pkt_ipv4[MAX_BURST_SZ];
+	uint8_t pkt_ipv6[MAX_BURST_SZ];
+	uint32_t num_ipv4 = 0;
+	uint32_t num_ipv6 = 0;
+	uint32_t calls = 0;
+	uint32_t cnt = 0;
+	uint32_t i = 0;
+	uint32_t k = 0;
+
+	if (n > MAX_BURST_SZ)
+		n = MAX_BURST_SZ;
+
+	/* Keep the packets having a table, ordered by table index so that
+	 * the packets sharing a context are contiguous */
+	for (i = 0; i < n; i++) {
+		res[i] = 0;
+		if ((tbl_indx[i] <= 0) || (tbl_indx[i] >= MAX_ACL_TABLES))
+			continue;
+
+		k = cnt++;
+		while ((k > 0) && (tbl_indx[order[k - 1]] > tbl_indx[i])) {
+			order[k] = order[k - 1];
+			k--;
+		}
+		order[k] = i;
+	}
+
+	/* One classify per ACL context, at the width of its packet group */
+	for (i = 0; i < cnt; i = k) {
+		int indx = tbl_indx[order[i]];
+
+		num_ipv4 = 0;
+		num_ipv6 = 0;
+		for (k = i; (k < cnt) && (tbl_indx[order[k]] == indx); k++) {
+			struct rte_mbuf *pkt = m[order[k]];
+			uint8_t *data = rte_pktmbuf_mtod_offset(pkt, uint8_t *,
+					ETH_HDR_SIZE);
+
+			if ((data[0] & VERSION_FLAG_CHECK) == IPv4_VERSION) {
+				data_ipv4[num_ipv4] = MBUF_IPV4_2PROTO(pkt);
+				pkt_ipv4[num_ipv4++] = order[k];
+			} else if ((data[0] & VERSION_FLAG_CHECK) == IPv6_VERSION) {
+				data_ipv6[num_ipv6] = MBUF_IPV6_2PROTO(pkt);
+				pkt_ipv6[num_ipv6++] = order[k];
+			}
+		}
+
+		calls += acl_classify_group(acl_config[indx].acx_ipv4,
+				data_ipv4, pkt_ipv4, num_ipv4, res);
+		calls += acl_classify_group(acl_config[indx].acx_ipv6,
+				data_ipv6, pkt_ipv6, num_ipv6, res);
+	}
+
+	return calls;
+}
+
 /* Function to add the default entry into the acl table */
 int up_sdf_default_entry_add(uint32_t indx, uint32_t precedence, uint8_t direction)
 {
@@ -1641,27 +2153,22 @@ int
 sdf_table_delete(uint32_t indx,
 		struct sdf_pkt_filter *pkt_filter_entry){
 
-	struct rte_acl_ctx *ctx = NULL;
 	struct acl_rules_table *t = &acl_rules_table[indx];
 	uint8_t is_ipv6 = (pkt_filter_entry->rule_ip_type == RULE_IPV6);
-	if(!is_ipv6)
-		ctx = acl_config[indx].acx_ipv4;
-	else
-		ctx = acl_config[indx].acx_ipv6;
-	/* Delete all rules from the ACL context and destroy all internal run-time structures */
-	rte_acl_reset(ctx);
-
 
 	if(!is_ipv6){
 		up_rules_entry_delete(t, pkt_filter_entry);
 	} else {
 		up_ipv6_rules_entry_delete(t, pkt_filter_entry);
 	}
-	clLog(clSystemLog, eCLSeverityDebug,
-		LOG_FORMAT"ACL DEL:%s \n", LOG_VALUE, ctx->name);
 
-	t = NULL;
-	free(t);
+	/* The data cores may still classify on the context, the builder
+	 * unpublishes the emptied table and retires the context */
+	if (reset_and_build_rules(indx, is_ipv6) < 0)
+		return -1;
+
+	clLog(clSystemLog, eCLSeverityDebug,
+		LOG_FORMAT"ACL DEL:%s \n", LOG_VALUE, t->name);
 	return 0;
 }
 
@@ -1679,6 +2186,7 @@ remove_rule_entry_acl(uint32_t indx,
 		LOG_VALUE, t->num_of_ue);
 		return 0;
 	}
+	t->num_of_ue = 0;
 
 	if(t->num_entries == 0){
 		clLog(clSystemLog, eCLSeverityDebug,
@@ -1686,15 +2194,7 @@ remove_rule_entry_acl(uint32_t indx,
 		return 0;
 	}
 
-	if(t->num_entries == 1)
-		return sdf_table_delete(indx, pkt_filter_entry);
-	else{
-		if(up_sdf_filter_entry_delete(indx, pkt_filter_entry)) {
-			clLog(clSystemLog, eCLSeverityCritical,
-				"Failed to delete up sdf filter entry\n", LOG_VALUE);
-			return -1;
-		}
-		return reset_and_build_rules(indx, is_ipv6);
-	}
+	/* Last user of the table is gone, release the table */
+	return acl_table_reclaim(indx, is_ipv6);
 }
 /****************************************[END]****************************************/
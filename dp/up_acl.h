@@ -106,6 +106,19 @@ enum  rule_ip_type {
 uint32_t *
 sdf_lookup(struct rte_mbuf **m, int nb_rx, uint32_t indx);
 
+/**
+ * @brief  : Function for SDF lookup of a burst. Packets are grouped by ACL
+ *           table and each table is classified once for all its packets.
+ * @param  : m, pointer to pkts.
+ * @param  : n, num. of pkts.
+ * @param  : tbl_indx, per packet acl table index, 0 to skip the packet
+ * @param  : res, per packet search result, 0 when no rule matched
+ * @return : Returns number of classify calls issued
+ */
+uint32_t
+sdf_lookup_bulk(struct rte_mbuf **m, uint32_t n, const int *tbl_indx,
+		uint32_t *res);
+
 
 /******************** UP SDF functions **********************/
 
@@ -179,5 +192,33 @@ remove_rule_entry_acl(uint32_t indx,
 int
 sdf_table_delete(uint32_t indx,
 				struct sdf_pkt_filter *pkt_filter_entry);
+
+/**
+ * @brief  : Create the SDF rule signature index and start the ACL builder
+ *           thread. ACL tables are compiled in the background and swapped
+ *           in without stalling the data cores.
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_acl_init(void);
+
+/**
+ * @brief  : Wait for the ACL builder to compile and swap in all the queued
+ *           tables, for the tools that install rules before the traffic.
+ * @param  : timeout_ms, max wait in msec
+ * @return : Returns 0 in case of success , -1 on timeout
+ */
+int
+up_acl_build_wait(uint32_t timeout_ms);
+
+/**
+ * @brief  : Report the result of the last completed build of an ACL
+ *           table, without waiting for the queued ones.
+ * @param  : indx, ACL table index
+ * @return : Returns 0 in case of success , -1 if the last build failed
+ */
+int
+up_acl_table_check(uint32_t indx);
 #endif /* _UP_ACL_H_ */
 
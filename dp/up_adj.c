@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_hash.h>
+#include <rte_ring.h>
+#include <rte_errno.h>
+#include <rte_jhash.h>
+#include <rte_malloc.h>
+
+#include "up_main.h"
+#include "up_adj.h"
+#include "up_ether.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+extern struct rte_mempool *arp_quxmpool[NUM_SPGW_PORTS];
+
+rte_atomic32_t up_adj_route_gen = RTE_ATOMIC32_INIT(0);
+
+/* Adjacencies per port, keyed by next hop */
+static struct rte_hash *adj_hash[NUM_SPGW_PORTS];
+
+/* Default gateway adjacency per port */
+static struct up_adj *adj_gw[NUM_SPGW_PORTS];
+
+/* Packets waiting for the mct core to resolve their next hop */
+static struct rte_ring *adj_resolve_ring;
+
+/**
+ * @brief  : Create the default gateway adjacency of the port
+ * @param  : portid, port id
+ * @param  : gw_ip, gateway IPv4 address in network order, 0 if not set
+ * @return : Returns nothing
+ */
+static void
+adj_gw_init(uint8_t portid, uint32_t gw_ip)
+{
+	struct arp_ip_key key = {0};
+
+	if (gw_ip == 0)
+		return;
+
+	key.ip_type.ipv4 = PRESENT;
+	key.ip_addr.ipv4 = gw_ip;
+	adj_gw[portid] = up_adj_get(portid, &key);
+}
+
+int
+up_adj_init(void)
+{
+	uint8_t port = 0;
+	char name[RTE_HASH_NAMESIZE];
+
+	for (port = 0; port < NUM_SPGW_PORTS; port++) {
+		struct rte_hash_parameters params = {
+			.name = name,
+			.entries = UP_ADJ_TBL_SZ,
+			.key_len = sizeof(struct arp_ip_key),
+			.hash_func = rte_jhash,
+			.hash_func_init_val = 0,
+			.socket_id = rte_socket_id(),
+		};
+
+		snprintf(name, sizeof(name), "ADJ_TBL_%u", port);
+		adj_hash[port] = rte_hash_create(&params);
+		if (adj_hash[port] == NULL) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to create adjacency table for port %u, "
+				"Error: %s\n", LOG_VALUE, port, rte_strerror(rte_errno));
+			return -1;
+		}
+	}
+
+	/* Multi producer, all the UL/DL workers feed this ring */
+	adj_resolve_ring = rte_ring_create("ADJ_RESOLVE_RING",
+			UP_ADJ_RESOLVE_RING_SZ, rte_socket_id(), RING_F_SC_DEQ);
+	if (adj_resolve_ring == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create adjacency resolve ring, Error: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	adj_gw_init(app.wb_port, app.wb_gw_ip);
+	adj_gw_init(app.eb_port, app.eb_gw_ip);
+
+	return 0;
+}
+
+void
+up_adj_nexthop_key(uint8_t portid, struct arp_ip_key *key)
+{
+	if (!key->ip_type.ipv4)
+		return;
+
+	/* Retrieve Gateway Routing IP Address of the next hop */
+	if (portid == app.wb_port) {
+		if (app.wb_gw_ip != 0 &&
+				(key->ip_addr.ipv4 & app.wb_mask) != app.wb_net) {
+			key->ip_addr.ipv4 = app.wb_gw_ip;
+		}
+	} else if (portid == app.eb_port) {
+		if (app.eb_gw_ip != 0 &&
+				(key->ip_addr.ipv4 & app.eb_mask) != app.eb_net) {
+			key->ip_addr.ipv4 = app.eb_gw_ip;
+		}
+	}
+}
+
+struct up_adj *
+up_adj_get(uint8_t portid, const struct arp_ip_key *key)
+{
+	int ret = 0;
+	struct up_adj *adj = NULL;
+
+	if ((portid >= NUM_SPGW_PORTS) || (adj_hash[portid] == NULL))
+		return NULL;
+
+	ret = rte_hash_lookup_data(adj_hash[portid], key, (void **)&adj);
+	if (ret >= 0)
+		return adj;
+
+	adj = rte_zmalloc("UP_ADJ", sizeof(struct up_adj), RTE_CACHE_LINE_SIZE);
+	if (adj == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to allocate memory for adjacency, Error: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return NULL;
+	}
+
+	/* No next hop entry, resolved on first use */
+	adj->portid = portid;
+	adj->key = *key;
+
+	ret = rte_hash_add_key_data(adj_hash[portid], key, adj);
+	if (ret) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to add adjacency for port %u, Error: %s\n",
+			LOG_VALUE, portid, rte_strerror(abs(ret)));
+		rte_free(adj);
+		return NULL;
+	}
+
+	return adj;
+}
+
+struct up_adj *
+up_adj_gw(uint8_t portid)
+{
+	if (portid >= NUM_SPGW_PORTS)
+		return NULL;
+
+	return adj_gw[portid];
+}
+
+void
+far_adj_update(far_info_t *far)
+{
+	uint8_t portid = 0;
+	struct arp_ip_key key = {0};
+	outer_hdr_creation_t *ohc = NULL;
+
+	if (far == NULL)
+		return;
+
+	ohc = &far->frwdng_parms.outer_hdr_creation;
+	if (ohc->outer_hdr_creation_desc == GTPU_UDP_IPv4 && ohc->ipv4_address) {
+		key.ip_type.ipv4 = PRESENT;
+		key.ip_addr.ipv4 = ohc->ipv4_address;
+	} else if (ohc->outer_hdr_creation_desc == GTPU_UDP_IPv6) {
+		key.ip_type.ipv6 = PRESENT;
+		memcpy(&key.ip_addr.ipv6, ohc->ipv6_address, IPV6_ADDRESS_LEN);
+	} else {
+		/* No tunnel peer, the port gateway is used */
+		far->adj = NULL;
+		return;
+	}
+
+	/* Peer reachable over the S1U/S5S8 port for access, SGI/S5S8 for core */
+	portid = (far->frwdng_parms.dst_intfc.interface_value == ACCESS) ?
+		app.wb_port : app.eb_port;
+
+	up_adj_nexthop_key(portid, &key);
+	far->adj = up_adj_get(portid, &key);
+}
+
+int
+up_adj_resolve(struct rte_mbuf *m, uint8_t portid, struct up_adj *adj)
+{
+	struct rte_mbuf *buf_pkt = NULL;
+	struct epc_meta_data *from_meta_data = NULL;
+	struct epc_meta_data *to_meta_data = NULL;
+
+	buf_pkt = rte_pktmbuf_clone(m, arp_quxmpool[portid]);
+	if (buf_pkt == NULL) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Failed to clone PKT for next hop resolution\n",
+			LOG_VALUE);
+		return -1;
+	}
+
+	from_meta_data =
+		(struct epc_meta_data *)RTE_MBUF_METADATA_UINT8_PTR(m,
+		META_DATA_OFFSET);
+	to_meta_data =
+		(struct epc_meta_data *)RTE_MBUF_METADATA_UINT8_PTR(buf_pkt,
+		META_DATA_OFFSET);
+	*to_meta_data = *from_meta_data;
+
+	/* Egress port and adjacency travel with the packet */
+	buf_pkt->port = portid;
+	buf_pkt->udata64 = (uint64_t)(uintptr_t)adj;
+
+	if (rte_ring_mp_enqueue(adj_resolve_ring, buf_pkt) != 0) {
+		rte_pktmbuf_free(buf_pkt);
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Adjacency resolve ring full, dropping PKT\n",
+			LOG_VALUE);
+		return -1;
+	}
+
+	return 0;
+}
+
+void
+up_adj_update(struct up_adj *adj, struct arp_entry_data *nh,
+		uint32_t route_gen, uint16_t ether_type)
+{
+	/* Readers copying the old header see the entry change */
+	adj->nh = NULL;
+	rte_smp_wmb();
+
+	/* The entry MAC is only changed by the mct core */
+	adj->gen = nh->gen;
+	adj->route_gen = route_gen;
+	ether_addr_copy(&nh->eth_addr, &adj->eth_hdr.d_addr);
+	ether_addr_copy(&ports_eth_addr[adj->portid], &adj->eth_hdr.s_addr);
+	adj->eth_hdr.ether_type = ether_type;
+
+	rte_smp_wmb();
+	adj->nh = nh;
+}
+
+uint32_t
+up_adj_process_resolve(void)
+{
+	uint32_t i = 0;
+	uint32_t n = 0;
+	struct rte_mbuf *pkts[UP_ADJ_RESOLVE_BURST];
+
+	if (adj_resolve_ring == NULL)
+		return 0;
+
+	n = rte_ring_sc_dequeue_burst(adj_resolve_ring, (void **)pkts,
+			UP_ADJ_RESOLVE_BURST, NULL);
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = pkts[i];
+		uint8_t portid = m->port;
+		struct up_adj *adj = (struct up_adj *)(uintptr_t)m->udata64;
+		struct arp_entry_data *nh = NULL;
+		/* Snapshot before the route lookup, a later change stays visible */
+		uint32_t route_gen = rte_atomic32_read(&up_adj_route_gen);
+
+		m->udata64 = 0;
+		if (resolve_ether_hdr(m, portid, &nh) < 0) {
+			/* Queued on the ARP entry or dropped */
+			rte_pktmbuf_free(m);
+			continue;
+		}
+
+		if (adj != NULL) {
+			up_adj_update(adj, nh, route_gen,
+					rte_pktmbuf_mtod(m, struct ether_hdr *)->ether_type);
+		}
+
+		if (rte_ring_enqueue(shared_ring[portid], m) == -ENOBUFS) {
+			rte_pktmbuf_free(m);
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Can't queue PKT ring full"
+				" so dropping PKT\n", LOG_VALUE);
+			continue;
+		}
+
+#ifdef STATS
+		if (portid == SGI_PORT_ID) {
+			++EPC_UL_PARAMS.pkts_out;
+		} else if (portid == S1U_PORT_ID) {
+			++EPC_DL_PARAMS.pkts_out;
+		}
+#endif /* STATS */
+	}
+
+	return n;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_ADJ_H_
+#define _UP_ADJ_H_
+/**
+ * @file
+ * This file contains the next hop adjacencies used to build the L2 header
+ * of the forwarded packets.
+ *
+ * An adjacency holds the ready made ether header of one next hop on one
+ * port. Each FAR with outer header creation references the adjacency of
+ * its peer, each port references the adjacency of its default gateway.
+ * Adjacencies are shared between FARs and never freed.
+ *
+ * The header is valid while the adjacency generations match the one of
+ * its next hop ARP/ND entry, bumped when the entry MAC changes, and the
+ * route table generation. A neighbour change only invalidates the
+ * adjacencies of that neighbour. The
+ * UL/DL cores never resolve a next hop themselves: a packet hitting a
+ * stale or unresolved adjacency is handed over to the mct core through
+ * the resolve ring, the mct core resolves it, rebuilds the adjacency and
+ * transmits the packet.
+ */
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_atomic.h>
+#include <rte_memcpy.h>
+#include <rte_branch_prediction.h>
+
+#include "pfcp_up_struct.h"
+#include "pipeline/epc_arp.h"
+
+/* Size of the resolve ring between the UL/DL cores and the mct core */
+#define UP_ADJ_RESOLVE_RING_SZ	4096
+
+/* Max number of adjacencies per port */
+#define UP_ADJ_TBL_SZ		(1 << 14)
+
+/* Packets resolved by the mct core per poll */
+#define UP_ADJ_RESOLVE_BURST	32
+
+/**
+ * @brief  : Next hop adjacency
+ */
+struct up_adj {
+	/* Next hop entry generation the header was built at */
+	volatile uint32_t gen;
+	/* Route table generation the header was built at */
+	volatile uint32_t route_gen;
+	/* Next hop ARP/ND entry, NULL while never built or rebuilt */
+	struct arp_entry_data *volatile nh;
+	/* Egress port */
+	uint8_t portid;
+	/* Ready made L2 header */
+	struct ether_hdr eth_hdr;
+	/* Next hop address */
+	struct arp_ip_key key;
+} __rte_cache_aligned;
+
+/* Generation of the route table */
+extern rte_atomic32_t up_adj_route_gen;
+
+/**
+ * @brief  : Create the adjacency tables, the resolve ring and the default
+ *           gateway adjacencies
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_adj_init(void);
+
+/**
+ * @brief  : Apply the port gateway to the next hop key, as done for the
+ *           transmitted packets
+ * @param  : portid, egress port
+ * @param  : key, next hop key, updated in place
+ * @return : Returns nothing
+ */
+void
+up_adj_nexthop_key(uint8_t portid, struct arp_ip_key *key);
+
+/**
+ * @brief  : Find or create the adjacency of a next hop, control path only
+ * @param  : portid, egress port
+ * @param  : key, next hop key
+ * @return : Returns adjacency pointer in case of success, NULL otherwise
+ */
+struct up_adj *
+up_adj_get(uint8_t portid, const struct arp_ip_key *key);
+
+/**
+ * @brief  : Get the default gateway adjacency of the port
+ * @param  : portid, egress port
+ * @return : Returns adjacency pointer, NULL if no gateway is configured
+ */
+struct up_adj *
+up_adj_gw(uint8_t portid);
+
+/**
+ * @brief  : Attach the FAR to the adjacency of its outer header peer
+ * @param  : far, far information
+ * @return : Returns nothing
+ */
+void
+far_adj_update(far_info_t *far);
+
+/**
+ * @brief  : Hand a packet without valid adjacency over to the mct core
+ * @param  : m, packet, the caller keeps ownership of it
+ * @param  : portid, egress port
+ * @param  : adj, adjacency to rebuild, or NULL
+ * @return : Returns 0 if the packet was queued, -1 otherwise
+ */
+int
+up_adj_resolve(struct rte_mbuf *m, uint8_t portid, struct up_adj *adj);
+
+/**
+ * @brief  : Resolve the packets queued by the UL/DL cores, mct core only
+ * @param  : No param
+ * @return : Returns number of packets processed
+ */
+uint32_t
+up_adj_process_resolve(void);
+
+/**
+ * @brief  : Rebuild the adjacency header from its next hop entry, mct core
+ *           only
+ * @param  : adj, adjacency
+ * @param  : nh, resolved next hop ARP/ND entry
+ * @param  : route_gen, route table generation read before the resolution
+ * @param  : ether_type, ether type in network order
+ * @return : Returns nothing
+ */
+void
+up_adj_update(struct up_adj *adj, struct arp_entry_data *nh,
+		uint32_t route_gen, uint16_t ether_type);
+
+/**
+ * @brief  : Invalidate the adjacencies of a next hop, called when the MAC
+ *           of its ARP/ND entry changes
+ * @param  : nh, next hop ARP/ND entry
+ * @return : Returns nothing
+ */
+static inline void
+up_adj_nh_invalidate(struct arp_entry_data *nh)
+{
+	rte_smp_wmb();
+	nh->gen++;
+}
+
+/**
+ * @brief  : Invalidate all the adjacencies, called on route changes
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static inline void
+up_adj_route_invalidate(void)
+{
+	rte_atomic32_inc(&up_adj_route_gen);
+}
+
+/**
+ * @brief  : Check the adjacency serves the next hop
+ * @param  : adj, adjacency
+ * @param  : portid, egress port
+ * @param  : key, next hop key
+ * @return : Returns 1 on match, 0 otherwise
+ */
+static inline int
+up_adj_match(const struct up_adj *adj, uint8_t portid,
+		const struct arp_ip_key *key)
+{
+	if (adj->portid != portid)
+		return 0;
+
+	if (key->ip_type.ipv4)
+		return adj->key.ip_type.ipv4 &&
+			(adj->key.ip_addr.ipv4 == key->ip_addr.ipv4);
+
+	return adj->key.ip_type.ipv6 &&
+		!memcmp(&adj->key.ip_addr.ipv6, &key->ip_addr.ipv6,
+				sizeof(struct in6_addr));
+}
+
+/**
+ * @brief  : Copy the adjacency L2 header into the packet
+ * @param  : adj, adjacency
+ * @param  : eth_hdr, packet ether header
+ * @return : Returns 0 in case of success, -1 if the adjacency is stale
+ */
+static inline int
+up_adj_fill(const struct up_adj *adj, struct ether_hdr *eth_hdr)
+{
+	const struct arp_entry_data *nh = adj->nh;
+	uint32_t gen = 0;
+
+	if (unlikely(nh == NULL))
+		return -1;
+
+	rte_smp_rmb();
+	gen = adj->gen;
+	if (unlikely((gen != nh->gen) || (adj->route_gen !=
+			(uint32_t)rte_atomic32_read(&up_adj_route_gen))))
+		return -1;
+
+	rte_memcpy(eth_hdr, &adj->eth_hdr, sizeof(struct ether_hdr));
+	rte_smp_rmb();
+
+	/* Rebuilt by the mct core while copying */
+	if (unlikely((adj->nh != nh) || (adj->gen != gen)))
+		return -1;
+
+	return 0;
+}
+
+#endif /* _UP_ADJ_H_ */
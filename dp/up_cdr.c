@@ -0,0 +1,1063 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+
+#include <rte_ring.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+
+#include "up_main.h"
+#include "up_cdr.h"
+#include "pfcp_up_llist.h"
+#include "pfcp_up_struct.h"
+#include "pfcp_util.h"
+#include "pfcp_struct.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+extern uint8_t dp_comm_ip_type;
+extern struct in6_addr dp_comm_ipv6;
+extern struct in_addr dp_comm_ip;
+char CDR_FILE_PATH[CDR_BUFF_SIZE];
+
+/* Index value: bytes of the CDRs of the key in the file, and the ack flag */
+#define UP_CDR_ACKED		(1ULL << 63)
+#define UP_CDR_BYTES_MASK	(UP_CDR_ACKED - 1)
+
+/**
+ * @brief  : Journal index key, the key of the CDR ack
+ */
+struct up_cdr_key {
+	uint64_t up_seid;
+	uint32_t seq_no;
+	uint32_t pad;
+};
+
+/**
+ * @brief  : CDR writer
+ */
+struct up_cdr_writer {
+	struct rte_mempool *pool;
+	struct rte_ring *ring;
+	pthread_t thread;
+	volatile uint8_t stop;
+	int fd;
+	/* Tombstones of the acknowledged CDRs */
+	int ack_fd;
+	char ack_path[CDR_BUFF_SIZE + 8];
+	char tmp_path[CDR_BUFF_SIZE + 8];
+	/* Tombstones of the current burst */
+	char ack_buf[UP_CDR_BURST * UP_CDR_ACK_LINE];
+	uint32_t ack_len;
+	/* CDRs of the file by ack key */
+	struct rte_hash *index;
+	/* Keys in the index */
+	uint32_t index_keys;
+	/* Bytes of the acknowledged CDRs still in the file */
+	uint64_t dead;
+	/* Size of the file, rotated at rotate_bytes if not 0 */
+	uint64_t size;
+	uint64_t rotate_bytes;
+	uint8_t fsync;
+	/* Data written since the last sync, TSC of the next periodic sync */
+	uint8_t dirty;
+	uint64_t fsync_tsc;
+	uint64_t fsync_period;
+	struct up_cdr_stats stats;
+	/* Counters at the last log, TSC of the next log */
+	struct up_cdr_stats last;
+	uint64_t stats_tsc;
+};
+
+static struct up_cdr_writer cdr;
+
+/* DP addresses of the CDRs, formatted once */
+static char cdr_dp_ip_v4[INET_ADDRSTRLEN] = "NA";
+static char cdr_dp_ip_v6[INET6_ADDRSTRLEN] = "NA";
+
+int
+cdr_cause_code(pfcp_usage_rpt_trig_ie_t *usage_rpt_trig, char *buf) {
+
+	if(usage_rpt_trig->volth == 1) {
+		strncpy(buf, VOLUME_LIMIT, CDR_BUFF_SIZE);
+		return 0;
+	}
+
+	if(usage_rpt_trig->timth == 1) {
+		strncpy(buf, TIME_LIMIT, CDR_BUFF_SIZE);
+		return 0;
+	}
+
+	if(usage_rpt_trig->termr == 1) {
+		strncpy(buf, CDR_TERMINATION, CDR_BUFF_SIZE);
+		return 0;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief  : Open the CDR file for append, the header is written in a new
+ *           file
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+cdr_open(void)
+{
+	char last = '\n';
+	struct stat st;
+
+	cdr.fd = open(CDR_FILE_PATH, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (cdr.fd < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create/open CDR file %s: %s\n",
+			LOG_VALUE, CDR_FILE_PATH, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(cdr.fd, &st) < 0)
+		st.st_size = 0;
+	cdr.size = st.st_size;
+
+	/* CDR partly written before a crash, ended so the next one is intact */
+	if ((cdr.size > 0) && (pread(cdr.fd, &last, 1, cdr.size - 1) == 1) &&
+			(last != '\n') && (write(cdr.fd, "\n", 1) == 1))
+		cdr.size++;
+
+	if (cdr.size == 0) {
+		if (write(cdr.fd, CDR_HEADER, strlen(CDR_HEADER)) < 0) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to write CDR header: %s\n", LOG_VALUE,
+				strerror(errno));
+		} else {
+			cdr.size = strlen(CDR_HEADER);
+			clLog(clSystemLog, eCLSeverityDebug,
+				LOG_FORMAT"Adding header in file %s\n", LOG_VALUE,
+				CDR_FILE_PATH);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Sync the CDR file per the policy, writer thread
+ * @param  : batch, set after a batch write
+ * @return : Returns nothing
+ */
+static void
+cdr_sync(uint8_t batch)
+{
+	uint64_t tsc = 0;
+
+	if (!cdr.dirty || (cdr.fd < 0))
+		return;
+
+	switch (cdr.fsync) {
+	case UP_CDR_FSYNC_BATCH:
+		if (!batch)
+			return;
+		break;
+	case UP_CDR_FSYNC_PERIODIC:
+		tsc = rte_rdtsc();
+		if (tsc < cdr.fsync_tsc)
+			return;
+		cdr.fsync_tsc = tsc + cdr.fsync_period;
+		break;
+	default:
+		return;
+	}
+
+	if ((fdatasync(cdr.fd) < 0) ||
+			((cdr.ack_fd >= 0) && (fdatasync(cdr.ack_fd) < 0))) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to sync CDR file: %s\n", LOG_VALUE,
+			strerror(errno));
+	}
+	cdr.dirty = 0;
+	cdr.stats.syncs++;
+}
+
+/**
+ * @brief  : Parse the ack key at the start of a CDR or tombstone line
+ * @param  : line, line of the CDR file or of the tombstone file
+ * @param  : key, key to be filled
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+cdr_line_key(const char *line, struct up_cdr_key *key)
+{
+	char *end = NULL;
+
+	/* The header or a partly written line */
+	if ((line[0] < '0') || (line[0] > '9'))
+		return -1;
+
+	memset(key, 0, sizeof(*key));
+	key->seq_no = strtoul(line, &end, 10);
+	if (*end != ',')
+		return -1;
+
+	key->up_seid = strtoull(end + 1, &end, 16);
+	if ((*end != ',') && (*end != '\n'))
+		return -1;
+
+	return 0;
+}
+
+/**
+ * @brief  : Account a CDR written to the file in the index
+ * @param  : key, ack key of the CDR
+ * @param  : len, CDR length
+ * @return : Returns nothing
+ */
+static void
+cdr_index_add(const struct up_cdr_key *key, uint32_t len)
+{
+	void *data = NULL;
+	uint64_t val = len;
+	uint8_t is_new = 1;
+
+	/* Several CDRs of a report share the key, they are removed together */
+	if (rte_hash_lookup_data(cdr.index, key, &data) >= 0) {
+		if ((uintptr_t)data & UP_CDR_ACKED)
+			cdr.dead -= (uintptr_t)data & UP_CDR_BYTES_MASK;
+		val += (uintptr_t)data & UP_CDR_BYTES_MASK;
+		is_new = 0;
+	}
+
+	/* Not indexed, the CDR is never removed */
+	if (rte_hash_add_key_data(cdr.index, key, (void *)(uintptr_t)val) < 0)
+		cdr.stats.index_fail++;
+	else if (is_new)
+		cdr.index_keys++;
+}
+
+/**
+ * @brief  : Mark the CDRs of the key acknowledged
+ * @param  : key, ack key
+ * @return : Returns 0 in case of success , -1 if no CDR is pending
+ */
+static int
+cdr_index_ack(const struct up_cdr_key *key)
+{
+	void *data = NULL;
+	uint64_t val = 0;
+
+	if (rte_hash_lookup_data(cdr.index, key, &data) < 0)
+		return -1;
+
+	val = (uintptr_t)data;
+	if (val & UP_CDR_ACKED)
+		return -1;
+
+	rte_hash_add_key_data(cdr.index, key, (void *)(uintptr_t)(val | UP_CDR_ACKED));
+	cdr.dead += val & UP_CDR_BYTES_MASK;
+	return 0;
+}
+
+/**
+ * @brief  : Drop the acknowledged CDRs from the index, after a compaction
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+cdr_index_purge(void)
+{
+	uint32_t iter = 0;
+	const void *key = NULL;
+	void *data = NULL;
+
+	while (rte_hash_iterate(cdr.index, &key, &data, &iter) >= 0) {
+		if (((uintptr_t)data & UP_CDR_ACKED) &&
+				(rte_hash_del_key(cdr.index, key) >= 0))
+			cdr.index_keys--;
+	}
+}
+
+/**
+ * @brief  : Rewrite the CDR file without the acknowledged CDRs and clear
+ *           the tombstones, writer thread
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+cdr_compact(void)
+{
+	FILE *in = NULL;
+	FILE *out = NULL;
+	void *data = NULL;
+	uint64_t kept = 0;
+	uint64_t removed = 0;
+	struct up_cdr_key key;
+	char line[2 * CDR_BUFF_SIZE];
+
+	in = fopen(CDR_FILE_PATH, "r");
+	if (in == NULL) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to open %s for compaction: %s\n", LOG_VALUE,
+			CDR_FILE_PATH, strerror(errno));
+		return -1;
+	}
+
+	out = fopen(cdr.tmp_path, "w");
+	if (out == NULL) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to open %s for compaction: %s\n", LOG_VALUE,
+			cdr.tmp_path, strerror(errno));
+		fclose(in);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), in) != NULL) {
+		if ((cdr_line_key(line, &key) == 0) &&
+				(rte_hash_lookup_data(cdr.index, &key, &data) >= 0) &&
+				((uintptr_t)data & UP_CDR_ACKED)) {
+			removed++;
+			continue;
+		}
+
+		fputs(line, out);
+		kept++;
+	}
+
+	/* The tombstones are cleared once the new file is durable */
+	if (ferror(in) || (fflush(out) != 0) || (fdatasync(fileno(out)) < 0)) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to compact %s: %s\n", LOG_VALUE,
+			CDR_FILE_PATH, strerror(errno));
+		fclose(in);
+		fclose(out);
+		unlink(cdr.tmp_path);
+		return -1;
+	}
+	fclose(in);
+	fclose(out);
+
+	if (rename(cdr.tmp_path, CDR_FILE_PATH) < 0) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to replace %s: %s\n", LOG_VALUE,
+			CDR_FILE_PATH, strerror(errno));
+		unlink(cdr.tmp_path);
+		return -1;
+	}
+
+	if (cdr.fd >= 0)
+		close(cdr.fd);
+	cdr_open();
+
+	if ((cdr.ack_fd >= 0) && (ftruncate(cdr.ack_fd, 0) < 0)) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to clear %s: %s\n", LOG_VALUE,
+			cdr.ack_path, strerror(errno));
+	}
+
+	cdr_index_purge();
+	cdr.dead = 0;
+	cdr.stats.compactions++;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"CDR file compacted: %lu acknowledged CDRs removed, %lu "
+		"lines kept, %lu bytes\n", LOG_VALUE, removed, kept, cdr.size);
+
+	return 0;
+}
+
+/**
+ * @brief  : Close the CDR file under a time stamped name, open a new one;
+ *           the CDRs of the closed file are no longer tracked
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+cdr_rotate(void)
+{
+	time_t now = time(NULL);
+	struct tm tm;
+	char path[CDR_BUFF_SIZE + 96] = {0};
+
+	/* Only the pending CDRs go in the closed file */
+	if (cdr.dead)
+		cdr_compact();
+
+	localtime_r(&now, &tm);
+	/* Rotation count keeps the names unique within a second */
+	snprintf(path, sizeof(path), "%s.%04d%02d%02d%02d%02d%02d.%lu",
+			CDR_FILE_PATH, tm.tm_year + 1900, tm.tm_mon + 1,
+			tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+			cdr.stats.rotations);
+
+	if (cdr.dirty && (cdr.fsync != UP_CDR_FSYNC_NONE)) {
+		fdatasync(cdr.fd);
+		cdr.dirty = 0;
+	}
+	close(cdr.fd);
+	cdr.fd = -1;
+
+	if (rename(CDR_FILE_PATH, path) < 0) {
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"Failed to rotate CDR file to %s: %s\n", LOG_VALUE,
+			path, strerror(errno));
+	} else {
+		rte_hash_reset(cdr.index);
+		cdr.index_keys = 0;
+		if ((cdr.ack_fd >= 0) && (ftruncate(cdr.ack_fd, 0) < 0)) {
+			clLog(clSystemLog, eCLSeverityMajor,
+				LOG_FORMAT"Failed to clear %s: %s\n", LOG_VALUE,
+				cdr.ack_path, strerror(errno));
+		}
+		cdr.dead = 0;
+		cdr.stats.rotations++;
+		clLog(clSystemLog, eCLSeverityInfo,
+			LOG_FORMAT"CDR file rotated to %s at %lu bytes\n", LOG_VALUE,
+			path, cdr.size);
+	}
+
+	cdr_open();
+}
+
+/**
+ * @brief  : Write the records in one writev, resumed on a short write,
+ *           writer thread
+ * @param  : iov, formatted records
+ * @param  : cnt, number of records
+ * @return : Returns nothing
+ */
+static void
+cdr_write(struct iovec *iov, uint32_t cnt)
+{
+	ssize_t ret = 0;
+	uint32_t idx = 0;
+	uint32_t records = cnt;
+
+	if ((cdr.fd < 0) && (cdr_open() < 0)) {
+		cdr.stats.write_fail += cnt;
+		return;
+	}
+
+	while (idx < cnt) {
+		ret = writev(cdr.fd, &iov[idx], cnt - idx);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to write %u CDRs: %s\n", LOG_VALUE,
+				cnt - idx, strerror(errno));
+			cdr.stats.write_fail += cnt - idx;
+			records = idx;
+			break;
+		}
+
+		cdr.stats.writes++;
+		cdr.stats.bytes += ret;
+		cdr.size += ret;
+
+		/* Skip the written records, the last one may be partly written */
+		while ((idx < cnt) && ((size_t)ret >= iov[idx].iov_len))
+			ret -= iov[idx++].iov_len;
+		if (idx < cnt) {
+			iov[idx].iov_base = (char *)iov[idx].iov_base + ret;
+			iov[idx].iov_len -= ret;
+		}
+	}
+
+	cdr.stats.records += records;
+	cdr.dirty = 1;
+}
+
+/**
+ * @brief  : Acknowledge the CDRs of the key, the tombstone is written with
+ *           the burst, writer thread
+ * @param  : seq_no, seq_no of the acknowledged report
+ * @param  : up_seid, user plane session id
+ * @return : Returns nothing
+ */
+static void
+cdr_ack(uint32_t seq_no, uint64_t up_seid)
+{
+	struct up_cdr_key key = { .up_seid = up_seid, .seq_no = seq_no };
+
+	if (cdr_index_ack(&key) < 0) {
+		cdr.stats.unknown_acks++;
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"No pending CDR for seq_no %u, up_seid %lx\n",
+			LOG_VALUE, seq_no, up_seid);
+		return;
+	}
+
+	cdr.ack_len += snprintf(&cdr.ack_buf[cdr.ack_len],
+			sizeof(cdr.ack_buf) - cdr.ack_len, "%u,%lx\n", seq_no, up_seid);
+	cdr.stats.acks++;
+}
+
+/**
+ * @brief  : Append the tombstones of the burst, writer thread
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+cdr_ack_flush(void)
+{
+	ssize_t ret = 0;
+	uint32_t off = 0;
+
+	if (cdr.ack_len == 0)
+		return;
+
+	/* A lost tombstone leaves its CDR pending, never the reverse */
+	while ((cdr.ack_fd >= 0) && (off < cdr.ack_len)) {
+		ret = write(cdr.ack_fd, &cdr.ack_buf[off], cdr.ack_len - off);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			clLog(clSystemLog, eCLSeverityMajor,
+				LOG_FORMAT"Failed to write CDR tombstones: %s\n",
+				LOG_VALUE, strerror(errno));
+			break;
+		}
+		off += ret;
+	}
+
+	cdr.ack_len = 0;
+	cdr.dirty = 1;
+}
+
+/**
+ * @brief  : Log the writer counters, once per UP_CDR_STATS_SEC
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+cdr_stats_log(void)
+{
+	uint64_t tsc = rte_rdtsc();
+	struct up_cdr_stats cur = cdr.stats;
+
+	if (tsc < cdr.stats_tsc)
+		return;
+	cdr.stats_tsc = tsc + rte_get_tsc_hz() * UP_CDR_STATS_SEC;
+
+	if ((cur.records == cdr.last.records) && (cur.acks == cdr.last.acks) &&
+			(cur.drops == cdr.last.drops) &&
+			(cur.write_fail == cdr.last.write_fail))
+		return;
+
+	clLog(clSystemLog, ((cur.drops != cdr.last.drops) ||
+			(cur.write_fail != cdr.last.write_fail)) ?
+			eCLSeverityMinor : eCLSeverityInfo,
+		LOG_FORMAT"CDR writer: %lu records/s, %lu bytes/s, %lu records per "
+		"write, %lu syncs, %lu acks, %lu unknown acks, %u pending keys, "
+		"%lu dead bytes, %lu dropped, %lu write failures, %lu not indexed, "
+		"%lu compactions, %lu rotations\n", LOG_VALUE,
+		(cur.records - cdr.last.records) / UP_CDR_STATS_SEC,
+		(cur.bytes - cdr.last.bytes) / UP_CDR_STATS_SEC,
+		(cur.writes > cdr.last.writes) ?
+		(cur.records - cdr.last.records) / (cur.writes - cdr.last.writes) : 0,
+		cur.syncs - cdr.last.syncs, cur.acks - cdr.last.acks,
+		cur.unknown_acks - cdr.last.unknown_acks,
+		cdr.index_keys, cdr.dead,
+		cur.drops - cdr.last.drops, cur.write_fail - cdr.last.write_fail,
+		cur.index_fail, cur.compactions, cur.rotations);
+
+	cdr.last = cur;
+}
+
+/**
+ * @brief  : CDR writer thread, drains the CDR ring in bursts until stopped
+ * @param  : arg, unused parameter
+ * @return : Returns nothing
+ */
+static void *
+cdr_writer_thread(void *arg)
+{
+	uint32_t i = 0;
+	uint32_t cnt = 0;
+	uint32_t iov_cnt = 0;
+	struct up_cdr_key key;
+	struct iovec iov[UP_CDR_BURST];
+	struct up_cdr_rec *recs[UP_CDR_BURST];
+
+	RTE_SET_USED(arg);
+
+	while (1) {
+		cnt = rte_ring_sc_dequeue_burst(cdr.ring, (void **)recs,
+				UP_CDR_BURST, NULL);
+		if (cnt == 0) {
+			if (cdr.stop)
+				break;
+			cdr_sync(0);
+			cdr_stats_log();
+			usleep(UP_CDR_IDLE_US);
+			continue;
+		}
+
+		/* A CDR is indexed before the acks queued after it */
+		for (i = 0, iov_cnt = 0; i < cnt; i++) {
+			if (recs[i]->type == UP_CDR_REC_ACK) {
+				cdr_ack(recs[i]->seq_no, recs[i]->up_seid);
+				continue;
+			}
+
+			memset(&key, 0, sizeof(key));
+			key.up_seid = recs[i]->up_seid;
+			key.seq_no = recs[i]->seq_no;
+			cdr_index_add(&key, recs[i]->len);
+
+			iov[iov_cnt].iov_base = recs[i]->data;
+			iov[iov_cnt].iov_len = recs[i]->len;
+			iov_cnt++;
+		}
+
+		/* CDRs before their tombstones */
+		if (iov_cnt)
+			cdr_write(iov, iov_cnt);
+		cdr_ack_flush();
+		cdr_sync(1);
+
+		rte_mempool_put_bulk(cdr.pool, (void **)recs, cnt);
+
+		if (cdr.rotate_bytes && (cdr.size >= cdr.rotate_bytes))
+			cdr_rotate();
+		else if ((cdr.dead >= UP_CDR_COMPACT_MIN) && (cdr.dead * 2 >= cdr.size))
+			cdr_compact();
+	}
+
+	if (cdr.dirty && (cdr.fsync != UP_CDR_FSYNC_NONE)) {
+		fdatasync(cdr.fd);
+		if (cdr.ack_fd >= 0)
+			fdatasync(cdr.ack_fd);
+	}
+	if (cdr.fd >= 0)
+		close(cdr.fd);
+	cdr.fd = -1;
+	if (cdr.ack_fd >= 0)
+		close(cdr.ack_fd);
+	cdr.ack_fd = -1;
+
+	return NULL;
+}
+
+/**
+ * @brief  : Rebuild the index from the CDR file and the tombstones, the
+ *           acknowledged CDRs are compacted out
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+cdr_recover(void)
+{
+	FILE *file = NULL;
+	uint64_t cdrs = 0;
+	uint64_t acks = 0;
+	struct up_cdr_key key;
+	char line[2 * CDR_BUFF_SIZE];
+
+	file = fopen(CDR_FILE_PATH, "r");
+	if (file != NULL) {
+		while (fgets(line, sizeof(line), file) != NULL) {
+			if (cdr_line_key(line, &key) == 0) {
+				cdr_index_add(&key, strlen(line));
+				cdrs++;
+			}
+		}
+		fclose(file);
+	}
+
+	file = fopen(cdr.ack_path, "r");
+	if (file != NULL) {
+		while (fgets(line, sizeof(line), file) != NULL) {
+			if ((cdr_line_key(line, &key) == 0) && (cdr_index_ack(&key) == 0))
+				acks++;
+		}
+		fclose(file);
+	}
+
+	if (cdrs) {
+		clLog(clSystemLog, eCLSeverityInfo,
+			LOG_FORMAT"CDR journal %s: %lu CDRs, %lu acknowledged\n",
+			LOG_VALUE, CDR_FILE_PATH, cdrs, acks);
+	}
+
+	/* Only the pending CDRs are left in the file */
+	if (cdr.dead)
+		cdr_compact();
+}
+
+/**
+ * @brief  : Take a record from the pool, the drop is counted on failure
+ * @param  : No param
+ * @return : Returns record, NULL if the pool is empty
+ */
+static struct up_cdr_rec *
+cdr_rec_alloc(void)
+{
+	void *obj = NULL;
+
+	if ((cdr.pool == NULL) || (rte_mempool_get(cdr.pool, &obj) < 0)) {
+		__sync_fetch_and_add(&cdr.stats.drops, 1);
+		return NULL;
+	}
+
+	return obj;
+}
+
+/**
+ * @brief  : Queue a record to the writer, the drop is counted on failure
+ * @param  : rec, record
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+cdr_rec_enqueue(struct up_cdr_rec *rec)
+{
+	if (rte_ring_mp_enqueue(cdr.ring, rec) < 0) {
+		rte_mempool_put(cdr.pool, rec);
+		__sync_fetch_and_add(&cdr.stats.drops, 1);
+		return -1;
+	}
+
+	return 0;
+}
+
+int
+generate_cdr(cdr_t *dp_cdr, uint64_t up_seid, char *trigg_buff,
+					uint32_t seq_no, uint32_t ue_ip_addr,
+					uint8_t ue_ipv6_addr_buff[],
+					char *CDR_BUFF) {
+
+	struct timeval epoc_start_time;
+	struct timeval epoc_end_time;
+	struct timeval epoc_data_start_time;
+	struct timeval epoc_data_end_time;
+	char ue_addr_buff_v4[INET_ADDRSTRLEN] = "NA";
+	char ue_addr_buff_v6[INET6_ADDRSTRLEN] = "NA";
+	char cp_ip_addr_buff_v4[INET_ADDRSTRLEN] = "NA";
+	char cp_ip_addr_buff_v6[INET6_ADDRSTRLEN] = "NA";
+	pfcp_session_t *sess = NULL;
+	pfcp_session_datat_t *sessions = NULL;
+	int len = 0;
+
+	if (dp_cdr == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+				"usage report is NULL\n");
+		return -1;
+	}
+
+	sess = get_sess_info_entry(up_seid, SESS_MODIFY);
+	if(sess == NULL) {
+		clLog(clSystemLog, eCLSeverityDebug,
+				LOG_FORMAT"Failed to Retrieve Session Info\n\n", LOG_VALUE);
+		return -1;
+	}
+
+	if(sess->sessions == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+				"Sessions not found\n");
+		return -1;
+	}
+
+	sessions = sess->sessions;
+
+	if ( ue_ip_addr == 0 && ue_ipv6_addr_buff == 0) {
+
+		/* Default bearer first, then the next one */
+		if (!sessions->ipv4 && !sessions->ipv6 && sessions->next != NULL)
+			sessions = sessions->next;
+
+		if (sessions->ipv4) {
+			inet_ntop(AF_INET, &sessions->ue_ip_addr, ue_addr_buff_v4,
+					sizeof(ue_addr_buff_v4));
+		}
+
+		if(sessions->ipv6) {
+			inet_ntop(AF_INET6, sessions->cold->ue_ipv6_addr,
+					ue_addr_buff_v6, sizeof(ue_addr_buff_v6));
+		}
+	} else {
+		/**Restoration case*/
+		if (ue_ip_addr) {
+			inet_ntop(AF_INET, &ue_ip_addr, ue_addr_buff_v4,
+					sizeof(ue_addr_buff_v4));
+		}
+
+		if (*ue_ipv6_addr_buff) {
+			inet_ntop(AF_INET6, ue_ipv6_addr_buff,
+					ue_addr_buff_v6, sizeof(ue_addr_buff_v6));
+		}
+
+	}
+
+	if (sess->cp_ip.type == PDN_TYPE_IPV4 ||
+			sess->cp_ip.type == PDN_TYPE_IPV4_IPV6) {
+		inet_ntop(AF_INET, &sess->cp_ip.ipv4.sin_addr, cp_ip_addr_buff_v4,
+				sizeof(cp_ip_addr_buff_v4));
+	}
+
+	if (sess->cp_ip.type == PDN_TYPE_IPV6 ||
+			sess->cp_ip.type  == PDN_TYPE_IPV4_IPV6) {
+		inet_ntop(AF_INET6, sess->cp_ip.ipv6.sin6_addr.s6_addr,
+				cp_ip_addr_buff_v6, sizeof(cp_ip_addr_buff_v6));
+	}
+
+	ntp_to_unix_time(&dp_cdr->start_time, &epoc_start_time);
+	ntp_to_unix_time(&dp_cdr->end_time, &epoc_end_time);
+	ntp_to_unix_time(&dp_cdr->time_of_frst_pckt, &epoc_data_start_time);
+	ntp_to_unix_time(&dp_cdr->time_of_lst_pckt, &epoc_data_end_time);
+
+	len = snprintf(CDR_BUFF, CDR_BUFF_SIZE,
+			"%u,%lx,%lx,%"PRIu64",%s,%s,%s,%s,%s,%s,%s,%lu,%lu,%lu,%u,%lu,%lu,%lu,%lu\n" ,
+			               seq_no,
+						   sess->up_seid,
+					       sess->cp_seid,
+						   sess->imsi,
+						   cdr_dp_ip_v4,
+						   cdr_dp_ip_v6,
+						   cp_ip_addr_buff_v4,
+						   cp_ip_addr_buff_v6,
+						   ue_addr_buff_v4,
+						   ue_addr_buff_v6,
+						   trigg_buff,
+						   dp_cdr->uplink_volume,
+						   dp_cdr->downlink_volume,
+						   dp_cdr->total_volume,
+						   dp_cdr->duration_value,
+						   (uint64_t)epoc_start_time.tv_sec,
+						   (uint64_t)epoc_end_time.tv_sec,
+						   (uint64_t)epoc_data_start_time.tv_sec,
+						   (uint64_t)epoc_data_end_time.tv_sec);
+	clLog(clSystemLog, eCLSeverityDebug,
+			"CDR : %s\n", CDR_BUFF);
+
+	/* Truncated record still ends the line */
+	if (len >= CDR_BUFF_SIZE) {
+		len = CDR_BUFF_SIZE - 1;
+		CDR_BUFF[len - 1] = '\n';
+	}
+
+	return len;
+}
+
+/**
+ * @brief  : Format a CDR into a record and queue it to the writer
+ * @param  : dp_cdr, usage of the CDR
+ * @param  : trigg_buff, cause for record closing
+ * @param  : up_seid, user plane session id
+ * @param  : seq_no, seq_no in msg used as a key to store CDR
+ * @param  : ue_ip_addr, UE IPv4 address, 0 to take it from the session
+ * @param  : ue_ipv6_addr, UE IPv6 address, NULL to take it from the session
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+cdr_submit(cdr_t *dp_cdr, char *trigg_buff, uint64_t up_seid,
+		uint32_t seq_no, uint32_t ue_ip_addr, uint8_t ue_ipv6_addr[])
+{
+	int len = 0;
+	struct up_cdr_rec *rec = cdr_rec_alloc();
+
+	if (rec == NULL)
+		return -1;
+
+	len = generate_cdr(dp_cdr, up_seid, trigg_buff, seq_no, ue_ip_addr,
+			ue_ipv6_addr, rec->data);
+	if (len <= 0) {
+		rte_mempool_put(cdr.pool, rec);
+		return -1;
+	}
+
+	rec->type = UP_CDR_REC_DATA;
+	rec->len = len;
+	rec->seq_no = seq_no;
+	rec->up_seid = up_seid;
+
+	return cdr_rec_enqueue(rec);
+}
+
+int
+up_cdr_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
+		uint64_t up_seid, uint32_t seq_no)
+{
+	char TRIGG_BUFF[CDR_BUFF_SIZE] = {0};
+	cdr_t dp_cdr = {0};
+
+	dp_cdr.uplink_volume = usage_report->vol_meas.uplink_volume;
+	dp_cdr.downlink_volume = usage_report->vol_meas.downlink_volume;
+	dp_cdr.total_volume = usage_report->vol_meas.total_volume;
+
+	dp_cdr.duration_value = usage_report->dur_meas.duration_value;
+
+	dp_cdr.start_time = usage_report->start_time.start_time;
+	dp_cdr.end_time = usage_report->end_time.end_time;
+	dp_cdr.time_of_frst_pckt = usage_report->time_of_frst_pckt.time_of_frst_pckt;
+	dp_cdr.time_of_lst_pckt = usage_report->time_of_lst_pckt.time_of_lst_pckt;
+	cdr_cause_code(&usage_report->usage_rpt_trig, TRIGG_BUFF);
+
+	return cdr_submit(&dp_cdr, TRIGG_BUFF, up_seid, seq_no, 0, NULL);
+}
+
+int
+store_cdr_for_restoration(pfcp_usage_rpt_sess_del_rsp_ie_t *usage_report,
+								uint64_t  up_seid, uint32_t trig,
+								uint32_t seq_no, uint32_t ue_ip_addr,
+								uint8_t ue_ipv6_addr[]) {
+
+	char TRIGG_BUFF[CDR_BUFF_SIZE] = {0};
+	cdr_t dp_cdr = {0};
+
+	RTE_SET_USED(trig);
+
+	dp_cdr.uplink_volume = usage_report->vol_meas.uplink_volume;
+	dp_cdr.downlink_volume = usage_report->vol_meas.downlink_volume;
+	dp_cdr.total_volume = usage_report->vol_meas.total_volume;
+
+	dp_cdr.duration_value = usage_report->dur_meas.duration_value;
+
+	dp_cdr.start_time = usage_report->start_time.start_time;
+	dp_cdr.end_time = usage_report->end_time.end_time;
+	dp_cdr.time_of_frst_pckt = usage_report->time_of_frst_pckt.time_of_frst_pckt;
+	dp_cdr.time_of_lst_pckt = usage_report->time_of_lst_pckt.time_of_lst_pckt;
+	cdr_cause_code(&usage_report->usage_rpt_trig, TRIGG_BUFF);
+
+	return cdr_submit(&dp_cdr, TRIGG_BUFF, up_seid, seq_no,
+			ue_ip_addr, ue_ipv6_addr);
+}
+
+int
+remove_cdr_entry(uint32_t seq_no, uint64_t up_seid) {
+
+	struct up_cdr_rec *rec = cdr_rec_alloc();
+
+	/* The CDR is kept in the file */
+	if (rec == NULL)
+		return -1;
+
+	rec->type = UP_CDR_REC_ACK;
+	rec->len = 0;
+	rec->seq_no = seq_no;
+	rec->up_seid = up_seid;
+
+	return cdr_rec_enqueue(rec);
+}
+
+int
+up_cdr_init(uint8_t fsync, uint32_t fsync_sec, uint32_t rotate_mb)
+{
+	int ret = 0;
+
+	if (dp_comm_ip_type & PDN_TYPE_IPV4)
+		inet_ntop(AF_INET, &dp_comm_ip, cdr_dp_ip_v4, sizeof(cdr_dp_ip_v4));
+	if (dp_comm_ip_type & PDN_TYPE_IPV6)
+		inet_ntop(AF_INET6, &dp_comm_ipv6, cdr_dp_ip_v6, sizeof(cdr_dp_ip_v6));
+
+	struct rte_hash_parameters index_params = {
+		.name = "CDR_INDEX",
+		.entries = UP_CDR_INDEX_SZ,
+		.key_len = sizeof(struct up_cdr_key),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id()
+	};
+
+	cdr.fd = -1;
+	cdr.ack_fd = -1;
+	snprintf(cdr.ack_path, sizeof(cdr.ack_path), "%s.ack", CDR_FILE_PATH);
+	snprintf(cdr.tmp_path, sizeof(cdr.tmp_path), "%s.tmp", CDR_FILE_PATH);
+	cdr.fsync = fsync;
+	cdr.fsync_period = rte_get_tsc_hz() *
+		(fsync_sec ? fsync_sec : UP_CDR_FSYNC_SEC_DFLT);
+	cdr.rotate_bytes = (uint64_t)rotate_mb << 20;
+
+	cdr.pool = rte_mempool_create("CDR_POOL", UP_CDR_POOL_SZ - 1,
+			sizeof(struct up_cdr_rec), UP_CDR_CACHE_SZ, 0, NULL, NULL,
+			NULL, NULL, rte_socket_id(), 0);
+	if (cdr.pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create CDR pool: %s\n", LOG_VALUE,
+			rte_strerror(rte_errno));
+		return -1;
+	}
+
+	/* Never full before the pool is empty */
+	cdr.ring = rte_ring_create("CDR_RING", UP_CDR_POOL_SZ, rte_socket_id(),
+			RING_F_SC_DEQ);
+	if (cdr.ring == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create CDR ring: %s\n", LOG_VALUE,
+			rte_strerror(rte_errno));
+		return -1;
+	}
+
+	/* Only written by the writer thread */
+	cdr.index = rte_hash_create(&index_params);
+	if (cdr.index == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create CDR index: %s\n", LOG_VALUE,
+			rte_strerror(rte_errno));
+		return -1;
+	}
+
+	cdr.ack_fd = open(cdr.ack_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (cdr.ack_fd < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to open CDR tombstones %s: %s\n", LOG_VALUE,
+			cdr.ack_path, strerror(errno));
+	}
+
+	/* Pending CDRs of the last run, opened again by the writer on failure */
+	cdr_recover();
+	if (cdr.fd < 0)
+		cdr_open();
+
+	ret = pthread_create(&cdr.thread, NULL, &cdr_writer_thread, NULL);
+	if (ret != 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create CDR writer thread: %s\n",
+			LOG_VALUE, strerror(ret));
+		return -1;
+	}
+	pthread_setname_np(cdr.thread, "cdr_writer");
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"CDR writer on %s, sync policy %u, rotation at %u MB\n",
+		LOG_VALUE, CDR_FILE_PATH, fsync, rotate_mb);
+
+	return 0;
+}
+
+void
+up_cdr_close(void)
+{
+	if (cdr.ring == NULL)
+		return;
+
+	cdr.stop = 1;
+	pthread_join(cdr.thread, NULL);
+	cdr.ring = NULL;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_CDR_H_
+#define _UP_CDR_H_
+/**
+ * @file
+ * This file contains the CDR writer of the dataplane.
+ *
+ * The CDRs are formatted by the core that builds the usage report, into a
+ * record taken from a pool, and queued on the CDR ring. The writer thread
+ * keeps the CDR file open and drains the ring in bursts, one writev per
+ * burst. The file is synced per the configured policy and rotated when
+ * it reaches the configured size.
+ *
+ * The CDR file is a journal: CDRs are only appended, and indexed by their
+ * ack key, the seq_no of the report and the UP SEID. The ack of a CDR is
+ * queued on the same ring, so it follows the CDR, and appends a tombstone
+ * to the tombstone file; an ack costs a hash update and a short append.
+ * The writer compacts the acknowledged CDRs out of the file once they are
+ * UP_CDR_COMPACT_MIN and half of it, and clears the tombstones. On start
+ * the index is rebuilt from the CDR file and the tombstones, so only the
+ * CDRs not acknowledged are left in the file.
+ *
+ * Records are only dropped when the pool or the ring is exhausted, the
+ * drops are counted and logged by the writer.
+ */
+#include <stdint.h>
+
+#include "pfcp_up_sess.h"
+
+/* Size of the CDR ring, the pool has one record less */
+#define UP_CDR_POOL_SZ		(1 << 14)
+
+/* Per lcore cache of the record pool */
+#define UP_CDR_CACHE_SZ		64
+
+/* Max number of records per writev */
+#define UP_CDR_BURST		64
+
+/* Sleep of the writer when the ring is empty, in usec */
+#define UP_CDR_IDLE_US		1000
+
+/* Period of the writer counters log, in seconds */
+#define UP_CDR_STATS_SEC	10
+
+/* Default period of UP_CDR_FSYNC_PERIODIC, in seconds */
+#define UP_CDR_FSYNC_SEC_DFLT	1
+
+/* Sync policy of the CDR file */
+#define UP_CDR_FSYNC_NONE	0
+#define UP_CDR_FSYNC_BATCH	1
+#define UP_CDR_FSYNC_PERIODIC	2
+
+/* Max number of CDR keys indexed, pending or acknowledged */
+#define UP_CDR_INDEX_SZ		(1 << 18)
+
+/* Acknowledged bytes in the file before a compaction */
+#define UP_CDR_COMPACT_MIN	(1 << 20)
+
+/* Max length of a tombstone line */
+#define UP_CDR_ACK_LINE		32
+
+/* Record types */
+#define UP_CDR_REC_DATA		0
+#define UP_CDR_REC_ACK		1
+
+/**
+ * @brief  : Formatted CDR, or removal of the acknowledged CDR
+ */
+struct up_cdr_rec {
+	uint8_t type;
+	uint16_t len;
+	/* Key of the acknowledged CDR */
+	uint32_t seq_no;
+	uint64_t up_seid;
+	char data[CDR_BUFF_SIZE];
+};
+
+/**
+ * @brief  : Counters of the CDR writer
+ */
+struct up_cdr_stats {
+	/* Records and bytes written */
+	uint64_t records;
+	uint64_t bytes;
+	uint64_t writes;
+	uint64_t syncs;
+	uint64_t rotations;
+	/* Acks of pending CDRs, and acks with no pending CDR */
+	uint64_t acks;
+	uint64_t unknown_acks;
+	/* CDRs not indexed, never removed */
+	uint64_t index_fail;
+	uint64_t compactions;
+	/* Records not written, write error */
+	uint64_t write_fail;
+	/* Records dropped by the producers, pool or ring exhausted */
+	volatile uint64_t drops;
+};
+
+/**
+ * @brief  : Create the record pool and the ring, recover the CDR journal
+ *           and start the writer thread
+ * @param  : fsync, UP_CDR_FSYNC_* policy
+ * @param  : fsync_sec, period of UP_CDR_FSYNC_PERIODIC, 0 for the default
+ * @param  : rotate_mb, size the file is rotated at in MB, 0 to never rotate
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_cdr_init(uint8_t fsync, uint32_t fsync_sec, uint32_t rotate_mb);
+
+/**
+ * @brief  : Format the CDR of a usage report of a Session Report Request
+ *           and queue it to the writer
+ * @param  : usage_report, usage report in pfcp-sess-rpt-req msg
+ * @param  : up_seid, user plane session id
+ * @param  : seq_no, seq_no in msg used as a key to store CDR
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_cdr_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
+		uint64_t up_seid, uint32_t seq_no);
+
+/**
+ * @brief  : Stop the writer once the queued records are written, close
+ *           the CDR file
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+up_cdr_close(void);
+
+#endif /* _UP_CDR_H_ */
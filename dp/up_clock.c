@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/time.h>
+#include <rte_atomic.h>
+
+#include "up_main.h"
+#include "up_clock.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+struct up_clock up_clock;
+
+/**
+ * @brief  : Read the wall clock and the TSC into a base
+ * @param  : b, base to be filled
+ * @return : Returns nothing
+ */
+static void
+up_clock_calibrate(struct up_clock_base *b)
+{
+	struct timeval tv;
+	uint64_t tsc = 0;
+
+	gettimeofday(&tv, NULL);
+	tsc = rte_rdtsc();
+
+	/* Move the TSC back to the start of the second */
+	b->ntp_sec = (uint32_t)(tv.tv_sec + OFFSET);
+	b->tsc = tsc - ((uint64_t)tv.tv_usec * up_clock.hz) / 1000000;
+}
+
+int
+up_clock_init(void)
+{
+	up_clock.hz = rte_get_tsc_hz();
+	if (up_clock.hz == 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"TSC frequency unknown, NTP clock not started\n",
+			LOG_VALUE);
+		return -1;
+	}
+
+	up_clock_calibrate(&up_clock.base[0]);
+	up_clock.cur = 0;
+	up_clock.next_sync = rte_rdtsc() + up_clock.hz * UP_CLOCK_SYNC_SEC;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"NTP clock on TSC %lu Hz, sync every %u sec\n",
+		LOG_VALUE, up_clock.hz, UP_CLOCK_SYNC_SEC);
+
+	return 0;
+}
+
+void
+up_clock_sync(void)
+{
+	int64_t drift = 0;
+	uint64_t tsc = rte_rdtsc();
+	uint32_t next = !up_clock.cur;
+	const struct up_clock_base *old = &up_clock.base[up_clock.cur];
+	struct up_clock_base *b = &up_clock.base[next];
+
+	if (tsc < up_clock.next_sync)
+		return;
+
+	up_clock_calibrate(b);
+
+	/* Publish the new base before switching to it */
+	rte_smp_wmb();
+	up_clock.cur = next;
+	up_clock.next_sync = tsc + up_clock.hz * UP_CLOCK_SYNC_SEC;
+
+	/* Cycles the old base was off by, on the start of the new second */
+	drift = (int64_t)(old->tsc - b->tsc) +
+		(int64_t)(int32_t)(b->ntp_sec - old->ntp_sec) * (int64_t)up_clock.hz;
+	if ((uint64_t)RTE_MAX(drift, -drift) > up_clock.hz / 1000) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"NTP clock corrected by %ld usec\n", LOG_VALUE,
+			drift / (int64_t)(up_clock.hz / 1000000));
+	}
+}
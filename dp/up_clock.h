@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_CLOCK_H_
+#define _UP_CLOCK_H_
+/**
+ * @file
+ * This file contains the coarse NTP clock of the dataplane.
+ *
+ * The wall clock is read once and paired with the TSC, the NTP time of a
+ * TSC value is then derived without any system call. The iface core pairs
+ * them again every UP_CLOCK_SYNC_SEC to follow the wall clock adjustments
+ * and the TSC drift; the new pair is written to the inactive base and
+ * published by switching the base index.
+ */
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
+
+/* Period of the wall clock sync, in seconds */
+#define UP_CLOCK_SYNC_SEC	10
+
+/**
+ * @brief  : Wall clock and TSC pair
+ */
+struct up_clock_base {
+	/* TSC at the start of the NTP second */
+	uint64_t tsc;
+	/* NTP seconds */
+	uint32_t ntp_sec;
+};
+
+/**
+ * @brief  : Coarse NTP clock
+ */
+struct up_clock {
+	struct up_clock_base base[2];
+	/* Base in use */
+	volatile uint32_t cur;
+	/* TSC cycles per second */
+	uint64_t hz;
+	/* TSC of the next sync, iface core */
+	uint64_t next_sync;
+} __rte_cache_aligned;
+
+extern struct up_clock up_clock;
+
+/**
+ * @brief  : Pair the wall clock with the TSC, before the workers start
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_clock_init(void);
+
+/**
+ * @brief  : Pair the wall clock with the TSC again when the sync period
+ *           expired, iface core
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+up_clock_sync(void);
+
+/**
+ * @brief  : Convert a TSC value to NTP seconds
+ * @param  : tsc, TSC value
+ * @return : Returns NTP timestamp in seconds
+ */
+static inline uint32_t
+up_clock_ntp_from_tsc(uint64_t tsc)
+{
+	const struct up_clock_base *b = &up_clock.base[up_clock.cur];
+
+	/* TSC read before the last sync */
+	if (unlikely(tsc < b->tsc))
+		return b->ntp_sec;
+
+	return b->ntp_sec + (uint32_t)((tsc - b->tsc) / up_clock.hz);
+}
+
+/**
+ * @brief  : Current NTP time, without system call
+ * @param  : No param
+ * @return : Returns NTP timestamp in seconds
+ */
+static inline uint32_t
+up_clock_ntp_now(void)
+{
+	return up_clock_ntp_from_tsc(rte_rdtsc());
+}
+
+#endif /* _UP_CLOCK_H_ */
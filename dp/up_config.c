@@ -43,6 +43,8 @@
 #include "pfcp_util.h"
 #include "pipeline/epc_packet_framework.h"
 #include "pfcp_up_sess.h"
+#include "up_cdr.h"
+#include "up_prof.h"
 #include "gw_adapter.h"
 
 #define DECIMAL_BASE 10
@@ -279,6 +281,9 @@ parse_up_config_param(struct app_params *app)
 	 */
 	app->teidri_val = -1;
 
+	/* Stage profiler on by default, PROF_SAMPLE=0 turns it off */
+	app->prof_sample = UP_PROF_PERIOD_DFLT;
+
 	/* Validate the Mandatory Parameters are Configured or Not */
 	for (inx = 0; inx < num_global_entries; ++inx) {
 
@@ -657,6 +662,68 @@ parse_up_config_param(struct app_params *app)
 			app->gtpu_seqnb_out = (uint8_t)atoi(global_entries[inx].value);
 
 			fprintf(stderr, "DP: GTPU_SEQNB_OUT: %u\n", app->gtpu_seqnb_out);
+		} else if(strncmp("UL_WORKERS", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			int workers = atoi(global_entries[inx].value);
+
+			/* Checked before the narrowing to uint8_t */
+			if (workers < 1 || workers > EPC_MAX_WORKERS)
+				rte_panic("Use 1 to %u for UL_WORKERS\n", EPC_MAX_WORKERS);
+			app->ul_workers = (uint8_t)workers;
+
+			fprintf(stderr, "DP: UL_WORKERS: %u\n", app->ul_workers);
+		} else if(strncmp("DL_WORKERS", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			int workers = atoi(global_entries[inx].value);
+
+			if (workers < 1 || workers > EPC_MAX_WORKERS)
+				rte_panic("Use 1 to %u for DL_WORKERS\n", EPC_MAX_WORKERS);
+			app->dl_workers = (uint8_t)workers;
+
+			fprintf(stderr, "DP: DL_WORKERS: %u\n", app->dl_workers);
+		} else if(strncmp("DDN_BUF_POOL_SIZE", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->ddn_buf_pool_sz = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: DDN_BUF_POOL_SIZE: %u\n", app->ddn_buf_pool_sz);
+		} else if(strncmp("DDN_BUF_POLICY", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->ddn_buf_policy = (uint8_t)atoi(global_entries[inx].value);
+			if (app->ddn_buf_policy != DDN_BUF_DROP_NEWEST &&
+					app->ddn_buf_policy != DDN_BUF_DROP_OLDEST)
+				rte_panic("Use 0 or 1 for DDN_BUF_POLICY drop newest/oldest\n");
+
+			fprintf(stderr, "DP: DDN_BUF_POLICY: %u\n", app->ddn_buf_policy);
+		} else if(strncmp("LI_EXPORT_CORE", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->li_export_core = (uint8_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: LI_EXPORT_CORE: %u\n", app->li_export_core);
+		} else if(strncmp("DISTRIBUTOR", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->distributor = (uint8_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: DISTRIBUTOR: %u\n", app->distributor);
+		} else if(strncmp("LOG_RING", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->log_ring = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: LOG_RING: %u\n", app->log_ring);
+		} else if(strncmp("PROF_SAMPLE", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->prof_sample = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: PROF_SAMPLE: %u\n", app->prof_sample);
+		} else if(strncmp("CDR_FSYNC_SEC", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->cdr_fsync_sec = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: CDR_FSYNC_SEC: %u\n", app->cdr_fsync_sec);
+		} else if(strncmp("CDR_FSYNC", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->cdr_fsync = (uint8_t)atoi(global_entries[inx].value);
+			if (app->cdr_fsync > UP_CDR_FSYNC_PERIODIC)
+				rte_panic("Use 0, 1 or 2 for CDR_FSYNC none/batch/periodic\n");
+
+			fprintf(stderr, "DP: CDR_FSYNC: %u\n", app->cdr_fsync);
+		} else if(strncmp("CDR_ROTATE_MB", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->cdr_rotate_mb = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: CDR_ROTATE_MB: %u\n", app->cdr_rotate_mb);
+		} else if(strncmp("URR_VOL_ERROR", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
+			app->urr_vol_err = (uint32_t)atoi(global_entries[inx].value);
+
+			fprintf(stderr, "DP: URR_VOL_ERROR: %u\n", app->urr_vol_err);
 		} else if(strncmp("TRANSMIT_TIMER", global_entries[inx].name, ENTRY_NAME_SIZE) == 0) {
 			app->transmit_timer = (int)atoi(global_entries[inx].value);
 
@@ -912,10 +979,24 @@ parse_config_args(struct app_params *app, int argc, char **argv)
 		}		/* end switch (opt) */
 	}			/* end while() */
 
+	if (app->ul_workers)
+		epc_app.num_ul_workers = app->ul_workers;
+	if (app->dl_workers)
+		epc_app.num_dl_workers = app->dl_workers;
+
 	set_unused_lcore(&epc_app.core_mct, &used_coremask);
 	set_unused_lcore(&epc_app.core_iface, &used_coremask);
-	set_unused_lcore(&epc_app.core_ul[S1U_PORT_ID], &used_coremask);
-	set_unused_lcore(&epc_app.core_dl[SGI_PORT_ID], &used_coremask);
+	for (unsigned wk = 0; wk < epc_app.num_ul_workers; wk++)
+		set_unused_lcore(&epc_app.core_ul[wk], &used_coremask);
+	for (unsigned wk = 0; wk < epc_app.num_dl_workers; wk++)
+		set_unused_lcore(&epc_app.core_dl[wk], &used_coremask);
+	if (app->li_export_core)
+		set_unused_lcore(&epc_app.core_li, &used_coremask);
+	if (app->distributor)
+		set_unused_lcore(&epc_app.core_dist, &used_coremask);
+#ifdef DP_BENCH
+	set_unused_lcore(&epc_app.core_bench, &used_coremask);
+#endif /* DP_BENCH */
 
 	return 0;
 }
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "up_main.h"
+#include "up_csum.h"
+#include "gw_adapter.h"
+
+/* RX checksum offloads of the port configuration */
+#define UP_CSUM_RX_OFFLOADS	(DEV_RX_OFFLOAD_IPV4_CKSUM | \
+					DEV_RX_OFFLOAD_UDP_CKSUM | \
+					DEV_RX_OFFLOAD_TCP_CKSUM | \
+					DEV_RX_OFFLOAD_OUTER_IPV4_CKSUM)
+
+extern int clSystemLog;
+
+uint64_t up_csum_tx_ol[RTE_MAX_ETHPORTS];
+
+void
+up_csum_port_conf(uint8_t port, const struct rte_eth_dev_info *dev_info,
+		struct rte_eth_conf *conf, struct rte_eth_txconf *txconf)
+{
+	uint64_t tx_offloads = 0;
+
+	/* Only the offloads the port has, the offloads field is used as is */
+	conf->rxmode.offloads &= ~UP_CSUM_RX_OFFLOADS |
+		dev_info->rx_offload_capa;
+	conf->rxmode.ignore_offload_bitfield = 1;
+
+	up_csum_tx_ol[port] = 0;
+	if (dev_info->tx_offload_capa & DEV_TX_OFFLOAD_IPV4_CKSUM) {
+		tx_offloads |= DEV_TX_OFFLOAD_IPV4_CKSUM;
+		up_csum_tx_ol[port] |= PKT_TX_IP_CKSUM;
+	}
+	if (dev_info->tx_offload_capa & DEV_TX_OFFLOAD_UDP_CKSUM) {
+		tx_offloads |= DEV_TX_OFFLOAD_UDP_CKSUM;
+		up_csum_tx_ol[port] |= PKT_TX_UDP_CKSUM;
+	}
+	conf->txmode.offloads |= tx_offloads;
+
+	/* The default TX queue flags may select a path without offloads */
+	*txconf = dev_info->default_txconf;
+	txconf->txq_flags = ETH_TXQ_FLAGS_IGNORE;
+	txconf->offloads = conf->txmode.offloads;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"Port %u checksums: RX %s, TX IPv4 %s, TX UDP %s\n",
+		LOG_VALUE, port,
+		(conf->rxmode.offloads & UP_CSUM_RX_OFFLOADS) ? "hw" : "none",
+		(up_csum_tx_ol[port] & PKT_TX_IP_CKSUM) ? "hw" : "sw",
+		(up_csum_tx_ol[port] & PKT_TX_UDP_CKSUM) ? "hw" : "sw");
+}
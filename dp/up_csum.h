@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_CSUM_H_
+#define _UP_CSUM_H_
+/**
+ * @file
+ * This file contains the checksums of the headers rewritten by the data
+ * path: the outer IP and UDP headers of the GTPU encapsulation and of the
+ * S5S8 relay.
+ *
+ * The TX checksum offloads of each port are detected when the port is
+ * initialized. On a port with the offload, the packet carries the PKT_TX_*
+ * flags and the l2/l3 lengths, and the UDP checksum is seeded with the
+ * pseudo header sum the NIC completes; other ports get the checksums in
+ * software. The RX checksum flags set by the NIC are checked before the
+ * GTPU decapsulation.
+ */
+#include <stdint.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_branch_prediction.h>
+
+#include "util.h"
+
+/* TX flags of the checksums */
+#define UP_CSUM_TX_FLAGS	(PKT_TX_IPV4 | PKT_TX_IPV6 | PKT_TX_IP_CKSUM | \
+					PKT_TX_L4_MASK)
+
+/* PKT_TX_IP_CKSUM and PKT_TX_UDP_CKSUM, when computed by the port */
+extern uint64_t up_csum_tx_ol[RTE_MAX_ETHPORTS];
+
+/**
+ * @brief  : Enable the checksum offloads supported by the port in its
+ *           configuration, record the TX ones for the data path
+ * @param  : port, port id
+ * @param  : dev_info, port capabilities
+ * @param  : conf, port configuration, updated
+ * @param  : txconf, TX queue configuration, filled
+ * @return : Returns nothing
+ */
+void
+up_csum_port_conf(uint8_t port, const struct rte_eth_dev_info *dev_info,
+		struct rte_eth_conf *conf, struct rte_eth_txconf *txconf);
+
+/**
+ * @brief  : Set the IPv4 header and UDP checksums of the packet sent on
+ *           the port, or request them from the NIC
+ * @param  : m, mbuf pointer, data starting with the ether header
+ * @param  : ipv4_hdr, IPv4 header, total length set
+ * @param  : udp_hdr, UDP header, length set
+ * @param  : port, egress port
+ * @return : Returns nothing
+ */
+static inline void
+up_csum_ipv4_udp(struct rte_mbuf *m, struct ipv4_hdr *ipv4_hdr,
+		struct udp_hdr *udp_hdr, uint8_t port)
+{
+	uint64_t ol = up_csum_tx_ol[port];
+
+	m->ol_flags &= ~UP_CSUM_TX_FLAGS;
+	ipv4_hdr->hdr_checksum = 0;
+	udp_hdr->dgram_cksum = 0;
+
+	if (likely(ol)) {
+		m->l2_len = ETH_HDR_SIZE;
+		m->l3_len = (ipv4_hdr->version_ihl & 0xf) << 2;
+		m->ol_flags |= PKT_TX_IPV4 | ol;
+	}
+
+	if (!(ol & PKT_TX_IP_CKSUM))
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+
+	if (ol & PKT_TX_UDP_CKSUM)
+		udp_hdr->dgram_cksum = rte_ipv4_phdr_cksum(ipv4_hdr, m->ol_flags);
+	else
+		udp_hdr->dgram_cksum = rte_ipv4_udptcp_cksum(ipv4_hdr, udp_hdr);
+}
+
+/**
+ * @brief  : Set the UDP checksum of the IPv6 packet sent on the port, or
+ *           request it from the NIC
+ * @param  : m, mbuf pointer, data starting with the ether header
+ * @param  : ipv6_hdr, IPv6 header, payload length set
+ * @param  : udp_hdr, UDP header, length set
+ * @param  : port, egress port
+ * @return : Returns nothing
+ */
+static inline void
+up_csum_ipv6_udp(struct rte_mbuf *m, struct ipv6_hdr *ipv6_hdr,
+		struct udp_hdr *udp_hdr, uint8_t port)
+{
+	m->ol_flags &= ~UP_CSUM_TX_FLAGS;
+	udp_hdr->dgram_cksum = 0;
+
+	if (likely(up_csum_tx_ol[port] & PKT_TX_UDP_CKSUM)) {
+		m->l2_len = ETH_HDR_SIZE;
+		m->l3_len = IPv6_HDR_SIZE;
+		m->ol_flags |= PKT_TX_IPV6 | PKT_TX_UDP_CKSUM;
+		udp_hdr->dgram_cksum = rte_ipv6_phdr_cksum(ipv6_hdr, m->ol_flags);
+	} else {
+		udp_hdr->dgram_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, udp_hdr);
+	}
+}
+
+/**
+ * @brief  : Complete in a copy of the packet headers the checksums left to
+ *           the NIC, for the copies taken after the offload is requested
+ * @param  : m, mbuf pointer, packet as sent on the port
+ * @param  : hdr, copy of the first bytes of the packet, updated
+ * @param  : hdr_len, number of bytes in the copy
+ * @return : Returns nothing
+ */
+static inline void
+up_csum_copy_fill(const struct rte_mbuf *m, uint8_t *hdr, uint32_t hdr_len)
+{
+	uint32_t l4_off = m->l2_len + m->l3_len;
+	uint16_t cksum = 0;
+	struct ipv4_hdr *ipv4_hdr = NULL;
+	struct udp_hdr *udp_hdr = NULL;
+
+	if (likely(!(m->ol_flags & (PKT_TX_IP_CKSUM | PKT_TX_L4_MASK))))
+		return;
+
+	if ((m->ol_flags & PKT_TX_IP_CKSUM) && (l4_off <= hdr_len)) {
+		ipv4_hdr = (struct ipv4_hdr *)(hdr + m->l2_len);
+		ipv4_hdr->hdr_checksum = 0;
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+	}
+
+	/* The UDP checksum field holds the pseudo header sum, the datagram
+	 * sum is then the pseudo header and data sum the NIC complements */
+	if (((m->ol_flags & PKT_TX_L4_MASK) == PKT_TX_UDP_CKSUM) &&
+			(l4_off + sizeof(struct udp_hdr) <= hdr_len) &&
+			(rte_raw_cksum_mbuf(m, l4_off, m->pkt_len - l4_off,
+					    &cksum) == 0)) {
+		cksum = ~cksum;
+		udp_hdr = (struct udp_hdr *)(hdr + l4_off);
+		udp_hdr->dgram_cksum = (cksum == 0) ? 0xffff : cksum;
+	}
+}
+
+/**
+ * @brief  : Check the RX checksum flags of the outer headers
+ * @param  : m, mbuf pointer
+ * @return : Returns 1 if the NIC found a bad IP or L4 checksum, 0 if they
+ *           are good or were not checked
+ */
+static inline int
+up_csum_rx_bad(const struct rte_mbuf *m)
+{
+	return ((m->ol_flags & PKT_RX_IP_CKSUM_MASK) == PKT_RX_IP_CKSUM_BAD) ||
+		((m->ol_flags & PKT_RX_L4_CKSUM_MASK) == PKT_RX_L4_CKSUM_BAD);
+}
+
+#endif /* _UP_CSUM_H_ */
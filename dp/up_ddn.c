@@ -24,48 +24,10 @@
 #include "gw_adapter.h"
 #include "interface.h"
 #include "pfcp_messages_encoder.h"
+#include "up_ddn_buf.h"
 
 extern int clSystemLog;
 
-struct
-rte_ring *allocate_ring(unsigned int dl_ring_size)
-{
-	char name[32];
-	struct rte_ring *dl_ring = NULL;
-	unsigned dl_core = rte_lcore_id();
-
-	if ((DL_RING_CONTAINER_SIZE > num_dl_rings) &&
-			(rte_ring_count(dl_ring_container) < DL_RING_CONTAINER_SIZE)) {
-
-		snprintf(name, sizeof(name), "dl_pkt_ring_%"PRIu32"_%u",
-				num_dl_rings, dl_core);
-
-		struct rte_ring *tmp =
-			rte_ring_create(name, rte_align32pow2(dl_ring_size),
-					rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
-		if (tmp) {
-			int ret = rte_ring_enqueue(dl_ring_container, tmp);
-			if (ret == ENOBUFS) {
-				clLog(clSystemLog, eCLSeverityDebug,
-						LOG_FORMAT"Cannot hold more dl rings\n", LOG_VALUE);
-				rte_ring_free(tmp);
-				return NULL;
-			}
-
-			dl_ring = tmp;
-			num_dl_rings++;
-		} else {
-			clLog(clSystemLog, eCLSeverityCritical,
-					LOG_FORMAT"Couldnt create %s for DL PKTS %s\n",
-					LOG_VALUE, name, rte_strerror(rte_errno));
-			if (rte_errno == EEXIST)
-				num_dl_rings++;
-		}
-	}
-
-	return dl_ring;
-}
-
 /* Process ddn ack received by data-plane from control-plane */
 int
 dp_ddn_ack(struct dp_id dp_id,
@@ -75,7 +37,7 @@ dp_ddn_ack(struct dp_id dp_id,
 
 	/** Currently ack attribute dl_buff_cnt and dl_buff_duration is not handled.
 	 *  default behaviour is ddn will be issued for the 1st packet for which the
-	 *  session is IDEL and it will issued after ring is full. */
+	 *  session is IDEL, packets over the DDN buffer limits are dropped. */
 
 	clLog(clSystemLog, eCLSeverityInfo,
 		LOG_FORMAT"DDN ACK processed\n", LOG_VALUE);
@@ -201,7 +163,7 @@ send_ddn_request(pdr_info_t *pdr)
 
 	/* Free allocated memory */
 	free(ddn);
-	++epc_app.dl_params[SGI_PORT_ID].ddn;
+	++EPC_DL_PARAMS.ddn;
 	return 0;
 
 }
@@ -212,7 +174,6 @@ enqueue_dl_pkts(pdr_info_t **pdrs, pfcp_session_datat_t **sess_info,
 {
 	int i = 0, rc = 0;
 	pdr_info_t *pdr = NULL;
-	struct rte_ring *ring = NULL;
 	struct pfcp_session_datat_t *si = NULL;
 
 	while (pkts_queue_mask) {
@@ -265,73 +226,38 @@ enqueue_dl_pkts(pdr_info_t **pdrs, pfcp_session_datat_t **sess_info,
 			}
 		}
 
-		ring = si->dl_ring;
-		if ((!ring) /* && ((pdr->far)->actions.buff) */) {
-			ring = allocate_ring((pdr->session)->bar.dl_buf_suggstd_pckts_cnt.pckt_cnt_val);
-			if (ring == NULL) {
-				clLog(clSystemLog, eCLSeverityInfo, LOG_FORMAT"Not enough memory, can't "
-					"buffer this Session: %lu\n", LOG_VALUE,
-					(pdr->session)->up_seid);
-				rte_pktmbuf_free(pkts[i]);
-				continue;
-			}
-
-			si->dl_ring = ring;
-
-			if (si->sess_state == IDLE) {
-				if ((pdr->far)->actions.nocp) {
-					rc = send_ddn_request(pdr);
-
-					if(rc < 0) {
-						clLog(clSystemLog, eCLSeverityCritical,
-							LOG_FORMAT"Failed to send ddn req for session: %lu\n",
-							LOG_VALUE, (pdr->session)->up_seid);
-
-					}
-
-					si->sess_state = IN_PROGRESS;
-				}
-			}
+		if (!(((pdr->far)->actions.nocp) || ((pdr->far)->actions.buff) ||
+				((pdr->far)->actions.forw))) {
+			rte_pktmbuf_free(pkts[i]);
+			continue;
 		}
 
-
-		if (((pdr->far)->actions.nocp) || ((pdr->far)->actions.buff) || ((pdr->far)->actions.forw)) {
-
-			if (rte_ring_enqueue(si->dl_ring, (void *)pkts[i]) == -ENOBUFS) {
-
-				rte_pktmbuf_free(pkts[i]);
-				rte_ring_free(si->dl_ring);
-				if(rte_ring_sc_dequeue(dl_ring_container, (void *)&si->dl_ring) == -ENOENT) {
-					clLog(clSystemLog, eCLSeverityCritical,
-						LOG_FORMAT"Ring not found\n",LOG_VALUE);
-				} else{
-					clLog(clSystemLog, eCLSeverityDebug,
-						LOG_FORMAT"Dequeued Ring \n",LOG_VALUE);
-				}
-				si->dl_ring = NULL;
-				pkts[i] = NULL;
-				si->sess_state = IDLE;
-
+		if (ddn_buf_enqueue(&si->cold->dl_buf, pkts[i],
+				(pdr->session)->bar.dl_buf_suggstd_pckts_cnt.pckt_cnt_val) < 0) {
+			clLog(clSystemLog, eCLSeverityDebug,
+				LOG_FORMAT"DDN buffer full, dropping pkt for Session:%lu\n",
+				LOG_VALUE, (pdr->session)->up_seid);
+		} else {
+			clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"ACTIONS : %s :"
+					"Buffering the PKTS\n", LOG_VALUE,
+					(((pdr->far)->actions.nocp != 0) &&
+					((pdr->far)->actions.buff != 0)) ? "Notify to CP, Buffer," :
+					(pdr->far)->actions.nocp != 0 ? "Notify to CP" :
+					(pdr->far)->actions.buff != 0 ? "Buffer" :"UNKNOWN");
+		}
+		pkts[i] = NULL;
+
+		/* First pkt of the idle session, page the UE. The workers of
+		 * the session race on it, only the one moving it out of IDLE
+		 * sends the DDN */
+		if (((pdr->far)->actions.nocp) &&
+				__sync_bool_compare_and_swap(&si->sess_state, IDLE,
+					IN_PROGRESS)) {
+			rc = send_ddn_request(pdr);
+			if(rc < 0) {
 				clLog(clSystemLog, eCLSeverityCritical,
-					LOG_FORMAT"Can't queue pkt ring full"
-					" So Dropping pkt\n", LOG_VALUE);
-
-				/* Send PFCP Session Report Response */
-				rc = send_ddn_request(pdr);
-				if(rc < 0) {
-					clLog(clSystemLog, eCLSeverityCritical,
-							LOG_FORMAT"Failed to send ddn req for session: %lu\n",
-							LOG_VALUE, (pdr->session)->up_seid);
-
-				}
-
-			} else {
-				clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"ACTIONS : %s :"
-						"Buffering the PKTS\n", LOG_VALUE,
-						(((pdr->far)->actions.nocp != 0) &&
-						((pdr->far)->actions.nocp != 0)) ? "Notify to CP, Buffer," :
-						(pdr->far)->actions.nocp != 0 ? "Notify to CP" :
-						(pdr->far)->actions.nocp != 0 ? "Buffer" :"UNKNOWN");
+					LOG_FORMAT"Failed to send ddn req for session: %lu\n",
+					LOG_VALUE, (pdr->session)->up_seid);
 			}
 		}
 	}
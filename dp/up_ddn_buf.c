@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_errno.h>
+#include <rte_memcpy.h>
+
+#include "up_main.h"
+#include "up_ddn_buf.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/* Shared pool of the buffered packets */
+static struct rte_mempool *ddn_buf_pool;
+
+/* DDN_BUF_DROP_NEWEST or DDN_BUF_DROP_OLDEST */
+static uint8_t ddn_buf_policy = DDN_BUF_DROP_NEWEST;
+
+int
+ddn_buf_init(uint32_t pool_sz, uint8_t policy)
+{
+	if (pool_sz == 0)
+		pool_sz = DDN_BUF_POOL_SZ_DFLT;
+
+	/* Cache stays within the mempool limit of pool_sz / 1.5 */
+	ddn_buf_pool = rte_pktmbuf_pool_create("DDN_BUF_POOL", pool_sz,
+			RTE_MIN((uint32_t)DDN_BUF_CACHE_SZ, pool_sz / 2), 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (ddn_buf_pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create DDN buffer pool of %u mbufs, "
+			"Error: %s\n", LOG_VALUE, pool_sz, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	ddn_buf_policy = policy;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"DDN buffer pool of %u mbufs, drop %s\n", LOG_VALUE,
+		pool_sz, (policy == DDN_BUF_DROP_OLDEST) ? "oldest" : "newest");
+
+	return 0;
+}
+
+/**
+ * @brief  : Append a packet to the queue, queue lock held
+ * @param  : q, session queue
+ * @param  : m, packet
+ * @return : Returns nothing
+ */
+static inline void
+ddn_buf_push(struct ddn_buf_q *q, struct rte_mbuf *m)
+{
+	m->udata64 = 0;
+	if (q->tail != NULL)
+		q->tail->udata64 = (uint64_t)(uintptr_t)m;
+	else
+		q->head = m;
+	q->tail = m;
+	q->count++;
+}
+
+/**
+ * @brief  : Take the oldest packet off the queue, queue lock held
+ * @param  : q, session queue
+ * @return : Returns packet, NULL if the queue is empty
+ */
+static inline struct rte_mbuf *
+ddn_buf_pop(struct ddn_buf_q *q)
+{
+	struct rte_mbuf *m = q->head;
+
+	if (m == NULL)
+		return NULL;
+
+	q->head = (struct rte_mbuf *)(uintptr_t)m->udata64;
+	if (q->head == NULL)
+		q->tail = NULL;
+	q->count--;
+	m->udata64 = 0;
+	return m;
+}
+
+/**
+ * @brief  : Free a chain of packets
+ * @param  : m, first packet of the chain
+ * @return : Returns number of packets freed
+ */
+static uint32_t
+ddn_buf_free_chain(struct rte_mbuf *m)
+{
+	uint32_t cnt = 0;
+
+	while (m != NULL) {
+		struct rte_mbuf *next = (struct rte_mbuf *)(uintptr_t)m->udata64;
+
+		rte_pktmbuf_free(m);
+		m = next;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+/**
+ * @brief  : Copy the packet and its metadata into a pool mbuf
+ * @param  : buf, empty mbuf of the pool
+ * @param  : m, received packet
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+ddn_buf_copy(struct rte_mbuf *buf, const struct rte_mbuf *m)
+{
+	char *data = NULL;
+	const void *src = NULL;
+	uint32_t len = rte_pktmbuf_pkt_len(m);
+
+	data = rte_pktmbuf_append(buf, len);
+	if (data == NULL)
+		return -1;
+
+	/* Only segmented packets are copied by the read */
+	src = rte_pktmbuf_read(m, 0, len, data);
+	if (src == NULL)
+		return -1;
+	if (src != data)
+		rte_memcpy(data, src, len);
+
+	*(struct epc_meta_data *)RTE_MBUF_METADATA_UINT8_PTR(buf, META_DATA_OFFSET) =
+		*(const struct epc_meta_data *)RTE_MBUF_METADATA_UINT8_PTR(m,
+				META_DATA_OFFSET);
+	buf->port = m->port;
+	buf->packet_type = m->packet_type;
+
+	return 0;
+}
+
+int
+ddn_buf_enqueue(struct ddn_buf_q *q, struct rte_mbuf *m, uint32_t limit)
+{
+	int ret = -1;
+	struct rte_mbuf *buf = NULL;
+	struct rte_mbuf *old = NULL;
+
+	if (limit == 0)
+		limit = DDN_BUF_SESS_SZ_DFLT;
+
+	buf = rte_pktmbuf_alloc(ddn_buf_pool);
+
+	rte_spinlock_lock(&q->lock);
+
+	/* Full queue or empty pool, the oldest packet makes room */
+	if (!q->closed && ((q->count >= limit) || (buf == NULL)) &&
+			(ddn_buf_policy == DDN_BUF_DROP_OLDEST) && (q->head != NULL)) {
+		old = ddn_buf_pop(q);
+		q->drops++;
+		if (buf == NULL) {
+			rte_pktmbuf_reset(old);
+			buf = old;
+			old = NULL;
+		}
+	}
+
+	if (!q->closed && (q->count < limit) && (buf != NULL) &&
+			(ddn_buf_copy(buf, m) == 0)) {
+		ddn_buf_push(q, buf);
+		buf = NULL;
+		ret = 0;
+	} else {
+		q->drops++;
+	}
+
+	rte_spinlock_unlock(&q->lock);
+
+	rte_pktmbuf_free(m);
+	rte_pktmbuf_free(buf);
+	rte_pktmbuf_free(old);
+
+	return ret;
+}
+
+uint32_t
+ddn_buf_dequeue_burst(struct ddn_buf_q *q, struct rte_mbuf **pkts, uint32_t n)
+{
+	uint32_t i = 0;
+
+	rte_spinlock_lock(&q->lock);
+	for (i = 0; (i < n) && (q->head != NULL); i++)
+		pkts[i] = ddn_buf_pop(q);
+	rte_spinlock_unlock(&q->lock);
+
+	return i;
+}
+
+uint32_t
+ddn_buf_trim(struct ddn_buf_q *q, uint32_t limit)
+{
+	uint32_t cnt = 0;
+	uint32_t dropped = 0;
+	struct rte_mbuf *chain = NULL;
+	struct rte_mbuf *last = NULL;
+
+	if (limit == 0)
+		limit = DDN_BUF_SESS_SZ_DFLT;
+
+	rte_spinlock_lock(&q->lock);
+
+	if (q->count > limit) {
+		dropped = q->count - limit;
+		q->drops += dropped;
+
+		if (ddn_buf_policy == DDN_BUF_DROP_OLDEST) {
+			/* Detach the oldest packets */
+			for (cnt = 0; cnt < dropped; cnt++) {
+				struct rte_mbuf *m = ddn_buf_pop(q);
+
+				if (last != NULL)
+					last->udata64 = (uint64_t)(uintptr_t)m;
+				else
+					chain = m;
+				last = m;
+			}
+		} else {
+			/* Detach the newest packets, after the first limit ones */
+			last = q->head;
+			for (cnt = 1; cnt < limit; cnt++)
+				last = (struct rte_mbuf *)(uintptr_t)last->udata64;
+			chain = (struct rte_mbuf *)(uintptr_t)last->udata64;
+			last->udata64 = 0;
+			q->tail = last;
+			q->count = limit;
+		}
+	}
+
+	rte_spinlock_unlock(&q->lock);
+
+	ddn_buf_free_chain(chain);
+
+	return dropped;
+}
+
+uint32_t
+ddn_buf_flush(struct ddn_buf_q *q, uint8_t close)
+{
+	uint32_t cnt = 0;
+	uint32_t drops = 0;
+	struct rte_mbuf *chain = NULL;
+
+	rte_spinlock_lock(&q->lock);
+	chain = q->head;
+	q->head = NULL;
+	q->tail = NULL;
+	q->count = 0;
+	if (close)
+		q->closed = 1;
+	drops = q->drops;
+	rte_spinlock_unlock(&q->lock);
+
+	cnt = ddn_buf_free_chain(chain);
+
+	clLog(clSystemLog, eCLSeverityDebug,
+		LOG_FORMAT"DDN buffer flushed %u pkts, %u pkts dropped before\n",
+		LOG_VALUE, cnt, drops);
+
+	return cnt;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_DDN_BUF_H_
+#define _UP_DDN_BUF_H_
+/**
+ * @file
+ * This file contains the downlink buffering of the sessions waiting for a
+ * DDN to complete.
+ *
+ * A buffered packet is copied into a mbuf of the shared DDN buffer pool and
+ * chained on the session queue, the received mbuf goes back to its RX pool
+ * right away. The pool is created once at startup, its size is the global
+ * limit of buffered packets; the BAR suggested packet count is the limit of
+ * one session. When a limit is hit the new packet is dropped, or with the
+ * drop oldest policy the oldest packet of the session makes room for it.
+ *
+ * Queues are filled by the DL workers, drained by DL worker 0 on the
+ * notification and flushed by the control path, all under the queue lock.
+ */
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include <rte_spinlock.h>
+
+/* Default size of the shared pool, i.e. max number of buffered packets */
+#define DDN_BUF_POOL_SZ_DFLT	(1 << 16)
+
+/* Per lcore cache of the shared pool */
+#define DDN_BUF_CACHE_SZ	256
+
+/* Session limit when the BAR has no suggested packet count */
+#define DDN_BUF_SESS_SZ_DFLT	1024
+
+/* Policy when the session or the global limit is hit */
+#define DDN_BUF_DROP_NEWEST	0
+#define DDN_BUF_DROP_OLDEST	1
+
+/**
+ * @brief  : Packets buffered for a session, oldest first
+ */
+struct ddn_buf_q {
+	rte_spinlock_t lock;
+	/* Set when the session is deleted, nothing is buffered anymore */
+	uint8_t closed;
+	/* Number of buffered packets */
+	uint32_t count;
+	/* Packets dropped on a full queue or pool */
+	uint32_t drops;
+	/* Packets are chained through udata64 */
+	struct rte_mbuf *head;
+	struct rte_mbuf *tail;
+};
+
+/**
+ * @brief  : Create the shared DDN buffer pool
+ * @param  : pool_sz, number of mbufs of the pool
+ * @param  : policy, DDN_BUF_DROP_NEWEST or DDN_BUF_DROP_OLDEST
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+ddn_buf_init(uint32_t pool_sz, uint8_t policy);
+
+/**
+ * @brief  : Buffer a copy of the packet on the session queue
+ * @param  : q, session queue
+ * @param  : m, packet, always consumed
+ * @param  : limit, max number of packets of the session, 0 for the default
+ * @return : Returns 0 if the packet was buffered, -1 if it was dropped
+ */
+int
+ddn_buf_enqueue(struct ddn_buf_q *q, struct rte_mbuf *m, uint32_t limit);
+
+/**
+ * @brief  : Take the oldest packets off the session queue
+ * @param  : q, session queue
+ * @param  : pkts, dequeued packets, owned by the caller
+ * @param  : n, max number of packets
+ * @return : Returns number of packets dequeued
+ */
+uint32_t
+ddn_buf_dequeue_burst(struct ddn_buf_q *q, struct rte_mbuf **pkts, uint32_t n);
+
+/**
+ * @brief  : Drop the packets over the limit, on a BAR update
+ * @param  : q, session queue
+ * @param  : limit, new max number of packets of the session
+ * @return : Returns number of packets dropped
+ */
+uint32_t
+ddn_buf_trim(struct ddn_buf_q *q, uint32_t limit);
+
+/**
+ * @brief  : Drop all the packets of the session queue
+ * @param  : q, session queue
+ * @param  : close, set to refuse the packets coming after, on session delete
+ * @return : Returns number of packets dropped
+ */
+uint32_t
+ddn_buf_flush(struct ddn_buf_q *q, uint8_t close);
+
+#endif /* _UP_DDN_BUF_H_ */
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_prefetch.h>
+#include <rte_hash_crc.h>
+
+#include "gtpu.h"
+#include "util.h"
+#include "up_main.h"
+#include "up_dist.h"
+#include "gw_adapter.h"
+
+/* Packets prefetched ahead of the classified one */
+#define DIST_PREFETCH_OFF	4
+
+/* Worker of the packets that are not user data */
+#define DIST_CTRL_WORKER	0
+
+extern int clSystemLog;
+
+/* Worker rings, indexed by port and worker id */
+static struct rte_ring *dist_ring[NUM_SPGW_PORTS][EPC_MAX_WORKERS];
+
+/* Counters of the distributor lcore */
+static struct up_dist_stats dist_stats[NUM_SPGW_PORTS];
+
+/* Distributor state of dist_stats_check */
+static uint64_t dist_stats_tsc;
+static uint64_t dist_stats_drops;
+
+int
+up_dist_init(void)
+{
+	uint8_t port = 0;
+	uint16_t wk = 0;
+	char name[RTE_RING_NAMESIZE];
+
+	if (epc_app.core_dist == -1)
+		return 0;
+
+	for (port = 0; port < NUM_SPGW_PORTS; port++) {
+		uint16_t nb_wk = (port == WEST_PORT_ID) ?
+			epc_app.num_ul_workers : epc_app.num_dl_workers;
+
+		for (wk = 0; wk < nb_wk; wk++) {
+			snprintf(name, sizeof(name), "DIST_%s_%u",
+					(port == WEST_PORT_ID) ? "WB" : "EB", wk);
+			/* Filled by the distributor, read by the worker */
+			dist_ring[port][wk] = rte_ring_create(name, UP_DIST_RING_SZ,
+					rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+			if (dist_ring[port][wk] == NULL) {
+				clLog(clSystemLog, eCLSeverityCritical,
+					LOG_FORMAT"Cannot create distributor ring %s: %s\n",
+					LOG_VALUE, name, rte_strerror(rte_errno));
+				return -1;
+			}
+		}
+	}
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"Distributor on lcore %d, %u UL / %u DL worker rings\n",
+		LOG_VALUE, epc_app.core_dist, epc_app.num_ul_workers,
+		epc_app.num_dl_workers);
+
+	return 0;
+}
+
+struct rte_ring *
+up_dist_ring(uint8_t port, uint16_t worker_id)
+{
+	if (port >= NUM_SPGW_PORTS || worker_id >= EPC_MAX_WORKERS)
+		return NULL;
+
+	return dist_ring[port][worker_id];
+}
+
+/**
+ * @brief  : Hash the TEID of a GTP-U user data packet
+ * @param  : m, packet
+ * @param  : off, offset of the UDP header
+ * @param  : hash, set to the TEID hash
+ * @return : Returns 1 for a user data packet, 0 otherwise
+ */
+static inline int
+dist_gtpu_hash(struct rte_mbuf *m, uint32_t off, uint32_t *hash)
+{
+	const struct udp_hdr *udph = rte_pktmbuf_mtod_offset(m,
+			const struct udp_hdr *, off);
+	const struct gtpu_hdr *gtpuhdr = NULL;
+
+	if (rte_pktmbuf_data_len(m) < off + UDP_HDR_SIZE + GTPU_HDR_SIZE)
+		return 0;
+
+	if (udph->dst_port != UDP_PORT_GTPU_NW_ORDER)
+		return 0;
+
+	/* End markers follow the packets of the bearer */
+	gtpuhdr = (const struct gtpu_hdr *)(udph + 1);
+	if ((gtpuhdr->msgtype != GTP_GPDU) && (gtpuhdr->msgtype != GTP_GEMR))
+		return 0;
+
+	*hash = rte_hash_crc_4byte(gtpuhdr->teid, PRIME_VALUE);
+	return 1;
+}
+
+/**
+ * @brief  : Hash the steering key of a packet: the TEID of the GTP-U
+ *           packets, the destination (UE) IP of the other IP packets of
+ *           the east port
+ * @param  : m, packet
+ * @param  : port, ingress port
+ * @param  : hash, set to the packet hash
+ * @return : Returns 1 for a user data packet, 0 otherwise
+ */
+static inline int
+dist_hash(struct rte_mbuf *m, uint8_t port, uint32_t *hash)
+{
+	const struct ether_hdr *eh = rte_pktmbuf_mtod(m, const struct ether_hdr *);
+
+	if (eh->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		const struct ipv4_hdr *ipv4_hdr = (const struct ipv4_hdr *)(eh + 1);
+		uint32_t ip_len = (ipv4_hdr->version_ihl & 0xf) << 2;
+
+		if (rte_pktmbuf_data_len(m) < ETH_HDR_SIZE + sizeof(*ipv4_hdr))
+			return 0;
+
+		if (ipv4_hdr->next_proto_id == IPPROTO_UDP &&
+				dist_gtpu_hash(m, ETH_HDR_SIZE + ip_len, hash))
+			return 1;
+
+		/* SGi, the UE is the destination whatever the protocol */
+		if (port == EAST_PORT_ID) {
+			*hash = rte_hash_crc_4byte(ipv4_hdr->dst_addr, PRIME_VALUE);
+			return 1;
+		}
+	} else if (eh->ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		const struct ipv6_hdr *ipv6_hdr = (const struct ipv6_hdr *)(eh + 1);
+		uint64_t prefix = 0;
+
+		if (rte_pktmbuf_data_len(m) < ETH_HDR_SIZE + IPv6_HDR_SIZE)
+			return 0;
+
+		if (ipv6_hdr->proto == IPPROTO_UDP &&
+				dist_gtpu_hash(m, ETH_HDR_SIZE + IPv6_HDR_SIZE, hash))
+			return 1;
+
+		/* SGi, the UE owns the /64 prefix of the destination */
+		if (port == EAST_PORT_ID) {
+			memcpy(&prefix, ipv6_hdr->dst_addr, sizeof(prefix));
+			*hash = rte_hash_crc_8byte(prefix, PRIME_VALUE);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Read a burst on a port and enqueue it to the worker rings
+ * @param  : port, WEST_PORT_ID or EAST_PORT_ID
+ * @return : Returns number of packets read
+ */
+static uint16_t
+dist_port(uint8_t port)
+{
+	uint16_t i = 0;
+	uint16_t n = 0;
+	uint16_t wk = 0;
+	uint32_t hash = 0;
+	uint32_t sent = 0;
+	struct rte_mbuf *pkts[UP_DIST_BURST];
+	struct rte_mbuf *bkt[EPC_MAX_WORKERS][UP_DIST_BURST];
+	uint16_t cnt[EPC_MAX_WORKERS] = {0};
+	struct up_dist_stats *st = &dist_stats[port];
+	uint64_t nb_wk = (port == WEST_PORT_ID) ?
+		epc_app.num_ul_workers : epc_app.num_dl_workers;
+
+	n = rte_eth_rx_burst(epc_app.ports[port], 0, pkts, UP_DIST_BURST);
+	if (n == 0)
+		return 0;
+	st->rx += n;
+
+	for (i = 0; i < RTE_MIN(n, (uint16_t)DIST_PREFETCH_OFF); i++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = pkts[i];
+
+		if (i + DIST_PREFETCH_OFF < n)
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[i + DIST_PREFETCH_OFF],
+						void *));
+
+		if (likely(dist_hash(m, port, &hash))) {
+			/* Multiply shift, the hash range split in nb_wk parts */
+			wk = (uint16_t)(((uint64_t)hash * nb_wk) >> 32);
+		} else {
+			wk = DIST_CTRL_WORKER;
+		}
+		bkt[wk][cnt[wk]++] = m;
+	}
+
+	for (wk = 0; wk < nb_wk; wk++) {
+		if (cnt[wk] == 0)
+			continue;
+
+		sent = rte_ring_sp_enqueue_burst(dist_ring[port][wk],
+				(void **)bkt[wk], cnt[wk], NULL);
+		st->enq[wk] += sent;
+		if (unlikely(sent < cnt[wk])) {
+			st->drop[wk] += cnt[wk] - sent;
+			for (i = sent; i < cnt[wk]; i++)
+				rte_pktmbuf_free(bkt[wk][i]);
+		}
+	}
+
+	return n;
+}
+
+/**
+ * @brief  : Log the counters when packets were dropped since the last
+ *           check, distributor lcore
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+dist_stats_check(void)
+{
+	uint8_t port = 0;
+	uint16_t wk = 0;
+	uint64_t drops = 0;
+	uint64_t port_drops[NUM_SPGW_PORTS] = {0};
+	uint64_t tsc = rte_rdtsc();
+
+	if (tsc < dist_stats_tsc)
+		return;
+	dist_stats_tsc = tsc + rte_get_tsc_hz() * UP_DIST_STATS_SEC;
+
+	for (port = 0; port < NUM_SPGW_PORTS; port++) {
+		for (wk = 0; wk < EPC_MAX_WORKERS; wk++)
+			port_drops[port] += dist_stats[port].drop[wk];
+		drops += port_drops[port];
+	}
+
+	if (drops == dist_stats_drops)
+		return;
+	dist_stats_drops = drops;
+
+	clLog(clSystemLog, eCLSeverityMinor,
+		LOG_FORMAT"Distributor worker rings full: WB rx %lu drop %lu, "
+		"EB rx %lu drop %lu\n", LOG_VALUE,
+		dist_stats[WEST_PORT_ID].rx, port_drops[WEST_PORT_ID],
+		dist_stats[EAST_PORT_ID].rx, port_drops[EAST_PORT_ID]);
+}
+
+void
+up_dist_run(__rte_unused void *arg)
+{
+	dist_port(WEST_PORT_ID);
+	dist_port(EAST_PORT_ID);
+
+	dist_stats_check();
+}
+
+void
+up_dist_stats_get(uint8_t port, struct up_dist_stats *stats)
+{
+	if (port >= NUM_SPGW_PORTS)
+		return;
+
+	*stats = dist_stats[port];
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_DIST_H_
+#define _UP_DIST_H_
+/**
+ * @file
+ * This file contains the software distributor of the ingress packets.
+ *
+ * RSS hashes the outer headers: all the GTP-U packets of an eNB share one
+ * outer tuple and land on one queue, and the vdevs have no RSS at all. When
+ * DISTRIBUTOR is set, the ports are set up with a single RX queue polled by
+ * the distributor lcore, which steers every packet to a worker ring: the
+ * uplink by the GTP-U TEID, the downlink by the destination UE IP of any
+ * IP packet (the TEID when the east port carries GTP-U, S5S8). A session
+ * is always handled by the same worker, which keeps its state core local
+ * and its packets in order.
+ *
+ * The workers read their ring in place of their RX queue. The other
+ * packets (ARP, non GTP-U packets of the west port, ...) go to worker 0.
+ * A full worker ring drops the packet, the drops are counted per worker.
+ */
+#include <stdint.h>
+#include <rte_ring.h>
+
+#include "epc_packet_framework.h"
+
+/* Size of the ring of a worker */
+#define UP_DIST_RING_SZ		1024
+
+/* Max number of packets read per port and burst */
+#define UP_DIST_BURST		64
+
+/* Period of the drop counters check of the distributor, in seconds */
+#define UP_DIST_STATS_SEC	10
+
+/**
+ * @brief  : Distributor counters of a port
+ */
+struct up_dist_stats {
+	uint64_t rx;
+	uint64_t enq[EPC_MAX_WORKERS];
+	uint64_t drop[EPC_MAX_WORKERS];
+};
+
+/**
+ * @brief  : Create the worker rings of both ports, when the distributor
+ *           lcore is configured
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_dist_init(void);
+
+/**
+ * @brief  : Ring read by a worker in place of its RX queue
+ * @param  : port, WEST_PORT_ID or EAST_PORT_ID
+ * @param  : worker_id, worker index
+ * @return : Returns ring, NULL when the distributor is not used
+ */
+struct rte_ring *
+up_dist_ring(uint8_t port, uint16_t worker_id);
+
+/**
+ * @brief  : Read a burst on both ports and steer it to the worker rings,
+ *           distributor lcore
+ * @param  : arg, unused parameter
+ * @return : Returns nothing
+ */
+void
+up_dist_run(void *arg);
+
+/**
+ * @brief  : Read the counters of a port
+ * @param  : port, WEST_PORT_ID or EAST_PORT_ID
+ * @param  : stats, filled with the counters
+ * @return : Returns nothing
+ */
+void
+up_dist_stats_get(uint8_t port, struct up_dist_stats *stats);
+
+#endif /* _UP_DIST_H_ */
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_malloc.h>
+
+#include "up_main.h"
+#include "up_rcu.h"
+#include "up_encap.h"
+#include "pfcp_util.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/**
+ * @brief  : Fill the IPv4 outer header of the template
+ * @param  : tmpl, template to be filled
+ * @param  : far, far information
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+fill_encap_tmpl_ipv4(struct gtpu_encap_tmpl *tmpl, far_info_t *far)
+{
+	uint32_t src_addr = 0;
+	uint32_t dst_addr = 0;
+	struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)tmpl->hdr;
+
+	dst_addr = ntohl(far->frwdng_parms.outer_hdr_creation.ipv4_address);
+
+	/* Select the local interface address of the next hop subnet */
+	if (validate_Subnet(dst_addr, app.wb_net, app.wb_bcast_addr)) {
+		src_addr = app.wb_ip;
+	} else if (validate_Subnet(dst_addr, app.wb_li_net, app.wb_li_bcast_addr)) {
+		src_addr = app.wb_li_ip;
+	} else {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"FAR_ID:%u, Destination IPv4 Addr "IPV4_ADDR" is NOT in "
+			"local intf subnet, no encap template\n", LOG_VALUE,
+			far->far_id_value, IPV4_ADDR_HOST_FORMAT(dst_addr));
+		return -1;
+	}
+
+	if ((!src_addr) || (!dst_addr))
+		return -1;
+
+	/* Same values as build_ipv4_default_hdr/set_ipv4_hdr */
+	ipv4_hdr->version_ihl = 0x45;
+	ipv4_hdr->type_of_service = 0;
+	ipv4_hdr->packet_id = 0x1513;
+	ipv4_hdr->fragment_offset = 0;
+	ipv4_hdr->time_to_live = 64;
+	ipv4_hdr->total_length = 0;
+	ipv4_hdr->next_proto_id = IP_PROTO_UDP;
+	ipv4_hdr->hdr_checksum = 0;
+	ipv4_hdr->src_addr = htonl(src_addr);
+	ipv4_hdr->dst_addr = htonl(dst_addr);
+
+	tmpl->ip_type = NOT_PRESENT;
+	tmpl->udp_off = IPv4_HDR_SIZE;
+	tmpl->ip_sum = rte_raw_cksum(ipv4_hdr, IPv4_HDR_SIZE);
+
+	return 0;
+}
+
+/**
+ * @brief  : Fill the IPv6 outer header of the template
+ * @param  : tmpl, template to be filled
+ * @param  : far, far information
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+fill_encap_tmpl_ipv6(struct gtpu_encap_tmpl *tmpl, far_info_t *far)
+{
+	struct in6_addr src_addr = {0};
+	struct in6_addr dst_addr = {0};
+	struct in6_addr tmp_addr = {0};
+	struct ipv6_hdr *ipv6_hdr = (struct ipv6_hdr *)tmpl->hdr;
+
+	memcpy(&dst_addr.s6_addr, far->frwdng_parms.outer_hdr_creation.ipv6_address,
+			IPV6_ADDRESS_LEN);
+
+	/* Select the local interface address of the next hop network */
+	if (validate_ipv6_network(dst_addr, app.wb_ipv6, app.wb_ipv6_prefix_len)) {
+		memcpy(&src_addr, &app.wb_ipv6, sizeof(struct in6_addr));
+	} else if (validate_ipv6_network(dst_addr, app.wb_li_ipv6,
+				app.wb_li_ipv6_prefix_len)) {
+		memcpy(&src_addr, &app.wb_li_ipv6, sizeof(struct in6_addr));
+	} else {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"FAR_ID:%u, Destination IPv6 Addr "IPv6_FMT" is NOT in "
+			"local intf network, no encap template\n", LOG_VALUE,
+			far->far_id_value, IPv6_PRINT(dst_addr));
+		return -1;
+	}
+
+	if ((!memcmp(&src_addr, &tmp_addr, IPV6_ADDRESS_LEN)) ||
+			(!memcmp(&dst_addr, &tmp_addr, IPV6_ADDRESS_LEN)))
+		return -1;
+
+	/* Same values as build_ipv6_default_hdr/set_ipv6_hdr */
+	ipv6_hdr->vtc_flow = IPv6_VERSION;
+	ipv6_hdr->payload_len = 0;
+	ipv6_hdr->proto = IP_PROTO_UDP;
+	ipv6_hdr->hop_limits = 0;
+	memcpy(&ipv6_hdr->src_addr, &src_addr.s6_addr, IPV6_ADDR_LEN);
+	memcpy(&ipv6_hdr->dst_addr, &dst_addr.s6_addr, IPV6_ADDR_LEN);
+
+	tmpl->ip_type = PRESENT;
+	tmpl->udp_off = IPv6_HDR_SIZE;
+
+	return 0;
+}
+
+/**
+ * @brief  : Build the outer header template of the FAR
+ * @param  : far, far information
+ * @return : Returns template pointer in case of success, NULL otherwise
+ */
+static struct gtpu_encap_tmpl *
+build_encap_tmpl(far_info_t *far)
+{
+	int ret = 0;
+	uint8_t *gpdu_hdr = NULL;
+	struct udp_hdr *udp_hdr = NULL;
+	struct gtpu_encap_tmpl *tmpl = NULL;
+
+	if (!far->frwdng_parms.outer_hdr_creation.teid)
+		return NULL;
+
+	if ((far->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc != GTPU_UDP_IPv4) &&
+		(far->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc != GTPU_UDP_IPv6))
+		return NULL;
+
+	tmpl = rte_zmalloc("ENCAP_TMPL", sizeof(struct gtpu_encap_tmpl),
+			RTE_CACHE_LINE_SIZE);
+	if (tmpl == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to allocate memory for encap template, "
+			"Error: %s\n", LOG_VALUE, rte_strerror(rte_errno));
+		return NULL;
+	}
+
+	if (far->frwdng_parms.outer_hdr_creation.outer_hdr_creation_desc == GTPU_UDP_IPv4)
+		ret = fill_encap_tmpl_ipv4(tmpl, far);
+	else
+		ret = fill_encap_tmpl_ipv6(tmpl, far);
+
+	if (ret) {
+		rte_free(tmpl);
+		return NULL;
+	}
+
+	/* UDP header, length and checksum are patched per packet */
+	udp_hdr = (struct udp_hdr *)(tmpl->hdr + tmpl->udp_off);
+	udp_hdr->src_port = htons(UDP_PORT_GTPU);
+	udp_hdr->dst_port = htons(UDP_PORT_GTPU);
+	udp_hdr->dgram_len = 0;
+	udp_hdr->dgram_cksum = 0;
+
+	/* GTPU header, length and sequence number are patched per packet */
+	tmpl->gtpu_off = tmpl->udp_off + UDP_HDR_SIZE;
+	tmpl->seqnb = app.gtpu_seqnb_out ? 1 : 0;
+	gpdu_hdr = tmpl->hdr + tmpl->gtpu_off;
+	if (tmpl->seqnb) {
+		gpdu_hdr[0] = (GTPU_VERSION << 5) | (GTP_PROTOCOL_TYPE_GTP << 4) |
+			(GTP_FLAG_SEQNB);
+		tmpl->hdr_len = tmpl->gtpu_off + GPDU_HDR_SIZE_WITH_SEQNB;
+	} else {
+		gpdu_hdr[0] = (GTPU_VERSION << 5) | (GTP_PROTOCOL_TYPE_GTP << 4);
+		tmpl->hdr_len = tmpl->gtpu_off + GPDU_HDR_SIZE_WITHOUT_SEQNB;
+	}
+	gpdu_hdr[1] = GTP_GPDU;
+	*((uint32_t *)(gpdu_hdr + 4)) =
+		htonl(far->frwdng_parms.outer_hdr_creation.teid);
+
+	return tmpl;
+}
+
+int8_t
+far_encap_tmpl_update(far_info_t *far)
+{
+	struct gtpu_encap_tmpl *tmpl = NULL;
+	struct gtpu_encap_tmpl *old = NULL;
+
+	if (far == NULL)
+		return -1;
+
+	tmpl = build_encap_tmpl(far);
+
+	/* Publish the filled template before the DL cores can pick it up */
+	rte_smp_wmb();
+	old = far->encap_tmpl;
+	far->encap_tmpl = tmpl;
+	up_rcu_defer_free(old);
+
+	clLog(clSystemLog, eCLSeverityDebug,
+		LOG_FORMAT"FAR_ID:%u, encap template %s\n", LOG_VALUE,
+		far->far_id_value, (tmpl != NULL) ? "built" : "not used");
+
+	return (tmpl != NULL) ? 0 : -1;
+}
+
+void
+far_encap_tmpl_free(far_info_t *far)
+{
+	if (far == NULL)
+		return;
+
+	up_rcu_defer_free(far->encap_tmpl);
+	far->encap_tmpl = NULL;
+}
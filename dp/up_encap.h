@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_ENCAP_H_
+#define _UP_ENCAP_H_
+/**
+ * @file
+ * This file contains the per FAR outer header templates used by the
+ * GTPU encapsulation. The IP, UDP and GTPU headers of a FAR are built
+ * once on the control path when the FAR is created or updated, the data
+ * path copies the template in front of the packet and only patches the
+ * length fields, the checksums and the GTPU sequence number. The IPv4
+ * header checksum is patched from the sum of the template when the egress
+ * port can not compute it.
+ */
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+#include <rte_byteorder.h>
+
+#include "gtpu.h"
+#include "util.h"
+#include "up_csum.h"
+#include "pfcp_up_struct.h"
+
+/* Largest outer header: IPv6 + UDP + GTPU with sequence number */
+#define GTPU_ENCAP_TMPL_MAX_LEN	(IPv6_HDR_SIZE + UDP_HDR_SIZE + \
+					GPDU_HDR_SIZE_WITH_SEQNB)
+
+/**
+ * @brief  : Ready made outer header of a FAR
+ */
+struct gtpu_encap_tmpl {
+	/* Outer IP header type, 0: IPv4, 1: IPv6 */
+	uint8_t ip_type;
+	/* GTPU sequence number present */
+	uint8_t seqnb;
+	/* Length of the IP + UDP + GTPU headers */
+	uint16_t hdr_len;
+	/* Offset of the UDP header in hdr[] */
+	uint16_t udp_off;
+	/* Offset of the GTPU header in hdr[] */
+	uint16_t gtpu_off;
+	/* IPv4 header sum with zero total length and checksum */
+	uint32_t ip_sum;
+	/* Outer IP + UDP + GTPU headers */
+	uint8_t hdr[GTPU_ENCAP_TMPL_MAX_LEN];
+} __rte_cache_aligned;
+
+/**
+ * @brief  : Build the outer header template of the FAR and publish it,
+ *           the old template is released through the QSBR
+ * @param  : far, far information
+ * @return : Returns 0 in case of success, -1 if the FAR can not use a
+ *           template, the encapsulation then builds the headers per packet
+ */
+int8_t
+far_encap_tmpl_update(far_info_t *far);
+
+/**
+ * @brief  : Release the outer header template of the FAR
+ * @param  : far, far information
+ * @return : Returns nothing
+ */
+void
+far_encap_tmpl_free(far_info_t *far);
+
+/**
+ * @brief  : Encapsulate the packet with the FAR outer header template
+ * @param  : m, mbuf pointer, data starting with the ether header
+ * @param  : tmpl, outer header template of the FAR
+ * @param  : port, egress port, for the checksum offloads
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static inline int
+gtpu_encap_tmpl_apply(struct rte_mbuf *m, const struct gtpu_encap_tmpl *tmpl,
+		uint8_t port)
+{
+	uint8_t *pkt_ptr = NULL;
+	uint8_t *gpdu_hdr = NULL;
+	struct udp_hdr *udp_hdr = NULL;
+	uint16_t tpdu_len = rte_pktmbuf_data_len(m) - ETH_HDR_SIZE;
+	uint16_t gtpu_len = tpdu_len;
+
+	/* Prepend the outer header in the headroom, the old ether header
+	 * space is reused by the new headers */
+	pkt_ptr = (uint8_t *)rte_pktmbuf_prepend(m, tmpl->hdr_len);
+	if (unlikely(pkt_ptr == NULL))
+		return -1;
+
+	pkt_ptr += ETH_HDR_SIZE;
+	rte_memcpy(pkt_ptr, tmpl->hdr, tmpl->hdr_len);
+
+	/* GTPU length and sequence number */
+	gpdu_hdr = pkt_ptr + tmpl->gtpu_off;
+	if (tmpl->seqnb) {
+		/* Shared by all the DL workers */
+		gtpu_len += sizeof(GTPU_STATIC_SEQNB);
+		*((uint32_t *)(gpdu_hdr + GPDU_HDR_SIZE_WITHOUT_SEQNB)) =
+			GTPU_STATIC_SEQNB |
+			htons(__sync_fetch_and_add(&gtpu_seqnb, 1));
+	}
+	*((uint16_t *)(gpdu_hdr + 2)) = rte_cpu_to_be_16(gtpu_len);
+
+	/* UDP length */
+	udp_hdr = (struct udp_hdr *)(pkt_ptr + tmpl->udp_off);
+	udp_hdr->dgram_len = rte_cpu_to_be_16(tmpl->hdr_len - tmpl->udp_off + tpdu_len);
+
+	if (tmpl->ip_type) {
+		struct ipv6_hdr *ipv6_hdr = (struct ipv6_hdr *)pkt_ptr;
+
+		ipv6_hdr->payload_len = udp_hdr->dgram_len;
+		up_csum_ipv6_udp(m, ipv6_hdr, udp_hdr, port);
+	} else {
+		struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)pkt_ptr;
+		uint16_t total_len = rte_cpu_to_be_16(tmpl->hdr_len + tpdu_len);
+		uint64_t ol = up_csum_tx_ol[port];
+		uint32_t sum = tmpl->ip_sum + total_len;
+
+		ipv4_hdr->total_length = total_len;
+		m->ol_flags &= ~UP_CSUM_TX_FLAGS;
+		if (likely(ol)) {
+			m->l2_len = ETH_HDR_SIZE;
+			m->l3_len = IPv4_HDR_SIZE;
+			m->ol_flags |= PKT_TX_IPV4 | ol;
+		}
+
+		if (ol & PKT_TX_IP_CKSUM) {
+			ipv4_hdr->hdr_checksum = 0;
+		} else {
+			/* Add the total length to the precomputed header sum */
+			sum = (sum & 0xffff) + (sum >> 16);
+			sum = (sum & 0xffff) + (sum >> 16);
+			ipv4_hdr->hdr_checksum = (sum == 0xffff) ? sum : (uint16_t)~sum;
+		}
+
+		udp_hdr->dgram_cksum = 0;
+		if (ol & PKT_TX_UDP_CKSUM)
+			udp_hdr->dgram_cksum = rte_ipv4_phdr_cksum(ipv4_hdr, m->ol_flags);
+		else
+			udp_hdr->dgram_cksum = rte_ipv4_udptcp_cksum(ipv4_hdr, udp_hdr);
+	}
+
+	return 0;
+}
+
+#endif /* _UP_ENCAP_H_ */
@@ -23,6 +23,7 @@
 #include "ipv4.h"
 #include "ipv6.h"
 #include "pfcp_util.h"
+#include "up_adj.h"
 #include "up_ether.h"
 #include "pipeline/epc_arp.h"
 #include "gw_adapter.h"
@@ -51,35 +52,30 @@ static inline void set_ether_type(struct rte_mbuf *m, uint16_t type)
 	eth_hdr->ether_type = htons(type);
 }
 
-int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
-			pdr_info_t **pdr, uint8_t flag)
+/**
+ * @brief  : Function to set the ethertype and compute the next hop key.
+ * @param  : m, mbuf pointer
+ * @param  : portid, port id
+ * @param  : pdr, pointer to pdr session info, may point to NULL
+ * @param  : tmp_arp_key, next hop key to be filled
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+get_nexthop_key(struct rte_mbuf *m, uint8_t portid,
+		pdr_info_t **pdr, struct arp_ip_key *tmp_arp_key)
 {
-	/* Construct the ether header */
 	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, void *);
 	uint8_t *ptr = (uint8_t *)(rte_pktmbuf_mtod(m, unsigned char *) + ETH_HDR_SIZE);
-	struct arp_ip_key tmp_arp_key = {0};
 
 	/* Check L3 IP packet type its IPv4 or IPv6 */
 	if (*ptr == IP_HDR_IPv4_VERSION) {
 		/* Fill the ether header for IPv4 packet */
 		struct ipv4_hdr *ipv4_hdr = (struct ipv4_hdr *)&eth_hdr[1];
-		tmp_arp_key.ip_type.ipv4 = PRESENT;
-		tmp_arp_key.ip_addr.ipv4 = ipv4_hdr->dst_addr;
+		tmp_arp_key->ip_type.ipv4 = PRESENT;
+		tmp_arp_key->ip_addr.ipv4 = ipv4_hdr->dst_addr;
 
 		/* Retrieve Gateway Routing IP Address of the next hop */
-		if (portid == app.wb_port) {
-			if (app.wb_gw_ip != 0 &&
-					(tmp_arp_key.ip_addr.ipv4 & app.wb_mask) != app.wb_net) {
-				/* UPLINK */
-				tmp_arp_key.ip_addr.ipv4 = app.wb_gw_ip;
-			}
-		} else if (portid == app.eb_port) {
-			if (app.eb_gw_ip != 0 &&
-					(tmp_arp_key.ip_addr.ipv4 & app.eb_mask) != app.eb_net) {
-				/* DOWNLINK */
-				tmp_arp_key.ip_addr.ipv4 = app.eb_gw_ip;
-			}
-		}
+		up_adj_nexthop_key(portid, tmp_arp_key);
 
 		/* IPv4 L2 hdr */
 		eth_hdr->ether_type = htons(ETH_TYPE_IPv4);
@@ -87,23 +83,23 @@ int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
 	} else if (*ptr == IPv6_VERSION) {
 		/* Fill the ether header for IPv6 packet */
 		struct ipv6_hdr *ipv6_hdr = (struct ipv6_hdr *)&eth_hdr[1];
-		tmp_arp_key.ip_type.ipv6 = PRESENT;
+		tmp_arp_key->ip_type.ipv6 = PRESENT;
 
 		/* Fill the IPv6 destination Address*/
-		memcpy(&tmp_arp_key.ip_addr.ipv6.s6_addr, &ipv6_hdr->dst_addr,
+		memcpy(&tmp_arp_key->ip_addr.ipv6.s6_addr, &ipv6_hdr->dst_addr,
 				IPV6_ADDRESS_LEN);
 
 		clLog(clSystemLog, eCLSeverityDebug,
 				LOG_FORMAT"DST IPv6: "IPv6_FMT", ARP Key:"IPv6_FMT"\n",
 				LOG_VALUE, IPv6_PRINT(*(struct in6_addr *)ipv6_hdr->dst_addr),
-				IPv6_PRINT(tmp_arp_key.ip_addr.ipv6));
+				IPv6_PRINT(tmp_arp_key->ip_addr.ipv6));
 
 		/* TODO: Add the support if remote proxy IP configure in the config file, GW STATIC Entry  */
 
 		/* IPv6 L2 hdr */
 		eth_hdr->ether_type = htons(ETH_TYPE_IPv6);
 	} else {
-		if (*pdr) {
+		if ((pdr != NULL) && (*pdr != NULL)) {
 			clLog(clSystemLog, eCLSeverityCritical,
 					LOG_FORMAT"IP type in header is not set appropriate,"
 					"IP Type:%x, Outer HDR Desc:%u\n", LOG_VALUE, *ptr,
@@ -116,6 +112,19 @@ int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
 		return -1;
 	}
 
+	return 0;
+}
+
+int
+resolve_ether_hdr(struct rte_mbuf *m, uint8_t portid,
+		struct arp_entry_data **nh)
+{
+	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, void *);
+	struct arp_ip_key tmp_arp_key = {0};
+
+	if (get_nexthop_key(m, portid, NULL, &tmp_arp_key) < 0)
+		return -1;
+
 	/* Get the entry for IP address, if not present than create it */
 	struct arp_entry_data *ret_arp_data = NULL;
 	ret_arp_data = retrieve_arp_entry(tmp_arp_key, portid);
@@ -244,18 +253,61 @@ int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
 						ret_arp_data->eth_addr.addr_bytes[4],
 						ret_arp_data->eth_addr.addr_bytes[5]);
 	}
+	*nh = ret_arp_data;
 	ether_addr_copy(&ret_arp_data->eth_addr, &eth_hdr->d_addr);
 	ether_addr_copy(&ports_eth_addr[portid], &eth_hdr->s_addr);
 
+	return 0;
+}
+
+int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
+			pdr_info_t **pdr, uint8_t flag)
+{
+	/* Construct the ether header */
+	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, void *);
+	struct arp_ip_key tmp_arp_key = {0};
+	struct up_adj *adj = NULL;
+
+	if (get_nexthop_key(m, portid, pdr, &tmp_arp_key) < 0)
+		return -1;
+
+	/* Adjacency of the FAR peer, else the port default gateway */
+	if ((*pdr != NULL) && ((*pdr)->far != NULL))
+		adj = (*pdr)->far->adj;
+	if ((adj == NULL) || !up_adj_match(adj, portid, &tmp_arp_key)) {
+		adj = up_adj_gw(portid);
+		if ((adj != NULL) && !up_adj_match(adj, portid, &tmp_arp_key))
+			adj = NULL;
+	}
+
+	if (likely(adj != NULL)) {
+		if (unlikely(up_adj_fill(adj, eth_hdr) < 0)) {
+			/* Stale or never built, the mct core rebuilds it */
+			up_adj_resolve(m, portid, adj);
+			return -1;
+		}
+	} else {
+		/* Next hop without adjacency, read only ARP lookup */
+		struct arp_entry_data *ret_arp_data = NULL;
+
+		ret_arp_data = lookup_arp_entry(&tmp_arp_key, portid);
+		if ((ret_arp_data == NULL) || (ret_arp_data->status != COMPLETE)) {
+			up_adj_resolve(m, portid, NULL);
+			return -1;
+		}
+		ether_addr_copy(&ret_arp_data->eth_addr, &eth_hdr->d_addr);
+		ether_addr_copy(&ports_eth_addr[portid], &eth_hdr->s_addr);
+	}
+
 #ifdef NGCORE_SHRINK
 #ifdef STATS
 	struct gtpu_hdr *gtpu_hdr = NULL;
 	gtpu_hdr = get_mtogtpu(m);
 	if ((gtpu_hdr != NULL) && (gtpu_hdr->msgtype == GTP_GEMR)) {
 		if(portid == SGI_PORT_ID) {
-			--epc_app.ul_params[S1U_PORT_ID].pkts_in;
+			--EPC_UL_PARAMS.pkts_in;
 		} else if(portid == S1U_PORT_ID) {
-			--epc_app.dl_params[SGI_PORT_ID].pkts_in;
+			--EPC_DL_PARAMS.pkts_in;
 		}
 
 		return 0;
@@ -263,15 +315,15 @@ int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
 
 	if (flag) {
 		if(portid == SGI_PORT_ID) {
-			++epc_app.dl_params[SGI_PORT_ID].pkts_out;
+			++EPC_DL_PARAMS.pkts_out;
 		} else if(portid == S1U_PORT_ID) {
-			++epc_app.ul_params[S1U_PORT_ID].pkts_out;
+			++EPC_UL_PARAMS.pkts_out;
 		}
 	} else {
 		if(portid == SGI_PORT_ID) {
-			++epc_app.ul_params[S1U_PORT_ID].pkts_out;
+			++EPC_UL_PARAMS.pkts_out;
 		} else if(portid == S1U_PORT_ID) {
-			++epc_app.dl_params[SGI_PORT_ID].pkts_out;
+			++EPC_DL_PARAMS.pkts_out;
 		}
 	}
 #endif /* STATS */
@@ -53,4 +53,16 @@ static inline struct ether_hdr *get_mtoeth(struct rte_mbuf *m)
 int construct_ether_hdr(struct rte_mbuf *m, uint8_t portid,
 		pdr_info_t **pdr, uint8_t flag);
 
+/**
+ * @brief  : Function to resolve the next hop and construct L2 headers,
+ *           may create the ARP entry and reach the kernel, mct core only.
+ * @param  : m, mbuf pointer
+ * @param  : portid, port id
+ * @param  : nh, resolved next hop ARP/ND entry
+ * @return : Returns 0 in case of success , -1 if the next hop is not
+ *           resolved yet, a copy of the packet is then queued on the entry
+ */
+int resolve_ether_hdr(struct rte_mbuf *m, uint8_t portid,
+		struct arp_entry_data **nh);
+
 #endif /* _ETHER_H_ */
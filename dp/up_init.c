@@ -29,6 +29,8 @@
 #include <unistd.h>
 
 #include "up_main.h"
+#include "up_ddn_buf.h"
+#include "up_csum.h"
 #include "gw_adapter.h"
 
 extern int cp_comm_ip_type;
@@ -105,10 +107,6 @@ const struct rte_eth_conf port_conf_default = {
 
 struct rte_ring *shared_ring[NUM_SPGW_PORTS] = {NULL, NULL};
 
-struct rte_ring *dl_ring_container = NULL;
-
-uint32_t num_dl_rings = 0;
-
 struct rte_ring *notify_ring = NULL;
 
 struct rte_mempool *notify_msg_pool = NULL;
@@ -120,25 +118,65 @@ struct in_addr cp_comm_ip;
 uint16_t cp_comm_port;
 
 /**
- * @brief  : Function to Initialize a given port using global settings and with the rx
- *           buffers coming from the mbuf_pool passed as parameter
+ * @brief  : RX mempool and queue counts a port was initialized with, the
+ *           port is configured again with them on a KNI MTU change
+ */
+static struct {
+	struct rte_mempool *mbuf_pool;
+	uint16_t rx_rings;
+	uint16_t tx_rings;
+} port_queues[NUM_SPGW_PORTS];
+
+/**
+ * @brief  : Configure a port and set up all its RX/TX queues, the port
+ *           must be stopped
  * @param  : port, port number.
- * @param  : mbuf_pool, memory pool pointer.
+ * @param  : port_conf, port configuration, RSS and checksum offloads are
+ *           added to it
  * @return : Returns 0 in case of success , -1 otherwise
  */
-static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
+static int
+port_queues_setup(uint8_t port, struct rte_eth_conf *port_conf)
 {
-	struct rte_eth_conf port_conf = port_conf_default;
-	const uint16_t rx_rings = 1, tx_rings = 1;  //tx_rings = rte_lcore_count() - 1;
+	struct rte_eth_dev_info dev_info = {0};
+	struct rte_eth_txconf txconf = {0};
+	uint16_t rx_rings = port_queues[port].rx_rings;
+	uint16_t tx_rings = port_queues[port].tx_rings;
 	int retval;
 	uint16_t q;
 
-
-	if (port >= rte_eth_dev_count())
+	rte_eth_dev_info_get(port, &dev_info);
+	if ((rx_rings > dev_info.max_rx_queues) ||
+			(tx_rings > dev_info.max_tx_queues)) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Port %u supports %u RX / %u TX queues, "
+			"workers need %u RX / %u TX queues\n", LOG_VALUE, port,
+			dev_info.max_rx_queues, dev_info.max_tx_queues,
+			rx_rings, tx_rings);
 		return -1;
+	}
+
+	/* Spread the ingress traffic across the worker queues */
+	if (rx_rings > 1) {
+		port_conf->rxmode.mq_mode = ETH_MQ_RX_RSS;
+		port_conf->rx_adv_conf.rss_conf.rss_key = NULL;
+		port_conf->rx_adv_conf.rss_conf.rss_hf =
+			(ETH_RSS_IP | ETH_RSS_UDP) & dev_info.flow_type_rss_offloads;
+
+		if (!port_conf->rx_adv_conf.rss_conf.rss_hf) {
+			/* e.g. net_ring/net_pcap, one ring/pcap per queue */
+			port_conf->rxmode.mq_mode = ETH_MQ_RX_NONE;
+			clLog(clSystemLog, eCLSeverityMajor,
+				LOG_FORMAT"Port %u has no RSS support, %u RX queues "
+				"are fed by the device as is\n", LOG_VALUE, port, rx_rings);
+		}
+	}
+
+	/* Checksum offloads of the port, software otherwise */
+	up_csum_port_conf(port, &dev_info, port_conf, &txconf);
 
 	/* Configure the Ethernet device. */
-	retval = rte_eth_dev_configure(port, rx_rings, tx_rings, &port_conf);
+	retval = rte_eth_dev_configure(port, rx_rings, tx_rings, port_conf);
 	if (retval != 0)
 		return retval;
 
@@ -146,7 +184,7 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	for (q = 0; q < rx_rings; q++) {
 		retval = rte_eth_rx_queue_setup(port, q, RX_NUM_DESC,
 				rte_eth_dev_socket_id(port),
-				NULL, mbuf_pool);
+				NULL, port_queues[port].mbuf_pool);
 		if (retval < 0)
 			return retval;
 	}
@@ -156,11 +194,40 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	for (q = 0; q < tx_rings; q++) {
 		retval = rte_eth_tx_queue_setup(port, q, TX_NUM_DESC,
 				rte_eth_dev_socket_id(port),
-				NULL);
+				&txconf);
 		if (retval < 0)
 			return retval;
 	}
 
+	return 0;
+}
+
+/**
+ * @brief  : Function to Initialize a given port using global settings and with the rx
+ *           buffers coming from the mbuf_pool passed as parameter
+ * @param  : port, port number.
+ * @param  : mbuf_pool, memory pool pointer.
+ * @param  : rx_rings, number of RX queues, one per worker polling the port
+ * @param  : tx_rings, number of TX queues, one per worker sending on the port
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool,
+		uint16_t rx_rings, uint16_t tx_rings)
+{
+	struct rte_eth_conf port_conf = port_conf_default;
+	int retval;
+
+	if ((port >= rte_eth_dev_count()) || (port >= NUM_SPGW_PORTS))
+		return -1;
+
+	port_queues[port].mbuf_pool = mbuf_pool;
+	port_queues[port].rx_rings = rx_rings;
+	port_queues[port].tx_rings = tx_rings;
+
+	retval = port_queues_setup(port, &port_conf);
+	if (retval != 0)
+		return retval;
+
 	/* Allocate ring on UL and DL core to share data between
 	 * Master core and UL/DL */
 	char *ring_name = "UL_MCT_ring";
@@ -169,7 +236,7 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	}
 
 	shared_ring[port] = rte_ring_create(ring_name, SHARED_RING_SIZE,
-			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+			rte_socket_id(), RING_F_SC_DEQ);
 	if (shared_ring[port] == NULL) {
 		printf ("Error in creating shared ring!!!");
 		return -1;
@@ -201,6 +268,39 @@ static inline int port_init(uint8_t port, struct rte_mempool *mbuf_pool)
 	return 0;
 }
 
+int
+dp_port_mtu_set(uint8_t port, uint32_t max_rx_pkt_len)
+{
+	struct rte_eth_conf port_conf = port_conf_default;
+	int retval;
+
+	/* Only the WB/EB ports set up by port_init */
+	if ((port >= NUM_SPGW_PORTS) || !port_queues[port].rx_rings)
+		return -EINVAL;
+
+	/* The workers and the distributor stay off the queues until the
+	 * port is restarted */
+	retval = epc_ports_pause();
+	if (retval != 0)
+		return retval;
+
+	rte_eth_dev_stop(port);
+
+	if (max_rx_pkt_len > ETHER_MAX_LEN)
+		port_conf.rxmode.offloads |= DEV_RX_OFFLOAD_JUMBO_FRAME;
+	else
+		port_conf.rxmode.offloads &= ~DEV_RX_OFFLOAD_JUMBO_FRAME;
+	port_conf.rxmode.max_rx_pkt_len = max_rx_pkt_len;
+
+	/* Same RX/TX queues as at init, every worker queue is set up again */
+	retval = port_queues_setup(port, &port_conf);
+	if (retval == 0)
+		retval = rte_eth_dev_start(port);
+
+	epc_ports_resume();
+	return retval;
+}
+
 void dp_port_init(void)
 {
 	uint8_t port_id;
@@ -215,8 +315,9 @@ void dp_port_init(void)
 	if (nb_ports < 2 || (nb_ports & 1))
 		rte_exit(EXIT_FAILURE, "Error: number of ports must be two\n");
 
-	/* Create S1U mempool to hold the mbufs. */
-	s1u_mempool = rte_pktmbuf_pool_create("S1U_MPOOL", NUM_MBUFS,
+	/* Create S1U mempool to hold the mbufs, sized for all UL RX queues. */
+	s1u_mempool = rte_pktmbuf_pool_create("S1U_MPOOL",
+			(NUM_MBUFS) * epc_app.num_ul_workers,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
@@ -231,8 +332,9 @@ void dp_port_init(void)
 	if (kni_mpool == NULL)
 		rte_exit(EXIT_FAILURE, "Cannot create kni_mpool !!!\n");
 
-	/* Create SGi mempool to hold the mbufs. */
-	sgi_mempool = rte_pktmbuf_pool_create("SGI_MPOOL", NUM_MBUFS,
+	/* Create SGi mempool to hold the mbufs, sized for all DL RX queues. */
+	sgi_mempool = rte_pktmbuf_pool_create("SGI_MPOOL",
+			(NUM_MBUFS) * epc_app.num_dl_workers,
 			MBUF_CACHE_SIZE, 0,
 			RTE_MBUF_DEFAULT_BUF_SIZE,
 			rte_socket_id());
@@ -253,14 +355,14 @@ void dp_port_init(void)
 
 		if (port_id == WB_PORT) {
 			kni_port_params_array[port_id]->lcore_rx =
-				(uint8_t)epc_app.core_ul[S1U_PORT_ID];
+				(uint8_t)epc_app.core_ul[0];
 			kni_port_params_array[port_id]->lcore_tx = (uint8_t)epc_app.core_mct;
 			printf("KNI lcore on port :%u rx :%u tx :%u\n", port_id,
 					kni_port_params_array[port_id]->lcore_rx,
 					kni_port_params_array[port_id]->lcore_tx);
 		} else if (port_id == EB_PORT) {
 			kni_port_params_array[port_id]->lcore_rx =
-				(uint8_t)epc_app.core_dl[SGI_PORT_ID];
+				(uint8_t)epc_app.core_dl[0];
 			kni_port_params_array[port_id]->lcore_tx = (uint8_t)epc_app.core_mct;
 			printf("KNI lcore on port :%u rx :%u tx :%u\n", port_id,
 					kni_port_params_array[port_id]->lcore_rx,
@@ -271,6 +373,7 @@ void dp_port_init(void)
 			kni_port_params_array[port_id]->lcore_k[j] = 0;
 		}
 		kni_port_params_array[port_id]->nb_lcore_k = 0;
+		rte_spinlock_init(&kni_port_params_array[port_id]->ingress_lock);
 
 	}
 
@@ -282,14 +385,21 @@ void dp_port_init(void)
 	/* Initialize KNI subsystem */
 	init_kni();
 
-	/* Initialize WB & EB ports. */
-	if (port_init(WB_PORT, s1u_mempool) != 0)
+	/* Initialize WB & EB ports. UL workers poll WB and send on EB,
+	 * DL workers poll EB and send on WB; with a distributor, it polls the
+	 * single RX queue of both ports. */
+	uint16_t wb_rx_q = (epc_app.core_dist != -1) ? 1 : epc_app.num_ul_workers;
+	uint16_t eb_rx_q = (epc_app.core_dist != -1) ? 1 : epc_app.num_dl_workers;
+
+	if (port_init(WB_PORT, s1u_mempool, wb_rx_q,
+				epc_app.num_dl_workers) != 0)
 		rte_exit(EXIT_FAILURE, LOG_FORMAT"Cannot init WB PORT %" PRIu8 "\n",
 				LOG_VALUE, WB_PORT);
 	/* Alloc kni on interface. */
 	kni_alloc(WB_PORT);
 
-	if (port_init(EB_PORT, sgi_mempool) != 0)
+	if (port_init(EB_PORT, sgi_mempool, eb_rx_q,
+				epc_app.num_ul_workers) != 0)
 		rte_exit(EXIT_FAILURE, LOG_FORMAT"Cannot init EB_PORT %" PRIu8 "\n",
 				LOG_VALUE, EB_PORT);
 	kni_alloc(EB_PORT);
@@ -321,13 +431,9 @@ dp_ddn_init(void)
 		rte_exit(EXIT_FAILURE, "Error in creating notify ring!!!\n");
 	}
 
-	/** Holds a set of rings to be used for downlink data buffering */
-	dl_ring_container = rte_ring_create("RING_CONTAINER", DL_RING_CONTAINER_SIZE,
-			rte_socket_id(),
-			RING_F_SC_DEQ);
-
-	if (dl_ring_container == NULL) {
-		rte_exit(EXIT_FAILURE, "Error in creating dl ring container!!!\n");
+	/** Shared pool of the downlink packets buffered for the idle sessions */
+	if (ddn_buf_init(app.ddn_buf_pool_sz, app.ddn_buf_policy) < 0) {
+		rte_exit(EXIT_FAILURE, "Error in creating DDN buffer pool!!!\n");
 	}
 
 	/** Create mempool for notification to hold pkts mbufs. */
@@ -272,10 +272,6 @@ static int
 kni_change_mtu(uint16_t port_id, unsigned int new_mtu)
 {
 	int ret;
-	uint16_t nb_rxd = NB_RXD;
-	struct rte_eth_conf conf;
-	struct rte_eth_dev_info dev_info;
-	struct rte_eth_rxconf rxq_conf;
 
 	if (port_id >= rte_eth_dev_count()) {
 		clLog(clSystemLog, eCLSeverityCritical,
@@ -286,52 +282,13 @@ kni_change_mtu(uint16_t port_id, unsigned int new_mtu)
 	clLog(clSystemLog, eCLSeverityInfo,
 		LOG_FORMAT"Change MTU of port %d to %u\n", LOG_VALUE, port_id, new_mtu);
 
-	/* Stop specific port */
-	rte_eth_dev_stop(port_id);
-
-	memcpy(&conf, &port_conf_default, sizeof(conf));
-	/* Set new MTU */
-	if (new_mtu > ETHER_MAX_LEN)
-		conf.rxmode.offloads |= DEV_RX_OFFLOAD_JUMBO_FRAME;
-	else
-		conf.rxmode.offloads &= ~DEV_RX_OFFLOAD_JUMBO_FRAME;
-
-	/* mtu + length of header + length of FCS = max pkt length */
-	conf.rxmode.max_rx_pkt_len = new_mtu + KNI_ENET_HEADER_SIZE +
-							KNI_ENET_FCS_SIZE;
-	ret = rte_eth_dev_configure(port_id, 1, 1, &conf);
-	if (ret < 0) {
-		clLog(clSystemLog, eCLSeverityCritical,
-			LOG_FORMAT"Fail to reconfigure port %d\n", LOG_VALUE, port_id);
-		return ret;
-	}
-
-	ret = rte_eth_dev_adjust_nb_rx_tx_desc(port_id, &nb_rxd, NULL);
-	if (ret < 0) {
-		rte_exit(EXIT_FAILURE, LOG_FORMAT"Could not adjust number of descriptors "
-				"for port%u (%d)\n", LOG_VALUE, (unsigned int)port_id,
-				ret);
-	}
-
-	rte_eth_dev_info_get(port_id, &dev_info);
-	rxq_conf = dev_info.default_rxconf;
-	rxq_conf.offloads = conf.rxmode.offloads;
-	struct rte_mempool *mbuf_pool = kni_mpool;
-
-	ret = rte_eth_rx_queue_setup(port_id, 0, nb_rxd,
-		rte_eth_dev_socket_id(port_id), &rxq_conf, mbuf_pool);
-	if (ret < 0) {
-		clLog(clSystemLog, eCLSeverityCritical,
-			LOG_FORMAT"Fail to setup Rx queue of port %d\n",
-			LOG_VALUE, port_id);
-		return ret;
-	}
-
-	/* Restart specific port */
-	ret = rte_eth_dev_start(port_id);
+	/* mtu + length of header + length of FCS = max pkt length. The other
+	 * port lcores are parked during the change */
+	ret = dp_port_mtu_set(port_id, new_mtu + KNI_ENET_HEADER_SIZE +
+			KNI_ENET_FCS_SIZE);
 	if (ret < 0) {
 		clLog(clSystemLog, eCLSeverityCritical,
-			LOG_FORMAT"Fail to restart port %d\n", LOG_VALUE, port_id);
+			LOG_FORMAT"Fail to change MTU of port %d\n", LOG_VALUE, port_id);
 		return ret;
 	}
 
@@ -0,0 +1,520 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_memcpy.h>
+#include <rte_mempool.h>
+
+#include "gtpu.h"
+#include "up_main.h"
+#include "up_csum.h"
+#include "up_ether.h"
+#include "up_li.h"
+#include "up_li_export.h"
+#include "gw_adapter.h"
+#include "pfcp_enum.h"
+
+#define IPV4_PKT_VER			0x45
+
+extern int clSystemLog;
+extern struct rte_ring *li_dl_ring;
+extern struct rte_ring *li_ul_ring;
+
+struct li_stats li_stats[RTE_MAX_LCORE];
+
+/* LI records */
+static struct rte_mempool *li_pool;
+
+/* Indirect mbufs of the clones, no data room */
+static struct rte_mempool *li_clone_pool;
+
+/* Encoded records of the control path events, for the DDF2 */
+static struct rte_ring *li_ev_ring;
+
+/* Exporter state of li_stats_check */
+static uint64_t li_stats_tsc;
+static uint64_t li_stats_drops;
+
+int
+up_li_init(void)
+{
+	/* Room of the LI header in front of the max LI payload */
+	RTE_BUILD_BUG_ON(LI_EXP_REC_SZ < MAX_LI_HDR_SIZE + sizeof(li_header_t));
+
+	li_pool = rte_mempool_create("LI_POOL", LI_POOL_SZ, sizeof(li_data_t),
+			LI_CACHE_SZ, 0, NULL, NULL, NULL, NULL, rte_socket_id(), 0);
+	if (li_pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create LI pool of %u records, Error: %s\n",
+			LOG_VALUE, LI_POOL_SZ, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	li_clone_pool = rte_pktmbuf_pool_create("LI_CLONE_POOL", LI_POOL_SZ,
+			LI_CACHE_SZ, 0, 0, rte_socket_id());
+	if (li_clone_pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create LI clone pool of %u mbufs, "
+			"Error: %s\n", LOG_VALUE, LI_POOL_SZ, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	li_ev_ring = rte_ring_create("LI_EV_RING", LI_EV_RING_SZ,
+			rte_socket_id(), RING_F_SC_DEQ);
+	if (li_ev_ring == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create LI event ring, Error: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	if (li_exp_init() < 0)
+		return -1;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"LI pools of %u records and clones\n", LOG_VALUE,
+		LI_POOL_SZ);
+
+	return 0;
+}
+
+/**
+ * @Brief  : Function to calculate gtpu header length
+ * @param  : pkts, rte_mbuf packet
+ * @return : Returns length of gtpu header length
+ */
+static uint8_t
+calc_gtpu_len(struct rte_mbuf *pkts)
+{
+	uint8_t gtpu_len = 0;
+	uint8_t *pkt_ptr = NULL;
+
+	if (1 == app.gtpu_seqnb_in) {
+		gtpu_len = GPDU_HDR_SIZE_WITH_SEQNB;
+	} else if (2 == app.gtpu_seqnb_in) {
+		gtpu_len = GPDU_HDR_SIZE_WITHOUT_SEQNB;
+	} else {
+		pkt_ptr = (uint8_t *) get_mtogtpu(pkts);
+		gtpu_len = GPDU_HDR_SIZE_DYNAMIC(*pkt_ptr);
+	}
+
+	return gtpu_len;
+}
+
+/**
+ * @Brief  : Function to fillup ethernet information
+ * @param  : intfc, interface name
+ * @param  : dir, packet direction
+ * @param  : *src, source
+ * @param  : *dst, destination
+ * @return : Returns nothing
+ */
+static void
+fill_ether_info(uint8_t intfc, uint8_t dir, int32_t *src, int32_t *dst) {
+	*src = -1;
+	*dst = -1;
+
+	if (WEST_INTFC == intfc) {
+		if (UPLINK_DIRECTION == dir) {
+			*dst = app.wb_port;
+		} else {
+			*src = app.wb_port;
+		}
+	} else if (EAST_INTFC == intfc) {
+		if (UPLINK_DIRECTION == dir) {
+			*src = app.eb_port;
+		} else {
+			*dst = app.eb_port;
+		}
+	}
+
+	clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"intfc(%u) dir(%u) src(%d) dst(%d)\n", LOG_VALUE,
+			intfc, dir, *src, *dst);
+
+	return;
+}
+
+/**
+ * @brief  : Release the clone and the LI record
+ * @param  : data, LI record
+ * @return : Returns nothing
+ */
+static void
+li_data_free(li_data_t *data)
+{
+	if (data->clone != NULL)
+		rte_pktmbuf_free(data->clone);
+	rte_mempool_put(li_pool, data);
+}
+
+int
+li_pkt_copy(struct rte_mbuf *m, const li_config_t *li, uint64_t imsi,
+		uint8_t intfc, uint8_t dir, uint8_t content, uint8_t sgi)
+{
+	void *obj = NULL;
+	const void *snap = NULL;
+	li_data_t *data = NULL;
+	struct li_stats *stats = &li_stats[rte_lcore_id()];
+	struct rte_ring *ring = (DOWNLINK_DIRECTION == dir) ?
+		li_dl_ring : li_ul_ring;
+
+	if (unlikely(rte_mempool_get(li_pool, &obj) < 0)) {
+		stats->pool_fail++;
+		return -1;
+	}
+
+	data = obj;
+	data->id = li->id;
+	data->imsi = imsi;
+	data->forward = li->forward;
+	data->intfc = intfc;
+	data->dir = dir;
+	data->content = content;
+	data->sgi = sgi;
+	data->gtpu_len = 0;
+	data->clone = NULL;
+	data->pkt_len = rte_pktmbuf_pkt_len(m);
+	data->snap_len = RTE_MIN(data->pkt_len, (uint32_t)LI_HDR_SNAP_SZ);
+
+	/* Headers are rewritten in place after the interception */
+	snap = rte_pktmbuf_read(m, 0, data->snap_len, data->snap);
+	if (snap != data->snap)
+		rte_memcpy(data->snap, snap, data->snap_len);
+
+	/* The copy is not sent, set the checksums left to the NIC */
+	up_csum_copy_fill(m, data->snap, data->snap_len);
+
+	if (!sgi && (COPY_HEADER_DATA_ONLY != content))
+		data->gtpu_len = calc_gtpu_len(m);
+
+	/* Payload past the snapshot is shared with the packet */
+	if ((COPY_HEADER_ONLY != content) && (data->pkt_len > data->snap_len)) {
+		data->clone = rte_pktmbuf_clone(m, li_clone_pool);
+		if (unlikely(data->clone == NULL)) {
+			stats->clone_fail++;
+			rte_mempool_put(li_pool, data);
+			return -1;
+		}
+	}
+
+	if (unlikely(rte_ring_enqueue(ring, data) < 0)) {
+		stats->ring_full++;
+		li_data_free(data);
+		return -1;
+	}
+
+	stats->queued++;
+	return 0;
+}
+
+/**
+ * @brief  : Copy bytes of the intercepted packet, out of the snapshot and
+ *           the clone
+ * @param  : data, LI record
+ * @param  : off, offset of the first byte in the packet
+ * @param  : len, number of bytes
+ * @param  : dst, destination buffer
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+li_data_read(const li_data_t *data, uint32_t off, uint32_t len, uint8_t *dst)
+{
+	uint32_t cnt = 0;
+	const void *src = NULL;
+
+	if (off + len > data->pkt_len)
+		return -1;
+
+	if (off < data->snap_len) {
+		cnt = RTE_MIN(len, data->snap_len - off);
+		rte_memcpy(dst, &data->snap[off], cnt);
+		off += cnt;
+		dst += cnt;
+		len -= cnt;
+	}
+
+	if (len == 0)
+		return 0;
+
+	if (data->clone == NULL)
+		return -1;
+
+	src = rte_pktmbuf_read(data->clone, off, len, dst);
+	if (src == NULL)
+		return -1;
+	if (src != dst)
+		rte_memcpy(dst, src, len);
+
+	return 0;
+}
+
+/**
+ * @brief  : Build the LI packet as per the LI content configuration
+ * @param  : data, LI record
+ * @param  : buf, LI packet buffer
+ * @return : Returns LI packet length, -1 if the packet is too short
+ */
+static int
+li_data_build(const li_data_t *data, uint8_t *buf)
+{
+	uint32_t off = 0;
+	uint32_t len = 0;
+	uint32_t ip_len = 0;
+	int32_t src_ether = -1;
+	int32_t dst_ether = -1;
+	struct udp_hdr *udp_ptr = NULL;
+	struct ipv4_hdr *ipv4_ptr = NULL;
+	struct ipv6_hdr *ipv6_ptr = NULL;
+	struct ether_hdr *eth_ptr = NULL;
+	uint8_t ipv4 = (data->snap_len > ETH_HDR_SIZE) &&
+		(IPV4_PKT_VER == data->snap[ETH_HDR_SIZE]);
+
+	ip_len = ipv4 ? IPv4_HDR_SIZE : IPv6_HDR_SIZE;
+
+	switch (data->content) {
+	case COPY_HEADER_ONLY:
+		len = ETH_HDR_SIZE + ip_len + UDP_HDR_SIZE + data->gtpu_len;
+		break;
+
+	case COPY_DATA_ONLY:
+		/*
+		 * Skip as many bytes as the outer headers past the ethernet
+		 * header, the ethernet header is then rebuilt over the tail of
+		 * the outer headers; SGi packets are copied as is
+		 */
+		if (!data->sgi)
+			off = ip_len + UDP_HDR_SIZE + data->gtpu_len;
+		if (off >= data->pkt_len)
+			return -1;
+		len = data->pkt_len - off;
+		break;
+
+	default:
+		len = data->pkt_len;
+		break;
+	}
+
+	/* Max payload of the LI header encoding */
+	len = RTE_MIN(len, (uint32_t)MAX_LI_HDR_SIZE);
+
+	if (li_data_read(data, off, len, buf) < 0)
+		return -1;
+
+	if (COPY_HEADER_ONLY == data->content) {
+		udp_ptr = (struct udp_hdr *)&buf[ETH_HDR_SIZE + ip_len];
+		udp_ptr->dgram_len = htons(UDP_HDR_SIZE + data->gtpu_len);
+
+		if (ipv4) {
+			ipv4_ptr = (struct ipv4_hdr *)&buf[ETH_HDR_SIZE];
+			ipv4_ptr->total_length = htons(IPv4_HDR_SIZE + UDP_HDR_SIZE +
+					data->gtpu_len);
+		} else {
+			ipv6_ptr = (struct ipv6_hdr *)&buf[ETH_HDR_SIZE];
+			ipv6_ptr->payload_len = htons(UDP_HDR_SIZE + data->gtpu_len);
+		}
+	} else if ((COPY_DATA_ONLY == data->content) && !data->sgi) {
+		/* Update ether header with available mac address */
+		eth_ptr = (struct ether_hdr *)&buf[0];
+
+		memset(eth_ptr, 0, sizeof(struct ether_hdr));
+		eth_ptr->ether_type = htons(ipv4 ? ETH_TYPE_IPv4 : ETH_TYPE_IPv6);
+
+		fill_ether_info(data->intfc, data->dir, &src_ether, &dst_ether);
+
+		if (-1 != src_ether) {
+			ether_addr_copy(&ports_eth_addr[src_ether],
+				&eth_ptr->s_addr);
+		}
+
+		if (-1 != dst_ether) {
+			ether_addr_copy(&ports_eth_addr[dst_ether],
+				&eth_ptr->d_addr);
+		}
+	}
+
+	return len;
+}
+
+uint32_t
+li_export(struct rte_ring *r, uint8_t tgt)
+{
+	int size = 0;
+	uint32_t i = 0;
+	uint32_t n = 0;
+	uint32_t cnt = 0;
+	struct ip_addr dummy = {0};
+	struct li_exp_rec *rec = NULL;
+	li_data_t *data[LI_EXPORT_BURST];
+	struct li_stats *stats = &li_stats[rte_lcore_id()];
+	/* Copies left in the ring while the target queue is full */
+	uint32_t max = RTE_MIN(rte_ring_count(r), li_exp_room(tgt));
+
+	while (cnt < max) {
+		n = rte_ring_sc_dequeue_burst(r, (void **)data,
+				RTE_MIN((uint32_t)LI_EXPORT_BURST, max - cnt), NULL);
+		if (n == 0)
+			break;
+
+		for (i = 0; i < n; i++) {
+			rec = li_exp_rec_alloc();
+			if (rec == NULL) {
+				stats->exp_fail++;
+				li_data_free(data[i]);
+				continue;
+			}
+
+			size = li_data_build(data[i], rec->data);
+			if (size > 0) {
+				create_li_header(rec->data, &size, CC_BASED, data[i]->id,
+						data[i]->imsi, dummy, dummy, 0, 0,
+						data[i]->forward);
+				rec->len = size;
+				li_exp_enqueue(tgt, rec);
+			} else {
+				li_exp_rec_free(rec);
+			}
+
+			/* Releases the packet data held by the clone */
+			li_data_free(data[i]);
+		}
+
+		cnt += n;
+	}
+
+	return cnt;
+}
+
+int
+li_event_enqueue(struct li_exp_rec *rec)
+{
+	if (rte_ring_enqueue(li_ev_ring, rec) < 0) {
+		li_stats[rte_lcore_id()].ring_full++;
+		li_exp_rec_free(rec);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Move the control path events to the DDF2 queue, exporter
+ * @param  : No param
+ * @return : Returns number of events moved
+ */
+static uint32_t
+li_event_export(void)
+{
+	uint32_t i = 0;
+	uint32_t n = 0;
+	struct li_exp_rec *rec[LI_EXPORT_BURST];
+
+	n = rte_ring_sc_dequeue_burst(li_ev_ring, (void **)rec,
+			RTE_MIN((uint32_t)LI_EXPORT_BURST, li_exp_room(LI_EXP_DDF2)),
+			NULL);
+	for (i = 0; i < n; i++)
+		li_exp_enqueue(LI_EXP_DDF2, rec[i]);
+
+	return n;
+}
+
+void
+li_process(void)
+{
+	li_export(li_ul_ring, LI_EXP_DDF3);
+	li_export(li_dl_ring, LI_EXP_DDF3);
+	li_event_export();
+
+	li_exp_flush(LI_EXP_DDF2);
+	li_exp_flush(LI_EXP_DDF3);
+
+	li_stats_check();
+	li_exp_stats_log();
+}
+
+void
+li_stats_check(void)
+{
+	uint32_t lcore = 0;
+	uint64_t drops = 0;
+	struct li_stats sum = {0};
+	uint64_t tsc = rte_rdtsc();
+
+	if (tsc < li_stats_tsc)
+		return;
+	li_stats_tsc = tsc + rte_get_tsc_hz() * LI_STATS_SEC;
+
+	for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+		sum.queued += li_stats[lcore].queued;
+		sum.pool_fail += li_stats[lcore].pool_fail;
+		sum.clone_fail += li_stats[lcore].clone_fail;
+		sum.ring_full += li_stats[lcore].ring_full;
+		sum.exp_fail += li_stats[lcore].exp_fail;
+	}
+
+	drops = sum.pool_fail + sum.clone_fail + sum.ring_full + sum.exp_fail;
+	if (drops == li_stats_drops)
+		return;
+	li_stats_drops = drops;
+
+	clLog(clSystemLog, eCLSeverityMinor,
+		LOG_FORMAT"LI copies queued %lu, dropped %lu: no record %lu, "
+		"no clone %lu, ring full %lu, no export record %lu\n", LOG_VALUE,
+		sum.queued, drops, sum.pool_fail, sum.clone_fail, sum.ring_full,
+		sum.exp_fail);
+}
+
+int8_t
+li_export_stats_get(li_export_stats_t *stats)
+{
+	uint8_t tgt = 0;
+	const char *name = NULL;
+	struct li_exp_stats cur;
+	li_export_target_stats_t *ts = NULL;
+
+	RTE_BUILD_BUG_ON(LI_EXP_STATS_TARGETS != LI_EXP_TARGETS);
+
+	if (stats == NULL)
+		return -1;
+
+	memset(stats, 0, sizeof(*stats));
+
+	for (tgt = 0; tgt < LI_EXP_TARGETS; tgt++) {
+		name = li_exp_target_name(tgt);
+		if (name == NULL)
+			continue;
+
+		li_exp_stats_get(tgt, &cur);
+		ts = &stats->target[tgt];
+		strncpy(ts->name, name, LI_EXP_STATS_NAME_LEN - 1);
+		ts->configured = 1;
+		ts->state = cur.state;
+		ts->records = cur.records;
+		ts->bytes = cur.bytes;
+		ts->acked = cur.acked;
+		ts->writes = cur.writes;
+		ts->partial = cur.partial;
+		ts->connects = cur.connects;
+		ts->disconnects = cur.disconnects;
+		ts->backlog = cur.backlog;
+		ts->unacked = cur.unacked;
+	}
+
+	return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_LI_H_
+#define _UP_LI_H_
+/**
+ * @file
+ * This file contains the user level packet copying of the intercepted
+ * packets (LI).
+ *
+ * A worker does not copy the intercepted packet: it takes a LI record from
+ * the LI pool, snapshots the outer headers into it and attaches a clone of
+ * the packet, an indirect mbuf sharing the packet data by reference count.
+ * The headers are snapshotted because the worker rewrites them in place
+ * after the interception (next hop, encap); the payload is never written.
+ * A header only copy takes no clone.
+ *
+ * The records are queued on li_ul_ring/li_dl_ring and the exporter builds
+ * the LI packet out of the snapshot and the clone into an export record of
+ * the DDF3 target, then frees the clone, which releases the packet data.
+ * The control path events are encoded by the iface core and queued on the
+ * event ring of the DDF2 target. The exporter runs on the LI lcore when one
+ * is configured, on the mct core otherwise. Pool, clone and ring failures
+ * drop the copy and are counted per lcore, the exporter logs them.
+ */
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+
+#include "gw_structs.h"
+#include "pfcp_up_struct.h"
+#include "up_li_export.h"
+
+/* Number of LI records and clones, i.e. max number of queued copies; a
+ * clone holds the packet data out of the RX pool until it is exported */
+#define LI_POOL_SZ		(1 << 13)
+
+/* Per lcore cache of the LI pools */
+#define LI_CACHE_SZ		128
+
+/* Outer header bytes snapshotted by the worker */
+#define LI_HDR_SNAP_SZ		128
+
+/* Size of the event ring of the DDF2 */
+#define LI_EV_RING_SZ		1024
+
+/* Max number of records exported per ring and burst */
+#define LI_EXPORT_BURST		32
+
+/* Period of the drop counters check of the exporter, in seconds */
+#define LI_STATS_SEC		10
+
+/**
+ * @brief  : Intercepted packet, queued to the exporter
+ */
+typedef struct li_data_ring {
+	uint64_t id;
+	uint64_t imsi;
+	uint8_t forward;
+	/* WEST_INTFC or EAST_INTFC */
+	uint8_t intfc;
+	/* UPLINK_DIRECTION or DOWNLINK_DIRECTION */
+	uint8_t dir;
+	/* COPY_HEADER_ONLY, COPY_HEADER_DATA_ONLY or COPY_DATA_ONLY */
+	uint8_t content;
+	/* Set for the SGi packets, not GTPU encapsulated */
+	uint8_t sgi;
+	/* GTPU header length of the encapsulated packets */
+	uint8_t gtpu_len;
+	/* Bytes in snap */
+	uint16_t snap_len;
+	/* Length of the intercepted packet */
+	uint32_t pkt_len;
+	/* Clone of the packet, NULL for a header only copy */
+	struct rte_mbuf *clone;
+	/* First bytes of the packet at the interception */
+	uint8_t snap[LI_HDR_SNAP_SZ];
+} li_data_t;
+
+/**
+ * @brief  : LI drop counters of an lcore
+ */
+struct li_stats {
+	/* Copies queued to the exporter */
+	uint64_t queued;
+	/* No LI record left */
+	uint64_t pool_fail;
+	/* No clone left */
+	uint64_t clone_fail;
+	/* LI or event ring full */
+	uint64_t ring_full;
+	/* No export record left, exporter */
+	uint64_t exp_fail;
+} __rte_cache_aligned;
+
+extern struct li_stats li_stats[RTE_MAX_LCORE];
+
+/**
+ * @brief  : Create the LI record and clone pools, the event ring and the
+ *           export record pool
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_li_init(void);
+
+/**
+ * @brief  : Queue a copy of the intercepted packet to the exporter, worker
+ * @param  : m, intercepted packet, not consumed
+ * @param  : li, LI configuration of the target
+ * @param  : imsi, IMSI of the target
+ * @param  : intfc, WEST_INTFC or EAST_INTFC
+ * @param  : dir, UPLINK_DIRECTION or DOWNLINK_DIRECTION
+ * @param  : content, packet content to copy
+ * @param  : sgi, set for the SGi packets
+ * @return : Returns 0 if the copy was queued, -1 if it was dropped
+ */
+int
+li_pkt_copy(struct rte_mbuf *m, const li_config_t *li, uint64_t imsi,
+		uint8_t intfc, uint8_t dir, uint8_t content, uint8_t sgi);
+
+/**
+ * @brief  : Build the queued copies into records of the target, as many as
+ *           the target queue takes, exporter
+ * @param  : r, li_ul_ring or li_dl_ring
+ * @param  : tgt, export target
+ * @return : Returns number of copies handled
+ */
+uint32_t
+li_export(struct rte_ring *r, uint8_t tgt);
+
+/**
+ * @brief  : Queue an encoded control path event for the DDF2
+ * @param  : rec, export record, always consumed
+ * @return : Returns 0 in case of success , -1 if the ring is full
+ */
+int
+li_event_enqueue(struct li_exp_rec *rec);
+
+/**
+ * @brief  : One exporter pass: move the copies and the events to the
+ *           targets, write the targets and check the counters
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+li_process(void);
+
+/**
+ * @brief  : Log the LI drops of all the lcores when they changed, once per
+ *           LI_STATS_SEC, exporter
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+li_stats_check(void);
+
+/**
+ * @brief  : Read the counters of the LI export targets, REST callback; the
+ *           counters of the exporter are read without lock
+ * @param  : stats, counters per target
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+li_export_stats_get(li_export_stats_t *stats);
+
+#endif /* _UP_LI_H_ */
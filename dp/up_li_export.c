@@ -0,0 +1,546 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+
+#include "up_li_export.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/* Max length of a target address */
+#define LI_EXP_ADDR_LEN		64
+
+/**
+ * @brief  : DDF connection and queue
+ */
+struct li_exp_target {
+	char name[16];
+	char ip[LI_EXP_ADDR_LEN];
+	char local_ip[LI_EXP_ADDR_LEN];
+	uint16_t port;
+	uint8_t configured;
+	int fd;
+	/* TSC of the next connection attempt */
+	uint64_t retry_tsc;
+	/*
+	 * Records, oldest first; indexes are free running. head is the first
+	 * record not acknowledged, sent the first record not fully written.
+	 */
+	struct li_exp_rec *queue[LI_EXP_QUEUE_SZ];
+	uint32_t head;
+	uint32_t sent;
+	uint32_t tail;
+	/* Bytes of the sent record already written */
+	uint32_t off;
+	/* Acknowledgement partly read */
+	uint8_t ack[LI_EXP_ACK_LEN];
+	uint8_t ack_len;
+	struct li_exp_stats stats;
+	/* Counters at the last log */
+	struct li_exp_stats last;
+};
+
+static struct li_exp_target li_exp_tgt[LI_EXP_TARGETS];
+
+static struct rte_mempool *li_exp_pool;
+
+/* TSC of the next counters log */
+static uint64_t li_exp_stats_tsc;
+
+int
+li_exp_init(void)
+{
+	uint8_t tgt = 0;
+
+	li_exp_pool = rte_mempool_create("LI_EXP_POOL", LI_EXP_POOL_SZ,
+			sizeof(struct li_exp_rec), LI_EXP_CACHE_SZ, 0, NULL, NULL,
+			NULL, NULL, rte_socket_id(), 0);
+	if (li_exp_pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create LI export pool of %u records, "
+			"Error: %s\n", LOG_VALUE, LI_EXP_POOL_SZ,
+			rte_strerror(rte_errno));
+		return -1;
+	}
+
+	for (tgt = 0; tgt < LI_EXP_TARGETS; tgt++)
+		li_exp_tgt[tgt].fd = -1;
+
+	return 0;
+}
+
+int
+li_exp_target_init(uint8_t tgt, const char *name, const char *ip,
+		uint16_t port, const char *local_ip)
+{
+	struct li_exp_target *t = NULL;
+
+	if (tgt >= LI_EXP_TARGETS || ip == NULL || ip[0] == '\0' || port == 0)
+		return -1;
+
+	t = &li_exp_tgt[tgt];
+	snprintf(t->name, sizeof(t->name), "%s", name);
+	snprintf(t->ip, sizeof(t->ip), "%s", ip);
+	snprintf(t->local_ip, sizeof(t->local_ip), "%s",
+			(local_ip != NULL) ? local_ip : "");
+	t->port = port;
+	t->fd = -1;
+	t->retry_tsc = 0;
+	t->stats.state = LI_EXP_DOWN;
+	t->configured = 1;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"LI export to %s at %s port %u, local %s\n", LOG_VALUE,
+		t->name, t->ip, t->port, t->local_ip[0] ? t->local_ip : "any");
+
+	return 0;
+}
+
+struct li_exp_rec *
+li_exp_rec_alloc(void)
+{
+	void *obj = NULL;
+
+	if (rte_mempool_get(li_exp_pool, &obj) < 0)
+		return NULL;
+
+	return obj;
+}
+
+void
+li_exp_rec_free(struct li_exp_rec *rec)
+{
+	rte_mempool_put(li_exp_pool, rec);
+}
+
+uint32_t
+li_exp_room(uint8_t tgt)
+{
+	struct li_exp_target *t = &li_exp_tgt[tgt];
+
+	return LI_EXP_QUEUE_SZ - (t->tail - t->head);
+}
+
+int
+li_exp_enqueue(uint8_t tgt, struct li_exp_rec *rec)
+{
+	struct li_exp_target *t = &li_exp_tgt[tgt];
+
+	if (t->tail - t->head >= LI_EXP_QUEUE_SZ)
+		return -1;
+
+	t->queue[t->tail++ & LI_EXP_QUEUE_MASK] = rec;
+	return 0;
+}
+
+/**
+ * @brief  : Fill a socket address
+ * @param  : ip, IPv4 or IPv6 address
+ * @param  : port, port, host order
+ * @param  : addr, address to be filled
+ * @param  : len, address length
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+li_exp_addr(const char *ip, uint16_t port, struct sockaddr_storage *addr,
+		socklen_t *len)
+{
+	struct sockaddr_in *in4 = (struct sockaddr_in *)addr;
+	struct sockaddr_in6 *in6 = (struct sockaddr_in6 *)addr;
+
+	memset(addr, 0, sizeof(*addr));
+
+	if (inet_pton(AF_INET, ip, &in4->sin_addr) == 1) {
+		in4->sin_family = AF_INET;
+		in4->sin_port = htons(port);
+		*len = sizeof(*in4);
+		return 0;
+	}
+
+	if (inet_pton(AF_INET6, ip, &in6->sin6_addr) == 1) {
+		in6->sin6_family = AF_INET6;
+		in6->sin6_port = htons(port);
+		*len = sizeof(*in6);
+		return 0;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief  : Close the connection, the records not acknowledged are
+ *           written again on the next connection
+ * @param  : t, target
+ * @param  : err, errno of the failure, 0 on a close by the peer
+ * @return : Returns nothing
+ */
+static void
+li_exp_disconnect(struct li_exp_target *t, int err)
+{
+	if (t->stats.state == LI_EXP_UP) {
+		t->stats.disconnects++;
+		clLog(clSystemLog, eCLSeverityMajor,
+			LOG_FORMAT"LI export connection to %s lost: %s, %u records "
+			"kept\n", LOG_VALUE, t->name,
+			err ? strerror(err) : "closed by peer", t->tail - t->head);
+	} else {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"LI export connection to %s failed: %s\n", LOG_VALUE,
+			t->name, err ? strerror(err) : "closed by peer");
+	}
+
+	if (t->fd >= 0)
+		close(t->fd);
+	t->fd = -1;
+	/* Not acknowledged, written again on the next connection */
+	t->sent = t->head;
+	t->off = 0;
+	t->ack_len = 0;
+	t->stats.state = LI_EXP_DOWN;
+	t->retry_tsc = rte_rdtsc() + (rte_get_tsc_hz() * LI_EXP_RETRY_MS) / 1000;
+}
+
+/**
+ * @brief  : Start a non-blocking connection to the target
+ * @param  : t, target
+ * @return : Returns nothing
+ */
+static void
+li_exp_connect(struct li_exp_target *t)
+{
+	int one = 1;
+	socklen_t len = 0;
+	socklen_t local_len = 0;
+	struct sockaddr_storage addr;
+	struct sockaddr_storage local;
+
+	if (li_exp_addr(t->ip, t->port, &addr, &len) < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Invalid %s address %s\n", LOG_VALUE, t->name, t->ip);
+		t->configured = 0;
+		return;
+	}
+
+	t->fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (t->fd < 0) {
+		li_exp_disconnect(t, errno);
+		return;
+	}
+
+	/* Records are already batched */
+	setsockopt(t->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	if ((t->local_ip[0] != '\0') &&
+			(li_exp_addr(t->local_ip, 0, &local, &local_len) == 0) &&
+			(local.ss_family == addr.ss_family) &&
+			(bind(t->fd, (struct sockaddr *)&local, local_len) < 0)) {
+		clLog(clSystemLog, eCLSeverityMinor,
+			LOG_FORMAT"Failed to bind %s local address %s: %s\n",
+			LOG_VALUE, t->name, t->local_ip, strerror(errno));
+	}
+
+	if ((connect(t->fd, (struct sockaddr *)&addr, len) < 0) &&
+			(errno != EINPROGRESS)) {
+		li_exp_disconnect(t, errno);
+		return;
+	}
+
+	t->stats.state = LI_EXP_CONNECTING;
+}
+
+/**
+ * @brief  : Check the pending connection
+ * @param  : t, target
+ * @return : Returns nothing
+ */
+static void
+li_exp_connected(struct li_exp_target *t)
+{
+	int err = 0;
+	socklen_t len = sizeof(err);
+	struct pollfd pfd = { .fd = t->fd, .events = POLLOUT };
+
+	if (poll(&pfd, 1, 0) <= 0)
+		return;
+
+	if ((getsockopt(t->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0) ||
+			(err != 0)) {
+		li_exp_disconnect(t, err ? err : errno);
+		return;
+	}
+
+	t->stats.state = LI_EXP_UP;
+	t->stats.connects++;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"LI export connected to %s, %u records queued\n",
+		LOG_VALUE, t->name, t->tail - t->head);
+}
+
+/**
+ * @brief  : Release the head record on its acknowledgement
+ * @param  : t, target
+ * @return : Returns nothing
+ */
+static void
+li_exp_ack(struct li_exp_target *t)
+{
+	struct li_exp_rec *rec = NULL;
+
+	if ((t->ack[0] != LI_EXP_ACK_LEN) || (t->ack[1] != LI_EXP_ACK_TYPE)) {
+		clLog(clSystemLog, eCLSeverityMinor,
+			LOG_FORMAT"Unexpected packet type %u from %s\n", LOG_VALUE,
+			t->ack[1], t->name);
+		return;
+	}
+
+	if (t->head == t->sent)
+		return;
+
+	rec = t->queue[t->head & LI_EXP_QUEUE_MASK];
+	if (memcmp(&t->ack[2], &rec->data[LI_EXP_SEQ_OFF], sizeof(uint32_t))) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Acknowledgement of %s out of sequence\n",
+			LOG_VALUE, t->name);
+	}
+
+	/* Acknowledged in order, over a single connection */
+	t->head++;
+	li_exp_rec_free(rec);
+	t->stats.acked++;
+}
+
+/**
+ * @brief  : Read the DDF acknowledgements, detect the close
+ * @param  : t, target
+ * @return : Returns 0 if the connection is up, -1 otherwise
+ */
+static int
+li_exp_recv(struct li_exp_target *t)
+{
+	ssize_t i = 0;
+	ssize_t ret = 0;
+	uint8_t buf[LI_EXP_ACK_LEN * 64];
+
+	while (1) {
+		ret = recv(t->fd, buf, sizeof(buf), MSG_DONTWAIT);
+		if (ret == 0) {
+			li_exp_disconnect(t, 0);
+			return -1;
+		}
+
+		if (ret < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				return 0;
+			li_exp_disconnect(t, errno);
+			return -1;
+		}
+
+		for (i = 0; i < ret; i++) {
+			t->ack[t->ack_len++] = buf[i];
+			if (t->ack_len == LI_EXP_ACK_LEN) {
+				li_exp_ack(t);
+				t->ack_len = 0;
+			}
+		}
+	}
+}
+
+uint32_t
+li_exp_flush(uint8_t tgt)
+{
+	ssize_t ret = 0;
+	uint32_t cnt = 0;
+	uint32_t iov_cnt = 0;
+	uint32_t idx = 0;
+	struct msghdr msg = {0};
+	struct li_exp_rec *rec = NULL;
+	struct iovec iov[LI_EXP_IOV_MAX];
+	struct li_exp_target *t = &li_exp_tgt[tgt];
+
+	/* No DDF, nothing is kept */
+	if (!t->configured) {
+		while (t->head != t->tail)
+			li_exp_rec_free(t->queue[t->head++ & LI_EXP_QUEUE_MASK]);
+		t->sent = t->head;
+		return 0;
+	}
+
+	switch (t->stats.state) {
+	case LI_EXP_DOWN:
+		if (rte_rdtsc() < t->retry_tsc)
+			return 0;
+		li_exp_connect(t);
+		if (t->stats.state != LI_EXP_CONNECTING)
+			return 0;
+		/* Fall through */
+	case LI_EXP_CONNECTING:
+		li_exp_connected(t);
+		if (t->stats.state != LI_EXP_UP)
+			return 0;
+		break;
+	default:
+		break;
+	}
+
+	if (li_exp_recv(t) < 0)
+		return 0;
+
+	while (t->sent != t->tail) {
+		/* Sent record from where the last write stopped */
+		for (iov_cnt = 0, idx = t->sent;
+				(idx != t->tail) && (iov_cnt < LI_EXP_IOV_MAX);
+				idx++, iov_cnt++) {
+			rec = t->queue[idx & LI_EXP_QUEUE_MASK];
+			iov[iov_cnt].iov_base = rec->data;
+			iov[iov_cnt].iov_len = rec->len;
+		}
+		iov[0].iov_base = (uint8_t *)iov[0].iov_base + t->off;
+		iov[0].iov_len -= t->off;
+
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iov_cnt;
+
+		ret = sendmsg(t->fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (ret < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				li_exp_disconnect(t, errno);
+			break;
+		}
+
+		t->stats.writes++;
+		t->stats.bytes += ret;
+
+		/* Records are released on their acknowledgement */
+		while ((ret > 0) && (t->sent != t->tail)) {
+			rec = t->queue[t->sent & LI_EXP_QUEUE_MASK];
+			if ((size_t)ret < rec->len - t->off) {
+				t->off += ret;
+				t->stats.partial++;
+				break;
+			}
+
+			ret -= rec->len - t->off;
+			t->off = 0;
+			t->sent++;
+			t->stats.records++;
+			cnt++;
+		}
+
+		/* Socket buffer full */
+		if (t->off != 0)
+			break;
+	}
+
+	return cnt;
+}
+
+void
+li_exp_stats_get(uint8_t tgt, struct li_exp_stats *stats)
+{
+	struct li_exp_target *t = &li_exp_tgt[tgt];
+
+	*stats = t->stats;
+	stats->backlog = t->tail - t->head;
+	stats->unacked = t->sent - t->head;
+}
+
+const char *
+li_exp_target_name(uint8_t tgt)
+{
+	if ((tgt >= LI_EXP_TARGETS) || !li_exp_tgt[tgt].configured)
+		return NULL;
+
+	return li_exp_tgt[tgt].name;
+}
+
+void
+li_exp_stats_log(void)
+{
+	uint8_t tgt = 0;
+	uint64_t tsc = rte_rdtsc();
+	struct li_exp_stats cur;
+	struct li_exp_target *t = NULL;
+	static const char * const state[] = { "down", "connecting", "up" };
+
+	if (tsc < li_exp_stats_tsc)
+		return;
+	li_exp_stats_tsc = tsc + rte_get_tsc_hz() * LI_EXP_STATS_SEC;
+
+	for (tgt = 0; tgt < LI_EXP_TARGETS; tgt++) {
+		t = &li_exp_tgt[tgt];
+		if (!t->configured)
+			continue;
+
+		li_exp_stats_get(tgt, &cur);
+		if ((cur.records == t->last.records) && (cur.backlog == 0))
+			continue;
+
+		clLog(clSystemLog, eCLSeverityInfo,
+			LOG_FORMAT"LI export %s %s: %lu records/s, %lu bytes/s, "
+			"%lu records per write, %lu partial writes, %lu acked, "
+			"backlog %u, unacked %u, %lu disconnects\n", LOG_VALUE,
+			t->name, state[cur.state],
+			(cur.records - t->last.records) / LI_EXP_STATS_SEC,
+			(cur.bytes - t->last.bytes) / LI_EXP_STATS_SEC,
+			(cur.writes > t->last.writes) ?
+			(cur.records - t->last.records) / (cur.writes - t->last.writes) : 0,
+			cur.partial - t->last.partial, cur.acked - t->last.acked,
+			cur.backlog, cur.unacked,
+			cur.disconnects);
+
+		t->last = cur;
+	}
+}
+
+void
+li_exp_close(void)
+{
+	uint8_t tgt = 0;
+	struct li_exp_target *t = NULL;
+
+	for (tgt = 0; tgt < LI_EXP_TARGETS; tgt++) {
+		t = &li_exp_tgt[tgt];
+
+		if (t->fd >= 0)
+			close(t->fd);
+		t->fd = -1;
+		t->stats.state = LI_EXP_DOWN;
+
+		while (t->head != t->tail)
+			li_exp_rec_free(t->queue[t->head++ & LI_EXP_QUEUE_MASK]);
+		t->sent = t->head;
+		t->off = 0;
+	}
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_LI_EXPORT_H_
+#define _UP_LI_EXPORT_H_
+/**
+ * @file
+ * This file contains the LI exporter, the TCP transport of the encoded LI
+ * records to the DDFs.
+ *
+ * Every DDF is a target with its own non-blocking connection and its own
+ * queue of records. As many queued records as the socket takes are written
+ * by one sendmsg, a short write resumes in the middle of the record. The
+ * records are self delimited by the packet length of their LI header, the
+ * byte stream is the one of one write per record.
+ *
+ * The DDF acknowledges every record, in order, with its sequence number; a
+ * record stays queued until it is acknowledged. When the connection is
+ * lost the target reconnects every LI_EXP_RETRY_MS and writes again from
+ * the first record not acknowledged, so nothing queued is lost, a record
+ * may be received twice. A full queue is not an error, the caller leaves
+ * the records where they are until there is room.
+ *
+ * The targets are only used by the exporter, no lock is taken; the record
+ * pool is shared with the producers.
+ */
+#include <stdint.h>
+
+/* Targets */
+#define LI_EXP_DDF2		0
+#define LI_EXP_DDF3		1
+#define LI_EXP_TARGETS		2
+
+/* Max number of records queued per target, power of 2 */
+#define LI_EXP_QUEUE_SZ		1024
+#define LI_EXP_QUEUE_MASK	(LI_EXP_QUEUE_SZ - 1)
+
+/* Number of records of the pool shared by the targets and the producers */
+#define LI_EXP_POOL_SZ		(1 << 12)
+
+/* Per lcore cache of the record pool */
+#define LI_EXP_CACHE_SZ		64
+
+/* Max number of records per sendmsg */
+#define LI_EXP_IOV_MAX		64
+
+/* Room of a record: LI header and max LI payload (MAX_LI_HDR_SIZE) */
+#define LI_EXP_REC_SZ		(2048 + 128)
+
+/* Acknowledgement of the DDF: length, type and sequence number */
+#define LI_EXP_ACK_LEN		6
+#define LI_EXP_ACK_TYPE		0xee
+
+/* Offset of the sequence number in the encoded LI header */
+#define LI_EXP_SEQ_OFF		68
+
+/* Reconnection period, in msec */
+#define LI_EXP_RETRY_MS		1000
+
+/* Period of the target counters log, in seconds */
+#define LI_EXP_STATS_SEC	10
+
+/* Target connection state */
+#define LI_EXP_DOWN		0
+#define LI_EXP_CONNECTING	1
+#define LI_EXP_UP		2
+
+/**
+ * @brief  : Encoded LI record
+ */
+struct li_exp_rec {
+	uint32_t len;
+	uint8_t data[LI_EXP_REC_SZ];
+};
+
+/**
+ * @brief  : Counters of a target
+ */
+struct li_exp_stats {
+	/* Records and bytes fully written, written again after a
+	 * reconnection included */
+	uint64_t records;
+	uint64_t bytes;
+	/* Records acknowledged, i.e. released */
+	uint64_t acked;
+	/* sendmsg calls, and the ones that left a record partly written */
+	uint64_t writes;
+	uint64_t partial;
+	/* Connections established and lost */
+	uint64_t connects;
+	uint64_t disconnects;
+	/* Records queued, not acknowledged yet */
+	uint32_t backlog;
+	/* Records written, not acknowledged yet */
+	uint32_t unacked;
+	/* Connection state */
+	uint8_t state;
+};
+
+/**
+ * @brief  : Create the record pool
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+li_exp_init(void);
+
+/**
+ * @brief  : Configure a target, the connection is opened by li_exp_flush
+ * @param  : tgt, LI_EXP_DDF2 or LI_EXP_DDF3
+ * @param  : name, target name in the logs
+ * @param  : ip, DDF IPv4 or IPv6 address
+ * @param  : port, DDF port
+ * @param  : local_ip, local address, empty for any
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+li_exp_target_init(uint8_t tgt, const char *name, const char *ip,
+		uint16_t port, const char *local_ip);
+
+/**
+ * @brief  : Take a record from the pool, any lcore
+ * @param  : No param
+ * @return : Returns record, NULL if the pool is empty
+ */
+struct li_exp_rec *
+li_exp_rec_alloc(void);
+
+/**
+ * @brief  : Return a record to the pool, any lcore
+ * @param  : rec, record
+ * @return : Returns nothing
+ */
+void
+li_exp_rec_free(struct li_exp_rec *rec);
+
+/**
+ * @brief  : Number of records the target queue can take
+ * @param  : tgt, target
+ * @return : Returns free room of the queue
+ */
+uint32_t
+li_exp_room(uint8_t tgt);
+
+/**
+ * @brief  : Queue a record on the target, the record is owned by the
+ *           target on success
+ * @param  : tgt, target
+ * @param  : rec, record
+ * @return : Returns 0 in case of success , -1 if the queue is full
+ */
+int
+li_exp_enqueue(uint8_t tgt, struct li_exp_rec *rec);
+
+/**
+ * @brief  : Handle the connection of the target, read the
+ *           acknowledgements and write the queue
+ * @param  : tgt, target
+ * @return : Returns number of records fully written
+ */
+uint32_t
+li_exp_flush(uint8_t tgt);
+
+/**
+ * @brief  : Read the counters of a target
+ * @param  : tgt, target
+ * @param  : stats, counters to be filled
+ * @return : Returns nothing
+ */
+void
+li_exp_stats_get(uint8_t tgt, struct li_exp_stats *stats);
+
+/**
+ * @brief  : Name of a target
+ * @param  : tgt, target
+ * @return : Returns name, NULL if the target is not configured
+ */
+const char *
+li_exp_target_name(uint8_t tgt);
+
+/**
+ * @brief  : Log the throughput and the backlog of the targets, once per
+ *           LI_EXP_STATS_SEC
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+li_exp_stats_log(void);
+
+/**
+ * @brief  : Close the target connections, the queued records are freed
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+li_exp_close(void);
+
+#endif /* _UP_LI_EXPORT_H_ */
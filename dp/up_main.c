@@ -26,10 +26,19 @@
 #include <rte_mbuf.h>
 #include <rte_branch_prediction.h>
 
-#include "li_interface.h"
 #include "gw_adapter.h"
 
 #include "up_main.h"
+#include "up_rcu.h"
+#include "up_acl.h"
+#include "up_adj.h"
+#include "up_urr.h"
+#include "up_clock.h"
+#include "up_twheel.h"
+#include "up_li.h"
+#include "up_li_export.h"
+#include "up_cdr.h"
+#include "up_prof.h"
 #include "pfcp_util.h"
 #include "pfcp_set_ie.h"
 
@@ -39,6 +48,9 @@
 #ifdef USE_CSID
 #include "csid_struct.h"
 #endif /* USE_CSID */
+#ifdef DP_BENCH
+#include "dp_bench.h"
+#endif /* DP_BENCH */
 
 #define UP "USER PLANE"
 #define DP_LOG_PATH "logs/dp.log"
@@ -76,7 +88,8 @@ teidri_info *upf_teidri_blocked_list = NULL;
 static void
 sig_handler(int signo)
 {
-	deinit_ddf();
+	li_exp_close();
+	up_cdr_close();
 
 	RTE_SET_USED(signo);
 	clLog(clSystemLog, eCLSeverityDebug, "UP: Called Signal_handler..\n");
@@ -142,6 +155,9 @@ init_cli_framework(void) {
 	cli_node.cli_config.gw_adapter_callback_list.get_dp_config = &fill_dp_configuration;
 	cli_node.cli_config.gw_adapter_callback_list.get_perf_flag = &get_perf_flag;
 	cli_node.cli_config.gw_adapter_callback_list.update_perf_flag = &update_perf_flag;
+	cli_node.cli_config.gw_adapter_callback_list.update_prof_period = &up_prof_set_period;
+	cli_node.cli_config.gw_adapter_callback_list.get_prof_stats = &up_prof_stats_get;
+	cli_node.cli_config.gw_adapter_callback_list.get_li_export_stats = &li_export_stats_get;
 
 	/* Init rest framework */
 	init_rest_framework(app.cli_rest_ip_buff, app.cli_rest_port);
@@ -160,6 +176,8 @@ int main(int argc, char **argv)
 	read_cfg_file(DP_CFG_PATH);
 
 	init_log_module(LOGGER_JSON_PATH);
+	if (app.log_ring && clLogRingInit(app.log_ring) < 0)
+		fprintf(stderr, "DP: Failed to start the log ring, logging synchronously\n");
 	init_signal_handler();
 
 #ifdef USE_REST
@@ -175,31 +193,40 @@ int main(int argc, char **argv)
 	argc -= ret;
 	argv += ret;
 
+	/* NTP clock of the packet timestamps, without system call */
+	if (up_clock_init() < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init NTP clock\n",
+				LOG_VALUE);
+
 	/* DP restart conter info */
 	dp_restart_cntr = get_dp_restart_cntr();
 
+#ifdef DP_BENCH
+	/* In-process ring ports of the benchmark, in place of the NICs */
+	if (dp_bench_port_init() < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to create the benchmark ports\n",
+				LOG_VALUE);
+#endif /* DP_BENCH */
+
 	/* DP Init */
 	dp_init(argc, argv);
+	clSetLogLevel(clSystemLog, (enum CLoggerLogLevel)RTE_MIN(app.log_level,
+				(uint32_t)eCLogLevelOff));
 
 	init_cli_framework();
 
 	/* TODO: Need to validate LI*/
-	/* Create TCP connection between data-plane and d-df2 */
-	init_ddf();
-
-	ddf2_fd = create_ddf_tunnel(app.ddf2_ip, app.ddf2_port, app.ddf2_local_ip,
-			(const uint8_t *)DDF2);
-	if (ddf2_fd == NULL) {
+	/* D-DF2/D-DF3 targets of the LI exporter, connected by the exporter */
+	if (li_exp_target_init(LI_EXP_DDF2, "DDF2", app.ddf2_ip, app.ddf2_port,
+				app.ddf2_local_ip) < 0) {
 		clLog(clSystemLog, eCLSeverityCritical,
-				LOG_FORMAT"Unable to connect to DDF2\n", LOG_VALUE);
+				LOG_FORMAT"Unable to configure DDF2\n", LOG_VALUE);
 	}
 
-	/* Create TCP connection between data-plane and d-df3 */
-	ddf3_fd = create_ddf_tunnel(app.ddf3_ip, app.ddf3_port, app.ddf3_local_ip,
-			(const uint8_t *)DDF3);
-	if (ddf3_fd == NULL) {
+	if (li_exp_target_init(LI_EXP_DDF3, "DDF3", app.ddf3_ip, app.ddf3_port,
+				app.ddf3_local_ip) < 0) {
 		clLog(clSystemLog, eCLSeverityCritical,
-				LOG_FORMAT"Unable to connect to DDF3\n", LOG_VALUE);
+				LOG_FORMAT"Unable to configure DDF3\n", LOG_VALUE);
 	}
 
 	create_heartbeat_hash_table();
@@ -231,9 +258,42 @@ int main(int argc, char **argv)
 	/* Initialization of the PFCP interface */
 	iface_module_constructor();
 
+	/* Deferred reclamation of the session, pdr,far,qer and urr objects */
+	up_rcu_init();
+
 	/* Create the session, pdr,far,qer and urr tables */
 	init_up_hash_tables();
 
+	/* SDF rule index and ACL builder, off the PFCP processing path */
+	if (up_acl_init() < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init SDF ACL tables\n",
+				LOG_VALUE);
+
+	/* Next hop adjacencies and the resolve ring to the mct core */
+	if (up_adj_init() < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init next hop adjacencies\n",
+				LOG_VALUE);
+
+	/* Timing wheel of the URR time thresholds, run by the iface core */
+	if (up_tw_init() < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init timing wheel\n",
+				LOG_VALUE);
+
+	/* URR usage counters of the workers and the fold ring to the iface core */
+	if (urr_usage_init(app.urr_vol_err) < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init URR usage counters\n",
+				LOG_VALUE);
+
+	/* Per stage cycle histograms of the workers */
+	if (up_prof_init(app.prof_sample) < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init stage profiler\n",
+				LOG_VALUE);
+
+	/* CDR writer thread, off the PFCP and mct cores */
+	if (up_cdr_init(app.cdr_fsync, app.cdr_fsync_sec, app.cdr_rotate_mb) < 0)
+		rte_exit(EXIT_FAILURE, LOG_FORMAT"Failed to init CDR writer\n",
+				LOG_VALUE);
+
 	/* Initialized/Start Pcaps on User-Plane */
 	if (app.generate_pcap) {
 		up_pcap_init();
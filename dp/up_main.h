@@ -34,6 +34,7 @@
 #include <rte_malloc.h>
 #include <rte_ethdev.h>
 #include <rte_version.h>
+#include <rte_spinlock.h>
 
 #include "../pfcp_messages/pfcp_up_struct.h"
 
@@ -339,6 +340,7 @@ struct kni_port_params {
 	uint32_t nb_kni; /* Number of KNI devices to be created */
 	unsigned lcore_k[KNI_MAX_KTHREAD]; /* lcore ID list for kthreads */
 	struct rte_kni *kni[KNI_MAX_KTHREAD]; /* KNI context pointers */
+	rte_spinlock_t ingress_lock; /* Serialize kni_ingress from RX workers */
 } __rte_cache_aligned;
 
 extern uint32_t nb_ports;
@@ -444,6 +446,11 @@ struct app_params {
 	uint8_t gtpu_seqnb_in;
 	/* outgoing GTP sequence number, 0 - do not include (default), 1 - include*/
 	uint8_t gtpu_seqnb_out;
+	/* Number of UL/DL workers, i.e. RX queues polled per direction */
+	uint8_t ul_workers;
+	uint8_t dl_workers;
+	/* DDN buffering policy, 0 - drop newest (default), 1 - drop oldest */
+	uint8_t ddn_buf_policy;
 	/* pfcp ipv6 prefix len */
 	uint8_t pfcp_ipv6_prefix_len;
 	/* Transmit Count */
@@ -462,13 +469,31 @@ struct app_params {
 	int teidri_val;
 	/* TEIDRI Timeout */
 	int teidri_timeout;
+	/* Max number of DL pkts buffered for the idle sessions */
+	uint32_t ddn_buf_pool_sz;
+	/* Error bound of the URR volume thresholds, in bytes */
+	uint32_t urr_vol_err;
+	/* Set to run the LI exporter on its own lcore */
+	uint8_t li_export_core;
+	/* Set to steer the packets to the workers on a distributor lcore */
+	uint8_t distributor;
+	/* Sync policy of the CDR file, UP_CDR_FSYNC_* */
+	uint8_t cdr_fsync;
+	/* Period of the periodic CDR file sync, in seconds */
+	uint32_t cdr_fsync_sec;
+	/* Size the CDR file is rotated at, in MB */
+	uint32_t cdr_rotate_mb;
 	/* cli rest port */
 	uint16_t cli_rest_port;
 	/* cli rest ip */
 	char cli_rest_ip_buff[IPV6_STR_LEN];
 
-	/* RTE Log Level*/
+	/* Lowest severity logged, CLoggerLogLevel */
 	uint32_t log_level;
+	/* Records of the log ring, 0 to log synchronously */
+	uint32_t log_ring;
+	/* Stage profiler sample period in bursts, 0 for off */
+	uint32_t prof_sample;
 	/* West Bound S1U/S5S8 Port */
 	uint32_t wb_port;
 	/* East Bound S5S8/SGI Port */
@@ -568,12 +593,6 @@ struct app_params {
 /** extern the app config struct */
 struct app_params app;
 
-/* file descriptor of ddf2 */
-void *ddf2_fd;
-
-/* file descriptor of ddf3 */
-void *ddf3_fd;
-
 /** ethernet addresses of ports */
 struct ether_addr ports_eth_addr[RTE_MAX_ETHPORTS];
 
@@ -610,25 +629,6 @@ typedef struct ddn_info_t {
 	uint64_t up_seid;
 }ddn_t;
 
-#pragma pack(push, 1)
-typedef struct li_data_ring
-{
-	uint64_t id;
-	uint64_t imsi;
-	int size;
-	uint8_t forward;
-	uint8_t *pkts;
-} li_data_t;
-#pragma pack(pop)
-
-#pragma pack(push, 1)
-typedef struct cdr_rpt_req {
-	pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report;
-	uint64_t  up_seid;
-	uint32_t seq_no;
-} cdr_rpt_req_t;
-#pragma pack(pop)
-
 /** CDR actions, N_A should never be accounted for */
 enum pkt_action_t {CHARGED, DROPPED, N_A};
 
@@ -639,12 +639,6 @@ extern uint64_t total_wrkr_pkts_processed;
 
 extern struct rte_ring *shared_ring[NUM_SPGW_PORTS];
 
-/** Holds a set of rings to be used for downlink data buffering */
-extern struct rte_ring *dl_ring_container;
-
-/** Number of DL rings currently created */
-extern uint32_t num_dl_rings;
-
 /** For notification of modify_session so that buffered packets
  * can be dequeued
  */
@@ -684,6 +678,17 @@ scan_dns_ring(void);
 void
 dp_port_init(void);
 
+/**
+ * @brief  : Set the max RX packet length of a WB/EB port, the port lcores
+ *           are parked while the port is stopped, configured again with all
+ *           its worker queues and restarted
+ * @param  : port, port number
+ * @param  : max_rx_pkt_len, MTU with the Ethernet header and FCS
+ * @return : Returns 0 in case of success , < 0 otherwise
+ */
+int
+dp_port_mtu_set(uint8_t port, uint32_t max_rx_pkt_len);
+
 /**
  * @brief  : Function to initialize the dataplane application config.
  * @param  : argc, number of arguments.
@@ -793,6 +798,37 @@ update_nexthop_info(struct rte_mbuf **pkts, uint32_t n,
 		uint64_t *pkts_mask, uint8_t portid,
 		pdr_info_t **pdr, uint8_t loopback_flag);
 
+/**
+ * @brief  : Acl table lookup for sdf rule, the burst is classified one ACL
+ *           table slot at a time with one classify call per ACL context
+ * @param  : pkts, mbuf packets
+ * @param  : n, no of packets
+ * @param  : pkts_mask, packet mask
+ * @param  : fd_pkts_mask, packet mask
+ * @param  : sess_data, session information
+ * @param  : prcdnc, precedence value
+ * @param  : prcdnc_val, storage of the precedence values
+ * @return : Returns nothing
+ */
+void
+acl_sdf_lookup(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
+		uint64_t *fd_pkts_mask, pfcp_session_datat_t **sess_data,
+		uint32_t **prcdnc, uint32_t *prcdnc_val);
+
+/**
+ * @brief  : Count the packets on the usage counters of the URR, the volume
+ *           thresholds are checked by the iface core
+ * @param  : pkts, pkts recived
+ * @param  : n, no of pkts recived
+ * @param  : pkts_mask, packet  mask
+ * @param  : pdr, structure for pdr info for pkts
+ * @param  : flow, UPLINK or DOWNLINK
+ * @return : Returns 0 for succes and -1 failure
+ */
+int
+update_usage(struct rte_mbuf **pkts, uint32_t n, uint64_t *pkts_mask,
+		pdr_info_t **pdr, uint16_t flow);
+
 /************* Session information function prototype***********/
 /**
  * @brief  : Get the UL session info from table lookup.
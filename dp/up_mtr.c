@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+
+#include "util.h"
+#include "up_main.h"
+#include "up_rcu.h"
+#include "up_mtr.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/**
+ * @brief  : Build the UL/DL meters from the QER bitrates
+ * @param  : qer, qer information
+ * @return : Returns meter pointer, NULL if the QER has no MBR or on error
+ */
+static struct up_mtr *
+build_qer_mtr(qer_info_t *qer)
+{
+	struct up_mtr *mtr = NULL;
+
+	if ((qer->max_bitrate.ul_mbr == 0) && (qer->max_bitrate.dl_mbr == 0))
+		return NULL;
+
+	mtr = rte_zmalloc("UP_MTR", sizeof(struct up_mtr), RTE_CACHE_LINE_SIZE);
+	if (mtr == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to allocate memory for QER meter, Error: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return NULL;
+	}
+
+	if (up_mtr_dir_config(&mtr->dir[UP_MTR_UL], qer->max_bitrate.ul_mbr,
+				qer->guaranteed_bitrate.ul_gbr, qer->avgng_wnd.avgng_wnd) ||
+		up_mtr_dir_config(&mtr->dir[UP_MTR_DL], qer->max_bitrate.dl_mbr,
+				qer->guaranteed_bitrate.dl_gbr, qer->avgng_wnd.avgng_wnd)) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"QER_ID:%u, Invalid meter parameters, UL MBR:%lu, "
+			"DL MBR:%lu\n", LOG_VALUE, qer->qer_id,
+			qer->max_bitrate.ul_mbr, qer->max_bitrate.dl_mbr);
+		rte_free(mtr);
+		return NULL;
+	}
+
+	return mtr;
+}
+
+/**
+ * @brief  : Log the color counters and release the meter through the QSBR
+ * @param  : mtr, meter
+ * @param  : name, meter owner, for the logs
+ * @param  : id, QER ID or session ID, for the logs
+ * @return : Returns nothing
+ */
+static void
+release_mtr(struct up_mtr *mtr, const char *name, uint64_t id)
+{
+	uint8_t dir = 0;
+
+	if (mtr == NULL)
+		return;
+
+	for (dir = 0; dir < UP_MTR_DIR_MAX; dir++) {
+		struct up_mtr_dir *d = &mtr->dir[dir];
+
+		if (!d->enabled)
+			continue;
+
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"%s:%lu, %s meter, Green:%lu pkts/%lu bytes, "
+			"Yellow:%lu pkts/%lu bytes, Red:%lu pkts/%lu bytes\n",
+			LOG_VALUE, name, id, (dir == UP_MTR_UL) ? "UL" : "DL",
+			d->pkts[e_RTE_METER_GREEN], d->bytes[e_RTE_METER_GREEN],
+			d->pkts[e_RTE_METER_YELLOW], d->bytes[e_RTE_METER_YELLOW],
+			d->pkts[e_RTE_METER_RED], d->bytes[e_RTE_METER_RED]);
+	}
+
+	up_rcu_defer_free(mtr);
+}
+
+int8_t
+qer_mtr_update(qer_info_t *qer, pfcp_session_t *sess)
+{
+	struct up_mtr *mtr = NULL;
+	struct up_mtr *old = NULL;
+
+	if (qer == NULL)
+		return -1;
+
+	mtr = build_qer_mtr(qer);
+
+	/* Publish the configured meter before the UL/DL cores can pick it up */
+	rte_smp_wmb();
+	if (qer->qer_corr_id_val && (sess != NULL)) {
+		/* APN-AMBR, shared by all the PDRs of the session */
+		old = sess->ambr_mtr;
+		sess->ambr_mtr = mtr;
+		release_mtr(old, "UP_SEID", sess->up_seid);
+	} else {
+		old = qer->mtr;
+		qer->mtr = mtr;
+		release_mtr(old, "QER_ID", qer->qer_id);
+	}
+
+	clLog(clSystemLog, eCLSeverityDebug,
+		LOG_FORMAT"QER_ID:%u, %s meter %s, UL MBR/GBR:%lu/%lu kbps, "
+		"DL MBR/GBR:%lu/%lu kbps\n", LOG_VALUE, qer->qer_id,
+		qer->qer_corr_id_val ? "APN-AMBR" : "MBR",
+		(mtr != NULL) ? "set" : "not used",
+		qer->max_bitrate.ul_mbr, qer->guaranteed_bitrate.ul_gbr,
+		qer->max_bitrate.dl_mbr, qer->guaranteed_bitrate.dl_gbr);
+
+	return 0;
+}
+
+void
+qer_mtr_free(qer_info_t *qer)
+{
+	if (qer == NULL)
+		return;
+
+	release_mtr(qer->mtr, "QER_ID", qer->qer_id);
+	qer->mtr = NULL;
+}
+
+void
+sess_ambr_mtr_free(pfcp_session_t *sess)
+{
+	if (sess == NULL)
+		return;
+
+	release_mtr(sess->ambr_mtr, "UP_SEID", sess->up_seid);
+	sess->ambr_mtr = NULL;
+}
+
+void
+qer_policing(struct rte_mbuf **pkts, pdr_info_t **pdr, uint32_t n,
+		uint64_t *pkts_mask, uint64_t *fd_pkts_mask, uint8_t direction)
+{
+	uint32_t i = 0;
+	uint64_t tsc = rte_rdtsc();
+	uint8_t dir = (direction == UPLINK) ? UP_MTR_UL : UP_MTR_DL;
+
+	for (i = 0; i < n; i++) {
+		uint8_t cnt = 0;
+		uint32_t len = 0;
+		qer_info_t *qer = NULL;
+		struct up_mtr *mtr = NULL;
+		enum rte_meter_color color = e_RTE_METER_GREEN;
+
+		if (!(ISSET_BIT(*pkts_mask, i)) || !(ISSET_BIT(*fd_pkts_mask, i)) ||
+				(pdr[i] == NULL))
+			continue;
+
+		/* Bitrates apply to the user IP packet */
+		len = rte_pktmbuf_pkt_len(pkts[i]) - ETH_HDR_SIZE;
+
+		/* Flow MBR/GBR of the QERs of the PDR */
+		for (qer = pdr[i]->quer; (qer != NULL) && (cnt < pdr[i]->qer_count) &&
+				(color != e_RTE_METER_RED); qer = qer->next, cnt++) {
+			mtr = qer->mtr;
+			if (mtr != NULL)
+				color = up_mtr_check(&mtr->dir[dir], tsc, len);
+		}
+
+		/* APN-AMBR of the session */
+		if ((color != e_RTE_METER_RED) && (pdr[i]->session != NULL)) {
+			mtr = pdr[i]->session->ambr_mtr;
+			if (mtr != NULL)
+				color = up_mtr_check(&mtr->dir[dir], tsc, len);
+		}
+
+		if (color == e_RTE_METER_RED) {
+			RESET_BIT(*pkts_mask, i);
+			clLog(clSystemLog, eCLSeverityDebug,
+				LOG_FORMAT"Packets DROPPED PDR_ID:%u, %s MBR exceeded\n",
+				LOG_VALUE, pdr[i]->rule_id,
+				(direction == UPLINK) ? "UL" : "DL");
+		}
+	}
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_MTR_H_
+#define _UP_MTR_H_
+/**
+ * @file
+ * This file contains the QER bitrate policing of the dataplane.
+ *
+ * Every QER carrying a MBR gets a two rate three color meter per
+ * direction: CIR is the GBR and PIR the MBR. Green packets are within the
+ * GBR, yellow packets above the GBR but within the MBR, both are
+ * forwarded; red packets exceed the MBR and are dropped. A QER carrying a
+ * QER Correlation ID is the APN-AMBR of the PFCP session, its meter is
+ * attached to the session and applied to all the packets of the session
+ * after the per QER meters.
+ *
+ * Meters are built on the control path and swapped as a whole on Update
+ * QER, the old meter is released through the QSBR.
+ *
+ * The flows of a session can be spread by RSS over several workers, which
+ * then share its meters. The token buckets of a direction are several
+ * words, they are checked and updated with the color counters under a
+ * spinlock of the direction. A split of the rate between per worker
+ * meters would cut the MBR of a single flow to the share of its worker.
+ */
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_ether.h>
+#include <rte_meter.h>
+#include <rte_mbuf.h>
+#include <rte_spinlock.h>
+
+/* Meter direction index */
+#define UP_MTR_UL		0
+#define UP_MTR_DL		1
+#define UP_MTR_DIR_MAX		2
+
+/* Burst window when the QER has no Averaging Window, in msec */
+#define UP_MTR_DFLT_WND_MS	100
+
+/* Smallest burst size, two full sized frames */
+#define UP_MTR_MIN_BURST	(2 * ETHER_MAX_LEN)
+
+struct qer_info_t;
+struct pdr_info_t;
+struct pfcp_session_t;
+
+/**
+ * @brief  : Meter of one direction with the per color counters
+ */
+struct up_mtr_dir {
+	/* Serializes the workers on the buckets and the counters */
+	rte_spinlock_t lock;
+	struct rte_meter_trtcm trtcm;
+	/* Set when a MBR is configured for the direction */
+	uint8_t enabled;
+	uint64_t pkts[e_RTE_METER_COLORS];
+	uint64_t bytes[e_RTE_METER_COLORS];
+} __rte_cache_aligned;
+
+/**
+ * @brief  : UL and DL meters of a QER or of a session APN-AMBR
+ */
+struct up_mtr {
+	struct up_mtr_dir dir[UP_MTR_DIR_MAX];
+};
+
+/**
+ * @brief  : Convert a PFCP bitrate to the meter rate
+ * @param  : kbps, bitrate in kilobits per second
+ * @return : Returns rate in bytes per second
+ */
+static inline uint64_t
+up_mtr_kbps_to_bytes(uint64_t kbps)
+{
+	return (kbps * 1000) / 8;
+}
+
+/**
+ * @brief  : Configure the meter of one direction
+ * @param  : d, meter to be configured
+ * @param  : mbr, maximum bitrate in kbps, 0 disables the meter
+ * @param  : gbr, guaranteed bitrate in kbps
+ * @param  : wnd, averaging window in msec, 0 for the default
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static inline int
+up_mtr_dir_config(struct up_mtr_dir *d, uint64_t mbr, uint64_t gbr,
+		uint32_t wnd)
+{
+	struct rte_meter_trtcm_params params = {0};
+
+	rte_spinlock_init(&d->lock);
+	d->enabled = 0;
+	if (mbr == 0)
+		return 0;
+
+	if (wnd == 0)
+		wnd = UP_MTR_DFLT_WND_MS;
+
+	/* Without GBR both buckets run at the MBR, no yellow packets */
+	if ((gbr == 0) || (gbr > mbr))
+		gbr = mbr;
+
+	params.pir = up_mtr_kbps_to_bytes(mbr);
+	params.cir = up_mtr_kbps_to_bytes(gbr);
+	params.pbs = RTE_MAX(params.pir * wnd / 1000, (uint64_t)UP_MTR_MIN_BURST);
+	params.cbs = RTE_MAX(params.cir * wnd / 1000, (uint64_t)UP_MTR_MIN_BURST);
+
+	if (rte_meter_trtcm_config(&d->trtcm, &params))
+		return -1;
+
+	d->enabled = 1;
+	return 0;
+}
+
+/**
+ * @brief  : Color a packet and update the color counters, safe against
+ *           the other workers sharing the meter
+ * @param  : d, meter
+ * @param  : tsc, current TSC
+ * @param  : len, IP length of the packet
+ * @return : Returns packet color, green when the meter is disabled
+ */
+static inline enum rte_meter_color
+up_mtr_check(struct up_mtr_dir *d, uint64_t tsc, uint32_t len)
+{
+	enum rte_meter_color color;
+
+	if (!d->enabled)
+		return e_RTE_METER_GREEN;
+
+	rte_spinlock_lock(&d->lock);
+	/* The TSC of the burst may be older than the last update by another
+	 * worker, the bucket update takes an unsigned time difference */
+	tsc = RTE_MAX(tsc, RTE_MAX(d->trtcm.time_tc, d->trtcm.time_tp));
+	color = rte_meter_trtcm_color_blind_check(&d->trtcm, tsc, len);
+	d->pkts[color]++;
+	d->bytes[color] += len;
+	rte_spinlock_unlock(&d->lock);
+	return color;
+}
+
+/**
+ * @brief  : Build the meter of the QER from its MBR/GBR and publish it on
+ *           the QER, or on the session for the APN-AMBR QER
+ * @param  : qer, qer information
+ * @param  : sess, pfcp session owning the qer
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+qer_mtr_update(struct qer_info_t *qer, struct pfcp_session_t *sess);
+
+/**
+ * @brief  : Release the meter of the QER
+ * @param  : qer, qer information
+ * @return : Returns nothing
+ */
+void
+qer_mtr_free(struct qer_info_t *qer);
+
+/**
+ * @brief  : Release the APN-AMBR meter of the session
+ * @param  : sess, pfcp session
+ * @return : Returns nothing
+ */
+void
+sess_ambr_mtr_free(struct pfcp_session_t *sess);
+
+/**
+ * @brief  : Police the packets with the QER meters of the matched PDR and
+ *           the APN-AMBR meter of the session, red packets are dropped
+ * @param  : pkts, mbuf packets
+ * @param  : pdr, matched pdrs
+ * @param  : n, number of packets
+ * @param  : pkts_mask, packet mask
+ * @param  : fd_pkts_mask, mask of the packets to police
+ * @param  : direction, uplink or downlink
+ * @return : Returns nothing
+ */
+void
+qer_policing(struct rte_mbuf **pkts, struct pdr_info_t **pdr, uint32_t n,
+		uint64_t *pkts_mask, uint64_t *fd_pkts_mask, uint8_t direction);
+
+#endif /* _UP_MTR_H_ */
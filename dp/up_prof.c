@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_malloc.h>
+
+#include "up_main.h"
+#include "up_prof.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+volatile uint32_t up_prof_period;
+volatile uint32_t up_prof_gen;
+struct up_prof_core *up_prof_cores[RTE_MAX_LCORE];
+
+static const char *up_prof_dir_name[UP_PROF_DIR_MAX] = {
+	[UP_PROF_UL] = "uplink",
+	[UP_PROF_DL] = "downlink",
+};
+
+static const char *up_prof_stage_name[UP_PROF_STAGE_MAX] = {
+	[UP_PROF_SESS] = "sess_lookup",
+	[UP_PROF_DECAP] = "decap",
+	[UP_PROF_ACL] = "acl",
+	[UP_PROF_QER] = "qer",
+	[UP_PROF_ENCAP] = "encap",
+	[UP_PROF_NEXTHOP] = "next_hop",
+	[UP_PROF_TX] = "tx",
+};
+
+int
+up_prof_init(uint32_t period)
+{
+	unsigned lcore = 0;
+
+	RTE_BUILD_BUG_ON(UP_PROF_DIR_MAX != PROF_DIR_MAX);
+	RTE_BUILD_BUG_ON(UP_PROF_STAGE_MAX != PROF_STAGE_MAX);
+
+	RTE_LCORE_FOREACH(lcore) {
+		up_prof_cores[lcore] = rte_zmalloc_socket("up_prof",
+				sizeof(struct up_prof_core), RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore));
+		if (up_prof_cores[lcore] == NULL) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to allocate the stage profiler of lcore %u\n",
+				LOG_VALUE, lcore);
+			return -1;
+		}
+	}
+
+	up_prof_period = period;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"Stage profiler samples 1 burst in %u, %u buckets per stage\n",
+		LOG_VALUE, period, UP_PROF_BUCKETS);
+
+	return 0;
+}
+
+int8_t
+up_prof_set_period(const int period)
+{
+	if (period < 0)
+		return -1;
+
+	up_prof_gen++;
+	up_prof_period = period;
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"Stage profiler samples 1 burst in %d, histograms restarted\n",
+		LOG_VALUE, period);
+
+	return 0;
+}
+
+/**
+ * @brief  : Middle of a bucket
+ * @param  : idx, bucket index
+ * @return : Returns cycle count
+ */
+static uint64_t
+up_prof_bucket_cycles(uint32_t idx)
+{
+	uint32_t shift = 0;
+
+	if (idx < UP_PROF_SUB)
+		return idx;
+
+	shift = (idx >> UP_PROF_SUB_BITS) - 1;
+	return ((uint64_t)(UP_PROF_SUB + (idx & (UP_PROF_SUB - 1))) << shift) +
+		((1ULL << shift) >> 1);
+}
+
+/**
+ * @brief  : Cycle count under which a share of the samples falls
+ * @param  : h, histogram
+ * @param  : permille, share of the samples, per thousand
+ * @return : Returns cycle count
+ */
+static uint64_t
+up_prof_percentile(const struct up_prof_hist *h, uint32_t permille)
+{
+	uint32_t idx = 0;
+	uint64_t seen = 0;
+	uint64_t rank = (h->samples * permille + 999) / 1000;
+
+	if (h->samples == 0)
+		return 0;
+
+	for (idx = 0; idx < UP_PROF_BUCKETS; idx++) {
+		seen += h->bucket[idx];
+		if (seen >= rank)
+			break;
+	}
+
+	return RTE_MIN(up_prof_bucket_cycles(idx), h->max);
+}
+
+int8_t
+up_prof_stats_get(prof_stats_t *stats)
+{
+	uint8_t dir = 0, stage = 0;
+	uint32_t idx = 0;
+	unsigned lcore = 0;
+	uint64_t hz = rte_get_tsc_hz();
+	struct up_prof_hist sum;
+
+	if (stats == NULL || hz == 0)
+		return -1;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->sample_period = up_prof_period;
+
+#define CYC_TO_NS(c) ((uint64_t)(((double)(c) * 1E9) / hz))
+	for (dir = 0; dir < UP_PROF_DIR_MAX; dir++) {
+		strncpy(stats->dir_name[dir], up_prof_dir_name[dir], PROF_NAME_LEN - 1);
+
+		for (stage = 0; stage < UP_PROF_STAGE_MAX; stage++) {
+			prof_stage_stats_t *st = &stats->stage[dir][stage];
+
+			memset(&sum, 0, sizeof(sum));
+			RTE_LCORE_FOREACH(lcore) {
+				const struct up_prof_core *pc = up_prof_cores[lcore];
+				const struct up_prof_hist *h = NULL;
+
+				/* Not cleared yet, counted for the old period */
+				if (pc == NULL || pc->gen != up_prof_gen)
+					continue;
+
+				h = &pc->hist[dir][stage];
+				sum.samples += h->samples;
+				sum.cycles += h->cycles;
+				sum.max = RTE_MAX(sum.max, h->max);
+				for (idx = 0; idx < UP_PROF_BUCKETS; idx++)
+					sum.bucket[idx] += h->bucket[idx];
+			}
+
+			strncpy(st->name, up_prof_stage_name[stage], PROF_NAME_LEN - 1);
+			st->samples = sum.samples;
+			if (sum.samples == 0)
+				continue;
+
+			st->mean_ns = CYC_TO_NS(sum.cycles / sum.samples);
+			st->p50_ns = CYC_TO_NS(up_prof_percentile(&sum, 500));
+			st->p90_ns = CYC_TO_NS(up_prof_percentile(&sum, 900));
+			st->p99_ns = CYC_TO_NS(up_prof_percentile(&sum, 990));
+			st->p999_ns = CYC_TO_NS(up_prof_percentile(&sum, 999));
+			st->max_ns = CYC_TO_NS(sum.max);
+		}
+	}
+#undef CYC_TO_NS
+
+	return 0;
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_PROF_H_
+#define _UP_PROF_H_
+/**
+ * @file
+ * This file contains the sampled per stage cycle profiler of the workers.
+ *
+ * One burst in up_prof_period is sampled on every worker lcore: the TSC is
+ * read around each stage of wb_pkt_handler/eb_pkt_handler and the deltas
+ * are counted in log-linear histograms of the lcore, UP_PROF_SUB_BITS of
+ * mantissa per power of 2, i.e. within 12.5% of the true value. A burst
+ * that is not sampled costs one counter increment.
+ *
+ * The histograms are only written by their lcore and summed by the REST
+ * thread when the percentiles are read. Changing the period restarts the
+ * histograms, each lcore clears its own on its next sample.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
+
+#include "gw_structs.h"
+
+/* Default sample period, in bursts */
+#define UP_PROF_PERIOD_DFLT	1024
+
+/* Mantissa bits of a bucket */
+#define UP_PROF_SUB_BITS	3
+#define UP_PROF_SUB		(1 << UP_PROF_SUB_BITS)
+
+/* Deltas are clamped to 2^UP_PROF_MAX_BITS - 1 cycles */
+#define UP_PROF_MAX_BITS	32
+#define UP_PROF_BUCKETS		((UP_PROF_MAX_BITS - UP_PROF_SUB_BITS + 1) * \
+		UP_PROF_SUB)
+
+/**
+ * @brief  : Profiled direction
+ */
+enum up_prof_dir {
+	UP_PROF_UL,
+	UP_PROF_DL,
+	UP_PROF_DIR_MAX
+};
+
+/**
+ * @brief  : Profiled stage of the packet handlers
+ */
+enum up_prof_stage {
+	/* Session lookup */
+	UP_PROF_SESS,
+	/* GTP-U decapsulation */
+	UP_PROF_DECAP,
+	/* SDF ACL lookup and PDR selection */
+	UP_PROF_ACL,
+	/* QER gating and policing */
+	UP_PROF_QER,
+	/* GTP-U encapsulation, or outer header rewrite of the relayed packets */
+	UP_PROF_ENCAP,
+	/* Next hop L2 header */
+	UP_PROF_NEXTHOP,
+	/* Pipeline output after the handler, and the port flush when it runs */
+	UP_PROF_TX,
+	UP_PROF_STAGE_MAX
+};
+
+/**
+ * @brief  : Cycle histogram of a stage
+ */
+struct up_prof_hist {
+	uint64_t samples;
+	uint64_t cycles;
+	uint64_t max;
+	uint64_t bucket[UP_PROF_BUCKETS];
+};
+
+/**
+ * @brief  : Profiler state of an lcore
+ */
+struct up_prof_core {
+	/* Bursts since the last sample */
+	uint32_t burst;
+	/* Generation the histograms were cleared for */
+	uint32_t gen;
+	/* End of the sampled handler, 0 when no TX is pending */
+	uint64_t tx_tsc;
+	uint8_t tx_dir;
+	struct up_prof_hist hist[UP_PROF_DIR_MAX][UP_PROF_STAGE_MAX];
+} __rte_cache_aligned;
+
+/* Sample period in bursts, 0 when the profiler is off */
+extern volatile uint32_t up_prof_period;
+/* Bumped to restart the histograms */
+extern volatile uint32_t up_prof_gen;
+/* Profiler state of the enabled lcores */
+extern struct up_prof_core *up_prof_cores[RTE_MAX_LCORE];
+
+/**
+ * @brief  : Allocate the histograms of the enabled lcores
+ * @param  : period, sample period in bursts, 0 for off
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_prof_init(uint32_t period);
+
+/**
+ * @brief  : Bucket of a cycle count
+ * @param  : cycles, TSC delta
+ * @return : Returns bucket index
+ */
+static inline uint32_t
+up_prof_bucket(uint64_t cycles)
+{
+	uint32_t shift = 0;
+
+	if (cycles >= (1ULL << UP_PROF_MAX_BITS))
+		cycles = (1ULL << UP_PROF_MAX_BITS) - 1;
+	if (cycles < UP_PROF_SUB)
+		return cycles;
+
+	shift = (63 - __builtin_clzll(cycles)) - UP_PROF_SUB_BITS;
+	return ((shift + 1) << UP_PROF_SUB_BITS) +
+		((cycles >> shift) & (UP_PROF_SUB - 1));
+}
+
+/**
+ * @brief  : Select the burst for sampling
+ * @param  : No param
+ * @return : Returns profiler state of the lcore if the burst is sampled,
+ *           NULL otherwise
+ */
+static inline struct up_prof_core *
+up_prof_sample(void)
+{
+	uint32_t period = up_prof_period;
+	unsigned lcore = rte_lcore_id();
+	struct up_prof_core *pc = NULL;
+
+	if (unlikely(period == 0) || lcore >= RTE_MAX_LCORE)
+		return NULL;
+
+	pc = up_prof_cores[lcore];
+	if (likely(pc == NULL || ++pc->burst < period))
+		return NULL;
+
+	pc->burst = 0;
+	if (unlikely(pc->gen != up_prof_gen)) {
+		pc->gen = up_prof_gen;
+		memset(pc->hist, 0, sizeof(pc->hist));
+	}
+	return pc;
+}
+
+/**
+ * @brief  : Start of a stage
+ * @param  : pc, profiler state of the sampled burst, or NULL
+ * @return : Returns TSC, 0 when the burst is not sampled
+ */
+static inline uint64_t
+up_prof_tsc(struct up_prof_core *pc)
+{
+	return unlikely(pc != NULL) ? rte_rdtsc() : 0;
+}
+
+/**
+ * @brief  : Count a TSC delta in the histogram of a stage
+ * @param  : pc, profiler state of the sampled burst
+ * @param  : dir, UP_PROF_UL or UP_PROF_DL
+ * @param  : stage, UP_PROF_* stage
+ * @param  : cycles, TSC delta
+ * @return : Returns nothing
+ */
+static inline void
+up_prof_add(struct up_prof_core *pc, uint8_t dir, uint8_t stage,
+		uint64_t cycles)
+{
+	struct up_prof_hist *h = &pc->hist[dir][stage];
+
+	h->samples++;
+	h->cycles += cycles;
+	if (cycles > h->max)
+		h->max = cycles;
+	h->bucket[up_prof_bucket(cycles)]++;
+}
+
+/**
+ * @brief  : End of a stage, the TSC moves to the start of the next one
+ * @param  : pc, profiler state of the sampled burst, or NULL
+ * @param  : dir, UP_PROF_UL or UP_PROF_DL
+ * @param  : stage, UP_PROF_* stage
+ * @param  : tsc, start of the stage
+ * @return : Returns nothing
+ */
+static inline void
+up_prof_stage(struct up_prof_core *pc, uint8_t dir, uint8_t stage,
+		uint64_t *tsc)
+{
+	uint64_t now = 0;
+
+	if (likely(pc == NULL))
+		return;
+
+	now = rte_rdtsc();
+	up_prof_add(pc, dir, stage, now - *tsc);
+	*tsc = now;
+}
+
+/**
+ * @brief  : End of the sampled handler, the TX stage starts
+ * @param  : pc, profiler state of the sampled burst, or NULL
+ * @param  : dir, UP_PROF_UL or UP_PROF_DL
+ * @return : Returns nothing
+ */
+static inline void
+up_prof_tx_start(struct up_prof_core *pc, uint8_t dir)
+{
+	if (likely(pc == NULL))
+		return;
+
+	pc->tx_dir = dir;
+	pc->tx_tsc = rte_rdtsc();
+}
+
+/**
+ * @brief  : End of the pipeline run, counts the TX stage of a sampled burst
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static inline void
+up_prof_tx_end(void)
+{
+	unsigned lcore = rte_lcore_id();
+	struct up_prof_core *pc = NULL;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return;
+
+	pc = up_prof_cores[lcore];
+	if (likely(pc == NULL || pc->tx_tsc == 0))
+		return;
+
+	up_prof_add(pc, pc->tx_dir, UP_PROF_TX, rte_rdtsc() - pc->tx_tsc);
+	pc->tx_tsc = 0;
+}
+
+/**
+ * @brief  : Set the sample period and restart the histograms, REST
+ *           callback
+ * @param  : period, sample period in bursts, 0 for off
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+up_prof_set_period(const int period);
+
+/**
+ * @brief  : Sum the histograms of the lcores into percentiles, REST
+ *           callback
+ * @param  : stats, percentiles in nsec per direction and stage
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+up_prof_stats_get(prof_stats_t *stats);
+
+#endif /* _UP_PROF_H_ */
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+
+#include "up_rcu.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+/**
+ * @brief  : Object waiting for its grace period to expire
+ */
+struct up_rcu_defer_entry {
+	void *obj;
+	void (*free_fn)(void *obj);
+	uint64_t token;
+};
+
+struct up_rcu_state up_rcu = {
+	.token = UP_RCU_OFFLINE + 1,
+	.sess_tbl_seq = 0,
+};
+
+/* Deferred free queue, filled and drained in token order */
+static struct up_rcu_defer_entry *defer_q;
+static uint32_t defer_head;
+static uint32_t defer_tail;
+static rte_spinlock_t defer_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* Serializes the session table writers */
+static rte_spinlock_t sess_tbl_lock = RTE_SPINLOCK_INITIALIZER;
+
+void
+up_rcu_init(void)
+{
+	defer_q = rte_zmalloc("UP_RCU_DEFER_Q",
+			sizeof(struct up_rcu_defer_entry) * UP_RCU_DEFER_QUEUE_SZ,
+			RTE_CACHE_LINE_SIZE);
+	if (defer_q == NULL)
+		rte_panic("Failed to allocate memory for QSBR defer queue\n");
+
+	defer_head = 0;
+	defer_tail = 0;
+}
+
+void
+up_rcu_register_reader(unsigned lcore)
+{
+	if (lcore >= RTE_MAX_LCORE)
+		return;
+
+	up_rcu.reader[lcore].cnt = up_rcu.token;
+	rte_smp_wmb();
+	up_rcu.reader[lcore].registered = 1;
+}
+
+/**
+ * @brief  : Compute the token every registered reader has reached
+ * @param  : No param
+ * @return : Returns the oldest token reported by the readers
+ */
+static uint64_t
+up_rcu_min_reader_token(void)
+{
+	uint64_t min = up_rcu.token;
+	unsigned lcore;
+
+	for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+		if (!up_rcu.reader[lcore].registered)
+			continue;
+
+		if (up_rcu.reader[lcore].cnt < min)
+			min = up_rcu.reader[lcore].cnt;
+	}
+	rte_smp_rmb();
+	return min;
+}
+
+/**
+ * @brief  : Free the queued objects up to the given token, defer_lock held
+ * @param  : min, token reached by all the readers
+ * @return : Returns number of objects freed
+ */
+static uint32_t
+up_rcu_drain(uint64_t min)
+{
+	uint32_t freed = 0;
+
+	while (defer_tail != defer_head) {
+		struct up_rcu_defer_entry *ent =
+			&defer_q[defer_tail & (UP_RCU_DEFER_QUEUE_SZ - 1)];
+
+		if (ent->token > min)
+			break;
+
+		ent->free_fn(ent->obj);
+		ent->obj = NULL;
+		defer_tail++;
+		freed++;
+	}
+	return freed;
+}
+
+void
+up_rcu_defer_call(void *obj, void (*free_fn)(void *obj))
+{
+	uint32_t slot = 0;
+
+	if (obj == NULL)
+		return;
+
+	rte_spinlock_lock(&defer_lock);
+
+	if (defer_q == NULL) {
+		/* QSBR not yet initialized, no reader is running */
+		rte_spinlock_unlock(&defer_lock);
+		free_fn(obj);
+		return;
+	}
+
+	if ((defer_head - defer_tail) >= UP_RCU_DEFER_QUEUE_SZ) {
+		/* Queue full, wait for the oldest grace period to expire */
+		clLog(clSystemLog, eCLSeverityMinor,
+			LOG_FORMAT"QSBR defer queue full, waiting for readers\n",
+			LOG_VALUE);
+		while (up_rcu_drain(up_rcu_min_reader_token()) == 0)
+			rte_pause();
+	}
+
+	/* Make the unlink visible before starting the new grace period */
+	rte_smp_mb();
+	slot = defer_head & (UP_RCU_DEFER_QUEUE_SZ - 1);
+	defer_q[slot].obj = obj;
+	defer_q[slot].free_fn = free_fn;
+	defer_q[slot].token = ++up_rcu.token;
+	defer_head++;
+
+	rte_spinlock_unlock(&defer_lock);
+}
+
+void
+up_rcu_defer_free(void *obj)
+{
+	up_rcu_defer_call(obj, rte_free);
+}
+
+uint32_t
+up_rcu_reclaim(void)
+{
+	uint32_t freed = 0;
+
+	if (defer_tail == defer_head)
+		return 0;
+
+	if (!rte_spinlock_trylock(&defer_lock))
+		return 0;
+
+	freed = up_rcu_drain(up_rcu_min_reader_token());
+
+	rte_spinlock_unlock(&defer_lock);
+	return freed;
+}
+
+void
+up_sess_tbl_write_begin(void)
+{
+	rte_spinlock_lock(&sess_tbl_lock);
+	up_rcu.sess_tbl_seq++;
+	rte_smp_wmb();
+}
+
+void
+up_sess_tbl_write_end(void)
+{
+	rte_smp_wmb();
+	up_rcu.sess_tbl_seq++;
+	rte_spinlock_unlock(&sess_tbl_lock);
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_RCU_H_
+#define _UP_RCU_H_
+/**
+ * @file
+ * This file contains the quiescent state based reclamation (QSBR) used to
+ * share the session tables between the iface core (writer) and the
+ * UL/DL/mct cores (readers).
+ *
+ * Readers never take a lock. Every reader lcore reports a quiescent state
+ * once per polling loop, i.e. at a point where it holds no reference to
+ * any session/PDR/FAR/QER/URR object. The writer unlinks an object and
+ * hands it to up_rcu_defer_free(); the memory is returned to the heap only
+ * after every registered reader has passed a quiescent state.
+ *
+ * rte_hash in DPDK 18.02 is not safe for a concurrent writer, so the
+ * sess_by_teid_hash and sess_by_ueip_hash updates are additionally
+ * bracketed by a sequence counter. Readers retry the lookup when the
+ * counter changed under them.
+ */
+#include <stdint.h>
+#include <rte_pause.h>
+#include <rte_atomic.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_branch_prediction.h>
+
+/* Max number of objects waiting for a grace period */
+#define UP_RCU_DEFER_QUEUE_SZ	(1 << 16)
+
+/* Number of times a reader retries a table lookup racing with an update */
+#define UP_SESS_TBL_READ_RETRY	8
+
+/* Reader counter value of an unregistered/offline lcore */
+#define UP_RCU_OFFLINE		0
+
+/**
+ * @brief  : Per lcore reader state, one cache line each
+ */
+struct up_rcu_reader {
+	volatile uint64_t cnt;
+	uint8_t registered;
+} __rte_cache_aligned;
+
+/**
+ * @brief  : QSBR state shared by the writer and the readers
+ */
+struct up_rcu_state {
+	/* Grace period token, bumped for every deferred object */
+	volatile uint64_t token;
+	/* Sequence counter of the session tables, odd while updating */
+	volatile uint32_t sess_tbl_seq;
+	struct up_rcu_reader reader[RTE_MAX_LCORE];
+} __rte_cache_aligned;
+
+extern struct up_rcu_state up_rcu;
+
+/**
+ * @brief  : Initialize the QSBR state and the deferred free queue
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+up_rcu_init(void);
+
+/**
+ * @brief  : Register an lcore as session table reader
+ * @param  : lcore, lcore id of the reader
+ * @return : Returns nothing
+ */
+void
+up_rcu_register_reader(unsigned lcore);
+
+/**
+ * @brief  : Hand an object over to the QSBR, it is freed with rte_free
+ *           once all the readers have passed a quiescent state
+ * @param  : obj, object unlinked from all the reader visible structures
+ * @return : Returns nothing
+ */
+void
+up_rcu_defer_free(void *obj);
+
+/**
+ * @brief  : Hand an object over to the QSBR, it is released with free_fn
+ *           once all the readers have passed a quiescent state
+ * @param  : obj, object unlinked from all the reader visible structures
+ * @param  : free_fn, destructor of the object
+ * @return : Returns nothing
+ */
+void
+up_rcu_defer_call(void *obj, void (*free_fn)(void *obj));
+
+/**
+ * @brief  : Free the deferred objects whose grace period has expired,
+ *           never blocks
+ * @param  : No param
+ * @return : Returns number of objects freed
+ */
+uint32_t
+up_rcu_reclaim(void);
+
+/**
+ * @brief  : Report a quiescent state for the calling reader lcore, must
+ *           be called while the lcore holds no session table reference
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static inline void
+up_rcu_quiescent(void)
+{
+	struct up_rcu_reader *rd = &up_rcu.reader[rte_lcore_id()];
+
+	/* Order all the previous table reads before the report */
+	rte_smp_mb();
+	rd->cnt = up_rcu.token;
+}
+
+/**
+ * @brief  : Start a session table update, writers are serialized
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+up_sess_tbl_write_begin(void);
+
+/**
+ * @brief  : End a session table update
+ * @param  : No param
+ * @return : Returns nothing
+ */
+void
+up_sess_tbl_write_end(void);
+
+/**
+ * @brief  : Snapshot the session table sequence before a lookup
+ * @param  : No param
+ * @return : Returns sequence value, waits while an update is in progress
+ */
+static inline uint32_t
+up_sess_tbl_read_begin(void)
+{
+	uint32_t seq = up_rcu.sess_tbl_seq;
+	uint32_t spin = 0;
+
+	while (unlikely(seq & 1) && (++spin < UP_SESS_TBL_READ_RETRY * 64)) {
+		rte_pause();
+		seq = up_rcu.sess_tbl_seq;
+	}
+	rte_smp_rmb();
+	return seq;
+}
+
+/**
+ * @brief  : Check whether the lookup started at seq raced with an update
+ * @param  : seq, value returned by up_sess_tbl_read_begin
+ * @return : Returns 1 if the lookup has to be retried, 0 otherwise
+ */
+static inline int
+up_sess_tbl_read_retry(uint32_t seq)
+{
+	rte_smp_rmb();
+	return unlikely((seq & 1) || (seq != up_rcu.sess_tbl_seq));
+}
+
+#endif /* _UP_RCU_H_ */
@@ -18,6 +18,7 @@
 #define _GNU_SOURCE     /* Expose declaration of tdestroy() */
 #include "util.h"
 #include "up_acl.h"
+#include "up_rcu.h"
 
 extern struct rte_hash *sess_ctx_by_sessid_hash;
 extern struct rte_hash *sess_by_teid_hash;
@@ -30,12 +31,67 @@ extern struct rte_hash *timer_by_id_hash;
 extern struct rte_hash *qer_rule_hash;
 
 
+/**
+ * @brief  : Lookup the session table, retried when it raced with an update
+ *           on the iface core. A lookup that keeps racing is a miss.
+ * @param  : h, session hash table
+ * @param  : key, lookup key
+ * @param  : value, session data
+ * @return : Returns hash position on success, -ENOENT otherwise
+ */
+static inline int
+sess_tbl_lookup_data(struct rte_hash *h, const void *key, void **value)
+{
+	uint32_t seq = 0;
+	uint32_t retry = 0;
+	int ret = 0;
+
+	do {
+		seq = up_sess_tbl_read_begin();
+		ret = rte_hash_lookup_data(h, key, value);
+		if (!up_sess_tbl_read_retry(seq))
+			return ret;
+	} while (++retry < UP_SESS_TBL_READ_RETRY);
+
+	*value = NULL;
+	return -ENOENT;
+}
+
+/**
+ * @brief  : Bulk lookup the session table, retried when it raced with an
+ *           update on the iface core. A lookup that keeps racing is a miss.
+ * @param  : h, session hash table
+ * @param  : key, lookup keys
+ * @param  : n, number of keys
+ * @param  : hit_mask, bitmask of the keys found
+ * @param  : value, session data
+ * @return : Returns number of keys found
+ */
+static inline int
+sess_tbl_lookup_bulk_data(struct rte_hash *h, const void **key, uint32_t n,
+		uint64_t *hit_mask, void **value)
+{
+	uint32_t seq = 0;
+	uint32_t retry = 0;
+	int ret = 0;
+
+	do {
+		seq = up_sess_tbl_read_begin();
+		ret = rte_hash_lookup_bulk_data(h, key, n, hit_mask, value);
+		if (!up_sess_tbl_read_retry(seq))
+			return ret;
+	} while (++retry < UP_SESS_TBL_READ_RETRY);
+
+	*hit_mask = 0;
+	return 0;
+}
+
 /* Retrive the Session information based on teid */
 int
 iface_lookup_uplink_data(struct ul_bm_key *key,
 		void **value)
 {
-	return rte_hash_lookup_data(sess_by_teid_hash, key, value);
+	return sess_tbl_lookup_data(sess_by_teid_hash, key, value);
 }
 
 /* Retrive the Session information based on teid */
@@ -43,7 +99,7 @@ int
 iface_lookup_uplink_bulk_data(const void **key, uint32_t n,
 		uint64_t *hit_mask, void **value)
 {
-	return rte_hash_lookup_bulk_data(sess_by_teid_hash, key, n, hit_mask, value);
+	return sess_tbl_lookup_bulk_data(sess_by_teid_hash, key, n, hit_mask, value);
 }
 
 /* Retrive the Session information based on UE IP */
@@ -51,7 +107,7 @@ int
 iface_lookup_downlink_data(struct dl_bm_key *key,
 		void **value)
 {
-	return rte_hash_lookup_data(sess_by_ueip_hash, key, value);
+	return sess_tbl_lookup_data(sess_by_ueip_hash, key, value);
 }
 
 /* Retrive the Session information based on UE IP */
@@ -59,7 +115,5 @@ int
 iface_lookup_downlink_bulk_data(const void **key, uint32_t n,
 		uint64_t *hit_mask, void **value)
 {
-	return rte_hash_lookup_bulk_data(sess_by_ueip_hash, key, n, hit_mask, value);
+	return sess_tbl_lookup_bulk_data(sess_by_ueip_hash, key, n, hit_mask, value);
 }
-
-
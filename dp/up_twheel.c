@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "up_main.h"
+#include "up_twheel.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+LIST_HEAD(up_tw_list, up_tw_timer);
+
+/**
+ * @brief  : Timing wheel
+ */
+struct up_tw {
+	struct up_tw_list slot[UP_TW_LEVELS][UP_TW_SLOTS];
+	/* Last processed tick */
+	uint64_t tick;
+	/* TSC of the last processed tick */
+	uint64_t tick_tsc;
+	/* TSC cycles per tick */
+	uint64_t tsc_per_tick;
+	/* Number of running timers */
+	uint32_t count;
+};
+
+static struct up_tw tw;
+
+/**
+ * @brief  : Link the timer in the slot of its expiry tick
+ * @param  : tmr, timer
+ * @return : Returns nothing
+ */
+static void
+tw_add(struct up_tw_timer *tmr)
+{
+	uint8_t level = 0;
+	uint64_t delta = 0;
+
+	/* Cascaded on its expiry tick, expired right after the cascade */
+	if (tmr->expire < tw.tick)
+		tmr->expire = tw.tick;
+
+	delta = tmr->expire - tw.tick;
+	if (delta >= (1ULL << (UP_TW_BITS * UP_TW_LEVELS))) {
+		delta = (1ULL << (UP_TW_BITS * UP_TW_LEVELS)) - 1;
+		tmr->expire = tw.tick + delta;
+	}
+
+	while ((level < UP_TW_LEVELS - 1) &&
+			(delta >= (1ULL << (UP_TW_BITS * (level + 1)))))
+		level++;
+
+	LIST_INSERT_HEAD(&tw.slot[level][(tmr->expire >> (UP_TW_BITS * level)) &
+			UP_TW_MASK], tmr, link);
+}
+
+/**
+ * @brief  : Move the timers of a slot to the lower levels
+ * @param  : level, level of the slot
+ * @param  : idx, slot index
+ * @return : Returns nothing
+ */
+static void
+tw_cascade(uint8_t level, uint32_t idx)
+{
+	struct up_tw_timer *tmr = NULL;
+	struct up_tw_list *slot = &tw.slot[level][idx];
+
+	/* Never linked back in the same slot, the expiry is within a slot of
+	 * the level below */
+	while ((tmr = LIST_FIRST(slot)) != NULL) {
+		LIST_REMOVE(tmr, link);
+		tw_add(tmr);
+	}
+}
+
+/**
+ * @brief  : Process the next tick
+ * @param  : No param
+ * @return : Returns number of expired timers
+ */
+static uint32_t
+tw_tick(void)
+{
+	uint8_t level = 0;
+	uint32_t expired = 0;
+	uint64_t tick = ++tw.tick;
+	struct up_tw_timer *tmr = NULL;
+	struct up_tw_list *slot = NULL;
+
+	for (level = 1; level < UP_TW_LEVELS; level++) {
+		if (tick & ((1ULL << (UP_TW_BITS * level)) - 1))
+			break;
+		tw_cascade(level, (tick >> (UP_TW_BITS * level)) & UP_TW_MASK);
+	}
+
+	/* The callback may stop any timer, even one of this slot */
+	slot = &tw.slot[0][tick & UP_TW_MASK];
+	while ((tmr = LIST_FIRST(slot)) != NULL) {
+		LIST_REMOVE(tmr, link);
+		if (tmr->period) {
+			tmr->expire = tick + tmr->period;
+			tw_add(tmr);
+		} else {
+			tmr->pending = 0;
+			tw.count--;
+		}
+
+		tmr->cb(tmr, tmr->arg);
+		expired++;
+	}
+
+	return expired;
+}
+
+int
+up_tw_init(void)
+{
+	uint8_t level = 0;
+	uint32_t idx = 0;
+
+	tw.tsc_per_tick = (rte_get_tsc_hz() * UP_TW_TICK_MS) / 1000;
+	if (tw.tsc_per_tick == 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"TSC frequency unknown, timing wheel not started\n",
+			LOG_VALUE);
+		return -1;
+	}
+
+	for (level = 0; level < UP_TW_LEVELS; level++) {
+		for (idx = 0; idx < UP_TW_SLOTS; idx++)
+			LIST_INIT(&tw.slot[level][idx]);
+	}
+
+	tw.tick = 0;
+	tw.count = 0;
+	tw.tick_tsc = rte_rdtsc();
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"Timing wheel of %u levels x %u slots, tick %u msec\n",
+		LOG_VALUE, UP_TW_LEVELS, UP_TW_SLOTS, UP_TW_TICK_MS);
+
+	return 0;
+}
+
+void
+up_tw_start(struct up_tw_timer *tmr, uint32_t ms, uint32_t period_ms,
+		up_tw_cb cb, void *arg)
+{
+	up_tw_stop(tmr);
+
+	tmr->cb = cb;
+	tmr->arg = arg;
+	tmr->period = period_ms ? RTE_MAX(period_ms / UP_TW_TICK_MS, 1U) : 0;
+	tmr->expire = tw.tick + RTE_MAX(ms / UP_TW_TICK_MS, 1U);
+	tmr->pending = 1;
+	tw.count++;
+
+	tw_add(tmr);
+}
+
+void
+up_tw_stop(struct up_tw_timer *tmr)
+{
+	if (!tmr->pending)
+		return;
+
+	LIST_REMOVE(tmr, link);
+	tmr->pending = 0;
+	tw.count--;
+}
+
+uint32_t
+up_tw_run(void)
+{
+	uint32_t expired = 0;
+	uint64_t tsc = rte_rdtsc();
+
+	if (tw.tsc_per_tick == 0)
+		return 0;
+
+	while ((tsc - tw.tick_tsc) >= tw.tsc_per_tick) {
+		tw.tick_tsc += tw.tsc_per_tick;
+		expired += tw_tick();
+	}
+
+	if (expired) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"Timing wheel tick %lu, %u timers expired, %u running\n",
+			LOG_VALUE, tw.tick, expired, tw.count);
+	}
+
+	return expired;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_TWHEEL_H_
+#define _UP_TWHEEL_H_
+/**
+ * @file
+ * This file contains the hierarchical timing wheel of the session timers.
+ *
+ * The wheel has UP_TW_LEVELS levels of UP_TW_SLOTS slots, a level slot
+ * covers all the slots of the level below. A timer is linked in the slot
+ * of its expiry tick at the lowest level that reaches it and moves down a
+ * level each time the level below wraps, so starting and stopping a timer
+ * are O(1) and a tick only walks the timers expiring on it.
+ *
+ * The wheel is driven by the iface core from the TSC; timers are only
+ * started, stopped and expired on the iface core, no lock is taken.
+ */
+#include <stdint.h>
+#include <sys/queue.h>
+
+/* Tick of the wheel, in msec */
+#define UP_TW_TICK_MS		10
+
+/* Slots per level, 2^UP_TW_BITS */
+#define UP_TW_BITS		8
+#define UP_TW_SLOTS		(1 << UP_TW_BITS)
+#define UP_TW_MASK		(UP_TW_SLOTS - 1)
+
+/* Levels, the wheel covers 2^32 ticks */
+#define UP_TW_LEVELS		4
+
+struct up_tw_timer;
+
+/**
+ * @brief  : Timer expiry callback, the timer may be stopped or restarted
+ * @param  : tmr, expired timer
+ * @param  : arg, timer argument
+ * @return : Returns nothing
+ */
+typedef void (*up_tw_cb)(struct up_tw_timer *tmr, void *arg);
+
+/**
+ * @brief  : Timer, embedded in its owner
+ */
+struct up_tw_timer {
+	LIST_ENTRY(up_tw_timer) link;
+	/* Expiry tick */
+	uint64_t expire;
+	/* Period in ticks, 0 for a one shot timer */
+	uint32_t period;
+	/* Set while linked in the wheel */
+	uint8_t pending;
+	up_tw_cb cb;
+	void *arg;
+};
+
+/**
+ * @brief  : Start the wheel clock
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+up_tw_init(void);
+
+/**
+ * @brief  : Start or restart a timer
+ * @param  : tmr, timer
+ * @param  : ms, time to the first expiry in msec
+ * @param  : period_ms, period in msec, 0 for a one shot timer
+ * @param  : cb, expiry callback
+ * @param  : arg, callback argument
+ * @return : Returns nothing
+ */
+void
+up_tw_start(struct up_tw_timer *tmr, uint32_t ms, uint32_t period_ms,
+		up_tw_cb cb, void *arg);
+
+/**
+ * @brief  : Stop a timer, nothing is done if it is not running
+ * @param  : tmr, timer
+ * @return : Returns nothing
+ */
+void
+up_tw_stop(struct up_tw_timer *tmr);
+
+/**
+ * @brief  : Move the wheel to the current tick and expire the timers of
+ *           the elapsed ticks, iface core
+ * @param  : No param
+ * @return : Returns number of expired timers
+ */
+uint32_t
+up_tw_run(void);
+
+#endif /* _UP_TWHEEL_H_ */
@@ -0,0 +1,625 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <rte_ring.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+
+#include "up_main.h"
+#include "up_rcu.h"
+#include "up_urr.h"
+#include "pfcp_up_sess.h"
+#include "gw_adapter.h"
+
+extern int clSystemLog;
+
+uint8_t urr_usage_slot[RTE_MAX_LCORE];
+uint8_t urr_usage_shared_slot;
+
+/* Number of counter lines of a URR */
+static uint32_t nb_slots = 1;
+
+/* Error bound of the volume thresholds, in bytes */
+static uint64_t vol_err = URR_VOL_ERR_DFLT;
+
+/* Fold requests of the workers and time reports, drained by the iface core */
+static struct rte_ring *urr_req_ring;
+
+/* Request type, in the low bit of the queued counters pointer */
+#define URR_REQ_FOLD		0x0
+#define URR_REQ_TIME		0x1
+#define URR_REQ(u, type)	((void *)((uintptr_t)(u) | (type)))
+#define URR_REQ_TYPE(req)	((uintptr_t)(req) & 0x1)
+#define URR_REQ_USAGE(req)	((struct urr_usage *)((uintptr_t)(req) & ~(uintptr_t)0x1))
+
+/* Ring fill above which the whole backlog is drained */
+#define URR_REQ_RING_HIWAT	(URR_REQ_RING_SZ / 2)
+
+/**
+ * @brief  : Report pending on the iface core
+ */
+struct urr_rpt {
+	struct urr_usage *u;
+	/* URR_USAGE_*_MASK of the reached volume thresholds */
+	uint8_t vol_mask;
+	/* Set when the time threshold expired */
+	uint8_t time;
+};
+
+/**
+ * @brief  : Back-pressure accounting of a worker
+ */
+struct urr_req_stats {
+	/* Fold requests retried on a full ring */
+	uint64_t fold_full;
+} __rte_cache_aligned;
+
+static struct urr_req_stats req_stats[RTE_MAX_LCORE];
+
+/* Time reports dropped on a full ring */
+static uint64_t time_req_drop;
+
+/* Session Report Requests sent and URRs they carried, iface core */
+static uint64_t rpt_sent;
+static uint64_t rpt_urrs;
+
+/**
+ * @brief  : Give the next counter line to the lcore, if it has none
+ * @param  : lcore, worker lcore
+ * @param  : slot, next free counter line
+ * @return : Returns nothing
+ */
+static void
+map_worker_slot(int lcore, uint8_t *slot)
+{
+	if ((lcore < 0) || (lcore >= RTE_MAX_LCORE) ||
+			(urr_usage_slot[lcore] != UINT8_MAX))
+		return;
+
+	urr_usage_slot[lcore] = (*slot)++;
+}
+
+int
+urr_usage_init(uint32_t err)
+{
+	unsigned wk = 0;
+	unsigned lcore = 0;
+	uint8_t slot = 0;
+
+	memset(urr_usage_slot, UINT8_MAX, sizeof(urr_usage_slot));
+
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++)
+		map_worker_slot(epc_app.core_ul[wk], &slot);
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++)
+		map_worker_slot(epc_app.core_dl[wk], &slot);
+
+	urr_usage_shared_slot = slot;
+	nb_slots = slot + 1;
+	for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++) {
+		if (urr_usage_slot[lcore] == UINT8_MAX)
+			urr_usage_slot[lcore] = urr_usage_shared_slot;
+	}
+
+	vol_err = (err != 0) ? err : URR_VOL_ERR_DFLT;
+
+	urr_req_ring = rte_ring_create("URR_REQ_RING", URR_REQ_RING_SZ,
+			rte_socket_id(), RING_F_SC_DEQ);
+	if (urr_req_ring == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create URR request ring, Error: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	clLog(clSystemLog, eCLSeverityInfo,
+		LOG_FORMAT"URR usage counters: %u lines per URR, volume error "
+		"bound %lu bytes\n", LOG_VALUE, nb_slots, vol_err);
+
+	return 0;
+}
+
+/**
+ * @brief  : Sum the counter lines into the URR, lock held
+ * @param  : u, URR counters
+ * @return : Returns nothing
+ */
+static void
+fold_locked(struct urr_usage *u)
+{
+	uint32_t s = 0;
+	uint8_t dir = 0;
+	uint32_t epoch = u->epoch;
+	uint32_t first = 0;
+	uint32_t last = 0;
+	urr_info_t *urr = u->urr;
+
+	for (dir = 0; dir < URR_USAGE_DIR_MAX; dir++)
+		u->sum[dir] = 0;
+
+	for (s = 0; s < nb_slots; s++) {
+		struct urr_usage_cnt *c = &u->cnt[s];
+
+		for (dir = 0; dir < URR_USAGE_DIR_MAX; dir++)
+			u->sum[dir] += c->vol[dir];
+
+		/* No packet of the line in the current report period */
+		if (c->epoch != epoch)
+			continue;
+
+		if ((first == 0) || (c->first_pkt_time < first))
+			first = c->first_pkt_time;
+		if (c->last_pkt_time > last)
+			last = c->last_pkt_time;
+	}
+
+	urr->uplnk_data = u->sum[URR_USAGE_UL] - u->base[URR_USAGE_UL];
+	urr->dwnlnk_data = u->sum[URR_USAGE_DL] - u->base[URR_USAGE_DL];
+	urr->first_pkt_time = first;
+	urr->last_pkt_time = last;
+}
+
+/**
+ * @brief  : Get the volume threshold of the direction
+ * @param  : urr, urr information
+ * @param  : dir, URR_USAGE_UL or URR_USAGE_DL
+ * @return : Returns threshold in bytes, 0 if none applies
+ */
+static uint64_t
+vol_thes(urr_info_t *urr, uint8_t dir)
+{
+	if ((urr->rept_trigg != VOL_BASED) && (urr->rept_trigg != VOL_TIME_BASED))
+		return 0;
+
+	return (dir == URR_USAGE_UL) ? urr->vol_thes_uplnk : urr->vol_thes_dwnlnk;
+}
+
+/**
+ * @brief  : Set the check points of the lines from the volume left before
+ *           the thresholds, lock held
+ * @param  : u, URR counters
+ * @return : Returns nothing
+ */
+static void
+arm_locked(struct urr_usage *u)
+{
+	uint32_t s = 0;
+	uint8_t dir = 0;
+
+	for (dir = 0; dir < URR_USAGE_DIR_MAX; dir++) {
+		uint64_t thes = vol_thes(u->urr, dir);
+		uint64_t used = u->sum[dir] - u->base[dir];
+		uint64_t step = 0;
+
+		if (thes == 0) {
+			for (s = 0; s < nb_slots; s++)
+				u->cnt[s].chk[dir] = UINT64_MAX;
+			continue;
+		}
+
+		/* All the lines at their check point is the threshold, the
+		 * error bound keeps the steps from shrinking to a packet */
+		step = (thes > used) ? (thes - used) / nb_slots : 0;
+		step = RTE_MAX(step, RTE_MAX(vol_err / nb_slots, (uint64_t)1));
+
+		for (s = 0; s < nb_slots; s++)
+			u->cnt[s].chk[dir] = u->cnt[s].vol[dir] + step;
+	}
+}
+
+/**
+ * @brief  : Restart the usage of the directions from the last fold and
+ *           re-arm the check points, lock held
+ * @param  : u, URR counters
+ * @param  : dir_mask, URR_USAGE_*_MASK of the volumes to restart
+ * @return : Returns nothing
+ */
+static void
+reset_locked(struct urr_usage *u, uint8_t dir_mask)
+{
+	uint8_t dir = 0;
+	urr_info_t *urr = u->urr;
+
+	for (dir = 0; dir < URR_USAGE_DIR_MAX; dir++) {
+		if (dir_mask & (1 << dir))
+			u->base[dir] = u->sum[dir];
+	}
+
+	/* Packet times of the lines restart on their next packet */
+	u->epoch++;
+
+	urr->uplnk_data = u->sum[URR_USAGE_UL] - u->base[URR_USAGE_UL];
+	urr->dwnlnk_data = u->sum[URR_USAGE_DL] - u->base[URR_USAGE_DL];
+	urr->first_pkt_time = 0;
+	urr->last_pkt_time = 0;
+
+	arm_locked(u);
+}
+
+int
+urr_usage_alloc(urr_info_t *urr, uint64_t cp_seid, uint64_t up_seid)
+{
+	struct urr_usage *u = NULL;
+
+	if (urr == NULL)
+		return -1;
+
+	u = urr->usage;
+	if (u == NULL) {
+		u = rte_zmalloc("URR_USAGE", sizeof(struct urr_usage) +
+				nb_slots * sizeof(struct urr_usage_cnt),
+				RTE_CACHE_LINE_SIZE);
+		if (u == NULL) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to allocate memory for URR usage "
+				"counters, URR_ID:%u, Error: %s\n", LOG_VALUE,
+				urr->urr_id, rte_strerror(rte_errno));
+			return -1;
+		}
+		u->urr = urr;
+		u->epoch = 1;
+		rte_spinlock_init(&u->lock);
+	}
+
+	u->cp_seid = cp_seid;
+	u->up_seid = up_seid;
+
+	rte_spinlock_lock(&u->lock);
+	fold_locked(u);
+	reset_locked(u, URR_USAGE_ALL_MASK);
+	rte_spinlock_unlock(&u->lock);
+
+	/* Publish the armed counters before the UL/DL cores can pick them up */
+	rte_smp_wmb();
+	urr->usage = u;
+
+	return 0;
+}
+
+/**
+ * @brief  : Free the counters once the workers are done with them, after
+ *           the fold requests queued before
+ * @param  : obj, URR counters
+ * @return : Returns nothing
+ */
+static void
+urr_usage_retire(void *obj)
+{
+	/* Requests of the URR are all queued, the URR is dead, skip them */
+	if (urr_req_ring != NULL)
+		urr_usage_process(rte_ring_count(urr_req_ring));
+
+	rte_free(obj);
+}
+
+void
+urr_usage_free(urr_info_t *urr)
+{
+	struct urr_usage *u = NULL;
+
+	if ((urr == NULL) || (urr->usage == NULL))
+		return;
+
+	u = urr->usage;
+	up_tw_stop(&u->time_tmr);
+	urr->usage = NULL;
+	u->dead = 1;
+
+	up_rcu_defer_call(u, urr_usage_retire);
+}
+
+void
+urr_usage_fold(urr_info_t *urr)
+{
+	struct urr_usage *u = NULL;
+
+	if ((urr == NULL) || (urr->usage == NULL))
+		return;
+
+	u = urr->usage;
+	rte_spinlock_lock(&u->lock);
+	fold_locked(u);
+	rte_spinlock_unlock(&u->lock);
+}
+
+void
+urr_usage_reset(urr_info_t *urr, uint8_t dir_mask)
+{
+	struct urr_usage *u = NULL;
+
+	if ((urr == NULL) || (urr->usage == NULL))
+		return;
+
+	u = urr->usage;
+	rte_spinlock_lock(&u->lock);
+	reset_locked(u, dir_mask);
+	rte_spinlock_unlock(&u->lock);
+}
+
+void
+urr_usage_fold_req(struct urr_usage *u, struct urr_usage_cnt *c, uint8_t dir)
+{
+	uint64_t chk = c->chk[dir];
+	unsigned lcore = rte_lcore_id();
+
+	/* One request in flight per line and direction */
+	c->chk[dir] = UINT64_MAX;
+	rte_smp_wmb();
+
+	/* Ring full, retried on the next packet */
+	if (rte_ring_mp_enqueue(urr_req_ring, URR_REQ(u, URR_REQ_FOLD)) != 0) {
+		c->chk[dir] = chk;
+		if (lcore < RTE_MAX_LCORE)
+			req_stats[lcore].fold_full++;
+	}
+}
+
+/**
+ * @brief  : Queue the time threshold report of the URR, timing wheel
+ *           callback on the iface core
+ * @param  : tmr, time threshold timer of the URR
+ * @param  : arg, URR counters
+ * @return : Returns nothing
+ */
+static void
+time_expired(struct up_tw_timer *tmr, void *arg)
+{
+	struct urr_usage *u = (struct urr_usage *)arg;
+	urr_info_t *urr = u->urr;
+
+	if ((urr->meas_method != TIME_BASED) && (urr->meas_method != VOL_TIME_BASED)) {
+		/* No duration to report */
+		up_tw_stop(tmr);
+		return;
+	}
+
+	if (rte_ring_mp_enqueue(urr_req_ring, URR_REQ(u, URR_REQ_TIME)) == 0)
+		return;
+
+	/* Ring full, this core is its consumer: make room and retry */
+	urr_usage_process(URR_FOLD_BURST);
+	if (rte_ring_mp_enqueue(urr_req_ring, URR_REQ(u, URR_REQ_TIME)) != 0) {
+		time_req_drop++;
+		clLog(clSystemLog, eCLSeverityMinor,
+			LOG_FORMAT"URR_ID:%u, URR request ring full, time threshold "
+			"report dropped\n", LOG_VALUE, urr->urr_id);
+	}
+}
+
+int
+urr_usage_time_start(urr_info_t *urr)
+{
+	struct urr_usage *u = NULL;
+
+	if ((urr == NULL) || (urr->usage == NULL) || (urr->time_thes == 0))
+		return -1;
+
+	u = urr->usage;
+	up_tw_start(&u->time_tmr, urr->time_thes * 1000, urr->time_thes * 1000,
+			time_expired, u);
+
+	return 0;
+}
+
+void
+urr_usage_time_stop(urr_info_t *urr)
+{
+	if ((urr == NULL) || (urr->usage == NULL))
+		return;
+
+	up_tw_stop(&urr->usage->time_tmr);
+}
+
+/**
+ * @brief  : Fold the counters of a request, re-arm the check points when
+ *           no volume threshold is reached
+ * @param  : u, URR counters
+ * @return : Returns URR_USAGE_*_MASK of the reached volume thresholds
+ */
+static uint8_t
+fold_check(struct urr_usage *u)
+{
+	uint8_t dir = 0;
+	uint8_t mask = 0;
+	urr_info_t *urr = u->urr;
+
+	rte_spinlock_lock(&u->lock);
+	fold_locked(u);
+	for (dir = 0; dir < URR_USAGE_DIR_MAX; dir++) {
+		uint64_t thes = vol_thes(urr, dir);
+
+		if (thes && ((u->sum[dir] - u->base[dir]) >= thes))
+			mask |= (1 << dir);
+	}
+	if (!mask)
+		arm_locked(u);
+	rte_spinlock_unlock(&u->lock);
+
+	if (mask) {
+		clLog(clSystemLog, eCLSeverityDebug,
+			LOG_FORMAT"URR_ID:%u, %s%sVolume threshold reached, UL:%lu DL:%lu bytes\n",
+			LOG_VALUE, urr->urr_id, (mask & URR_USAGE_UL_MASK) ? "Uplink " : "",
+			(mask & URR_USAGE_DL_MASK) ? "Downlink " : "",
+			urr->uplnk_data, urr->dwnlnk_data);
+	}
+
+	return mask;
+}
+
+/**
+ * @brief  : Get the pending report of the URR, a new one if it has none
+ * @param  : rpt, pending reports
+ * @param  : nb_rpt, number of pending reports
+ * @param  : u, URR counters
+ * @return : Returns pending report of the URR
+ */
+static struct urr_rpt *
+get_rpt(struct urr_rpt *rpt, uint32_t *nb_rpt, struct urr_usage *u)
+{
+	uint32_t i = 0;
+
+	for (i = 0; i < *nb_rpt; i++) {
+		if (rpt[i].u == u)
+			return &rpt[i];
+	}
+
+	rpt[i].u = u;
+	rpt[i].vol_mask = 0;
+	rpt[i].time = 0;
+	(*nb_rpt)++;
+	return &rpt[i];
+}
+
+/**
+ * @brief  : Send the pending reports, one Session Report Request carries
+ *           the URRs of one session
+ * @param  : rpt, pending reports, consumed
+ * @param  : nb_rpt, number of pending reports
+ * @return : Returns nothing
+ */
+static void
+send_reports(struct urr_rpt *rpt, uint32_t nb_rpt)
+{
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint8_t k = 0;
+
+	for (i = 0; i < nb_rpt; i++) {
+		uint8_t cnt = 0;
+		uint64_t cp_seid = 0;
+		uint64_t up_seid = 0;
+		uint32_t trig[URR_RPT_BATCH_MAX];
+		urr_info_t *urr[URR_RPT_BATCH_MAX];
+		struct urr_rpt *batch[URR_RPT_BATCH_MAX];
+
+		if (rpt[i].u == NULL)
+			continue;
+
+		cp_seid = rpt[i].u->cp_seid;
+		up_seid = rpt[i].u->up_seid;
+
+		for (j = i; (j < nb_rpt) && (cnt < URR_RPT_BATCH_MAX); j++) {
+			if ((rpt[j].u == NULL) || (rpt[j].u->up_seid != up_seid))
+				continue;
+
+			urr[cnt] = rpt[j].u->urr;
+			if (rpt[j].vol_mask && rpt[j].time)
+				trig[cnt] = VOL_TIME_BASED;
+			else if (rpt[j].vol_mask)
+				trig[cnt] = VOL_BASED;
+			else
+				trig[cnt] = TIME_BASED;
+			batch[cnt++] = &rpt[j];
+		}
+
+		if (send_usage_report_req(urr, trig, cnt, cp_seid, up_seid) != 0) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to Send Usage Report Request, "
+				"UP_SEID:%lu\n", LOG_VALUE, up_seid);
+		}
+		rpt_sent++;
+		rpt_urrs += cnt;
+
+		for (k = 0; k < cnt; k++) {
+			/* Reset the reported volume directions */
+			if (batch[k]->vol_mask)
+				urr_usage_reset(urr[k], batch[k]->vol_mask);
+			batch[k]->u = NULL;
+		}
+	}
+}
+
+/**
+ * @brief  : Account the request ring backlog, the iface core drains the
+ *           whole backlog above the high watermark
+ * @param  : max, number of requests the caller asked for
+ * @return : Returns number of requests to handle
+ */
+static uint32_t
+req_backlog(uint32_t max)
+{
+	static uint8_t backlog;
+	uint32_t pending = rte_ring_count(urr_req_ring);
+	uint64_t fold_full = 0;
+	unsigned lcore = 0;
+
+	if (pending <= URR_REQ_RING_HIWAT) {
+		backlog = 0;
+		return max;
+	}
+
+	if (!backlog) {
+		backlog = 1;
+		for (lcore = 0; lcore < RTE_MAX_LCORE; lcore++)
+			fold_full += req_stats[lcore].fold_full;
+
+		clLog(clSystemLog, eCLSeverityMinor,
+			LOG_FORMAT"URR request ring backlog of %u, fold retries:%lu, "
+			"time reports dropped:%lu, reports sent:%lu for %lu URRs\n",
+			LOG_VALUE, pending, fold_full,
+			time_req_drop, rpt_sent, rpt_urrs);
+	}
+
+	return RTE_MAX(max, pending);
+}
+
+uint32_t
+urr_usage_process(uint32_t max)
+{
+	uint32_t i = 0;
+	uint32_t n = 0;
+	uint32_t done = 0;
+	uint32_t nb_rpt = 0;
+	void *reqs[URR_FOLD_BURST];
+	struct urr_rpt rpt[URR_FOLD_BURST];
+
+	if (urr_req_ring == NULL)
+		return 0;
+
+	max = req_backlog(max);
+
+	while (done < max) {
+		n = rte_ring_sc_dequeue_burst(urr_req_ring, reqs,
+				RTE_MIN((uint32_t)URR_FOLD_BURST, max - done), NULL);
+		if (n == 0)
+			break;
+
+		nb_rpt = 0;
+		for (i = 0; i < n; i++) {
+			uint8_t mask = 0;
+			struct urr_usage *u = URR_REQ_USAGE(reqs[i]);
+
+			/* URR deleted after the request was queued */
+			if (u->dead)
+				continue;
+
+			if (URR_REQ_TYPE(reqs[i]) == URR_REQ_TIME) {
+				get_rpt(rpt, &nb_rpt, u)->time = 1;
+				continue;
+			}
+
+			mask = fold_check(u);
+			if (mask)
+				get_rpt(rpt, &nb_rpt, u)->vol_mask |= mask;
+		}
+
+		send_reports(rpt, nb_rpt);
+		done += n;
+	}
+
+	return done;
+}
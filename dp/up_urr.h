@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _UP_URR_H_
+#define _UP_URR_H_
+/**
+ * @file
+ * This file contains the URR usage counting of the dataplane.
+ *
+ * Every URR gets one cache line of 64-bit counters per worker lcore, a
+ * worker only writes its own line. The counters are summed ("folded") into
+ * the URR by the iface core, when a report is built or when a worker
+ * crosses its check point. Check points split the volume left before the
+ * threshold between the workers, so the threshold is detected when it is
+ * reached, but never closer than the configured error bound: a smaller
+ * bound means more folds on the iface core.
+ *
+ * Counters only grow, a report resets the URR usage by moving the base the
+ * counters are measured from.
+ *
+ * Usage reports are only encoded and sent by the iface core: the volume
+ * thresholds found by the folds and the time thresholds expired on the
+ * timing wheel are sent as one Session Report Request per session. A
+ * worker hitting a full request ring retries on its next packet, a time
+ * report is dropped; both are accounted and the iface core drains the
+ * whole backlog when the ring fills up.
+ */
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_spinlock.h>
+#include <rte_branch_prediction.h>
+
+#include "up_twheel.h"
+
+/* Usage direction index */
+#define URR_USAGE_UL		0
+#define URR_USAGE_DL		1
+#define URR_USAGE_DIR_MAX	2
+
+/* Direction masks of urr_usage_reset */
+#define URR_USAGE_UL_MASK	(1 << URR_USAGE_UL)
+#define URR_USAGE_DL_MASK	(1 << URR_USAGE_DL)
+#define URR_USAGE_ALL_MASK	(URR_USAGE_UL_MASK | URR_USAGE_DL_MASK)
+
+/* Default error bound of the volume thresholds, in bytes */
+#define URR_VOL_ERR_DFLT	(64 * 1024)
+
+/* Size of the request ring from the workers and the timer thread */
+#define URR_REQ_RING_SZ		4096
+
+/* Max number of requests handled per iface loop */
+#define URR_FOLD_BURST		32
+
+/* Max number of URRs carried by one Session Report Request */
+#define URR_RPT_BATCH_MAX	8
+
+struct urr_info_t;
+
+/**
+ * @brief  : Usage counted by one lcore
+ */
+struct urr_usage_cnt {
+	/* Bytes counted since the URR creation */
+	volatile uint64_t vol[URR_USAGE_DIR_MAX];
+	/* Volume at which a fold is requested, UINT64_MAX when disarmed */
+	volatile uint64_t chk[URR_USAGE_DIR_MAX];
+	/* Report period of the packet times */
+	volatile uint32_t epoch;
+	volatile uint32_t first_pkt_time;
+	volatile uint32_t last_pkt_time;
+} __rte_cache_aligned;
+
+/**
+ * @brief  : Usage counters of a URR
+ */
+struct urr_usage {
+	struct urr_info_t *urr;
+	uint64_t cp_seid;
+	uint64_t up_seid;
+	/* Current report period, bumped on every report */
+	volatile uint32_t epoch;
+	/* Set when the URR is deleted, pending fold requests are ignored */
+	volatile uint8_t dead;
+
+	/* Fold state, iface core */
+	rte_spinlock_t lock __rte_cache_aligned;
+	/* Counter sum at the last report */
+	uint64_t base[URR_USAGE_DIR_MAX];
+	/* Counter sum at the last fold */
+	uint64_t sum[URR_USAGE_DIR_MAX];
+	/* Time threshold timer, on the timing wheel */
+	struct up_tw_timer time_tmr;
+
+	struct urr_usage_cnt cnt[] __rte_cache_aligned;
+};
+
+/* Counter line of every lcore, the last line is shared by non-worker lcores */
+extern uint8_t urr_usage_slot[RTE_MAX_LCORE];
+extern uint8_t urr_usage_shared_slot;
+
+/**
+ * @brief  : Create the request ring and map the worker lcores to their
+ *           counter line
+ * @param  : vol_err, error bound of the volume thresholds in bytes, 0 for
+ *           the default
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+urr_usage_init(uint32_t vol_err);
+
+/**
+ * @brief  : Allocate the counters of the URR, or re-arm them on a URR
+ *           update; the usage restarts from 0
+ * @param  : urr, urr information
+ * @param  : cp_seid, CP session ID of the URR
+ * @param  : up_seid, UP session ID of the URR
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+urr_usage_alloc(struct urr_info_t *urr, uint64_t cp_seid, uint64_t up_seid);
+
+/**
+ * @brief  : Release the counters of the URR through the QSBR
+ * @param  : urr, urr information
+ * @return : Returns nothing
+ */
+void
+urr_usage_free(struct urr_info_t *urr);
+
+/**
+ * @brief  : Sum the counters into the volume and packet times of the URR
+ * @param  : urr, urr information
+ * @return : Returns nothing
+ */
+void
+urr_usage_fold(struct urr_info_t *urr);
+
+/**
+ * @brief  : Restart the usage after a report, the packet times always
+ *           restart
+ * @param  : urr, urr information
+ * @param  : dir_mask, URR_USAGE_*_MASK of the volumes to restart
+ * @return : Returns nothing
+ */
+void
+urr_usage_reset(struct urr_info_t *urr, uint8_t dir_mask);
+
+/**
+ * @brief  : Start the periodic time threshold timer of the URR
+ * @param  : urr, urr information
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+urr_usage_time_start(struct urr_info_t *urr);
+
+/**
+ * @brief  : Stop the time threshold timer of the URR
+ * @param  : urr, urr information
+ * @return : Returns nothing
+ */
+void
+urr_usage_time_stop(struct urr_info_t *urr);
+
+/**
+ * @brief  : Handle the fold requests of the workers and the time reports,
+ *           send the reports of the reached thresholds, iface core
+ * @param  : max, max number of requests handled
+ * @return : Returns number of requests handled
+ */
+uint32_t
+urr_usage_process(uint32_t max);
+
+/**
+ * @brief  : Queue a fold request for the iface core, worker check point hit
+ * @param  : u, URR counters
+ * @param  : c, counter line of the worker
+ * @param  : dir, URR_USAGE_UL or URR_USAGE_DL
+ * @return : Returns nothing
+ */
+void
+urr_usage_fold_req(struct urr_usage *u, struct urr_usage_cnt *c, uint8_t dir);
+
+/**
+ * @brief  : Count a packet on the counter line of the calling lcore
+ * @param  : u, URR counters
+ * @param  : dir, URR_USAGE_UL or URR_USAGE_DL
+ * @param  : len, user data length of the packet
+ * @param  : now, NTP timestamp of the packet
+ * @return : Returns nothing
+ */
+static inline void
+urr_usage_count(struct urr_usage *u, uint8_t dir, uint32_t len, uint32_t now)
+{
+	unsigned lcore = rte_lcore_id();
+	uint8_t slot = (lcore < RTE_MAX_LCORE) ?
+		urr_usage_slot[lcore] : urr_usage_shared_slot;
+	struct urr_usage_cnt *c = &u->cnt[slot];
+	uint32_t epoch = u->epoch;
+
+	if (unlikely(c->epoch != epoch)) {
+		c->first_pkt_time = now;
+		c->epoch = epoch;
+	}
+	c->last_pkt_time = now;
+
+	if (likely(slot != urr_usage_shared_slot))
+		c->vol[dir] += len;
+	else
+		__sync_fetch_and_add(&c->vol[dir], len);
+
+	if (unlikely(c->vol[dir] >= c->chk[dir]))
+		urr_usage_fold_req(u, c, dir);
+}
+
+#endif /* _UP_URR_H_ */
@@ -38,15 +38,7 @@ construct_udp_hdr(struct rte_mbuf *m, uint16_t len,
 	udp_hdr->dst_port = htons(dport);
 	udp_hdr->dgram_len = htons(len);
 
-	/* update Udp checksum */
+	/* Set by up_csum_ipv4_udp/up_csum_ipv6_udp, in software or by
+	 * the NIC */
 	udp_hdr->dgram_cksum = 0;
-	if (ip_type) {
-		struct ipv6_hdr *ipv6_hdr;
-		ipv6_hdr = get_mtoip_v6(m);
-		udp_hdr->dgram_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, udp_hdr);
-	} else {
-		struct ipv4_hdr *ipv4_hdr;
-		ipv4_hdr = get_mtoip(m);
-		udp_hdr->dgram_cksum = rte_ipv4_udptcp_cksum(ipv4_hdr, udp_hdr);
-	}
 }
@@ -138,7 +138,8 @@ static inline struct udp_hdr *get_mtoudp_v6(struct rte_mbuf *m)
 }
 
 /**
- * @brief  : Function to construct udp header.
+ * @brief  : Function to construct udp header, the checksum is left to
+ *           the caller.
  * @param  : m, mbuf pointer
  * @param  : len, len of header
  * @param  : sport, src port
@@ -140,6 +140,30 @@ int get_request_timeout_value(char **response, int request_timeout);
  */
 int get_perf_flag_json_resp(char **response, int perf_flag);
 /* Function */
+/**
+ * @brief: get log level json resp
+ * @param: response
+ * @param: log level value
+ * @return: sucess code
+ */
+int get_log_level_json_resp(char **response, int log_level);
+/* Function */
+/**
+ * @brief: get stage profiler json resp
+ * @param: response
+ * @param: stage profiler percentiles
+ * @return: sucess code
+ */
+int get_stage_prof_json_resp(char **response, prof_stats_t *prof_stats);
+/* Function */
+/**
+ * @brief: get LI export stats json resp
+ * @param: response
+ * @param: LI export target counters
+ * @return: sucess code
+ */
+int get_li_export_stats_json_resp(char **response, li_export_stats_t *li_stats);
+/* Function */
 /**
  * @brief: get request tries value
  * @param: json value
@@ -180,6 +204,22 @@ int get_transmit_timer_value_in_seconds(const char *json, char **response);
  */
 int get_perf_flag_value_in_int(const char *json, char **response);
 /* Function */
+/**
+ * @brief: get log level value
+ * @param: json value
+ * @param: response
+ * @return: log level value, -1 if missing
+ */
+int get_log_level_value_in_int(const char *json, char **response);
+/* Function */
+/**
+ * @brief: get stage profiler sample period value
+ * @param: json value
+ * @param: response
+ * @return: sample period in bursts, -1 if missing
+ */
+int get_sample_period_value_in_int(const char *json, char **response);
+/* Function */
 /**
  * @brief: get  periodic value
  * @param: json value
@@ -36,6 +36,8 @@ extern "C" {
 #define TRUE                         (1)
 #define PERF_ON						 (1)
 #define PERF_OFF					 (0)
+/* Logger ids with a runtime severity threshold */
+#define CL_MAX_LOGID                 (8)
 #define __file__ (strrchr(__FILE__, '/') ? strrchr(__FILE__, '/') + 1 : __FILE__)
 #define LOG_FORMAT "%s:%s:%d:"
 #define LOG_VALUE __file__, __func__, __LINE__
@@ -109,6 +111,57 @@ int8_t init_log_module(const char *name);
  */
 void clLog(const int logid, enum CLoggerSeverity sev, const char *fmt, ...);
 
+/* Lowest severity written per logger id, eCLogLevelDebug by default */
+extern volatile uint8_t cl_log_level[CL_MAX_LOGID];
+
+/**
+ * @brief  : Check the severity against the threshold of the logger
+ * @param  : logid, logid
+ * @param  : sev, Severity of logging
+ * @return : Returns true if the message is written, false otherwise
+ */
+static inline bool
+clLogEnabled(const int logid, enum CLoggerSeverity sev)
+{
+	return ((unsigned int)logid >= CL_MAX_LOGID) ||
+		((uint8_t)sev >= cl_log_level[logid]);
+}
+
+/* Messages below the threshold cost a compare: the arguments of the
+ * call are not evaluated and nothing is formatted */
+#define clLog(logid, sev, ...) \
+	(clLogEnabled((logid), (sev)) ? (clLog)((logid), (sev), __VA_ARGS__) : (void)0)
+
+/* Function */
+/**
+ * @brief  : Set the severity threshold of a logger
+ * @param  : logid, logid
+ * @param  : level, lowest level written, eCLogLevelOff for none
+ * @return : Returns nothing
+ */
+void clSetLogLevel(const int logid, enum CLoggerLogLevel level);
+
+/* Function */
+/**
+ * @brief  : Get the severity threshold of a logger
+ * @param  : logid, logid
+ * @return : Returns lowest level written
+ */
+enum CLoggerLogLevel clGetLogLevel(const int logid);
+
+/* Function */
+/**
+ * @brief  : Start the log ring: clLog only copies the format pointer and
+ *           the raw arguments into the ring, a background thread formats
+ *           and writes them. Messages are written synchronously when the
+ *           ring is not started, and when their arguments do not fit in a
+ *           record. Messages below eCLSeverityCritical are dropped and
+ *           counted when the ring is full.
+ * @param  : size, number of records, rounded up to a power of 2
+ * @return : Returns 0 on success else -1
+ */
+int8_t clLogRingInit(uint32_t size);
+
 /* Function */
 /**
  * @brief  : init rest framework
@@ -327,6 +380,51 @@ int get_rto(const char *request_body, char **response_body);
  */
 int get_pf(const char *request_body, char **response_body);
 
+/* Function */
+/**
+ * @brief  : get log level
+ * @param  : request_body, http request body
+ * @param  : response_body, http response body
+ * @return : Returns status code
+ */
+int get_log_level(const char *request_body, char **response_body);
+
+/* Function */
+/**
+ * @brief  : post log level
+ * @param  : request_body, http request body
+ * @param  : response_body, http response body
+ * @return : Returns status code
+ */
+int post_log_level(const char *request_body, char **response_body);
+
+/* Function */
+/**
+ * @brief  : get stage profiler percentiles
+ * @param  : request_body, http request body
+ * @param  : response_body, http response body
+ * @return : Returns status code
+ */
+int get_stage_prof(const char *request_body, char **response_body);
+
+/* Function */
+/**
+ * @brief  : post stage profiler sample period
+ * @param  : request_body, http request body
+ * @param  : response_body, http response body
+ * @return : Returns status code
+ */
+int post_stage_prof(const char *request_body, char **response_body);
+
+/* Function */
+/**
+ * @brief  : get LI export target counters
+ * @param  : request_body, http request body
+ * @param  : response_body, http response body
+ * @return : Returns status code
+ */
+int get_li_export_stats(const char *request_body, char **response_body);
+
 /* Function */
 /**
  * @brief  : get generate pcap status
@@ -64,6 +64,13 @@
 #define GX_MSG_TYPE_LEN               8
 #define SYSTEM_MSG_TYPE_LEN           4
 #define HEALTH_STATS_SIZE             2
+/* Directions, stages and name length of the DP stage profiler */
+#define PROF_DIR_MAX                  2
+#define PROF_STAGE_MAX                7
+#define PROF_NAME_LEN                16
+/* Targets and name length of the DP LI exporter */
+#define LI_EXP_STATS_TARGETS          2
+#define LI_EXP_STATS_NAME_LEN        16
 
 #define MAX_NUM_GW_MESSAGES         256
 #define MAX_INTERFACE_NAME_LEN       10
@@ -407,6 +414,55 @@ typedef struct {
 
 } dp_configuration_t;
 
+/**
+ * @brief  : Percentiles of a profiled DP stage, in nsec
+ */
+typedef struct prof_stage_stats_t {
+	char name[PROF_NAME_LEN];
+	uint64_t samples;
+	uint64_t mean_ns;
+	uint64_t p50_ns;
+	uint64_t p90_ns;
+	uint64_t p99_ns;
+	uint64_t p999_ns;
+	uint64_t max_ns;
+} prof_stage_stats_t;
+
+/**
+ * @brief  : Maintains the DP stage profiler statistics
+ */
+typedef struct {
+	uint32_t sample_period;
+	char dir_name[PROF_DIR_MAX][PROF_NAME_LEN];
+	prof_stage_stats_t stage[PROF_DIR_MAX][PROF_STAGE_MAX];
+} prof_stats_t;
+
+/**
+ * @brief  : Counters of a DP LI export target, a DDF connection
+ */
+typedef struct li_export_target_stats_t {
+	char name[LI_EXP_STATS_NAME_LEN];
+	uint8_t configured;
+	/* 0 down, 1 connecting, 2 up */
+	uint8_t state;
+	uint64_t records;
+	uint64_t bytes;
+	uint64_t acked;
+	uint64_t writes;
+	uint64_t partial;
+	uint64_t connects;
+	uint64_t disconnects;
+	uint32_t backlog;
+	uint32_t unacked;
+} li_export_target_stats_t;
+
+/**
+ * @brief  : Maintains the DP LI exporter statistics
+ */
+typedef struct {
+	li_export_target_stats_t target[LI_EXP_STATS_TARGETS];
+} li_export_stats_t;
+
 typedef struct li_df_config_t {
 
 	/* Identifier */
@@ -464,6 +520,9 @@ typedef struct gw_adapter_callback_register {
 	int8_t (*add_ue_entry)(li_df_config_t*, uint16_t);
 	int8_t (*update_ue_entry)(li_df_config_t*, uint16_t);
 	uint8_t (*delete_ue_entry)(uint64_t*, uint16_t);
+	int8_t (*update_prof_period)(const int);
+	int8_t (*get_prof_stats)(prof_stats_t*);
+	int8_t (*get_li_export_stats)(li_export_stats_t*);
 } gw_adapter_callback_register;
 
 
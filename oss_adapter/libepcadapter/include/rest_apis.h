@@ -13,6 +13,9 @@
 #define GET_PCAP_STATUS_URI "/generate_pcap"
 #define GET_STAT_ALL_URI "/statliveall"
 #define GET_PERF_FLAG_URI "/perf_flag"
+#define GET_LOG_LEVEL_URI "/log_level"
+#define GET_STAGE_PROF_URI "/stage_prof"
+#define GET_LI_EXPORT_STATS_URI "/li_export_stats"
 #define GET_RESET_STATS_URI "/reset_stats"
 #define GET_STAT_FREQUENCY_URI "/statfreq"
 #define GET_CONFIG_LIVE_URI "/configlive"
@@ -397,6 +400,91 @@ class RestPerfFlagPost : public EManagementHandler
 
 };
 
+class RestLogLevelGet : public EManagementHandler
+{
+	private:
+		CRestCallback m_cb;
+	public:
+		RestLogLevelGet(ELogger &audit);
+
+		void registerHandler();
+
+		virtual Void process(const Pistache::Http::Request& request,
+					Pistache::Http::ResponseWriter &response);
+
+		void registerCallback(CRestCallback cb) { m_cb = cb;};
+		virtual ~RestLogLevelGet() {}
+
+};
+
+class RestLogLevelPost : public EManagementHandler
+{
+	private:
+		CRestCallback m_cb;
+	public:
+		RestLogLevelPost(ELogger &audit);
+
+		void registerHandler();
+
+		virtual Void process(const Pistache::Http::Request& request,
+					Pistache::Http::ResponseWriter &response);
+
+		void registerCallback(CRestCallback cb) { m_cb = cb;};
+		virtual ~RestLogLevelPost() {}
+
+};
+
+class RestStageProfGet : public EManagementHandler
+{
+	private:
+		CRestCallback m_cb;
+	public:
+		RestStageProfGet(ELogger &audit);
+
+		void registerHandler();
+
+		virtual Void process(const Pistache::Http::Request& request,
+					Pistache::Http::ResponseWriter &response);
+
+		void registerCallback(CRestCallback cb) { m_cb = cb;};
+		virtual ~RestStageProfGet() {}
+
+};
+
+class RestStageProfPost : public EManagementHandler
+{
+	private:
+		CRestCallback m_cb;
+	public:
+		RestStageProfPost(ELogger &audit);
+
+		void registerHandler();
+
+		virtual Void process(const Pistache::Http::Request& request,
+					Pistache::Http::ResponseWriter &response);
+
+		void registerCallback(CRestCallback cb) { m_cb = cb;};
+		virtual ~RestStageProfPost() {}
+
+};
+
+class RestLiExportStatsGet : public EManagementHandler
+{
+	private:
+		CRestCallback m_cb;
+	public:
+		RestLiExportStatsGet(ELogger &audit);
+
+		void registerHandler();
+
+		virtual Void process(const Pistache::Http::Request& request,
+					Pistache::Http::ResponseWriter &response);
+
+		void registerCallback(CRestCallback cb) { m_cb = cb;};
+		virtual ~RestLiExportStatsGet() {}
+
+};
+
 class RestUEDetailsPost : public EManagementHandler
 {
 	private:
@@ -152,6 +152,92 @@ int get_perf_flag_json_resp(char **response, int perf_flag)
 	return REST_SUCESSS;
 }
 
+int get_log_level_json_resp(char **response, int log_level)
+{
+	std::string res = "{\"log_level\": " + std::to_string(log_level) + "}";
+	*response = strdup(res.c_str());
+	return REST_SUCESSS;
+}
+
+int get_stage_prof_json_resp(char **response, prof_stats_t *prof_stats)
+{
+	std::string json;
+	statsrapidjson::Document document;
+	document.SetObject();
+	statsrapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+
+	document.AddMember("sample_period", prof_stats->sample_period, allocator);
+
+	for (int dir = 0; dir < PROF_DIR_MAX; dir++) {
+		statsrapidjson::Value stages(statsrapidjson::kObjectType);
+
+		for (int stage = 0; stage < PROF_STAGE_MAX; stage++) {
+			prof_stage_stats_t *st = &prof_stats->stage[dir][stage];
+			statsrapidjson::Value value(statsrapidjson::kObjectType);
+
+			value.AddMember("samples", st->samples, allocator);
+			value.AddMember("mean_ns", st->mean_ns, allocator);
+			value.AddMember("p50_ns", st->p50_ns, allocator);
+			value.AddMember("p90_ns", st->p90_ns, allocator);
+			value.AddMember("p99_ns", st->p99_ns, allocator);
+			value.AddMember("p999_ns", st->p999_ns, allocator);
+			value.AddMember("max_ns", st->max_ns, allocator);
+			stages.AddMember(statsrapidjson::Value(st->name, allocator).Move(),
+					value, allocator);
+		}
+
+		document.AddMember(statsrapidjson::Value(prof_stats->dir_name[dir], allocator).Move(),
+				stages, allocator);
+	}
+
+	statsrapidjson::StringBuffer strbuf;
+	statsrapidjson::Writer<statsrapidjson::StringBuffer> writer(strbuf);
+	document.Accept(writer);
+	json = strbuf.GetString();
+	*response = strdup(json.c_str());
+
+	return REST_SUCESSS;
+}
+
+int get_li_export_stats_json_resp(char **response, li_export_stats_t *li_stats)
+{
+	std::string json;
+	statsrapidjson::Document document;
+	document.SetObject();
+	statsrapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+	static const char * const state[] = { "down", "connecting", "up" };
+
+	for (int tgt = 0; tgt < LI_EXP_STATS_TARGETS; tgt++) {
+		li_export_target_stats_t *ts = &li_stats->target[tgt];
+		statsrapidjson::Value value(statsrapidjson::kObjectType);
+
+		if (!ts->configured)
+			continue;
+
+		value.AddMember("state", statsrapidjson::StringRef(
+				state[ts->state < 3 ? ts->state : 0]), allocator);
+		value.AddMember("records", ts->records, allocator);
+		value.AddMember("bytes", ts->bytes, allocator);
+		value.AddMember("acked", ts->acked, allocator);
+		value.AddMember("writes", ts->writes, allocator);
+		value.AddMember("partial_writes", ts->partial, allocator);
+		value.AddMember("connects", ts->connects, allocator);
+		value.AddMember("disconnects", ts->disconnects, allocator);
+		value.AddMember("backlog", ts->backlog, allocator);
+		value.AddMember("unacked", ts->unacked, allocator);
+		document.AddMember(statsrapidjson::Value(ts->name, allocator).Move(),
+				value, allocator);
+	}
+
+	statsrapidjson::StringBuffer strbuf;
+	statsrapidjson::Writer<statsrapidjson::StringBuffer> writer(strbuf);
+	document.Accept(writer);
+	json = strbuf.GetString();
+	*response = strdup(json.c_str());
+
+	return REST_SUCESSS;
+}
+
 int csGetInterval(char **response)
 {
 	std::string res = "{\"statfreq\": " + std::to_string(CStats::singleton().getInterval()) + "}";
@@ -331,6 +417,30 @@ int get_perf_flag_value_in_int(const char *json, char **response)
 	return perf_flag_value;
 }
 
+int get_log_level_value_in_int(const char *json, char **response)
+{
+
+	statsrapidjson::Document doc;
+	doc.Parse(json);
+
+	if (!doc.HasMember("log_level") || !doc["log_level"].IsUint())
+		return -1;
+
+	return doc["log_level"].GetUint();
+}
+
+int get_sample_period_value_in_int(const char *json, char **response)
+{
+
+	statsrapidjson::Document doc;
+	doc.Parse(json);
+
+	if (!doc.HasMember("sample_period") || !doc["sample_period"].IsUint())
+		return -1;
+
+	return doc["sample_period"].GetUint();
+}
+
 int get_transmit_timer_value_in_seconds(const char *json, char **response)
 {
 
@@ -15,6 +15,13 @@
  */
 
 #include <stdarg.h>
+#include <ctype.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <atomic>
+#include <algorithm>
+#include <new>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -61,23 +68,436 @@ int8_t init_log_module(const char *filename)
 	return 0;
 }
 
-void clLog(const int logid, enum CLoggerSeverity sev, const char *fmt, ...)
+/* Size of a log ring record and of its argument area */
+#define CL_RING_REC_SIZE             (512)
+#define CL_RING_ARGS_SIZE            (CL_RING_REC_SIZE - 32)
+/* Sleep of the log ring thread when the ring is empty, in usec */
+#define CL_RING_IDLE_USEC            (1000)
+
+volatile uint8_t cl_log_level[CL_MAX_LOGID] = {0};
+
+/**
+ * @brief  : Log ring record, the arguments are stored in the order of the
+ *           conversions: integers as int64_t, doubles, long doubles and
+ *           pointers as is, strings copied with their terminating null
+ */
+struct cl_ring_rec {
+	/* Ring position the record is ready for */
+	std::atomic<uint64_t> seq;
+	const char *fmt;
+	int32_t logid;
+	uint16_t sev;
+	uint16_t len;
+	uint8_t args[CL_RING_ARGS_SIZE];
+};
+
+/**
+ * @brief  : Multi producer, single consumer log ring
+ */
+struct cl_ring {
+	struct cl_ring_rec *rec;
+	uint64_t mask;
+	std::atomic<uint64_t> head;
+	uint64_t tail;
+	std::atomic<uint64_t> drops;
+	pthread_t thread;
+};
+
+static struct cl_ring cl_ring;
+
+/**
+ * @brief  : Write a formatted message on the logger
+ * @param  : logid, logid
+ * @param  : sev, Severity of logging
+ * @param  : msg, formatted message
+ * @return : Returns nothing
+ */
+static void cl_log_write(const int logid, enum CLoggerSeverity sev, const char *msg)
+{
+	switch (sev)
+	{
+		case eCLSeverityDebug:   { ELogger::log(logid).info(msg);     break;  }
+		case eCLSeverityInfo:    { ELogger::log(logid).startup(msg);  break;  }
+		case eCLSeverityStartup: { ELogger::log(logid).debug(msg);    break;  }
+		case eCLSeverityMinor:   { ELogger::log(logid).minor(msg);    break;  }
+		case eCLSeverityMajor:   { ELogger::log(logid).major(msg);    break;  }
+		case eCLSeverityCritical:{ ELogger::log(logid).critical(msg); break;  }
+	}
+}
+
+/* Type of the argument of a conversion */
+enum cl_arg_type {
+	CL_ARG_NONE,
+	CL_ARG_INT,
+	CL_ARG_DOUBLE,
+	CL_ARG_LDOUBLE,
+	CL_ARG_PTR,
+	CL_ARG_STR,
+	CL_ARG_BAD
+};
+
+/**
+ * @brief  : Parse the conversion starting after a '%'
+ * @param  : p, conversion, moved past its last character
+ * @param  : stars, number of '*' width and precision arguments
+ * @param  : lmod, number of 'l' length modifiers, 2 for 'L'
+ * @return : Returns the type of the argument
+ */
+static enum cl_arg_type cl_fmt_conv(const char **p, uint8_t *stars, uint8_t *lmod)
+{
+	const char *c = *p;
+
+	*stars = 0;
+	*lmod = 0;
+	while (*c && strchr("-+ #0", *c))
+		c++;
+	for (; *c && (isdigit((unsigned char)*c) || *c == '.' || *c == '*'); c++) {
+		if (*c == '*')
+			(*stars)++;
+	}
+	for (; *c && strchr("hlLqjzt", *c); c++) {
+		if (*c == 'l' || *c == 'q' || *c == 'j' || *c == 'z' || *c == 't')
+			(*lmod)++;
+		else if (*c == 'L')
+			*lmod = 2;
+	}
+
+	*p = *c ? c + 1 : c;
+	switch (*c) {
+		case '%': return CL_ARG_NONE;
+		case 'd': case 'i': case 'u': case 'o':
+		case 'x': case 'X': case 'c': return CL_ARG_INT;
+		case 'f': case 'F': case 'e': case 'E':
+		case 'g': case 'G': case 'a': case 'A':
+			return (*lmod == 2) ? CL_ARG_LDOUBLE : CL_ARG_DOUBLE;
+		case 'p': return CL_ARG_PTR;
+		case 's': return (*lmod) ? CL_ARG_BAD : CL_ARG_STR;
+		default: return CL_ARG_BAD;
+	}
+}
+
+/**
+ * @brief  : Copy the raw arguments of the format into the record
+ * @param  : rec, record
+ * @param  : fmt, format
+ * @param  : args, arguments
+ * @return : Returns 0 on success, -1 if an argument is not supported or
+ *           the arguments do not fit
+ */
+static int cl_ring_capture(struct cl_ring_rec *rec, const char *fmt, va_list args)
+{
+	uint8_t *pos = rec->args;
+	uint8_t *end = rec->args + CL_RING_ARGS_SIZE;
+	const char *p = fmt;
+	uint8_t stars = 0, lmod = 0;
+
+#define CL_RING_PUT(type, val) do {					\
+		type v = (val);						\
+		if (pos + sizeof(v) > end)				\
+			return -1;					\
+		memcpy(pos, &v, sizeof(v));				\
+		pos += sizeof(v);					\
+	} while (0)
+
+	while ((p = strchr(p, '%')) != NULL) {
+		p++;
+		enum cl_arg_type type = cl_fmt_conv(&p, &stars, &lmod);
+		if (type == CL_ARG_BAD)
+			return -1;
+
+		for (; stars; stars--)
+			CL_RING_PUT(int, va_arg(args, int));
+
+		switch (type) {
+			case CL_ARG_INT:
+				if (lmod)
+					CL_RING_PUT(int64_t, va_arg(args, long long));
+				else
+					CL_RING_PUT(int64_t, va_arg(args, int));
+				break;
+			case CL_ARG_DOUBLE:
+				CL_RING_PUT(double, va_arg(args, double));
+				break;
+			case CL_ARG_LDOUBLE:
+				CL_RING_PUT(long double, va_arg(args, long double));
+				break;
+			case CL_ARG_PTR:
+				CL_RING_PUT(void *, va_arg(args, void *));
+				break;
+			case CL_ARG_STR: {
+				const char *str = va_arg(args, const char *);
+				size_t len = strlen(str ? str : "(null)") + 1;
+				if (pos + len > end)
+					return -1;
+				memcpy(pos, str ? str : "(null)", len);
+				pos += len;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+#undef CL_RING_PUT
+
+	rec->len = pos - rec->args;
+	return 0;
+}
+
+/**
+ * @brief  : Format the record, replaying its arguments conversion by
+ *           conversion
+ * @param  : rec, record
+ * @param  : buf, output buffer
+ * @param  : size, size of the output buffer
+ * @return : Returns nothing
+ */
+static void cl_ring_format(const struct cl_ring_rec *rec, char *buf, size_t size)
+{
+	const uint8_t *pos = rec->args;
+	const char *p = rec->fmt;
+	const char *conv = NULL;
+	char spec[64] = {0};
+	size_t off = 0;
+	uint8_t stars = 0, lmod = 0;
+	int star[2] = {0};
+
+#define CL_RING_GET(type) ({						\
+		type v;							\
+		memcpy(&v, pos, sizeof(v));				\
+		pos += sizeof(v);					\
+		v;							\
+	})
+#define CL_RING_OUT(...) do {						\
+		int n = 0;						\
+		if (stars == 2)						\
+			n = snprintf(buf + off, size - off, spec, star[0], star[1], __VA_ARGS__); \
+		else if (stars == 1)					\
+			n = snprintf(buf + off, size - off, spec, star[0], __VA_ARGS__); \
+		else							\
+			n = snprintf(buf + off, size - off, spec, __VA_ARGS__); \
+		if (n > 0)						\
+			off = std::min(off + n, size - 1);		\
+	} while (0)
+
+	buf[0] = '\0';
+	while (off < size - 1 && *p) {
+		const char *pct = strchr(p, '%');
+		size_t lit = pct ? (size_t)(pct - p) : strlen(p);
+
+		lit = std::min(lit, size - 1 - off);
+		memcpy(buf + off, p, lit);
+		off += lit;
+		buf[off] = '\0';
+		if (pct == NULL)
+			break;
+
+		conv = pct + 1;
+		enum cl_arg_type type = cl_fmt_conv(&conv, &stars, &lmod);
+		p = conv;
+		if (type == CL_ARG_NONE) {
+			if (off < size - 1) {
+				buf[off++] = '%';
+				buf[off] = '\0';
+			}
+			continue;
+		}
+
+		/* Checked by the producer, more than 2 stars are not valid */
+		if (stars > 2 || (size_t)(conv - pct) >= sizeof(spec))
+			break;
+		memcpy(spec, pct, conv - pct);
+		spec[conv - pct] = '\0';
+		for (uint8_t i = 0; i < stars; i++)
+			star[i] = CL_RING_GET(int);
+
+		switch (type) {
+			case CL_ARG_INT:
+				/* The length modifier of the format picks the width */
+				if (lmod)
+					CL_RING_OUT(CL_RING_GET(int64_t));
+				else
+					CL_RING_OUT((int)CL_RING_GET(int64_t));
+				break;
+			case CL_ARG_DOUBLE:
+				CL_RING_OUT(CL_RING_GET(double));
+				break;
+			case CL_ARG_LDOUBLE:
+				CL_RING_OUT(CL_RING_GET(long double));
+				break;
+			case CL_ARG_PTR:
+				CL_RING_OUT(CL_RING_GET(void *));
+				break;
+			case CL_ARG_STR: {
+				const char *str = (const char *)pos;
+				pos += strlen(str) + 1;
+				CL_RING_OUT(str);
+				break;
+			}
+			default:
+				break;
+		}
+	}
+#undef CL_RING_GET
+#undef CL_RING_OUT
+}
+
+/**
+ * @brief  : Queue the message in the log ring
+ * @param  : logid, logid
+ * @param  : sev, Severity of logging
+ * @param  : fmt, logger string params for printing
+ * @param  : args, arguments
+ * @return : Returns 0 if the message is queued or dropped, -1 if it has to
+ *           be written synchronously
+ */
+static int cl_ring_enqueue(const int logid, enum CLoggerSeverity sev,
+		const char *fmt, va_list args)
+{
+	uint64_t pos = cl_ring.head.load(std::memory_order_relaxed);
+	struct cl_ring_rec *rec = NULL;
+
+	for (;;) {
+		rec = &cl_ring.rec[pos & cl_ring.mask];
+		uint64_t seq = rec->seq.load(std::memory_order_acquire);
+		int64_t diff = (int64_t)seq - (int64_t)pos;
+
+		if (diff == 0) {
+			if (cl_ring.head.compare_exchange_weak(pos, pos + 1,
+					std::memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			/* Full, the critical messages are never lost */
+			if (sev == eCLSeverityCritical)
+				return -1;
+			cl_ring.drops.fetch_add(1, std::memory_order_relaxed);
+			return 0;
+		} else {
+			pos = cl_ring.head.load(std::memory_order_relaxed);
+		}
+	}
+
+	rec->logid = logid;
+	rec->sev = sev;
+	rec->fmt = fmt;
+	if (cl_ring_capture(rec, fmt, args) != 0) {
+		/* The slot is taken, released as an empty message */
+		rec->fmt = NULL;
+		rec->seq.store(pos + 1, std::memory_order_release);
+		return -1;
+	}
+
+	rec->seq.store(pos + 1, std::memory_order_release);
+	return 0;
+}
+
+/**
+ * @brief  : Log ring thread, formats and writes the queued messages
+ * @param  : arg, unused
+ * @return : Returns nothing
+ */
+static void *cl_ring_run(void *arg)
+{
+	char szBuff[2048] = {0};
+	uint64_t drops = 0;
+
+	for (;;) {
+		struct cl_ring_rec *rec = &cl_ring.rec[cl_ring.tail & cl_ring.mask];
+
+		if (rec->seq.load(std::memory_order_acquire) != cl_ring.tail + 1) {
+			uint64_t d = cl_ring.drops.load(std::memory_order_relaxed);
+			if (d != drops) {
+				snprintf(szBuff, sizeof(szBuff),
+					LOG_FORMAT"Log ring full, %lu messages dropped\n",
+					LOG_VALUE, (unsigned long)(d - drops));
+				cl_log_write(STANDARD_LOGID, eCLSeverityMajor, szBuff);
+				drops = d;
+			}
+			usleep(CL_RING_IDLE_USEC);
+			continue;
+		}
+
+		if (rec->fmt != NULL) {
+			cl_ring_format(rec, szBuff, sizeof(szBuff));
+			cl_log_write(rec->logid, (enum CLoggerSeverity)rec->sev, szBuff);
+		}
+
+		rec->seq.store(cl_ring.tail + cl_ring.mask + 1, std::memory_order_release);
+		cl_ring.tail++;
+	}
+
+	return NULL;
+}
+
+int8_t clLogRingInit(uint32_t size)
+{
+	uint64_t cnt = 1;
+
+	if (cl_ring.rec != NULL || size == 0)
+		return -1;
+
+	while (cnt < size)
+		cnt <<= 1;
+
+	cl_ring.rec = new (std::nothrow) cl_ring_rec[cnt];
+	if (cl_ring.rec == NULL)
+		return -1;
+
+	for (uint64_t i = 0; i < cnt; i++)
+		cl_ring.rec[i].seq.store(i, std::memory_order_relaxed);
+	cl_ring.mask = cnt - 1;
+	cl_ring.head.store(0);
+	cl_ring.tail = 0;
+	cl_ring.drops.store(0);
+
+	if (pthread_create(&cl_ring.thread, NULL, cl_ring_run, NULL) != 0) {
+		delete[] cl_ring.rec;
+		cl_ring.rec = NULL;
+		return -1;
+	}
+	pthread_setname_np(cl_ring.thread, "cl_log_ring");
+
+	char szBuff[128] = {0};
+	snprintf(szBuff, sizeof(szBuff), LOG_FORMAT"Log ring of %lu records started\n",
+		LOG_VALUE, (unsigned long)cnt);
+	cl_log_write(STANDARD_LOGID, eCLSeverityInfo, szBuff);
+	return 0;
+}
+
+void clSetLogLevel(const int logid, enum CLoggerLogLevel level)
 {
+	if ((unsigned int)logid < CL_MAX_LOGID)
+		cl_log_level[logid] = level;
+}
+
+enum CLoggerLogLevel clGetLogLevel(const int logid)
+{
+	if ((unsigned int)logid >= CL_MAX_LOGID)
+		return eCLogLevelDebug;
+
+	return (enum CLoggerLogLevel)cl_log_level[logid];
+}
+
+void (clLog)(const int logid, enum CLoggerSeverity sev, const char *fmt, ...)
+{
+	/* Callers built without the clLog macro */
+	if (!clLogEnabled(logid, sev)) return;
 	if(cli_node.cli_config.perf_flag && eCLSeverityCritical != sev) return;
 	char szBuff[2048] = {0};
 	va_list args;
 	va_start(args, fmt);
+	if (cl_ring.rec != NULL) {
+		va_list raw;
+		va_copy(raw, args);
+		int queued = cl_ring_enqueue(logid, sev, fmt, raw);
+		va_end(raw);
+		if (queued == 0) {
+			va_end(args);
+			return;
+		}
+	}
 	vsnprintf(szBuff, sizeof(szBuff), fmt, args);
 	va_end(args);
-	switch (sev)
-	{
-		case eCLSeverityDebug:   { ELogger::log(logid).info(szBuff);     break;  }
-		case eCLSeverityInfo:    { ELogger::log(logid).startup(szBuff);  break;  }
-		case eCLSeverityStartup: { ELogger::log(logid).debug(szBuff);    break;  }
-		case eCLSeverityMinor:   { ELogger::log(logid).minor(szBuff);    break;  }
-		case eCLSeverityMajor:   { ELogger::log(logid).major(szBuff);    break;  }
-		case eCLSeverityCritical:{ ELogger::log(logid).critical(szBuff); break;  }
-	}
+	cl_log_write(logid, sev, szBuff);
 }
 
 int8_t init_rest_framework(char *cli_rest_ip, uint16_t port)
@@ -156,6 +576,18 @@ int8_t init_rest_framework(char *cli_rest_ip, uint16_t port)
 	pPFGet->registerCallback(get_pf);
 	pRestHandle->registerHandler(*pPFGet);
 
+	RestLogLevelGet *pLLGet = new RestLogLevelGet(ELogger::log(STANDARD_LOGID));
+	pLLGet->registerCallback(get_log_level);
+	pRestHandle->registerHandler(*pLLGet);
+
+	RestStageProfGet *pSPGet = new RestStageProfGet(ELogger::log(STANDARD_LOGID));
+	pSPGet->registerCallback(get_stage_prof);
+	pRestHandle->registerHandler(*pSPGet);
+
+	RestLiExportStatsGet *pLEGet = new RestLiExportStatsGet(ELogger::log(STANDARD_LOGID));
+	pLEGet->registerCallback(get_li_export_stats);
+	pRestHandle->registerHandler(*pLEGet);
+
 	RestPeriodicTimerPost *pPTPost = new RestPeriodicTimerPost(ELogger::log(STANDARD_LOGID));
 	pPTPost->registerCallback(post_pt);
 	pRestHandle->registerHandler(*pPTPost);
@@ -197,6 +629,14 @@ int8_t init_rest_framework(char *cli_rest_ip, uint16_t port)
 	pPFPost->registerCallback(post_pf);
 	pRestHandle->registerHandler(*pPFPost);
 
+	RestLogLevelPost *pLLPost = new RestLogLevelPost(ELogger::log(STANDARD_LOGID));
+	pLLPost->registerCallback(post_log_level);
+	pRestHandle->registerHandler(*pLLPost);
+
+	RestStageProfPost *pSPPost = new RestStageProfPost(ELogger::log(STANDARD_LOGID));
+	pSPPost->registerCallback(post_stage_prof);
+	pRestHandle->registerHandler(*pSPPost);
+
 	RestUEDetailsPost *pAddUEPost = new RestUEDetailsPost(ELogger::log(STANDARD_LOGID));
 	pAddUEPost->registerCallback(add_ue_entry_details);
 	pRestHandle->registerHandler(*pAddUEPost);
@@ -960,6 +1400,93 @@ int get_pf(const char *request_body, char **response_body)
 	return get_perf_flag_json_resp(response_body, cli_node.cli_config.perf_flag);
 }
 
+int post_log_level(const char *request_body, char **response_body)
+{
+	clLog(STANDARD_LOGID, eCLSeverityInfo,
+		LOG_FORMAT"post_log_level() body=[%s]", LOG_VALUE, request_body);
+
+	int rest_code = check_valid_json(request_body, response_body);
+
+	if(rest_code == REST_FAIL)
+	{
+		return rest_code;
+	}
+
+	int log_level = get_log_level_value_in_int(request_body, response_body);
+
+	if ((log_level < eCLogLevelDebug) || (log_level > eCLogLevelOff)) {
+		return invalid_value_error_response(request_body, response_body);
+	}
+
+	clSetLogLevel(STANDARD_LOGID, (enum CLoggerLogLevel)log_level);
+
+	return get_log_level_json_resp(response_body, clGetLogLevel(STANDARD_LOGID));
+}
+
+int get_stage_prof(const char *request_body, char **response_body)
+{
+	prof_stats_t prof_stats;
+
+	clLog(STANDARD_LOGID, eCLSeverityInfo,
+		LOG_FORMAT"get_stage_prof() body=[%s]", LOG_VALUE, request_body);
+
+	if ((cli_node.cli_config.gw_adapter_callback_list.get_prof_stats == NULL) ||
+		((*cli_node.cli_config.gw_adapter_callback_list.get_prof_stats)(&prof_stats) != 0)) {
+		return resp_cmd_not_supported(get_gw_type(), response_body);
+	}
+
+	return get_stage_prof_json_resp(response_body, &prof_stats);
+}
+
+int get_li_export_stats(const char *request_body, char **response_body)
+{
+	li_export_stats_t li_stats;
+
+	clLog(STANDARD_LOGID, eCLSeverityInfo,
+		LOG_FORMAT"get_li_export_stats() body=[%s]", LOG_VALUE, request_body);
+
+	if ((cli_node.cli_config.gw_adapter_callback_list.get_li_export_stats == NULL) ||
+		((*cli_node.cli_config.gw_adapter_callback_list.get_li_export_stats)(&li_stats) != 0)) {
+		return resp_cmd_not_supported(get_gw_type(), response_body);
+	}
+
+	return get_li_export_stats_json_resp(response_body, &li_stats);
+}
+
+int post_stage_prof(const char *request_body, char **response_body)
+{
+	clLog(STANDARD_LOGID, eCLSeverityInfo,
+		LOG_FORMAT"post_stage_prof() body=[%s]", LOG_VALUE, request_body);
+
+	int rest_code = check_valid_json(request_body, response_body);
+
+	if(rest_code == REST_FAIL)
+	{
+		return rest_code;
+	}
+
+	int sample_period = get_sample_period_value_in_int(request_body, response_body);
+
+	if (sample_period < 0) {
+		return invalid_value_error_response(request_body, response_body);
+	}
+
+	if ((cli_node.cli_config.gw_adapter_callback_list.update_prof_period == NULL) ||
+		((*cli_node.cli_config.gw_adapter_callback_list.update_prof_period)(sample_period) != 0)) {
+		return resp_cmd_not_supported(get_gw_type(), response_body);
+	}
+
+	return get_stage_prof(request_body, response_body);
+}
+
+int get_log_level(const char *request_body, char **response_body)
+{
+	clLog(STANDARD_LOGID, eCLSeverityInfo,
+		LOG_FORMAT"get_log_level() body=[%s]", LOG_VALUE, request_body);
+
+	return get_log_level_json_resp(response_body, clGetLogLevel(STANDARD_LOGID));
+}
+
 int post_stat_logging(const char *request_body, char **response_body)
 {
 	clLog(STANDARD_LOGID, eCLSeverityInfo,
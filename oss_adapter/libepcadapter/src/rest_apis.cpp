@@ -332,6 +332,81 @@ RestPerfFlagPost::process(const Pistache::Http::Request& request,
 	free(res);
 }
 
+RestLogLevelGet::RestLogLevelGet(ELogger &audit)
+: EManagementHandler(EManagementHandler::HttpMethod::httpGet,
+			GET_LOG_LEVEL_URI, audit)
+{}
+
+void
+RestLogLevelGet::process(const Pistache::Http::Request& request,
+				Pistache::Http::ResponseWriter &response)
+{
+	char *res = (char *)malloc(RSP_LEN);
+	m_cb(request.body().c_str(), &res);
+	response.send(Pistache::Http::Code::Ok, res);
+	free(res);
+}
+
+RestLogLevelPost::RestLogLevelPost(ELogger &audit)
+: EManagementHandler(EManagementHandler::HttpMethod::httpPost,
+			GET_LOG_LEVEL_URI, audit)
+{}
+
+void
+RestLogLevelPost::process(const Pistache::Http::Request& request,
+				Pistache::Http::ResponseWriter &response)
+{
+	char *res = (char *)malloc(RSP_LEN);
+	m_cb(request.body().c_str(), &res);
+	response.send(Pistache::Http::Code::Ok, res);
+	free(res);
+}
+
+RestStageProfGet::RestStageProfGet(ELogger &audit)
+: EManagementHandler(EManagementHandler::HttpMethod::httpGet,
+			GET_STAGE_PROF_URI, audit)
+{}
+
+void
+RestStageProfGet::process(const Pistache::Http::Request& request,
+				Pistache::Http::ResponseWriter &response)
+{
+	char *res = (char *)malloc(RSP_LEN);
+	m_cb(request.body().c_str(), &res);
+	response.send(Pistache::Http::Code::Ok, res);
+	free(res);
+}
+
+RestStageProfPost::RestStageProfPost(ELogger &audit)
+: EManagementHandler(EManagementHandler::HttpMethod::httpPost,
+			GET_STAGE_PROF_URI, audit)
+{}
+
+void
+RestStageProfPost::process(const Pistache::Http::Request& request,
+				Pistache::Http::ResponseWriter &response)
+{
+	char *res = (char *)malloc(RSP_LEN);
+	m_cb(request.body().c_str(), &res);
+	response.send(Pistache::Http::Code::Ok, res);
+	free(res);
+}
+
+RestLiExportStatsGet::RestLiExportStatsGet(ELogger &audit)
+: EManagementHandler(EManagementHandler::HttpMethod::httpGet,
+			GET_LI_EXPORT_STATS_URI, audit)
+{}
+
+void
+RestLiExportStatsGet::process(const Pistache::Http::Request& request,
+				Pistache::Http::ResponseWriter &response)
+{
+	char *res = (char *)malloc(RSP_LEN);
+	m_cb(request.body().c_str(), &res);
+	response.send(Pistache::Http::Code::Ok, res);
+	free(res);
+}
+
 RestUEDetailsPost::RestUEDetailsPost(ELogger &audit)
 : EManagementHandler(EManagementHandler::HttpMethod::httpPost,
 			POST_UE_DETAILS_URI, audit)
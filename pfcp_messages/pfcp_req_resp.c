@@ -527,6 +527,14 @@ process_pfcp_msg(uint8_t *buf_rx, peer_addr_t *peer_addr, bool is_ipv6)
 				int offend_id = 0 ;
 				cause_check_sess_estab(&pfcp_session_request, &cause_id, &offend_id);
 
+				/* Reject and remove the session if one of its ACL tables
+				 * failed its last build */
+				sess = get_sess_info_entry(pfcp_session_response.up_fseid.seid, SESS_MODIFY);
+				if ((cause_id == REQUESTACCEPTED) && (up_sess_acl_check(sess) < 0)) {
+					cause_id = RULECREATION_MODIFICATIONFAILURE;
+					up_sess_estab_rollback(sess);
+				}
+
 				cli_cause = cause_id;
 
 				/*Filling Node ID for F-SEID*/
@@ -588,6 +596,9 @@ process_pfcp_msg(uint8_t *buf_rx, peer_addr_t *peer_addr, bool is_ipv6)
 				sess = get_sess_info_entry(pfcp_session_mod_req.header.seid_seqno.has_seid.seid, SESS_MODIFY);
 				if(sess == NULL) {
 					cause_id = SESSIONCONTEXTNOTFOUND;
+				} else if (up_sess_mod_acl_check(&pfcp_session_mod_req, sess) < 0) {
+					/* Reject before the change is applied */
+					cause_id = RULECREATION_MODIFICATIONFAILURE;
 				}
 
 				if ((sess != NULL) && (sess->li_sx_config_cnt > 0)) {
@@ -607,7 +618,8 @@ process_pfcp_msg(uint8_t *buf_rx, peer_addr_t *peer_addr, bool is_ipv6)
 				pfcp_sess_mod_res.header.seid_seqno.has_seid.seq_no =
 					pfcp_session_mod_req.header.seid_seqno.has_seid.seq_no;
 
-				if (process_up_session_modification_req(&pfcp_session_mod_req,
+				if ((cause_id != RULECREATION_MODIFICATIONFAILURE) &&
+						process_up_session_modification_req(&pfcp_session_mod_req,
 						&pfcp_sess_mod_res)) {
 					clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"Failure in proces "
 						"up session modification_req function\n", LOG_VALUE);
@@ -19,9 +19,15 @@
 #include "pfcp_enum.h"
 #include "pfcp_set_ie.h"
 #include "pfcp_up_llist.h"
+#include "up_rcu.h"
+#include "up_encap.h"
+#include "up_adj.h"
+#include "up_mtr.h"
+#include "up_ddn_buf.h"
+#include "up_urr.h"
 #include "pfcp_util.h"
 #include "pfcp_association.h"
-#include "li_interface.h"
+#include "up_li.h"
 #include "gw_adapter.h"
 #include "seid_llist.h"
 #include "pfcp_up_sess.h"
@@ -166,9 +172,9 @@ fill_peer_node_info_t(pfcp_session_t *sess, node_address_t *cp_node_addr)
 			if (current->pdrs != NULL) {
 				if ((current->pdrs)->pdi.src_intfc.interface_value == CORE) {
 					memcpy(&peer_info_t.wb_peer_ip,
-							&current->wb_peer_ip_addr, sizeof(node_address_t));
+							&current->cold->wb_peer_ip_addr, sizeof(node_address_t));
 
-					(current->wb_peer_ip_addr.ip_type == IPV6_TYPE) ?
+					(current->cold->wb_peer_ip_addr.ip_type == IPV6_TYPE) ?
 						clLog(clSystemLog, eCLSeverityDebug,
 								LOG_FORMAT"West Bound Peer Node IPv6 Address: "IPv6_FMT"\n",
 								LOG_VALUE, IPv6_PRINT(IPv6_CAST(peer_info_t.wb_peer_ip.ipv6_addr))):
@@ -201,7 +207,7 @@ fill_peer_node_info_t(pfcp_session_t *sess, node_address_t *cp_node_addr)
 			if (current_t->pdrs != NULL) {
 				if ((current_t->pdrs)->pdi.src_intfc.interface_value == ACCESS) {
 					memcpy(&peer_info_t.eb_peer_ip,
-							&current_t->eb_peer_ip_addr, sizeof(node_address_t));
+							&current_t->cold->eb_peer_ip_addr, sizeof(node_address_t));
 					break;
 				}
 			}
@@ -485,7 +491,7 @@ process_pdi_ueip_info(pfcp_ue_ip_address_ie_t *ue_addr, ue_ip_addr_t *ue_addr_t,
 		ue_addr_t->v6 = PRESENT;
 		ue_addr_t->ipv6_pfx_dlgtn_bits = ue_addr->ipv6_pfx_dlgtn_bits;
 		memcpy(ue_addr_t->ipv6_address, ue_addr->ipv6_address, IPV6_ADDRESS_LEN);
-		memcpy(session->ue_ipv6_addr, ue_addr->ipv6_address, IPV6_ADDRESS_LEN);
+		memcpy(session->cold->ue_ipv6_addr, ue_addr->ipv6_address, IPV6_ADDRESS_LEN);
 	}
 	return 0;
 }
@@ -619,13 +625,14 @@ process_pdr_pdi_info(pfcp_pdi_ie_t *pdi_ie_t, pdi_t *pdi,
 						swap_src_dst_ip(&pkt_filter.u.rule_str[0]);
 					}
 
-					(*session)->acl_table_indx[(*session)->acl_table_count] =
+					(*session)->cold->acl_table_indx[(*session)->acl_table_count] =
 													get_acl_table_indx(&pkt_filter, SESS_CREATE);
-					if ((*session)->acl_table_indx[(*session)->acl_table_count] <= 0) {
+					if ((*session)->cold->acl_table_indx[(*session)->acl_table_count] <= 0) {
 						/* TODO: ERROR Handling */
 						clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"ACL table creation failed\n", LOG_VALUE);
 					}else{
 						(*session)->acl_table_count++;
+						sess_data_acl_sync(*session);
 					}
 				}
 			}
@@ -638,7 +645,7 @@ process_pdr_pdi_info(pfcp_pdi_ie_t *pdi_ie_t, pdi_t *pdi,
 			dir = UPLINK;
 		}
 
-		if (up_sdf_default_entry_add((*session)->acl_table_indx[(*session)->acl_table_count],
+		if (up_sdf_default_entry_add((*session)->cold->acl_table_indx[(*session)->acl_table_count],
 																			prcdnc_val, dir)) {
 			/* TODO: ERROR Handling */
 			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Failed to add default rule \n", LOG_VALUE);
@@ -662,7 +669,6 @@ static int8_t
 process_create_urr_info(pfcp_create_urr_ie_t *urr, urr_info_t *urr_t, uint64_t cp_seid,
 		uint64_t up_seid, peer_addr_t cp_ip)
 {
-	peerEntry *timer_entry = NULL;
 	urr_t  = get_urr_info_entry(urr->urr_id.urr_id_value, cp_ip, cp_seid);
 	if(urr_t == NULL){
 		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT" URR not found for "
@@ -721,20 +727,18 @@ process_create_urr_info(pfcp_create_urr_ie_t *urr, urr_info_t *urr_t, uint64_t c
 	urr_t->first_pkt_time = 0;
 	urr_t->last_pkt_time = 0;
 
+	/* Per worker usage counters, checked against the thresholds above */
+	if (urr_usage_alloc(urr_t, cp_seid, up_seid) < 0)
+		return -1;
+
 	clLog(clSystemLog, eCLSeverityDebug,LOG_FORMAT" URR created with urr id %u\n",
 			LOG_VALUE, urr_t->urr_id);
 
 	if((urr_t->rept_trigg == TIME_BASED) || (urr_t->rept_trigg == VOL_TIME_BASED)) {
-		timer_entry = fill_timer_entry_usage_report(&dest_addr_t.ipv4, urr_t, cp_seid, up_seid);
-		if(!(add_timer_entry_usage_report(timer_entry, urr_t->time_thes, timer_callback))) {
-			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Faild to add timer "
-				"entry while creating URR info\n", LOG_VALUE);
-			return -1;
-		}
-
-		if (starttimer(&timer_entry->pt) < 0) {
-		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT" Periodic Timer "
-			"failed to start while creating URR info\n", LOG_VALUE);
+		/* Periodic timer on the timing wheel of the iface core */
+		if (urr_usage_time_start(urr_t) < 0) {
+			clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT" Periodic Timer "
+				"failed to start while creating URR info\n", LOG_VALUE);
 		}
 	}
 
@@ -764,19 +768,19 @@ process_create_bar_info(pfcp_create_bar_ie_t *bar, bar_info_t *bar_t)
  * @param  : qer, hold create qer info
  * @param  : quer_t, structure to be updated
  * @param  : session, session information
- * @param  : cp_ip, peer node address
- * @param  : cp_seid, CP session ID of UE
+ * @param  : sess, pfcp session information
  * @return : Returns 0 in case of success , -1 otherwise
  */
 static int8_t
 process_create_qer_info(pfcp_create_qer_ie_t *qer, qer_info_t **quer_t,
-		pfcp_session_datat_t **session, peer_addr_t cp_ip, uint64_t cp_seid)
+		pfcp_session_datat_t **session, pfcp_session_t *sess)
 {
 	qer_info_t *qer_t = NULL;
 	/* M: QER ID */
 	if (qer->qer_id.header.len) {
 		/* Get allocated memory location */
-		qer_t = get_qer_info_entry(qer->qer_id.qer_id_value, quer_t, cp_ip, cp_seid);
+		qer_t = get_qer_info_entry(qer->qer_id.qer_id_value, quer_t,
+				sess->cp_ip, sess->cp_seid);
 		if (qer_t == NULL)
 			return -1;
 	}
@@ -876,6 +880,56 @@ process_create_qer_info(pfcp_create_qer_ie_t *qer, qer_info_t **quer_t,
 	/* Pointer to Sessions */
 	qer_t->session = *session;
 
+	/* MBR/GBR or APN-AMBR policing */
+	qer_mtr_update(qer_t, sess);
+
+	return 0;
+}
+
+/**
+ * @brief  : Process update qer info
+ * @param  : qer, hold update qer info
+ * @param  : sess, pfcp session information
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int8_t
+process_update_qer_info(pfcp_update_qer_ie_t *qer, pfcp_session_t *sess)
+{
+	qer_info_t *qer_t = NULL;
+
+	/* M: QER ID */
+	if (qer->qer_id.header.len) {
+		/* Get allocated memory location */
+		qer_t = find_qer_info_entry(qer->qer_id.qer_id_value,
+				sess->cp_ip, sess->cp_seid);
+	}
+
+	/* Check qer entry found or not */
+	if (qer_t == NULL)
+		return -1;
+
+	/* Gate Status */
+	if (qer->gate_status.header.len) {
+		qer_t->gate_status.ul_gate = qer->gate_status.ul_gate;
+		qer_t->gate_status.dl_gate = qer->gate_status.dl_gate;
+	}
+
+	/* MBR: Maximum Bitrate */
+	if (qer->maximum_bitrate.header.len) {
+		qer_t->max_bitrate.ul_mbr = qer->maximum_bitrate.ul_mbr;
+		qer_t->max_bitrate.dl_mbr = qer->maximum_bitrate.dl_mbr;
+	}
+
+	/* GBR: Guaranteed Bitrate */
+	if (qer->guaranteed_bitrate.header.len) {
+		qer_t->guaranteed_bitrate.ul_gbr = qer->guaranteed_bitrate.ul_gbr;
+		qer_t->guaranteed_bitrate.dl_gbr = qer->guaranteed_bitrate.dl_gbr;
+	}
+
+	/* Rebuild the meter with the new bitrates */
+	if ((qer->maximum_bitrate.header.len) || (qer->guaranteed_bitrate.header.len))
+		qer_mtr_update(qer_t, sess);
+
 	return 0;
 }
 
@@ -1037,21 +1091,21 @@ process_create_far_info(pfcp_create_far_ie_t *far,
 								LOG_VALUE);
 					}
 #endif /* USE_REST */
-					(*session)->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
-					(*session)->wb_peer_ip_addr.ipv4_addr = far->frwdng_parms.outer_hdr_creation.ipv4_address;
+					(*session)->cold->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
+					(*session)->cold->wb_peer_ip_addr.ipv4_addr = far->frwdng_parms.outer_hdr_creation.ipv4_address;
 					clLog(clSystemLog, eCLSeverityDebug,
 							LOG_FORMAT"MBR: West Bound Peer IPv4 Node Addr:"IPV4_ADDR"\n",
-							LOG_VALUE, IPV4_ADDR_HOST_FORMAT((*session)->wb_peer_ip_addr.ipv4_addr));
+							LOG_VALUE, IPV4_ADDR_HOST_FORMAT((*session)->cold->wb_peer_ip_addr.ipv4_addr));
 
 				} else {
-					(*session)->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
-					memcpy((*session)->wb_peer_ip_addr.ipv6_addr,
+					(*session)->cold->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
+					memcpy((*session)->cold->wb_peer_ip_addr.ipv6_addr,
 							far->frwdng_parms.outer_hdr_creation.ipv6_address,
 							IPV6_ADDRESS_LEN);
 					clLog(clSystemLog, eCLSeverityDebug,
 							LOG_FORMAT"MBR: West Bound Peer IPv6 Node Addr:"IPv6_FMT"\n",
 							LOG_VALUE,
-							IPv6_PRINT(*(struct in6_addr *)(*session)->wb_peer_ip_addr.ipv6_addr));
+							IPv6_PRINT(*(struct in6_addr *)(*session)->cold->wb_peer_ip_addr.ipv6_addr));
 #ifdef USE_REST
 					/* Fill the peer node entry and add the entry into connection table */
 					memset(&peer_addr, 0, sizeof(node_address_t));
@@ -1092,21 +1146,21 @@ process_create_far_info(pfcp_create_far_ie_t *far,
 							LOG_VALUE);
 					}
 #endif /* USE_REST */
-					(*session)->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
-					(*session)->eb_peer_ip_addr.ipv4_addr = far->frwdng_parms.outer_hdr_creation.ipv4_address;
+					(*session)->cold->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
+					(*session)->cold->eb_peer_ip_addr.ipv4_addr = far->frwdng_parms.outer_hdr_creation.ipv4_address;
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"MBR: West Bound Peer IPv4 Node Addr:"IPV4_ADDR"\n",
-						LOG_VALUE, IPV4_ADDR_HOST_FORMAT((*session)->eb_peer_ip_addr.ipv4_addr));
+						LOG_VALUE, IPV4_ADDR_HOST_FORMAT((*session)->cold->eb_peer_ip_addr.ipv4_addr));
 
 				} else {
 					/* TODO:PATH MANG: Add the entry for IPv6 Address */
-					(*session)->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
-					memcpy((*session)->eb_peer_ip_addr.ipv6_addr,
+					(*session)->cold->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
+					memcpy((*session)->cold->eb_peer_ip_addr.ipv6_addr,
 							far->frwdng_parms.outer_hdr_creation.ipv6_address,
 							IPV6_ADDRESS_LEN);
 					clLog(clSystemLog, eCLSeverityDebug,
 							LOG_FORMAT"MBR: West Bound Peer IPv6 Node Addr:"IPv6_FMT"\n",
-							LOG_VALUE, IPv6_PRINT(*(struct in6_addr *)(*session)->eb_peer_ip_addr.ipv6_addr));
+							LOG_VALUE, IPv6_PRINT(*(struct in6_addr *)(*session)->cold->eb_peer_ip_addr.ipv6_addr));
 #ifdef USE_REST
 					/* Fill the peer node entry and add the entry into connection table */
 					memset(&peer_addr, 0, sizeof(node_address_t));
@@ -1150,6 +1204,10 @@ process_create_far_info(pfcp_create_far_ie_t *far,
 
 	/* Pointer to Session */
 	far_t->session = *session;
+
+	/* Prebuild the outer header and attach the next hop of the FAR */
+	far_encap_tmpl_update(far_t);
+	far_adj_update(far_t);
 	return 0;
 }
 
@@ -1198,8 +1256,10 @@ process_update_pdr_info(pfcp_update_pdr_ie_t *pdr, pfcp_session_t *sess)
 			if (pdr->pdi.ue_ip_address.v4) {
 				int ret = 0;
 				/* Session Entry not present. Add new session entry */
+				up_sess_tbl_write_begin();
 				ret = rte_hash_add_key_data(sess_by_ueip_hash,
 						&ue_ip, session);
+				up_sess_tbl_write_end();
 				if (ret) {
 					clLog(clSystemLog, eCLSeverityCritical,
 							LOG_FORMAT"Failed to add entry for UE IPv4: "IPV4_ADDR" or IPv6 Addr: %s"
@@ -1269,18 +1329,19 @@ process_update_pdr_info(pfcp_update_pdr_ie_t *pdr, pfcp_session_t *sess)
 				int32_t indx = get_acl_table_indx(&pkt_filter, SESS_MODIFY);
 				if(indx > 0){
 					for(uint16_t itr = 0; itr < session->acl_table_count; itr++){
-						if(session->acl_table_indx[itr] == indx){
+						if(session->cold->acl_table_indx[itr] == indx){
 							flag = 1;
 						}
 						if(flag && itr != session->acl_table_count - 1)
-							session->acl_table_indx[itr] = session->acl_table_indx[itr+1];
+							session->cold->acl_table_indx[itr] = session->cold->acl_table_indx[itr+1];
 					}
 				}
 
 				if(flag){
-					session->acl_table_indx[session->acl_table_count] = 0;
+					session->cold->acl_table_indx[session->acl_table_count] = 0;
 					session->acl_table_count--;
 				}
+				sess_data_acl_sync(session);
 			}
 		}
 	}
@@ -1305,6 +1366,9 @@ process_update_pdr_info(pfcp_update_pdr_ie_t *pdr, pfcp_session_t *sess)
 		/* Linked into Session Obj */
 		session->hdr_rvl = pdr->outer_hdr_removal.outer_hdr_removal_desc;
 	}
+
+	/* Precedence may have changed, re-sort the session PDRs */
+	update_pdr_prcdnc_tbl(session, NULL);
 	return 0;
 }
 
@@ -1368,16 +1432,17 @@ fill_sdf_rule_by_rule_name(uint8_t *rule_name, pdi_t *pdi,
 						swap_src_dst_ip(&pkt_filter.u.rule_str[0]);
 					}
 
-					(*session)->acl_table_indx[(*session)->acl_table_count] =
+					(*session)->cold->acl_table_indx[(*session)->acl_table_count] =
 													get_acl_table_indx(&pkt_filter, SESS_CREATE);
-					if ((*session)->acl_table_indx[(*session)->acl_table_count] <= 0) {
+					if ((*session)->cold->acl_table_indx[(*session)->acl_table_count] <= 0) {
 						/* TODO: ERROR Handling */
 						clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"ACL table creation failed\n", LOG_VALUE);
 						continue;
 					}else{
 						(*session)->acl_table_count++;
+						sess_data_acl_sync(*session);
 					}
-					(*session)->predef_rule = TRUE;
+					(*session)->cold->predef_rule = TRUE;
 
 				} /* TODO: ERROR Handling */
 			}
@@ -1512,10 +1577,13 @@ process_create_pdr_info(pfcp_create_pdr_ie_t *pdr, pfcp_session_datat_t **sessio
 
 	clLog(clSystemLog, eCLSeverityInfo, LOG_FORMAT"Entry Add PDR_ID:%u, precedence:%u, ACL_TABLE_INDX:%u\n",
 			LOG_VALUE, pdr->pdr_id.rule_id, pdr->precedence.prcdnc_val,
-			(*session)->acl_table_indx[(*session)->acl_table_count - 1]);
+			(*session)->cold->acl_table_indx[(*session)->acl_table_count - 1]);
 
 	/* pointer to the session */
 	pdr_t->session = sess;
+
+	/* Index the new PDR by precedence */
+	update_pdr_prcdnc_tbl(*session, NULL);
 	return 0;
 }
 
@@ -1584,8 +1652,10 @@ get_pfcp_session_data(pfcp_create_pdr_ie_t *create_pdr, pfcp_session_t *sess)
 			if (create_pdr->pdi.ue_ip_address.v4) {
 				int ret = 0;
 				/* Session Entry not present. Add new session entry */
+				up_sess_tbl_write_begin();
 				ret = rte_hash_add_key_data(sess_by_ueip_hash,
 						&ue_ip, session);
+				up_sess_tbl_write_end();
 				if (ret) {
 					clLog(clSystemLog, eCLSeverityCritical,
 							LOG_FORMAT"Failed to add entry for UE IPv4: "IPV4_ADDR" or IPv6 Addr: %s"
@@ -1718,7 +1788,7 @@ process_up_session_estab_req(pfcp_sess_estab_req_t *sess_req,
 						sess_req->create_qer[itr3].qer_id.qer_id_value) {
 
 					if (process_create_qer_info(&sess_req->create_qer[itr3],
-								&(session->pdrs[itr]).quer, &session, sess->cp_ip, sess->cp_seid)) {
+								&(session->pdrs[itr]).quer, &session, sess)) {
 						return -1;
 					}
 				}
@@ -2132,22 +2202,22 @@ process_update_far_info(pfcp_update_far_ie_t *far, uint64_t up_seid,
 					}
 #endif /* USE_REST */
 
-					far_t->session->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
-					far_t->session->wb_peer_ip_addr.ipv4_addr = far->upd_frwdng_parms.outer_hdr_creation.ipv4_address;
+					far_t->session->cold->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
+					far_t->session->cold->wb_peer_ip_addr.ipv4_addr = far->upd_frwdng_parms.outer_hdr_creation.ipv4_address;
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"MBR: West Bound Peer IPv4 Node Addr:"IPV4_ADDR"\n",
-						LOG_VALUE, IPV4_ADDR_HOST_FORMAT((far_t->session)->wb_peer_ip_addr.ipv4_addr));
+						LOG_VALUE, IPV4_ADDR_HOST_FORMAT((far_t->session)->cold->wb_peer_ip_addr.ipv4_addr));
 
 				} else {
 					/* TODO:PATH: Add the connection entry */
-					far_t->session->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
-					memcpy(far_t->session->wb_peer_ip_addr.ipv6_addr,
+					far_t->session->cold->wb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
+					memcpy(far_t->session->cold->wb_peer_ip_addr.ipv6_addr,
 							far->upd_frwdng_parms.outer_hdr_creation.ipv6_address,
 							IPV6_ADDRESS_LEN);
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"MBR: West Bound Peer IPv6 Node Addr:"IPv6_FMT"\n",
 						LOG_VALUE,
-						IPv6_PRINT(IPv6_CAST(far_t->session)->wb_peer_ip_addr.ipv6_addr));
+						IPv6_PRINT(IPv6_CAST(far_t->session)->cold->wb_peer_ip_addr.ipv6_addr));
 #ifdef USE_REST
 					/* Add the peer node connection entry */
 					memset(&peer_addr, 0, sizeof(node_address_t));
@@ -2236,23 +2306,23 @@ process_update_far_info(pfcp_update_far_ie_t *far, uint64_t up_seid,
 							LOG_VALUE);
 					}
 #endif /* USE_REST */
-					far_t->session->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
-					far_t->session->eb_peer_ip_addr.ipv4_addr =
+					far_t->session->cold->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV4;
+					far_t->session->cold->eb_peer_ip_addr.ipv4_addr =
 							far->upd_frwdng_parms.outer_hdr_creation.ipv4_address;
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"MBR: West Bound Peer IPv4 Node Addr:"IPV4_ADDR"\n",
-						LOG_VALUE, IPV4_ADDR_HOST_FORMAT(far_t->session->eb_peer_ip_addr.ipv4_addr));
+						LOG_VALUE, IPV4_ADDR_HOST_FORMAT(far_t->session->cold->eb_peer_ip_addr.ipv4_addr));
 				} else {
 					/* TODO:PATH MANG: Add the entry for IPv6 Address */
-					far_t->session->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
-					memcpy(far_t->session->eb_peer_ip_addr.ipv6_addr,
+					far_t->session->cold->eb_peer_ip_addr.ip_type |=  PDN_TYPE_IPV6;
+					memcpy(far_t->session->cold->eb_peer_ip_addr.ipv6_addr,
 							far->upd_frwdng_parms.outer_hdr_creation.ipv6_address,
 							IPV6_ADDRESS_LEN);
 
 					clLog(clSystemLog, eCLSeverityDebug,
 						LOG_FORMAT"MBR: West Bound Peer IPv6 Node Addr:"IPv6_FMT"\n",
 						LOG_VALUE,
-						IPv6_PRINT(IPv6_CAST(far_t->session->eb_peer_ip_addr.ipv6_addr)));
+						IPv6_PRINT(IPv6_CAST(far_t->session->cold->eb_peer_ip_addr.ipv6_addr)));
 #ifdef USE_REST
 					/* Add the peer node connection entry */
 					memset(&peer_addr, 0, sizeof(node_address_t));
@@ -2288,6 +2358,13 @@ process_update_far_info(pfcp_update_far_ie_t *far, uint64_t up_seid,
 		fill_li_update_duplicating_param(far, far_t, sess);
 	}
 
+	/* Outer header may have changed, rebuild the template */
+	if (far->upd_frwdng_parms.outer_hdr_creation.header.len)
+		far_encap_tmpl_update(far_t);
+
+	/* Peer or destination interface may have changed */
+	far_adj_update(far_t);
+
 	return 0;
 }
 
@@ -2297,12 +2374,13 @@ fill_sess_mod_usage_report(pfcp_usage_rpt_sess_mod_rsp_ie_t *usage_report,
 {
 
 	int8_t size = 0;
-	int ret = 0;
 	struct timeval epoc_start_time;
 	struct timeval epoc_end_time;
-	peerEntry *data = NULL;
 	uint32_t end_time = 0;
 
+	/* Sum the usage counted by the workers */
+	urr_usage_fold(urr);
+
 	size += set_urr_id(&usage_report->urr_id, urr->urr_id);
 
 	pfcp_set_ie_header(&(usage_report->urseqn.header), PFCP_IE_URSEQN,
@@ -2344,40 +2422,65 @@ fill_sess_mod_usage_report(pfcp_usage_rpt_sess_mod_rsp_ie_t *usage_report,
 	usage_report->time_of_lst_pckt.time_of_lst_pckt = urr->last_pkt_time;
 
 	urr->start_time = current_ntp_timestamp();
-	urr->first_pkt_time = 0;
-	urr->last_pkt_time = 0;
-
-	rule_key hash_key = {0};
-	hash_key.id = urr->urr_id;
-	hash_key.cp_seid = cp_seid;
+	urr_usage_reset(urr, 0);
 
 	pfcp_set_ie_header(&usage_report->header, IE_USAGE_RPT_SESS_MOD_RSP, size);
-	/*remove from hash*/
-	if(urr->meas_method == TIME_BASED || urr->meas_method == VOL_TIME_BASED) {
-		ret = rte_hash_lookup_data(timer_by_id_hash,
-				&hash_key, (void **)&data);
-		if (ret >=  0) {
-			if(data->pt.ti_id != 0) {
-				stoptimer(&data->pt.ti_id);
-				deinittimer(&data->pt.ti_id);
-
-				/* URR Entry is present. Delete Session Entry */
-				ret = rte_hash_del_key(timer_by_id_hash, &hash_key);
-
-				if ( ret < 0) {
-					clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Timer Entry "
-						"not found for URR_ID:%u\n", LOG_VALUE, urr->urr_id);
-					return -1;
+	/* Stop the periodic report timer */
+	if(urr->meas_method == TIME_BASED || urr->meas_method == VOL_TIME_BASED)
+		urr_usage_time_stop(urr);
+	return size;
+}
+
+/**
+ * @brief  : Remove the SDF rules of a PDR from the ACL tables and from the
+ *           tables of its session
+ * @param  : session, session data of the PDR
+ * @param  : pdr, pdr info
+ * @return : Returns nothing
+ */
+static void
+pdr_acl_rules_remove(pfcp_session_datat_t *session, pdr_info_t *pdr)
+{
+	struct sdf_pkt_filter pkt_filter = {0};
+
+	for(int itr = 0; itr < pdr->pdi.sdf_filter_cnt; itr++){
+
+		pkt_filter.precedence = pdr->prcdnc_val;
+		/* Reset the rule string */
+		memset(pkt_filter.u.rule_str, 0, MAX_LEN);
+
+		/* flow description */
+		if (pdr->pdi.sdf_filter[itr].fd) {
+			memcpy(&pkt_filter.u.rule_str, &pdr->pdi.sdf_filter[itr].flow_desc,
+							pdr->pdi.sdf_filter[itr].len_of_flow_desc);
+			pkt_filter.rule_ip_type = get_rule_ip_type(pkt_filter.u.rule_str);
+
+			if (!pdr->pdi.src_intfc.interface_value) {
+				/* swap the src and dst address for UL traffic.*/
+				swap_src_dst_ip(&pkt_filter.u.rule_str[0]);
+			}
+
+			int flag = 0;
+			int32_t indx = get_acl_table_indx(&pkt_filter, SESS_DEL);
+			for(uint16_t itr = 0; itr < session->acl_table_count; itr++){
+				if(session->cold->acl_table_indx[itr] == indx){
+					flag = 1;
 				}
+				if(flag && itr != session->acl_table_count - 1)
+					session->cold->acl_table_indx[itr] = session->cold->acl_table_indx[itr+1];
+			}
 
-				if (data != NULL) {
-					rte_free(data);
-					data = NULL;
+			if(flag == 1 && indx > 0){
+				if (remove_rule_entry_acl(indx,	&pkt_filter)) {
+					/* TODO: ERROR handling */
+				}else{
+					session->cold->acl_table_indx[session->acl_table_count] = 0;
+					session->acl_table_count--;
 				}
 			}
+			sess_data_acl_sync(session);
 		}
 	}
-	return size;
 }
 
 int8_t
@@ -2387,7 +2490,6 @@ process_remove_pdr_sess(pfcp_remove_pdr_ie_t *remove_pdr, uint64_t up_seid,
 	int ret = 0;
 	uint8_t uiFlag = 0;
 	pfcp_session_t *sess = NULL;
-	struct sdf_pkt_filter pkt_filter = {0};
 
 	/* Get the session information from session table based on UP_SESSION_ID*/
 	sess = get_sess_info_entry(up_seid, SESS_MODIFY);
@@ -2413,43 +2515,7 @@ process_remove_pdr_sess(pfcp_remove_pdr_ie_t *remove_pdr, uint64_t up_seid,
 
 				}
 				//Remove Entry from ACL Table
-				for(int itr = 0; itr < pdr->pdi.sdf_filter_cnt; itr++){
-
-					pkt_filter.precedence = pdr->prcdnc_val;
-					/* Reset the rule string */
-					memset(pkt_filter.u.rule_str, 0, MAX_LEN);
-
-					/* flow description */
-					if (pdr->pdi.sdf_filter[itr].fd) {
-						memcpy(&pkt_filter.u.rule_str, &pdr->pdi.sdf_filter[itr].flow_desc,
-										pdr->pdi.sdf_filter[itr].len_of_flow_desc);
-						pkt_filter.rule_ip_type = get_rule_ip_type(pkt_filter.u.rule_str);
-
-						if (!pdr->pdi.src_intfc.interface_value) {
-							/* swap the src and dst address for UL traffic.*/
-							swap_src_dst_ip(&pkt_filter.u.rule_str[0]);
-						}
-
-						int flag = 0;
-						int32_t indx = get_acl_table_indx(&pkt_filter, SESS_DEL);
-						for(uint16_t itr = 0; itr < session->acl_table_count; itr++){
-							if(session->acl_table_indx[itr] == indx){
-								flag = 1;
-							}
-							if(flag && itr != session->acl_table_count - 1)
-								session->acl_table_indx[itr] = session->acl_table_indx[itr+1];
-						}
-
-						if(flag == 1 && indx > 0){
-							if (remove_rule_entry_acl(indx,	&pkt_filter)) {
-								/* TODO: ERROR handling */
-							}else{
-								session->acl_table_indx[session->acl_table_count] = 0;
-								session->acl_table_count--;
-							}
-						}
-					}
-				}
+				pdr_acl_rules_remove(session, pdr);
 
 
 				far_info_t *far = pdr->far;
@@ -2527,6 +2593,9 @@ process_remove_pdr_sess(pfcp_remove_pdr_ie_t *remove_pdr, uint64_t up_seid,
 				/* Get PDR ID */
 				uint32_t pdr_id = pdr->rule_id;
 
+				/* Drop the PDR from the precedence table first */
+				update_pdr_prcdnc_tbl(session, pdr);
+
 				/* Delete the PDR info node from the linked list */
 				session->pdrs = remove_pdr_node(session->pdrs, pdr);
 
@@ -2562,6 +2631,147 @@ process_remove_pdr_sess(pfcp_remove_pdr_ie_t *remove_pdr, uint64_t up_seid,
 	return 0;
 }
 
+int8_t
+up_sess_acl_check(pfcp_session_t *sess)
+{
+	pfcp_session_datat_t *session = NULL;
+
+	if (sess == NULL)
+		return -1;
+
+	for (session = sess->sessions; session != NULL; session = session->next) {
+		for (uint8_t itr = 0; itr < session->acl_table_count; itr++) {
+			if (up_acl_table_check(session->cold->acl_table_indx[itr]) < 0) {
+				clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"SDF rules "
+					"of the session not installed, UP_SEID:%lu\n",
+					LOG_VALUE, sess->up_seid);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Check the ACL tables the SDF filters of a PDI go to, a filter
+ *           without table yet gets a new one and is not checked
+ * @param  : pdi, pdi ie
+ * @param  : prcdnc_val, precedence of the PDR
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int8_t
+pdi_acl_check(pfcp_pdi_ie_t *pdi, uint32_t prcdnc_val)
+{
+	int32_t indx = 0;
+	struct sdf_pkt_filter pkt_filter = {0};
+
+	for (int itr = 0; itr < pdi->sdf_filter_count; itr++) {
+		if (!pdi->sdf_filter[itr].header.len || !pdi->sdf_filter[itr].fd)
+			continue;
+
+		pkt_filter.precedence = prcdnc_val;
+		/* Reset the rule string */
+		memset(pkt_filter.u.rule_str, 0, MAX_LEN);
+		memcpy(&pkt_filter.u.rule_str, &pdi->sdf_filter[itr].flow_desc,
+				pdi->sdf_filter[itr].len_of_flow_desc);
+		pkt_filter.rule_ip_type = get_rule_ip_type(pkt_filter.u.rule_str);
+		if (!pdi->src_intfc.interface_value) {
+			/* swap the src and dst address for UL traffic.*/
+			swap_src_dst_ip(&pkt_filter.u.rule_str[0]);
+		}
+
+		/* Lookup only, the table is not referenced */
+		indx = get_acl_table_indx(&pkt_filter, SESS_MODIFY);
+		if ((indx > 0) && (up_acl_table_check(indx) < 0))
+			return -1;
+	}
+
+	return 0;
+}
+
+int8_t
+up_sess_mod_acl_check(pfcp_sess_mod_req_t *sess_mod_req, pfcp_session_t *sess)
+{
+	pdr_info_t *pdr = NULL;
+	uint32_t prcdnc_val = 0;
+
+	for (int itr = 0; itr < sess_mod_req->create_pdr_count; itr++) {
+		if (!sess_mod_req->create_pdr[itr].pdi.header.len)
+			continue;
+
+		if (pdi_acl_check(&sess_mod_req->create_pdr[itr].pdi,
+				sess_mod_req->create_pdr[itr].precedence.prcdnc_val) < 0)
+			goto fail;
+	}
+
+	for (int itr = 0; itr < sess_mod_req->update_pdr_count; itr++) {
+		pfcp_update_pdr_ie_t *update_pdr = &sess_mod_req->update_pdr[itr];
+
+		if (!update_pdr->pdi.header.len)
+			continue;
+
+		if (update_pdr->precedence.header.len) {
+			prcdnc_val = update_pdr->precedence.prcdnc_val;
+		} else {
+			pdr = get_pdr_info_entry(update_pdr->pdr_id.rule_id, NULL,
+					SESS_MODIFY, sess->cp_ip, sess->cp_seid);
+			if (pdr == NULL)
+				continue;
+			prcdnc_val = pdr->prcdnc_val;
+		}
+
+		if (pdi_acl_check(&update_pdr->pdi, prcdnc_val) < 0)
+			goto fail;
+	}
+
+	return 0;
+
+fail:
+	clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"SDF rules of the "
+		"modification go to a failed ACL table, UP_SEID:%lu\n",
+		LOG_VALUE, sess->up_seid);
+	return -1;
+}
+
+int8_t
+up_sess_estab_rollback(pfcp_session_t *sess)
+{
+	pdr_info_t *pdr = NULL;
+	pfcp_session_datat_t *session = NULL;
+	pfcp_sess_del_rsp_t sess_del_rsp = {0};
+
+	if (sess == NULL)
+		return -1;
+
+	/* Release the ACL tables, the deletion keeps them */
+	for (session = sess->sessions; session != NULL; session = session->next) {
+		for (pdr = session->pdrs; pdr != NULL; pdr = pdr->next)
+			pdr_acl_rules_remove(session, pdr);
+	}
+
+	/* The usage reports are dropped with the response */
+	if (up_delete_session_entry(sess, &sess_del_rsp))
+		return -1;
+
+	/* The session was not counted as active */
+	update_sys_stat(number_of_active_session, INCREMENT);
+
+#ifdef USE_CSID
+	if (del_sess_by_csid_entry(sess, sess->up_fqcsid, SX_PORT_ID)) {
+		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Error: %s \n", LOG_VALUE,
+				strerror(errno));
+	}
+#endif /* USE_CSID */
+
+	clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"Session rolled back, "
+		"UP_SEID:%lu\n", LOG_VALUE, sess->up_seid);
+
+	/* PDRs on the UL/DL cores may still point to it */
+	up_rcu_defer_free(sess);
+	return 0;
+}
+
 int8_t
 process_up_session_modification_req(pfcp_sess_mod_req_t *sess_mod_req,
 					pfcp_sess_mod_rsp_t *sess_mod_rsp)
@@ -2582,32 +2792,11 @@ process_up_session_modification_req(pfcp_sess_mod_req_t *sess_mod_req,
 
 	/* pfcpsmreq_flags: Dropped the bufferd packets  */
 	if (sess_mod_req->pfcpsmreq_flags.drobu) {
-		/* Free the downlink data rings */
-		//rte_free();
-
-		struct rte_ring *ring = NULL;
 		struct pfcp_session_datat_t *si = NULL;
 
-		si = sess->sessions;
-
-		while (si != NULL) {
-
-			/* Delete dl ring which created by default if present */
-			ring = si->dl_ring;
-			if (ring) {
-				if (rte_ring_dequeue(dl_ring_container, (void **)&ring) ==
-						ENOENT) {
-					clLog(clSystemLog, eCLSeverityCritical,
-							LOG_FORMAT"Can't put ring back, so free it\n", LOG_VALUE);
-					rte_ring_free(ring);
-				}
-
-				rte_ring_free(si->dl_ring);
-				si->dl_ring = NULL;
-			}
-
-			si = si->next;
-		}
+		/* Drop the downlink buffered pkts */
+		for (si = sess->sessions; si != NULL; si = si->next)
+			ddn_buf_flush(&si->cold->dl_buf, 0);
 	}
 
 	/* Scenario CP Changes it's SEID */
@@ -2662,7 +2851,7 @@ process_up_session_modification_req(pfcp_sess_mod_req_t *sess_mod_req,
 						sess_mod_req->create_qer[itr3].qer_id.qer_id_value) {
 
 					if (process_create_qer_info(&sess_mod_req->create_qer[itr3],
-								&(session->pdrs[itr]).quer, &session, sess->cp_ip, sess->cp_seid)) {
+								&(session->pdrs[itr]).quer, &session, sess)) {
 						return -1;
 					}
 				}
@@ -2707,6 +2896,13 @@ process_up_session_modification_req(pfcp_sess_mod_req_t *sess_mod_req,
 		}
 	}
 
+	/* Process the Update QER information */
+	for (int itr = 0; itr < sess_mod_req->update_qer_count; itr++) {
+		if (process_update_qer_info(&sess_mod_req->update_qer[itr], sess)) {
+			/* TODO: Error Handling */
+		}
+	}
+
 	for(int itr = 0; itr < sess_mod_req->update_pdr_count; itr++ ){
 		/* Process the Update PDR info */
 		if(process_update_pdr_info(&sess_mod_req->update_pdr[itr], sess)){
@@ -3042,6 +3238,9 @@ fill_sess_rep_req_usage_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
 	struct timeval epoc_end_time;
 	uint32_t end_time = 0;
 
+	/* Sum the usage counted by the workers */
+	urr_usage_fold(urr);
+
 	size += set_urr_id(&usage_report->urr_id, urr->urr_id);
 
 	pfcp_set_ie_header(&(usage_report->urseqn.header), PFCP_IE_URSEQN,
@@ -3053,9 +3252,9 @@ fill_sess_rep_req_usage_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
 						(sizeof(pfcp_usage_rpt_trig_ie_t) - sizeof(pfcp_ie_header_t)));
 	size += sizeof(pfcp_usage_rpt_trig_ie_t);
 
-	if(trig == VOL_BASED)
+	if(trig == VOL_BASED || trig == VOL_TIME_BASED)
 		usage_report->usage_rpt_trig.volth = 1;
-	else if(trig == TIME_BASED)
+	if(trig == TIME_BASED || trig == VOL_TIME_BASED)
 		usage_report->usage_rpt_trig.timth = 1;
 
 
@@ -3088,13 +3287,11 @@ fill_sess_rep_req_usage_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
 	usage_report->time_of_lst_pckt.time_of_lst_pckt = urr->last_pkt_time;
 
 	urr->start_time = current_ntp_timestamp();
-	urr->first_pkt_time = 0;
-	urr->last_pkt_time = 0;
 
-	if(urr->meas_method == TIME_BASED || urr->meas_method == VOL_TIME_BASED) {
-		urr->uplnk_data = 0;
-		urr->dwnlnk_data = 0;
-	}
+	if(urr->meas_method == TIME_BASED || urr->meas_method == VOL_TIME_BASED)
+		urr_usage_reset(urr, URR_USAGE_ALL_MASK);
+	else
+		urr_usage_reset(urr, 0);
 	pfcp_set_ie_header(&usage_report->header, IE_USAGE_RPT_SESS_RPT_REQ, size);
 	return size;
 }
@@ -3105,12 +3302,13 @@ fill_sess_del_usage_report(pfcp_usage_rpt_sess_del_rsp_ie_t *usage_report,
 {
 
 	int8_t size = 0;
-	peerEntry *data = NULL;
-	int ret = 0;
 	struct timeval epoc_start_time;
 	struct timeval epoc_end_time;
 	uint32_t end_time = 0;
 
+	/* Sum the usage counted by the workers */
+	urr_usage_fold(urr);
+
 	size += set_urr_id(&usage_report->urr_id, urr->urr_id);
 
 	pfcp_set_ie_header(&(usage_report->urseqn.header), PFCP_IE_URSEQN,
@@ -3151,43 +3349,13 @@ fill_sess_del_usage_report(pfcp_usage_rpt_sess_del_rsp_ie_t *usage_report,
 	usage_report->time_of_lst_pckt.time_of_lst_pckt = urr->last_pkt_time;
 
 	urr->start_time = current_ntp_timestamp();
-	urr->first_pkt_time = 0;
-	urr->last_pkt_time = 0;
-
-	rule_key hash_key = {0};
-	hash_key.id = urr->urr_id;
-	hash_key.cp_seid = cp_seid;
+	urr_usage_reset(urr, 0);
 
 	pfcp_set_ie_header(&usage_report->header, IE_USAGE_RPT_SESS_DEL_RSP, size);
 
-	if((urr->rept_trigg == TIME_BASED) || (urr->rept_trigg == VOL_TIME_BASED)) {
-		ret = rte_hash_lookup_data(timer_by_id_hash,
-				&hash_key, (void **)&data);
-
-		if (ret >= 0) {
-			if(data->pt.ti_id != 0) {
-				stoptimer(&data->pt.ti_id);
-				deinittimer(&data->pt.ti_id);
-
-				/* URR Entry is present. Delete timer Entry */
-				ret = rte_hash_del_key(timer_by_id_hash, &hash_key);
-
-				if ( ret < 0) {
-					clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Timer Entry "
-						"not found for URR_ID:%u\n", LOG_VALUE, urr->urr_id);
-					return -1;
-				}
-
-				if (data != NULL) {
-					rte_free(data);
-					data = NULL;
-				}
-			}
-		} else {
-			clLog(clSystemLog, eCLSeverityCritical,
-				LOG_FORMAT"No timer entery found for URR %u\n", LOG_VALUE, urr->urr_id);
-		}
-	}
+	/* Stop the periodic report timer */
+	if((urr->rept_trigg == TIME_BASED) || (urr->rept_trigg == VOL_TIME_BASED))
+		urr_usage_time_stop(urr);
 	return size;
 }
 
@@ -3216,55 +3384,9 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 
 	/* Cleanup the session data form hash table and delete the node from linked list */
 	while (session != NULL) {
-			if (session->dl_ring != NULL) {
-			struct rte_ring *ring = session->dl_ring;
-
-			session->dl_ring = NULL;
-			/* This is going to be nasty. We could potentially have a race
-			 * condition if modify bearer occurs directly before a delete
-			 * session, causing scan_notify_ring_func to work on the same
-			 * ring as this function. For our current tests, we *should* be
-			 * okay. For now.
-			 */
-
-			int i = 0;
-			int ret = 0;
-			int count = 0;
-			struct rte_mbuf *m[MAX_BURST_SZ];
-
-			do {
-
-		 /* Adding handling for support dpdk-18.02 and dpdk-16.11.04 */
-#if (RTE_VER_YEAR >= 16) && (RTE_VER_MONTH >= 11)
-				ret = rte_ring_sc_dequeue_burst(ring,
-				        (void **)m, MAX_BURST_SZ);
-#elif (RTE_VER_YEAR >= 18) && (RTE_VER_MONTH >= 02)
-				unsigned int *ring_entry = NULL;
-
-				/* Adding handling for support dpdk-18.02 */
-				ret = rte_ring_sc_dequeue_burst(ring,
-				        (void **)m, MAX_BURST_SZ, ring_entry);
-#endif
-
-				for (i = 0; i < ret; ++i) {
-					if (m[i] != NULL)
-						rte_pktmbuf_free(m[i]);
-				}
-				count += ret;
-			} while (ret);
-
-			if(ring) {
-			    rte_ring_free(ring);
-			}
-			if(rte_ring_sc_dequeue(dl_ring_container, (void *)&ring) == -ENOENT) {
-				clLog(clSystemLog, eCLSeverityCritical,
-					LOG_FORMAT"Ring not found\n",LOG_VALUE);
-			} else{
-				clLog(clSystemLog, eCLSeverityDebug,
-					LOG_FORMAT"Dequeued Ring \n",LOG_VALUE);
-			}
-			ring = NULL;
-		}
+		/* Drop the buffered pkts, a DL worker still holding the session
+		 * finds the buffer closed */
+		ddn_buf_flush(&session->cold->dl_buf, 1);
 
 		/* Cleanup PDRs info from the linked list */
 		pdr_info_t *pdr = session->pdrs;
@@ -3274,7 +3396,7 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 				ue_ip_addr = session->ue_ip_addr;
 			}
 			if (session->ipv6) {
-				memcpy(ue_ipv6_addr, session->ue_ipv6_addr, IPV6_ADDRESS_LEN);
+				memcpy(ue_ipv6_addr, session->cold->ue_ipv6_addr, IPV6_ADDRESS_LEN);
 			}
 		}
 
@@ -3284,7 +3406,7 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 					ue_ip_addr = session->next->ue_ip_addr;
 				}
 				if (session->next->ipv6) {
-					memcpy(ue_ipv6_addr, session->next->ue_ipv6_addr, IPV6_ADDRESS_LEN);
+					memcpy(ue_ipv6_addr, session->next->cold->ue_ipv6_addr, IPV6_ADDRESS_LEN);
 				}
 			}
 		}
@@ -3358,6 +3480,9 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 			/* Get PDR ID */
 			uint32_t pdr_id = pdr->rule_id;
 
+			/* Drop the PDR from the precedence table first */
+			update_pdr_prcdnc_tbl(session, pdr);
+
 			/* Delete the PDR info node from the linked list */
 			session->pdrs = remove_pdr_node(session->pdrs, pdr);
 			pdr = session->pdrs;
@@ -3374,7 +3499,7 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 
 		if ((session->ipv4 != 0) || (session->ipv6 != 0)){
 			ue_ip[inx].ue_ipv4 = session->ue_ip_addr;
-			memcpy(ue_ip[inx].ue_ipv6, session->ue_ipv6_addr, IPV6_ADDRESS_LEN);
+			memcpy(ue_ip[inx].ue_ipv6, session->cold->ue_ipv6_addr, IPV6_ADDRESS_LEN);
 			inx++;
 		}
 
@@ -3437,6 +3562,9 @@ up_delete_session_entry(pfcp_session_t *sess, pfcp_sess_del_rsp_t *sess_del_rsp)
 		return -1;
 	}
 
+	/* Release the APN-AMBR meter */
+	sess_ambr_mtr_free(sess);
+
 	/*CLI:decrement active session count*/
 	update_sys_stat(number_of_active_session, DECREMENT);
 
@@ -3475,8 +3603,8 @@ process_up_session_deletion_req(pfcp_sess_del_req_t *sess_del_req,
 	}
 #endif /* USE_CSID */
 
-	/* Cleanup the session */
-	rte_free(sess);
+	/* Cleanup the session, PDRs on the UL/DL cores may still point to it */
+	up_rcu_defer_free(sess);
 	sess = NULL;
 
 	clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"PFCP Session Deletion Request :: END \n", LOG_VALUE);
@@ -3489,103 +3617,6 @@ bool inittimer(peerEntry *md, int ptms, gstimercallback cb)
 	return gst_timer_init(&md->pt, ttInterval, cb, ptms, md);
 }
 
-peerEntry *
-fill_timer_entry_usage_report(struct sockaddr_in *peer_addr, urr_info_t *urr, uint64_t cp_seid, uint64_t up_seid)
-{
-	peerEntry *timer_entry = NULL;
-	int ret = 0;
-
-	timer_entry = rte_zmalloc_socket(NULL, sizeof(peerEntry),
-			RTE_CACHE_LINE_SIZE, rte_socket_id());
-	if(timer_entry == NULL )
-	{
-		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Failure to allocate timer entry :"
-				"%s\n", LOG_VALUE, rte_strerror(rte_errno));
-		return NULL;
-	}
-
-	timer_entry->dstIP = peer_addr->sin_addr.s_addr;
-	timer_entry->cp_seid = cp_seid;
-	timer_entry->up_seid = up_seid;
-	timer_entry->urr = urr;
-
-	rule_key hash_key = {0};
-	hash_key.id = urr->urr_id;
-	hash_key.cp_seid = cp_seid;
-
-	ret = rte_hash_add_key_data(timer_by_id_hash,
-			&hash_key, timer_entry);
-	if (ret) {
-		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Failed to add timer entry for URR_ID = %u"
-			"\n\tError= %s\n", LOG_VALUE, urr->urr_id, rte_strerror(abs(ret)));
-
-		return NULL;
-	}
-
-	return(timer_entry);
-}
-
-bool
-add_timer_entry_usage_report(peerEntry *conn_data, uint32_t timeout_ms,
-		gstimercallback cb)
-{
-
-	if (!inittimer(conn_data, timeout_ms*1000, cb))
-	{
-		clLog(clSystemLog, eCLSeverityCritical,LOG_FORMAT " =>%s - initialization of %s failed erro no %s\n",
-			LOG_VALUE, getPrintableTime(), conn_data->name, strerror(errno));
-		return false;
-	}
-
-	return true;
-}
-
-
-void
-timer_callback(gstimerinfo_t *ti, const void *data_t )
-{
-
-	peerEntry *data =  (peerEntry *) data_t;
-	int ret = 0;
-
-	rule_key hash_key = {0};
-	hash_key.id = data->urr->urr_id;
-	hash_key.cp_seid = data->cp_seid;
-
-	if(data->urr->meas_method == TIME_BASED ||
-			data->urr->meas_method == VOL_TIME_BASED) {
-		if(send_usage_report_req(data->urr, data->cp_seid, data->up_seid, TIME_BASED) != 0 ){
-
-			clLog(clSystemLog, eCLSeverityCritical,LOG_FORMAT"Failed to Send Usage "
-				"Report Request \n", LOG_VALUE);
-		}
-
-	} else {
-		ret = rte_hash_lookup_data(timer_by_id_hash,
-				&hash_key, (void **)&data);
-
-		if (ret >=0 ) {
-
-			if(data->pt.ti_id != 0) {
-				stoptimer(&data->pt.ti_id);
-				deinittimer(&data->pt.ti_id);
-				ret = rte_hash_del_key(timer_by_id_hash, &hash_key);
-
-				if ( ret < 0) {
-					clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT"Timer Entry not "
-						"found for URR_ID:%u\n", LOG_VALUE, data->urr->urr_id);
-					return;
-				}
-
-				if (data != NULL) {
-					rte_free(data);
-					data = NULL;
-				}
-			}
-		}
-	}
-}
-
 int
 fill_li_duplicating_params(pfcp_create_far_ie_t *far, far_info_t *far_t, pfcp_session_t *sess) {
 
@@ -3719,9 +3750,8 @@ int32_t
 process_event_li(pfcp_session_t *sess, uint8_t *buf_rx, int buf_rx_size,
 	uint8_t *buf_tx, int buf_tx_size, peer_addr_t *peer_addr) {
 
-	int ret = 0;
 	int pkt_length = 0;
-	uint8_t *pkt = NULL;
+	struct li_exp_rec *rec = NULL;
 
 	if (NULL == sess) {
 		clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT" Sess"
@@ -3742,18 +3772,19 @@ process_event_li(pfcp_session_t *sess, uint8_t *buf_rx, int buf_rx_size,
 		/* For incoming message */
 		if ((NULL != buf_rx) && (buf_rx_size > 0)) {
 
-			pkt_length = buf_rx_size;
-			pkt = rte_malloc(NULL, (pkt_length + sizeof(li_header_t)), 0);
-			if (NULL == pkt) {
+			/* Max payload of the LI header encoding */
+			pkt_length = RTE_MIN(buf_rx_size, MAX_LI_HDR_SIZE);
+			rec = li_exp_rec_alloc();
+			if (NULL == rec) {
 				clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT" Failed"
 					" to allocate memory for li packet", LOG_VALUE);
 
 				return -1;
 			}
 
-			memcpy(pkt, buf_rx, pkt_length);
+			memcpy(rec->data, buf_rx, pkt_length);
 
-			create_li_header(pkt, &pkt_length, EVENT_BASED,
+			create_li_header(rec->data, &pkt_length, EVENT_BASED,
 				sess->li_sx_config[cnt].id, sess->imsi,
 				fill_ip_info(peer_addr->type,
 						peer_addr->ipv4.sin_addr.s_addr,
@@ -3767,33 +3798,32 @@ process_event_li(pfcp_session_t *sess, uint8_t *buf_rx, int buf_rx_size,
 				dp_comm_port,
 				sess->li_sx_config[cnt].forward);
 
-			ret = send_li_data_pkt(ddf2_fd, pkt, pkt_length);
-			if (ret < 0) {
+			rec->len = pkt_length;
+
+			/* Sent to the DDF2 by the LI exporter */
+			if (li_event_enqueue(rec) < 0) {
 				clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT" Failed"
-					" to send PFCP event on TCP sock"
-					" with error %d\n", LOG_VALUE, ret);
+					" to queue PFCP event for DDF2\n", LOG_VALUE);
 				return -1;
 			}
-
-			rte_free(pkt);
-			pkt = NULL;
 		}
 
 		/* For outgoing message */
 		if ((NULL != buf_tx) && (buf_tx_size > 0)) {
 
-			pkt_length = buf_tx_size;
-			pkt = rte_malloc(NULL, (pkt_length + sizeof(li_header_t)), 0);
-			if (NULL == pkt) {
+			/* Max payload of the LI header encoding */
+			pkt_length = RTE_MIN(buf_tx_size, MAX_LI_HDR_SIZE);
+			rec = li_exp_rec_alloc();
+			if (NULL == rec) {
 				clLog(clSystemLog, eCLSeverityCritical, LOG_FORMAT"Failed"
 					" to allocate memory for li packet", LOG_VALUE);
 
 				return -1;
 			}
 
-			memcpy(pkt, buf_tx, pkt_length);
+			memcpy(rec->data, buf_tx, pkt_length);
 
-			create_li_header(pkt, &pkt_length, EVENT_BASED,
+			create_li_header(rec->data, &pkt_length, EVENT_BASED,
 				sess->li_sx_config[cnt].id, sess->imsi,
 				fill_ip_info(peer_addr->type,
 						dp_comm_ip.s_addr,
@@ -3807,16 +3837,14 @@ process_event_li(pfcp_session_t *sess, uint8_t *buf_rx, int buf_rx_size,
 						ntohs(peer_addr->ipv6.sin6_port)),
 				sess->li_sx_config[cnt].forward);
 
-			ret = send_li_data_pkt(ddf2_fd, pkt, pkt_length);
-			if (ret < 0) {
+			rec->len = pkt_length;
+
+			/* Sent to the DDF2 by the LI exporter */
+			if (li_event_enqueue(rec) < 0) {
 				clLog(clSystemLog, eCLSeverityDebug, LOG_FORMAT" Failed"
-						" to send PFCP event on TCP sock"
-						" with error %d\n", LOG_VALUE, ret);
+					" to queue PFCP event for DDF2\n", LOG_VALUE);
 				return -1;
 			}
-
-			rte_free(pkt);
-			pkt = NULL;
 		}
 	}
 
@@ -4100,58 +4128,12 @@ process_up_session_report_resp(pfcp_sess_rpt_rsp_t *sess_rep_resp)
 		if (sess->bar.dl_buf_suggstd_pckts_cnt.pckt_cnt_val !=
 				sess_rep_resp->update_bar.dl_buf_suggstd_pckt_cnt.pckt_cnt_val) {
 
-			struct rte_ring *ring = NULL;
-			struct rte_ring *new_ring = NULL;
 			struct pfcp_session_datat_t *si = NULL;
 
-			si = sess->sessions;
-
-			while (si != NULL) {
-
-				/* Delete dl ring which created by default if present */
-				ring = si->dl_ring;
-				if (ring) {
-
-					unsigned int *ring_entry = NULL;
-					unsigned int count = rte_ring_count(ring);
-					struct rte_mbuf pkts[count];
-					new_ring = allocate_ring(
-							sess_rep_resp->update_bar.dl_buf_suggstd_pckt_cnt.pckt_cnt_val);
-
-					if (new_ring == NULL) {
-						clLog(clSystemLog, eCLSeverityCritical,
-								LOG_FORMAT"Not enough memory "
-								"to allocate new ring\n", LOG_VALUE);
-						return 0;
-					}
-					if(rte_ring_sc_dequeue_burst(ring, (void **)&pkts,
-								count, ring_entry) == -ENOENT) {
-
-						clLog(clSystemLog, eCLSeverityCritical,
-								LOG_FORMAT"Can't put ring back, so free it\n",
-								LOG_VALUE);
-						rte_ring_free(ring);
-					}
-					if(rte_ring_enqueue_burst(new_ring, (void **)&pkts,
-								count, ring_entry) == -ENOBUFS) {
-
-						clLog(clSystemLog, eCLSeverityCritical,
-								LOG_FORMAT"Can't put ring back, so free it\n", LOG_VALUE);
-						rte_ring_free(new_ring);
-					}
-					rte_ring_free(ring);
-					if(rte_ring_sc_dequeue(dl_ring_container, (void *)&ring) == -ENOENT) {
-						clLog(clSystemLog, eCLSeverityCritical,
-								LOG_FORMAT"Ring not found\n",LOG_VALUE);
-					} else{
-						clLog(clSystemLog, eCLSeverityDebug,
-								LOG_FORMAT"Dequeued Ring \n",LOG_VALUE);
-					}
-					ring = NULL;
-					si->dl_ring = new_ring;
-				}
-
-				si = si->next;
+			/* Drop the buffered pkts over the new limit */
+			for (si = sess->sessions; si != NULL; si = si->next) {
+				ddn_buf_trim(&si->cold->dl_buf,
+						sess_rep_resp->update_bar.dl_buf_suggstd_pckt_cnt.pckt_cnt_val);
 			}
 			sess->bar.dl_buf_suggstd_pckts_cnt.pckt_cnt_val =
 				sess_rep_resp->update_bar.dl_buf_suggstd_pckt_cnt.pckt_cnt_val;
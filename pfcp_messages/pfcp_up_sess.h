@@ -21,14 +21,11 @@
 #include "pfcp_messages.h"
 
 /*DP-CDR related definations*/
-#define PATH_TEMP		"./CDR_temp.csv"
 #define VOLUME_LIMIT	"volume_limit"
 #define TIME_LIMIT		"Time_limit"
 #define CDR_TERMINATION	"Termination"
 #define CDR_BUFF_SIZE 	256
 #define CDR_TIME_BUFF 	16
-#define MAX_SEQ_NO_LEN 32
-#define UP_SEID_LEN 16
 #define CDR_HEADER "seq_no,up_seid,cp_seid,imsi,dp_ip_v4,dp_ip_v6,cp_ip_v4,cp_ip_v6,ue_ip_v4,ue_ip_v6,cause_for_record_closing,uplink_volume,downlink_volume,total_volume,duration_measurement,start_time,end_time,data_start_time,data_end_time\n"
 
 extern char CDR_FILE_PATH[CDR_BUFF_SIZE];
@@ -62,6 +59,35 @@ int8_t
 process_up_session_modification_req(pfcp_sess_mod_req_t *sess_mod_req,
 			pfcp_sess_mod_rsp_t *sess_mod_rsp);
 
+/**
+ * @brief  : Check that the last build of the ACL tables of the session SDF
+ *           rules did not fail, without waiting for the queued builds
+ * @param  : sess, session to check
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+up_sess_acl_check(pfcp_session_t *sess);
+
+/**
+ * @brief  : Check, before it is applied, that the SDF rules of the created
+ *           and updated PDRs of a modification do not go to an ACL table
+ *           whose last build failed
+ * @param  : sess_mod_req, pfcp session modification request
+ * @param  : sess, session to modify
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+up_sess_mod_acl_check(pfcp_sess_mod_req_t *sess_mod_req, pfcp_session_t *sess);
+
+/**
+ * @brief  : Remove a rejected establishment: its rules, ACL table
+ *           references and session entries
+ * @param  : sess, session to remove
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int8_t
+up_sess_estab_rollback(pfcp_session_t *sess);
+
 /**
  * @brief  : Process pfcp session report resp at dp side
  * @param  : sess_rep_resp, hold pfcp session report response
@@ -159,41 +185,6 @@ int8_t
 fill_sess_rep_req_usage_report(pfcp_usage_rpt_sess_rpt_req_ie_t *usage_report,
 												urr_info_t *urr, uint32_t trig);
 
-/*
-* @brief  : add a timer entry for usage report
-* @param  : conn_data, Peer node connection information
-* @param  : urr, urr object
-* @param  : cb, timer callback
-* @return : Returns true or false
-*/
-
-bool
-add_timer_entry_usage_report( peerEntry *conn_data, uint32_t timeout_ms, gstimercallback cb);
-
-
-
-/*
-* @brief  : fill a Peer node connection information
-* @param  : peer_addr, dest sockect addr
-* @param  : urr, urr object
-* @param  : cp_seid, seid of CP
-* @param  : up_seid, seid of UP
-* @return : Returns pointer of peerEntry
-*/
-peerEntry *
-fill_timer_entry_usage_report(struct sockaddr_in *peer_addr, urr_info_t *urr, uint64_t cp_seid, uint64_t up_seid);
-
-
-/**
-* @brief  : timer callback
-* @param  : ti, timer information
-* @param  : data_t, Peer node connection information
-* @return : Returns nothing
-*/
-void
-timer_callback(gstimerinfo_t *ti, const void *data_t);
-
-
 /**
 * @brief  : inittimer, initialize a timer
 * @param  : md, Peer node connection infomation
@@ -205,13 +196,15 @@ bool inittimer(peerEntry *md, int ptms, gstimercallback cb);
 
 /*
 * @brief  : Send pfcp report request for periodic genration for CDR
-* @param  : urr, URR info for which we need to generte PFCP rep Req
+* @param  : urr, URRs of the session for which we need to generte PFCP rep Req
+* @param  : trig, Trig point of every URR (VOL based, Time Based or both)
+* @param  : urr_cnt, number of URRs
 * @param  : cp_seid, seid of CP
 * @param  : up_seid, seid of UP
-* @param  : trig, Trig point of  PFCP rep Req(VOL based or Time Based)
 * @return : Returns 0 for succes and -1 failure
 */
-int send_usage_report_req(urr_info_t *urr, uint64_t cp_seid, uint64_t up_seid, uint32_t trig);
+int send_usage_report_req(urr_info_t **urr, uint32_t *trig, uint8_t urr_cnt,
+		uint64_t cp_seid, uint64_t up_seid);
 
 /*
  * @brief  : fill duplicating parameter ie for user level packet copying or LI
@@ -286,7 +279,8 @@ process_up_pfd_mgmt_request(pfcp_pfd_mgmt_req_t *pfcp_pfd_mgmt_req, uint8_t *cau
 
 /*
  * @brief  : remove cdr entry using seq no
- *           when receive response from CP
+ *           when receive response from CP, a tombstone in the
+ *           CDR journal
  * @param  : seq_no, seq_no in response as a key
  * @param  : up_seid, up seid as a key
  * @return  : 0 on success, else -1
@@ -295,16 +289,8 @@ int
 remove_cdr_entry(uint32_t seq_no, uint64_t up_seid);
 
 /*
- * @brief  : dump CDR from usage report in
- *           pfcp-sess-rpt-req message
- * @return : 0 on success,else -1
- */
-int
-store_cdr_into_file_pfcp_sess_rpt_req();
-
-/*
- * @brief  : generate & store CDR from usage report
- *           when restoration begins
+ * @brief  : generate CDR from usage report and queue it to the
+ *           CDR writer, when restoration begins
  * @param  : usage_report, to fill usage info from urr_t
  * @param  : up_seid, user plane session id
  * @param  : trig, cause for record close
@@ -23,6 +23,7 @@
 #include "pfcp_struct.h"
 #include "vepc_cp_dp_api.h"
 #include "../interface/interface.h"
+#include "up_ddn_buf.h"
 
 #ifdef USE_CSID
 #include "csid_struct.h"
@@ -43,8 +44,11 @@
 #define MAX_BEARERS 15
 #define MAX_LIST_SIZE 16
 #define ACL_TABLE_NAME_LEN 16
-#define MAX_ACL_TABLES		1000
+/* One ACL table per distinct SDF rule, index 0 unused */
+#define MAX_ACL_TABLES		16384
 #define MAX_SDF_RULE_NUM	32
+/* ACL tables of a session held in its hot record */
+#define SESS_DATA_ACL_HOT	4
 #define NAME_LEN			32
 
 typedef struct pfcp_session_t pfcp_session_t;
@@ -53,6 +57,10 @@ typedef struct pdr_info_t pdr_info_t;
 typedef struct qer_info_t qer_info_t;
 typedef struct urr_info_t urr_info_t;
 typedef struct predef_rules_t predef_rules_t;
+struct gtpu_encap_tmpl;
+struct up_adj;
+struct up_mtr;
+struct urr_usage;
 
 /**
  * @brief  : rte hash for pfcp context
@@ -198,6 +206,12 @@ typedef struct far_info_t {
 
 	/* Mapping of FAR with BAR */
 	uint8_t bar_id_value;
+
+	/* Prebuilt outer header, NULL when the headers are built per packet */
+	struct gtpu_encap_tmpl *volatile encap_tmpl;
+
+	/* Next hop adjacency of the outer header peer, never freed */
+	struct up_adj *adj;
 }far_info_t;
 
 
@@ -217,6 +231,9 @@ typedef struct qer_info_t {
 	paging_plcy_indctr_t paging_plcy_indctr;			/* Paging policy */
 	avgng_wnd_t avgng_wnd;						/* Averaging Window */
 
+	/* MBR/GBR meter, NULL when the QER does not police */
+	struct up_mtr *volatile mtr;
+
 	//pfcp_session_t *session;					/* Pointer to session */
 	pfcp_session_datat_t *session;					/* Pointer to session */
 
@@ -243,16 +260,19 @@ typedef struct urr_info_t {
 	uint32_t urr_seq_num;						/* URR seq num */
 	uint16_t meas_method;                       /* Measurment Method */
 	uint16_t rept_trigg;                        /* Reporting Trigger */
-	uint32_t vol_thes_uplnk;                    /* Vol Threshold */
-	uint32_t vol_thes_dwnlnk;                   /* Vol Threshold */
+	uint64_t vol_thes_uplnk;                    /* Vol Threshold */
+	uint64_t vol_thes_dwnlnk;                   /* Vol Threshold */
 	uint32_t time_thes;                         /* Time Threshold */
-	uint32_t uplnk_data;                        /* Uplink data usage */
-	uint32_t dwnlnk_data;                       /* Downlink Data Usage */
+	uint64_t uplnk_data;                        /* Uplink data usage */
+	uint64_t dwnlnk_data;                       /* Downlink Data Usage */
 	uint32_t start_time;                        /* Start Time */
 	uint32_t end_time;                          /* End Time */
 	uint32_t first_pkt_time;                    /* First Pkt Time */
 	uint32_t last_pkt_time;                     /* Last Pkt Time */
 
+	/* Per worker usage counters, folded into the fields above */
+	struct urr_usage *volatile usage;
+
 	urr_info_t *next;
 }urr_info_t;
 
@@ -284,14 +304,26 @@ typedef struct pdr_info_t {
 }pdr_info_t;
 
 /**
- * @brief  : Maintains pfcp session data related information
+ * @brief  : Precedence ordered view of the session data PDRs, looked up
+ *           with the precedence returned by the SDF ACL. The table is
+ *           rebuilt and swapped as a whole whenever a PDR is created,
+ *           updated or removed, readers never see a partial update.
  */
-typedef struct pfcp_session_datat_t
+typedef struct pdr_prcdnc_tbl_t {
+	/* Number of PDRs in the table */
+	uint32_t count;
+	/* PDR pointers, same order as prcdnc[] */
+	pdr_info_t **pdr;
+	/* Precedence keys in ascending order, pdr[] is laid out after them */
+	uint32_t prcdnc[];
+} pdr_prcdnc_tbl_t;
+
+/**
+ * @brief  : Maintains the control plane only part of the pfcp session data,
+ *           kept out of the cache lines read by the UL/DL handlers
+ */
+typedef struct pfcp_session_datat_cold_t
 {
-	uint8_t ipv4;
-	uint8_t ipv6;
-	/* UE Addr */
-	uint32_t ue_ip_addr;
 	uint8_t ue_ipv6_addr[IPV6_ADDRESS_LEN];
 	/* West Bound eNB/SGWU Address*/
 	node_address_t wb_peer_ip_addr;
@@ -299,12 +331,26 @@ typedef struct pfcp_session_datat_t
 	/* East Bound PGWU Address */
 	node_address_t eb_peer_ip_addr;
 
-	char acl_table_name[ACL_TABLE_NAME_LEN];
+	/* All the ACL tables of the session, the first SESS_DATA_ACL_HOT are
+	 * copied in the hot record */
 	int acl_table_indx[MAX_SDF_RULE_NUM];
-	uint8_t acl_table_count;
 	bool predef_rule;
 
+	/** DL pkts buffered for this session, only while it is not CONNECTED */
+	struct ddn_buf_q dl_buf;
+} pfcp_session_datat_cold_t;
+
+/**
+ * @brief  : Maintains pfcp session data related information. This is the
+ *           hot record found by the TEID/UE IP lookups, it holds what the
+ *           UL/DL handlers read and fits in one cache line.
+ */
+typedef struct pfcp_session_datat_t
+{
+	/* PDRs indexed by precedence, NULL when the session has no PDR */
+	pdr_prcdnc_tbl_t *volatile pdr_tbl;
 	pdr_info_t *pdrs;
+
 	/** Session state for use with downlink data processing*/
 	enum up_session_state sess_state;
 
@@ -313,12 +359,54 @@ typedef struct pfcp_session_datat_t
 	/* Header Removal */
 	enum outer_header_rvl_crt hdr_rvl;
 
-	/** Ring to hold the DL pkts for this session */
-	struct rte_ring *dl_ring;
+	/* UE Addr */
+	uint32_t ue_ip_addr;
+	uint8_t ipv4;
+	uint8_t ipv6;
+
+	uint8_t acl_table_count;
+	/* First ACL tables of cold->acl_table_indx, see sess_data_acl_sync() */
+	uint16_t acl_table_hot[SESS_DATA_ACL_HOT];
+
+	/* Control plane only fields */
+	pfcp_session_datat_cold_t *cold;
 
 	struct pfcp_session_datat_t *next;
 } pfcp_session_datat_t;
 
+/**
+ * @brief  : Copy the first ACL table indexes of the cold record in the hot
+ *           record, called after every change of the session ACL tables
+ * @param  : sess_data, session data
+ * @return : Returns nothing
+ */
+static inline void
+sess_data_acl_sync(pfcp_session_datat_t *sess_data)
+{
+	uint8_t itr = 0;
+
+	for (itr = 0; itr < SESS_DATA_ACL_HOT; itr++) {
+		sess_data->acl_table_hot[itr] = (itr < sess_data->acl_table_count) ?
+			sess_data->cold->acl_table_indx[itr] : 0;
+	}
+}
+
+/**
+ * @brief  : Get an ACL table index of the session, from the hot record for
+ *           the first SESS_DATA_ACL_HOT ones
+ * @param  : sess_data, session data
+ * @param  : itr, index below acl_table_count
+ * @return : Returns ACL table index
+ */
+static inline int
+sess_data_acl_indx(const pfcp_session_datat_t *sess_data, uint16_t itr)
+{
+	if (itr < SESS_DATA_ACL_HOT)
+		return sess_data->acl_table_hot[itr];
+
+	return sess_data->cold->acl_table_indx[itr];
+}
+
 /**
  * @brief  : Maintains sx li config
  */
@@ -365,6 +453,9 @@ typedef struct pfcp_session_t {
 	/* BAR ID Changes */
 	bar_info_t bar;
 
+	/* APN-AMBR meter, NULL when the session is not policed */
+	struct up_mtr *volatile ambr_mtr;
+
 	pfcp_session_datat_t *sessions;
 } pfcp_session_t;
 
@@ -532,6 +623,16 @@ qer_info_t *
 get_qer_info_entry(uint32_t qer_id, qer_info_t **head,
 					peer_addr_t cp_ip, uint64_t cp_seid);
 
+/**
+ * @brief  : Find QER entry in QER hash table, never creates it.
+ * @param  : QER ID, key.
+ * @param  : cp_ip, peer node address
+ * @param  : cp_seid, CP session ID of UE
+ * @return : qer_info_t cntxt or NULL
+ */
+qer_info_t *
+find_qer_info_entry(uint32_t qer_id, peer_addr_t cp_ip, uint64_t cp_seid);
+
 /**
  * @brief  : Delete QER entry from QER hash table.
  * @param  : QER ID, key
@@ -599,14 +700,4 @@ gen_up_sess_id(uint64_t cp_sess_id);
  */
 qer_info_t *
 add_rule_info_qer_hash(uint8_t *rule_name);
-
-/**
- * @brief  : Allocates ring for buffering downlink packets
- *           Allocate downlink packet buffer ring from a set of
- *           rings from the ring container.
- * @param  : No param
- * @return : Returns rte_ring Allocated ring on success, NULL on failure
- */
-struct
-rte_ring *allocate_ring(unsigned int dl_ring_size);
 #endif /* PFCP_UP_STRUCT_H */
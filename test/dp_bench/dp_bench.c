@@ -0,0 +1,893 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_cfgfile.h>
+
+#include "up_main.h"
+#include "gtpu.h"
+#include "up_dist.h"
+#include "up_prof.h"
+#include "pfcp_enum.h"
+#include "pfcp_set_ie.h"
+#include "pfcp_messages_encoder.h"
+#include "pfcp_messages_decoder.h"
+#include "gw_adapter.h"
+#include "dp_bench.h"
+#include "dp_bench_sess.h"
+
+/* Size of the RX and TX rings of the ports */
+#define BENCH_RING_SZ		4096
+
+/* Packets of the benchmark in flight */
+#define BENCH_POOL_SZ		(32 * 1024 - 1)
+#define BENCH_POOL_CACHE	256
+
+/* Packets generated or drained per burst */
+#define BENCH_BURST		32
+
+/* Session Establishment Requests in flight */
+#define BENCH_PFCP_WINDOW	64
+
+/* Response timeout of the DP, in seconds */
+#define BENCH_PFCP_TIMEOUT	2
+
+/* Inner and SGi UDP ports */
+#define BENCH_UE_PORT		5000
+#define BENCH_SERVER_PORT	6000
+
+extern int clSystemLog;
+extern struct in_addr dp_comm_ip;
+extern uint16_t dp_comm_port;
+
+/**
+ * @brief  : Benchmark parameters
+ */
+struct bench_cfg {
+	uint32_t sessions;
+	struct dp_bench_sess_cfg sess;
+	uint32_t pkt_size;
+	/* 0 both, 1 uplink only, 2 downlink only */
+	uint32_t direction;
+	/* 0 for the max rate of the benchmark lcore */
+	uint64_t rate_pps;
+	uint32_t warmup_sec;
+	uint32_t duration_sec;
+	/* Host order */
+	uint32_t server_ip;
+	struct ether_addr enb_mac;
+	struct ether_addr gw_mac;
+	uint8_t exit;
+};
+
+/**
+ * @brief  : Counters read at the start and at the end of the measurement,
+ *           per direction
+ */
+struct bench_cnt {
+	uint64_t tsc;
+	uint64_t offered[DP_BENCH_DIR_MAX];
+	uint64_t rx_full[DP_BENCH_DIR_MAX];
+	uint64_t fwd[DP_BENCH_DIR_MAX];
+	/* Worker counters, wrapping */
+	uint32_t dp_in[DP_BENCH_DIR_MAX][EPC_MAX_WORKERS];
+	uint32_t dp_out[DP_BENCH_DIR_MAX][EPC_MAX_WORKERS];
+	uint32_t dp_drop[DP_BENCH_DIR_MAX][EPC_MAX_WORKERS][UP_DROP_MAX];
+	uint64_t dist_drop[DP_BENCH_DIR_MAX];
+	uint64_t port_err[DP_BENCH_DIR_MAX];
+};
+
+static struct bench_cfg cfg;
+
+/* Running counters of the benchmark lcore */
+static struct bench_cnt cnt;
+
+static struct rte_mempool *bench_pool;
+/* Rings of the ports, by port id */
+static struct rte_ring *rx_ring[NUM_SPGW_PORTS][EPC_MAX_WORKERS];
+static struct rte_ring *tx_ring[NUM_SPGW_PORTS][EPC_MAX_WORKERS];
+
+/* Frame templates, the session fields are set per packet */
+static uint8_t tmpl[DP_BENCH_DIR_MAX][RTE_MBUF_DEFAULT_DATAROOM];
+static uint16_t tmpl_len[DP_BENCH_DIR_MAX];
+
+/* Next session and RX ring of each direction */
+static uint32_t next_sess[DP_BENCH_DIR_MAX];
+static uint32_t next_ring[DP_BENCH_DIR_MAX];
+
+/* Control packets of the DP drained from the TX rings */
+static uint64_t ctrl_pkts;
+static uint64_t echo_pkts;
+
+/* Addresses of the ring ports, WB_MAC and EB_MAC of the bench dp.cfg */
+static const struct ether_addr bench_wb_mac = {
+	.addr_bytes = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01}
+};
+static const struct ether_addr bench_eb_mac = {
+	.addr_bytes = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02}
+};
+
+static const char *dir_name[DP_BENCH_DIR_MAX] = {"UL", "DL"};
+
+static const char *drop_name[UP_DROP_MAX] = {
+	[UP_DROP_SESS] = "No session",
+	[UP_DROP_SDF] = "No SDF/PDR match",
+	[UP_DROP_QER] = "QER gate/MBR",
+	[UP_DROP_NEXTHOP] = "Next hop",
+};
+
+/**
+ * @brief  : Create a ring port and its rings
+ * @param  : name, port name
+ * @param  : port_id, WEST_PORT_ID or EAST_PORT_ID, expected port id
+ * @param  : mac, MAC address of the port
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+bench_port_create(const char *name, uint8_t port_id,
+		const struct ether_addr *mac)
+{
+	int port = 0;
+	uint32_t q = 0;
+	char ring_name[RTE_RING_NAMESIZE];
+
+	for (q = 0; q < EPC_MAX_WORKERS; q++) {
+		snprintf(ring_name, sizeof(ring_name), "%s_rx%u", name, q);
+		rx_ring[port_id][q] = rte_ring_create(ring_name, BENCH_RING_SZ,
+				rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+
+		snprintf(ring_name, sizeof(ring_name), "%s_tx%u", name, q);
+		tx_ring[port_id][q] = rte_ring_create(ring_name, BENCH_RING_SZ,
+				rte_socket_id(), RING_F_SC_DEQ);
+
+		if (rx_ring[port_id][q] == NULL || tx_ring[port_id][q] == NULL) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"Failed to create the rings of %s: %s\n",
+				LOG_VALUE, name, rte_strerror(rte_errno));
+			return -1;
+		}
+	}
+
+	port = rte_eth_from_rings(name, rx_ring[port_id], EPC_MAX_WORKERS,
+			tx_ring[port_id], EPC_MAX_WORKERS, rte_socket_id());
+	if (port != port_id) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create the ring port %s\n", LOG_VALUE, name);
+		return -1;
+	}
+
+	/* Ring ports have no address, checked against WB_MAC/EB_MAC */
+	ether_addr_copy(mac, rte_eth_devices[port].data->mac_addrs);
+
+	return 0;
+}
+
+int
+dp_bench_port_init(void)
+{
+	if (rte_eth_dev_count_avail() != 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Ports found, run the benchmark with --no-pci and "
+			"no --vdev\n", LOG_VALUE);
+		return -1;
+	}
+
+	if (bench_port_create("dp_bench_wb", WEST_PORT_ID, &bench_wb_mac) < 0)
+		return -1;
+
+	if (bench_port_create("dp_bench_eb", EAST_PORT_ID, &bench_eb_mac) < 0)
+		return -1;
+
+	bench_pool = rte_pktmbuf_pool_create("dp_bench_pool", BENCH_POOL_SZ,
+			BENCH_POOL_CACHE, 0, RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (bench_pool == NULL) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create the benchmark mbuf pool: %s\n",
+			LOG_VALUE, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Read a number of the benchmark parameters
+ * @param  : file, parameters file
+ * @param  : key, parameter name
+ * @param  : dflt, value when the parameter is not set
+ * @return : Returns parameter value
+ */
+static uint64_t
+bench_cfg_num(struct rte_cfgfile *file, const char *key, uint64_t dflt)
+{
+	const char *entry = rte_cfgfile_get_entry(file, "0", key);
+
+	if (entry == NULL)
+		return dflt;
+
+	return strtoull(entry, NULL, 0);
+}
+
+/**
+ * @brief  : Read an IPv4 address of the benchmark parameters
+ * @param  : file, parameters file
+ * @param  : key, parameter name
+ * @param  : ip, address in host order
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+bench_cfg_ip(struct rte_cfgfile *file, const char *key, uint32_t *ip)
+{
+	struct in_addr addr = {0};
+	const char *entry = rte_cfgfile_get_entry(file, "0", key);
+
+	if (entry == NULL || inet_aton(entry, &addr) == 0) {
+		fprintf(stderr, "DP_BENCH: %s missing or invalid\n", key);
+		return -1;
+	}
+
+	*ip = ntohl(addr.s_addr);
+	fprintf(stderr, "DP_BENCH: %s: %s\n", key, entry);
+	return 0;
+}
+
+/**
+ * @brief  : Read a MAC address of the benchmark parameters
+ * @param  : file, parameters file
+ * @param  : key, parameter name
+ * @param  : mac, address
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+bench_cfg_mac(struct rte_cfgfile *file, const char *key, struct ether_addr *mac)
+{
+	uint8_t *b = mac->addr_bytes;
+	const char *entry = rte_cfgfile_get_entry(file, "0", key);
+
+	if (entry == NULL || sscanf(entry, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+				&b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != ETHER_ADDR_LEN) {
+		fprintf(stderr, "DP_BENCH: %s missing or invalid\n", key);
+		return -1;
+	}
+
+	fprintf(stderr, "DP_BENCH: %s: %s\n", key, entry);
+	return 0;
+}
+
+/**
+ * @brief  : Load the benchmark parameters
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+bench_cfg_load(void)
+{
+	int ret = 0;
+	struct rte_cfgfile *file = rte_cfgfile_load(DP_BENCH_FILE, 0);
+
+	if (file == NULL) {
+		fprintf(stderr, "DP_BENCH: Cannot load %s\n", DP_BENCH_FILE);
+		return -1;
+	}
+
+	cfg.sessions = bench_cfg_num(file, "SESSIONS", 1000);
+	cfg.sess.sdf_filters = bench_cfg_num(file, "SDF_FILTERS", 1);
+	cfg.sess.distinct_sdf = bench_cfg_num(file, "DISTINCT_SDF", 0);
+	cfg.sess.qer_pct = bench_cfg_num(file, "QER_PCT", 0);
+	cfg.sess.urr_pct = bench_cfg_num(file, "URR_PCT", 0);
+	cfg.sess.mbr_kbps = bench_cfg_num(file, "MBR_KBPS", 10000000);
+	cfg.sess.urr_vol_thresh = bench_cfg_num(file, "URR_VOL_THRESH", 0);
+	cfg.pkt_size = bench_cfg_num(file, "PKT_SIZE", 64);
+	cfg.direction = bench_cfg_num(file, "DIRECTION", 0);
+	cfg.rate_pps = bench_cfg_num(file, "RATE_PPS", 0);
+	cfg.warmup_sec = bench_cfg_num(file, "WARMUP_SEC", 2);
+	cfg.duration_sec = bench_cfg_num(file, "DURATION_SEC", 10);
+	cfg.sess.teid_start = bench_cfg_num(file, "TEID_START", 1);
+	cfg.sess.enb_teid_start = bench_cfg_num(file, "ENB_TEID_START", 1);
+	cfg.exit = bench_cfg_num(file, "EXIT", 0);
+
+	if (bench_cfg_ip(file, "ENB_IP", &cfg.sess.enb_ip) < 0 ||
+			bench_cfg_ip(file, "UE_IP_START", &cfg.sess.ue_ip_start) < 0 ||
+			bench_cfg_ip(file, "SERVER_IP", &cfg.server_ip) < 0 ||
+			bench_cfg_mac(file, "ENB_MAC", &cfg.enb_mac) < 0 ||
+			bench_cfg_mac(file, "GW_MAC", &cfg.gw_mac) < 0)
+		ret = -1;
+
+	rte_cfgfile_close(file);
+
+	if (cfg.sessions == 0 || cfg.sess.sdf_filters == 0 ||
+			cfg.sess.sdf_filters > DP_BENCH_SDF_MAX ||
+			cfg.sess.distinct_sdf > 1 ||
+			(cfg.sess.distinct_sdf && (cfg.sess.sdf_filters < 2 ||
+				cfg.sessions > DP_BENCH_DISTINCT_SESS_MAX)) ||
+			cfg.sess.qer_pct > 100 || cfg.sess.urr_pct > 100 ||
+			cfg.direction > 2 ||
+			cfg.pkt_size < sizeof(struct ipv4_hdr) + sizeof(struct udp_hdr) ||
+			cfg.pkt_size > ETHER_MTU - sizeof(struct ipv4_hdr) -
+			sizeof(struct udp_hdr) - GTPU_HDR_SIZE) {
+		fprintf(stderr, "DP_BENCH: Invalid parameters in %s\n", DP_BENCH_FILE);
+		ret = -1;
+	}
+
+	fprintf(stderr, "DP_BENCH: SESSIONS: %u, SDF_FILTERS: %u, DISTINCT_SDF: %u, "
+			"QER_PCT: %u, URR_PCT: %u, PKT_SIZE: %u, DIRECTION: %u, "
+			"RATE_PPS: %lu\n", cfg.sessions, cfg.sess.sdf_filters,
+			cfg.sess.distinct_sdf, cfg.sess.qer_pct, cfg.sess.urr_pct,
+			cfg.pkt_size, cfg.direction, cfg.rate_pps);
+
+	return ret;
+}
+
+/**
+ * @brief  : Install the sessions through the PFCP socket of the DP
+ * @param  : No param
+ * @return : Returns number of accepted sessions
+ */
+static uint32_t
+bench_sess_install(void)
+{
+	int fd = 0;
+	ssize_t len = 0;
+	uint32_t sent = 0;
+	uint32_t rcvd = 0;
+	uint32_t accepted = 0;
+	uint64_t tsc = rte_rdtsc();
+	double sec = 0;
+	struct sockaddr_in dp_addr = {0};
+	struct sockaddr_in local_addr = {0};
+	struct timeval tv = {.tv_sec = BENCH_PFCP_TIMEOUT};
+	static pfcp_sess_estab_req_t req;
+	static pfcp_sess_estab_rsp_t rsp;
+	static uint8_t buf[PFCP_MSG_LEN];
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to create the PFCP socket: %s\n",
+			LOG_VALUE, strerror(errno));
+		return 0;
+	}
+
+	/* Sessions and reports of the DP come back to this address */
+	local_addr.sin_family = AF_INET;
+	local_addr.sin_addr = dp_comm_ip;
+	if (bind(fd, (struct sockaddr *)&local_addr, sizeof(local_addr)) < 0 ||
+			setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0) {
+		clLog(clSystemLog, eCLSeverityCritical,
+			LOG_FORMAT"Failed to set up the PFCP socket: %s\n",
+			LOG_VALUE, strerror(errno));
+		close(fd);
+		return 0;
+	}
+
+	dp_addr.sin_family = AF_INET;
+	dp_addr.sin_addr = dp_comm_ip;
+	dp_addr.sin_port = dp_comm_port;
+
+	while (rcvd < cfg.sessions) {
+		while (sent < cfg.sessions && sent - rcvd < BENCH_PFCP_WINDOW) {
+			dp_bench_sess_req(&cfg.sess, &req, sent);
+			len = encode_pfcp_sess_estab_req_t(&req, buf);
+			if (sendto(fd, buf, len, 0, (struct sockaddr *)&dp_addr,
+						sizeof(dp_addr)) < 0) {
+				clLog(clSystemLog, eCLSeverityCritical,
+					LOG_FORMAT"Failed to send the Session Establishment "
+					"Request: %s\n", LOG_VALUE, strerror(errno));
+				close(fd);
+				return accepted;
+			}
+			sent++;
+		}
+
+		len = recv(fd, buf, sizeof(buf), 0);
+		if (len <= 0) {
+			clLog(clSystemLog, eCLSeverityCritical,
+				LOG_FORMAT"%u Session Establishment Requests not answered\n",
+				LOG_VALUE, sent - rcvd);
+			break;
+		}
+
+		if (((pfcp_header_t *)buf)->message_type !=
+				PFCP_SESSION_ESTABLISHMENT_RESPONSE)
+			continue;
+
+		memset(&rsp, 0, sizeof(rsp));
+		decode_pfcp_sess_estab_rsp_t(buf, &rsp);
+		rcvd++;
+		if (rsp.cause.cause_value == REQUESTACCEPTED)
+			accepted++;
+	}
+
+	close(fd);
+
+	sec = (double)(rte_rdtsc() - tsc) / rte_get_tsc_hz();
+	printf("DP_BENCH: %u/%u sessions installed in %.2f sec, %.0f per sec\n",
+			accepted, cfg.sessions, sec, sec > 0 ? rcvd / sec : 0);
+
+	return accepted;
+}
+
+/**
+ * @brief  : Build the frame templates of both directions
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+bench_tmpl_init(void)
+{
+	struct ether_hdr *eth = NULL;
+	struct ipv4_hdr *ip = NULL;
+	struct udp_hdr *udp = NULL;
+	struct gtpu_hdr *gtpu = NULL;
+	uint8_t *inner = NULL;
+
+	/* Inner packet, the UE IP is set per packet */
+	inner = &tmpl[DP_BENCH_UL][ETH_HDR_LEN + IPV4_HDR_LEN + UDP_HDR_LEN +
+		GTPU_HDR_SIZE];
+	ip = (struct ipv4_hdr *)inner;
+	ip->version_ihl = IPv4_VERSION | (IPV4_HDR_LEN / IPV4_IHL_MULTIPLIER);
+	ip->total_length = htons(cfg.pkt_size);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->dst_addr = htonl(cfg.server_ip);
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = htons(BENCH_UE_PORT);
+	udp->dst_port = htons(BENCH_SERVER_PORT);
+	udp->dgram_len = htons(cfg.pkt_size - IPV4_HDR_LEN);
+
+	/* Uplink GTP-U from the eNB, the TEID is set per packet */
+	eth = (struct ether_hdr *)tmpl[DP_BENCH_UL];
+	ether_addr_copy(&bench_wb_mac, &eth->d_addr);
+	ether_addr_copy(&cfg.enb_mac, &eth->s_addr);
+	eth->ether_type = htons(ETHER_TYPE_IPv4);
+	ip = (struct ipv4_hdr *)(eth + 1);
+	ip->version_ihl = IPv4_VERSION | (IPV4_HDR_LEN / IPV4_IHL_MULTIPLIER);
+	ip->total_length = htons(IPV4_HDR_LEN + UDP_HDR_LEN + GTPU_HDR_SIZE +
+			cfg.pkt_size);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = htonl(cfg.sess.enb_ip);
+	ip->dst_addr = htonl(app.wb_ip);
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = htons(UDP_PORT_GTPU);
+	udp->dst_port = htons(UDP_PORT_GTPU);
+	udp->dgram_len = htons(UDP_HDR_LEN + GTPU_HDR_SIZE + cfg.pkt_size);
+	gtpu = (struct gtpu_hdr *)(udp + 1);
+	gtpu->version = GTPU_VERSION;
+	gtpu->pt = GTP_PROTOCOL_TYPE_GTP;
+	gtpu->msgtype = GTP_GPDU;
+	gtpu->msglen = htons(cfg.pkt_size);
+	tmpl_len[DP_BENCH_UL] = ETH_HDR_LEN + IPV4_HDR_LEN + UDP_HDR_LEN +
+		GTPU_HDR_SIZE + cfg.pkt_size;
+
+	/* Downlink SGi packet from the server, the UE IP is set per packet */
+	eth = (struct ether_hdr *)tmpl[DP_BENCH_DL];
+	ether_addr_copy(&bench_eb_mac, &eth->d_addr);
+	ether_addr_copy(&cfg.gw_mac, &eth->s_addr);
+	eth->ether_type = htons(ETHER_TYPE_IPv4);
+	ip = (struct ipv4_hdr *)(eth + 1);
+	ip->version_ihl = IPv4_VERSION | (IPV4_HDR_LEN / IPV4_IHL_MULTIPLIER);
+	ip->total_length = htons(cfg.pkt_size);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = htonl(cfg.server_ip);
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = htons(BENCH_SERVER_PORT);
+	udp->dst_port = htons(BENCH_UE_PORT);
+	udp->dgram_len = htons(cfg.pkt_size - IPV4_HDR_LEN);
+	tmpl_len[DP_BENCH_DL] = ETH_HDR_LEN + cfg.pkt_size;
+}
+
+/**
+ * @brief  : Number of RX queues polled by the DP on the ingress port
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @return : Returns number of queues
+ */
+static uint32_t
+bench_rx_queues(uint8_t dir)
+{
+	if (epc_app.core_dist != -1)
+		return 1;
+
+	return (dir == DP_BENCH_UL) ? epc_app.num_ul_workers : epc_app.num_dl_workers;
+}
+
+/**
+ * @brief  : Inject a burst of packets of the next sessions
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @param  : n, number of packets
+ * @return : Returns nothing
+ */
+static void
+bench_gen(uint8_t dir, uint32_t n)
+{
+	uint32_t i = 0;
+	uint32_t enq = 0;
+	uint32_t sess = 0;
+	uint8_t *frame = NULL;
+	struct ipv4_hdr *ip = NULL;
+	struct gtpu_hdr *gtpu = NULL;
+	struct rte_mbuf *pkts[BENCH_BURST];
+	struct rte_ring *ring = rx_ring[(dir == DP_BENCH_UL) ?
+		WEST_PORT_ID : EAST_PORT_ID][next_ring[dir]];
+
+	/* Pool empty, the DP holds the packets */
+	if (rte_pktmbuf_alloc_bulk(bench_pool, pkts, n) != 0)
+		return;
+
+	for (i = 0; i < n; i++) {
+		sess = next_sess[dir];
+		if (++next_sess[dir] == cfg.sessions)
+			next_sess[dir] = 0;
+
+		frame = rte_pktmbuf_mtod(pkts[i], uint8_t *);
+		rte_memcpy(frame, tmpl[dir], tmpl_len[dir]);
+		pkts[i]->data_len = tmpl_len[dir];
+		pkts[i]->pkt_len = tmpl_len[dir];
+
+		if (dir == DP_BENCH_UL) {
+			pkts[i]->port = WEST_PORT_ID;
+			gtpu = (struct gtpu_hdr *)(frame + ETH_HDR_LEN + IPV4_HDR_LEN +
+					UDP_HDR_LEN);
+			gtpu->teid = htonl(cfg.sess.teid_start + sess);
+			ip = (struct ipv4_hdr *)((uint8_t *)gtpu + GTPU_HDR_SIZE);
+			ip->src_addr = htonl(cfg.sess.ue_ip_start + sess);
+		} else {
+			pkts[i]->port = EAST_PORT_ID;
+			ip = (struct ipv4_hdr *)(frame + ETH_HDR_LEN);
+			ip->dst_addr = htonl(cfg.sess.ue_ip_start + sess);
+		}
+		ip->hdr_checksum = rte_ipv4_cksum(ip);
+	}
+
+	if (++next_ring[dir] >= bench_rx_queues(dir))
+		next_ring[dir] = 0;
+
+	enq = rte_ring_enqueue_burst(ring, (void **)pkts, n, NULL);
+	cnt.offered[dir] += n;
+	cnt.rx_full[dir] += n - enq;
+	for (i = enq; i < n; i++)
+		rte_pktmbuf_free(pkts[i]);
+}
+
+/**
+ * @brief  : Count a packet sent by the DP on the west port, answer the
+ *           GTP-U echo requests sent to the eNB
+ * @param  : m, packet
+ * @return : Returns nothing
+ */
+static void
+bench_west_tx(struct rte_mbuf *m)
+{
+	struct ether_hdr *eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	struct gtpu_hdr *gtpu = NULL;
+
+	if (eth->ether_type != htons(ETHER_TYPE_IPv4) ||
+			get_mtoip(m)->next_proto_id != IPPROTO_UDP ||
+			ntohs(get_mtoudp(m)->dst_port) != UDP_PORT_GTPU) {
+		ctrl_pkts++;
+		rte_pktmbuf_free(m);
+		return;
+	}
+
+	gtpu = get_mtogtpu(m);
+	if (gtpu->msgtype == GTP_GPDU) {
+		cnt.fwd[DP_BENCH_DL]++;
+		rte_pktmbuf_free(m);
+		return;
+	}
+
+	if (gtpu->msgtype == GTPU_ECHO_REQUEST) {
+		echo_pkts++;
+		process_echo_request(m, WEST_PORT_ID, IPV4_TYPE);
+		if (rte_ring_enqueue(rx_ring[WEST_PORT_ID][0], m) == 0)
+			return;
+	} else {
+		ctrl_pkts++;
+	}
+
+	rte_pktmbuf_free(m);
+}
+
+/**
+ * @brief  : Count a packet sent by the DP on the east port
+ * @param  : m, packet
+ * @return : Returns nothing
+ */
+static void
+bench_east_tx(struct rte_mbuf *m)
+{
+	struct ether_hdr *eth = rte_pktmbuf_mtod(m, struct ether_hdr *);
+
+	if (eth->ether_type == htons(ETHER_TYPE_IPv4) &&
+			get_mtoip(m)->dst_addr == htonl(cfg.server_ip))
+		cnt.fwd[DP_BENCH_UL]++;
+	else
+		ctrl_pkts++;
+
+	rte_pktmbuf_free(m);
+}
+
+/**
+ * @brief  : Drain the TX rings of both ports
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+bench_drain(void)
+{
+	uint32_t q = 0;
+	uint32_t i = 0;
+	uint32_t n = 0;
+	struct rte_mbuf *pkts[BENCH_BURST];
+
+	for (q = 0; q < EPC_MAX_WORKERS; q++) {
+		n = rte_ring_dequeue_burst(tx_ring[WEST_PORT_ID][q], (void **)pkts,
+				BENCH_BURST, NULL);
+		for (i = 0; i < n; i++)
+			bench_west_tx(pkts[i]);
+
+		n = rte_ring_dequeue_burst(tx_ring[EAST_PORT_ID][q], (void **)pkts,
+				BENCH_BURST, NULL);
+		for (i = 0; i < n; i++)
+			bench_east_tx(pkts[i]);
+	}
+}
+
+/**
+ * @brief  : Read the counters of the benchmark and of the DP
+ * @param  : c, filled with the counters
+ * @return : Returns nothing
+ */
+static void
+bench_snapshot(struct bench_cnt *c)
+{
+	uint32_t wk = 0;
+	uint32_t q = 0;
+	struct rte_eth_stats st = {0};
+	struct up_dist_stats ds = {0};
+
+	memcpy(c, &cnt, sizeof(*c));
+	c->tsc = rte_rdtsc();
+
+	for (wk = 0; wk < epc_app.num_ul_workers; wk++) {
+		c->dp_in[DP_BENCH_UL][wk] = epc_app.ul_params[wk].pkts_in;
+		c->dp_out[DP_BENCH_UL][wk] = epc_app.ul_params[wk].pkts_out;
+		memcpy(c->dp_drop[DP_BENCH_UL][wk], epc_app.ul_params[wk].pkts_drop,
+				sizeof(c->dp_drop[DP_BENCH_UL][wk]));
+	}
+
+	for (wk = 0; wk < epc_app.num_dl_workers; wk++) {
+		c->dp_in[DP_BENCH_DL][wk] = epc_app.dl_params[wk].pkts_in;
+		c->dp_out[DP_BENCH_DL][wk] = epc_app.dl_params[wk].pkts_out;
+		memcpy(c->dp_drop[DP_BENCH_DL][wk], epc_app.dl_params[wk].pkts_drop,
+				sizeof(c->dp_drop[DP_BENCH_DL][wk]));
+	}
+
+	if (epc_app.core_dist != -1) {
+		up_dist_stats_get(WEST_PORT_ID, &ds);
+		for (q = 0; q < EPC_MAX_WORKERS; q++)
+			c->dist_drop[DP_BENCH_UL] += ds.drop[q];
+
+		up_dist_stats_get(EAST_PORT_ID, &ds);
+		for (q = 0; q < EPC_MAX_WORKERS; q++)
+			c->dist_drop[DP_BENCH_DL] += ds.drop[q];
+	}
+
+	/* The egress port of the direction */
+	if (rte_eth_stats_get(EAST_PORT_ID, &st) == 0)
+		c->port_err[DP_BENCH_UL] = st.oerrors;
+	if (rte_eth_stats_get(WEST_PORT_ID, &st) == 0)
+		c->port_err[DP_BENCH_DL] = st.oerrors;
+}
+
+/**
+ * @brief  : Print the results of a direction
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @param  : a, counters at the start of the measurement
+ * @param  : b, counters at the end of the measurement
+ * @return : Returns nothing
+ */
+static void
+bench_report_dir(uint8_t dir, const struct bench_cnt *a,
+		const struct bench_cnt *b)
+{
+	uint32_t wk = 0;
+	uint8_t r = 0;
+	uint64_t in = 0;
+	uint64_t out = 0;
+	uint64_t known = 0;
+	uint64_t drop[UP_DROP_MAX] = {0};
+	uint32_t workers = (dir == DP_BENCH_UL) ?
+		epc_app.num_ul_workers : epc_app.num_dl_workers;
+	uint64_t cycles = b->tsc - a->tsc;
+	double sec = (double)cycles / rte_get_tsc_hz();
+	uint64_t offered = b->offered[dir] - a->offered[dir];
+	uint64_t fwd = b->fwd[dir] - a->fwd[dir];
+
+	for (wk = 0; wk < workers; wk++) {
+		in += (uint32_t)(b->dp_in[dir][wk] - a->dp_in[dir][wk]);
+		out += (uint32_t)(b->dp_out[dir][wk] - a->dp_out[dir][wk]);
+		for (r = 0; r < UP_DROP_MAX; r++)
+			drop[r] += (uint32_t)(b->dp_drop[dir][wk][r] -
+					a->dp_drop[dir][wk][r]);
+	}
+
+	printf("%s offered      : %lu pkts, %.3f Mpps\n", dir_name[dir],
+			offered, offered / sec / 1e6);
+	printf("%s forwarded    : %lu pkts, %.3f Mpps\n", dir_name[dir],
+			fwd, fwd / sec / 1e6);
+	if (fwd) {
+		printf("%s cycles/pkt   : %.1f (%u workers)\n", dir_name[dir],
+				(double)cycles * workers / fwd, workers);
+	}
+
+	printf("%s drops:\n", dir_name[dir]);
+	printf("  %-18s: %lu\n", "RX ring full",
+			b->rx_full[dir] - a->rx_full[dir]);
+	if (epc_app.core_dist != -1) {
+		printf("  %-18s: %lu\n", "Distributor ring",
+				b->dist_drop[dir] - a->dist_drop[dir]);
+	}
+	for (r = 0; r < UP_DROP_MAX; r++) {
+		printf("  %-18s: %lu\n", drop_name[r], drop[r]);
+		known += drop[r];
+	}
+	printf("  %-18s: %lu\n", "TX port errors",
+			b->port_err[dir] - a->port_err[dir]);
+	printf("  %-18s: %ld\n", "Other", (int64_t)(in - out - known));
+}
+
+/**
+ * @brief  : Print the results of the measurement
+ * @param  : a, counters at the start of the measurement
+ * @param  : b, counters at the end of the measurement
+ * @return : Returns nothing
+ */
+static void
+bench_report(const struct bench_cnt *a, const struct bench_cnt *b)
+{
+	uint8_t dir = 0;
+	uint8_t stage = 0;
+	static prof_stats_t prof;
+
+	printf("\n**************************\n");
+	printf("DP BENCHMARK :: %u sessions, %u SDF filters, %u%% QER, %u%% URR, "
+			"%u bytes, %.1f sec\n", cfg.sessions, cfg.sess.sdf_filters,
+			cfg.sess.qer_pct, cfg.sess.urr_pct, cfg.pkt_size,
+			(double)(b->tsc - a->tsc) / rte_get_tsc_hz());
+	printf("**************************\n");
+
+	for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++) {
+		if (cfg.direction && cfg.direction != dir + 1)
+			continue;
+		bench_report_dir(dir, a, b);
+	}
+
+	printf("Control pkts   : %lu, echo requests answered: %lu\n",
+			ctrl_pkts, echo_pkts);
+
+	/* Stage breakdown of the sampled bursts of the measurement */
+	if (up_prof_period && up_prof_stats_get(&prof) == 0) {
+		printf("Stages (nsec)  : mean / p50 / p99, 1 burst in %u\n",
+				up_prof_period);
+		for (dir = 0; dir < PROF_DIR_MAX; dir++) {
+			for (stage = 0; stage < PROF_STAGE_MAX; stage++) {
+				prof_stage_stats_t *ps = &prof.stage[dir][stage];
+
+				if (ps->samples == 0)
+					continue;
+				printf("  %s %-8s: %lu / %lu / %lu\n", prof.dir_name[dir],
+						ps->name, ps->mean_ns, ps->p50_ns, ps->p99_ns);
+			}
+		}
+	}
+	printf("**************************\n");
+	fflush(stdout);
+}
+
+void
+dp_bench_run(void *arg)
+{
+	uint8_t dir = 0;
+	uint8_t measuring = 0;
+	uint32_t n = 0;
+	uint64_t now = 0;
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t start = 0;
+	uint64_t warm_end = 0;
+	uint64_t end = 0;
+	uint64_t allowed = 0;
+	uint64_t gen[DP_BENCH_DIR_MAX] = {0};
+	static uint8_t done;
+	static struct bench_cnt a;
+	static struct bench_cnt b;
+
+	RTE_SET_USED(arg);
+
+	/* Called in the loop of the lcore, the DP is left running */
+	if (done) {
+		bench_drain();
+		return;
+	}
+	done = 1;
+
+	if (bench_cfg_load() < 0 || bench_sess_install() == 0) {
+		fprintf(stderr, "DP_BENCH: Benchmark not started\n");
+		return;
+	}
+	bench_tmpl_init();
+
+	start = rte_rdtsc();
+	warm_end = start + cfg.warmup_sec * hz;
+	end = warm_end + cfg.duration_sec * hz;
+
+	while ((now = rte_rdtsc()) < end) {
+		if (!measuring && now >= warm_end) {
+			/* Restart the stage histograms for the measurement */
+			if (up_prof_period)
+				up_prof_set_period(up_prof_period);
+			bench_snapshot(&a);
+			measuring = 1;
+		}
+
+		for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++) {
+			if (cfg.direction && cfg.direction != dir + 1)
+				continue;
+
+			n = BENCH_BURST;
+			if (cfg.rate_pps) {
+				allowed = (double)(now - start) * cfg.rate_pps / hz;
+				n = RTE_MIN(allowed - RTE_MIN(allowed, gen[dir]),
+						(uint64_t)BENCH_BURST);
+			}
+			if (n == 0)
+				continue;
+
+			bench_gen(dir, n);
+			gen[dir] += n;
+		}
+
+		bench_drain();
+	}
+
+	bench_snapshot(&b);
+	bench_report(&a, &b);
+
+	if (cfg.exit)
+		kill(getpid(), SIGINT);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DP_BENCH_H_
+#define _DP_BENCH_H_
+/**
+ * @file
+ * This file contains the DP throughput benchmark, built in the dataplane
+ * with DP_BENCH.
+ *
+ * The west and east ports are in-process ring ports, no NIC or vdev is
+ * needed. Once the DP is up, the benchmark lcore installs the sessions
+ * through the PFCP socket of the DP, like a CP would, then injects GTP-U
+ * uplink and SGi downlink packets into the RX rings of the ports and
+ * drains their TX rings. The GTP-U echo requests sent to the eNB are
+ * answered, so the sessions are not flushed as a dead peer.
+ *
+ * After a warm-up, the packets offered and forwarded, the worker cycles
+ * per forwarded packet and the drops per reason are measured over the
+ * configured duration and printed per direction.
+ */
+#include <stdint.h>
+
+/* Benchmark parameters, section [0] */
+#define DP_BENCH_FILE		"../config/dp_bench.cfg"
+
+/**
+ * @brief  : Create the ring ports used as west and east ports, before
+ *           the ports are initialized by the DP
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+int
+dp_bench_port_init(void);
+
+/**
+ * @brief  : Run the benchmark on its first call, then keep draining the
+ *           TX rings of the ports, benchmark lcore
+ * @param  : arg, unused parameter
+ * @return : Returns nothing
+ */
+void
+dp_bench_run(void *arg);
+
+#endif /* _DP_BENCH_H_ */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+#include "up_main.h"
+#include "pfcp_enum.h"
+#include "pfcp_set_ie.h"
+#include "dp_bench_sess.h"
+
+/* Length of the SDF filter flags */
+#define BENCH_SDF_FLAG_LEN	2
+
+extern struct in_addr dp_comm_ip;
+
+/**
+ * @brief  : Add an SDF filter to the PDI
+ * @param  : pdi, PDI of the Create PDR
+ * @param  : idx, filter index
+ * @param  : rule, flow description
+ * @return : Returns IE size
+ */
+static int
+bench_sdf_add(pfcp_pdi_ie_t *pdi, uint8_t idx, const char *rule)
+{
+	int len = 0;
+	pfcp_sdf_filter_ie_t *sdf = &pdi->sdf_filter[idx];
+
+	sdf->fd = PRESENT;
+	sdf->len_of_flow_desc = strnlen(rule, sizeof(sdf->flow_desc));
+	memcpy(sdf->flow_desc, rule, sdf->len_of_flow_desc);
+
+	len = BENCH_SDF_FLAG_LEN + sizeof(uint16_t) + sdf->len_of_flow_desc;
+	pfcp_set_ie_header(&sdf->header, PFCP_IE_SDF_FILTER, len);
+
+	pdi->header.len += len + sizeof(pfcp_ie_header_t);
+	pdi->sdf_filter_count = idx + 1;
+
+	return len + sizeof(pfcp_ie_header_t);
+}
+
+void
+dp_bench_sess_sdf(const struct dp_bench_sess_cfg *sc, uint32_t idx,
+		uint32_t k, char *rule, size_t len)
+{
+	if (sc->distinct_sdf)
+		snprintf(rule, len, "10.%u.%u.%u/32 10.255.%u.0/24 "
+				"0 : 65535 0 : 65535 0x11/0xff", (idx >> 16) & 0xff,
+				(idx >> 8) & 0xff, idx & 0xff, k);
+	else
+		snprintf(rule, len, "10.255.%u.0/24 10.255.%u.0/24 "
+				"0 : 65535 0 : 65535 0x11/0xff", k, k);
+}
+
+/**
+ * @brief  : Fill the uplink or downlink Create PDR of a session
+ * @param  : sc, session parameters
+ * @param  : cpdr, Create PDR
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @param  : idx, session index
+ * @param  : qer, set when the session has a QER
+ * @param  : urr, set when the session has URRs
+ * @return : Returns nothing
+ */
+static void
+bench_pdr(const struct dp_bench_sess_cfg *sc, pfcp_create_pdr_ie_t *cpdr,
+		uint8_t dir, uint32_t idx, uint8_t qer, uint8_t urr)
+{
+	int len = 0;
+	uint32_t k = 0;
+	pdr_t pdr = {0};
+	fteid_ie_t fteid = {0};
+	ue_ip_addr_t ue_addr = {0};
+	char rule[MAX_FLOW_DESC_LEN] = {0};
+
+	pdr.rule_id = dir + 1;
+	pdr.prcdnc_val = DP_BENCH_PRECEDENCE;
+	pdr.pdi.src_intfc.interface_value = (dir == DP_BENCH_UL) ?
+		SOURCE_INTERFACE_VALUE_ACCESS : SOURCE_INTERFACE_VALUE_CORE;
+	set_create_pdr(cpdr, &pdr, 0);
+
+	if (dir == DP_BENCH_UL) {
+		fteid.v4 = PRESENT;
+		fteid.teid = sc->teid_start + idx;
+		fteid.ipv4_address = htonl(app.wb_ip);
+		len = set_fteid(&cpdr->pdi.local_fteid, &fteid);
+		cpdr->pdi.header.len += len;
+		cpdr->header.len += len;
+
+		cpdr->header.len += set_outer_hdr_removal(&cpdr->outer_hdr_removal,
+				GTP_U_UDP_IPv4);
+	} else {
+		ue_addr.v4 = PRESENT;
+		ue_addr.ipv4_address = htonl(sc->ue_ip_start + idx);
+		len = set_ue_ip(&cpdr->pdi.ue_ip_address, ue_addr);
+		cpdr->pdi.header.len += len;
+		cpdr->header.len += len;
+	}
+
+	/* Filters matching no packet, then the filter matching all of them */
+	for (k = 0; k + 1 < sc->sdf_filters; k++) {
+		dp_bench_sess_sdf(sc, idx, k, rule, sizeof(rule));
+		cpdr->header.len += bench_sdf_add(&cpdr->pdi, k, rule);
+	}
+	cpdr->header.len += bench_sdf_add(&cpdr->pdi, k,
+			"0.0.0.0/0 0.0.0.0/0 0 : 65535 0 : 65535 0x0/0x0");
+
+	cpdr->header.len += set_far_id(&cpdr->far_id, dir + 1);
+
+	if (qer) {
+		cpdr->qer_id_count = 1;
+		cpdr->header.len += set_qer_id(&cpdr->qer_id[0], 1);
+	}
+
+	if (urr) {
+		cpdr->urr_id_count = 1;
+		cpdr->header.len += set_urr_id(&cpdr->urr_id[0], dir + 1);
+	}
+}
+
+void
+dp_bench_sess_req(const struct dp_bench_sess_cfg *sc,
+		pfcp_sess_estab_req_t *req, uint32_t idx)
+{
+	uint16_t len = 0;
+	uint8_t dir = 0;
+	far_t far = {0};
+	qer_t qer = {0};
+	pdr_t urr_pdr = {0};
+	node_address_t node = {0};
+	node_address_t enb = {0};
+	uint8_t has_qer = (idx % 100) < sc->qer_pct;
+	uint8_t has_urr = (idx % 100) < sc->urr_pct;
+
+	memset(req, 0, sizeof(*req));
+
+	/* SEID 0, the UP SEID is made from the CP SEID */
+	set_pfcp_seid_header(&req->header, PFCP_SESSION_ESTABLISHMENT_REQUEST,
+			HAS_SEID, idx + 1, 0);
+
+	node.ip_type = PDN_TYPE_IPV4;
+	node.ipv4_addr = dp_comm_ip.s_addr;
+	set_node_id(&req->node_id, node);
+	set_fseid(&req->cp_fseid, idx + 1, node);
+
+	for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++)
+		bench_pdr(sc, &req->create_pdr[dir], dir, idx, has_qer, has_urr);
+	req->create_pdr_count = DP_BENCH_DIR_MAX;
+
+	/* Uplink FAR, to the SGi */
+	far.far_id_value = DP_BENCH_UL + 1;
+	far.actions.forw = PRESENT;
+	set_create_far(&req->create_far[DP_BENCH_UL], &far);
+	len = set_destination_interface(
+			&req->create_far[DP_BENCH_UL].frwdng_parms.dst_intfc,
+			DESTINATION_INTERFACE_VALUE_CORE);
+	pfcp_set_ie_header(&req->create_far[DP_BENCH_UL].frwdng_parms.header,
+			IE_FRWDNG_PARMS, len);
+	req->create_far[DP_BENCH_UL].header.len += len + sizeof(pfcp_ie_header_t);
+
+	/* Downlink FAR, to the eNB */
+	far.far_id_value = DP_BENCH_DL + 1;
+	set_create_far(&req->create_far[DP_BENCH_DL], &far);
+	enb.ip_type = PDN_TYPE_IPV4;
+	enb.ipv4_addr = htonl(sc->enb_ip);
+	req->create_far[DP_BENCH_DL].header.len +=
+		set_forwarding_param(&req->create_far[DP_BENCH_DL].frwdng_parms, enb,
+				sc->enb_teid_start + idx, DESTINATION_INTERFACE_VALUE_ACCESS);
+	req->create_far_count = DP_BENCH_DIR_MAX;
+
+	if (has_qer) {
+		qer.qer_id = 1;
+		qer.max_bitrate.ul_mbr = sc->mbr_kbps;
+		qer.max_bitrate.dl_mbr = sc->mbr_kbps;
+		set_create_qer(&req->create_qer[0], &qer);
+		req->create_qer_count = 1;
+	}
+
+	if (has_urr) {
+		for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++) {
+			memset(&urr_pdr, 0, sizeof(urr_pdr));
+			urr_pdr.pdi.src_intfc.interface_value = (dir == DP_BENCH_UL) ?
+				SOURCE_INTERFACE_VALUE_ACCESS : SOURCE_INTERFACE_VALUE_CORE;
+			urr_pdr.urr.urr_id_value = dir + 1;
+			urr_pdr.urr.mea_mt.volum = PRESENT;
+			if (sc->urr_vol_thresh) {
+				urr_pdr.urr.rept_trigg.volth = PRESENT;
+				urr_pdr.urr.vol_th.uplink_volume = sc->urr_vol_thresh;
+				urr_pdr.urr.vol_th.downlink_volume = sc->urr_vol_thresh;
+			}
+			set_create_urr(&req->create_urr[dir], &urr_pdr);
+		}
+		req->create_urr_count = DP_BENCH_DIR_MAX;
+	}
+}
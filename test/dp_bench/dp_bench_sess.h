@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DP_BENCH_SESS_H_
+#define _DP_BENCH_SESS_H_
+/**
+ * @file
+ * This file contains the Session Establishment Requests of the DP
+ * benchmarks, shared by the throughput benchmark and the microbenchmarks.
+ *
+ * Session idx has one uplink PDR on TEID teid_start + idx and one downlink
+ * PDR on UE IP ue_ip_start + idx, each with sdf_filters SDF filters: the
+ * first ones match no packet, the last one matches all the traffic. The
+ * uplink FAR forwards to the SGi, the downlink FAR encapsulates to the eNB
+ * on TEID enb_teid_start + idx. qer_pct and urr_pct of the sessions get an
+ * MBR QER and volume URRs.
+ *
+ * With distinct_sdf, the filters matching no packet are on a source
+ * address of the session, each one is then a distinct rule and takes an
+ * ACL table of its own: 2 x (sdf_filters - 1) tables per session.
+ */
+#include <stdint.h>
+#include <stddef.h>
+
+#include "pfcp_messages.h"
+
+/* Max SDF filters per PDR, the last one matches all the traffic */
+#define DP_BENCH_SDF_MAX	8
+
+/* Sessions with distinct filters, on the last 3 bytes of the address */
+#define DP_BENCH_DISTINCT_SESS_MAX	(1 << 24)
+
+/* Precedence of the PDRs */
+#define DP_BENCH_PRECEDENCE	100
+
+/* Directions */
+#define DP_BENCH_UL		0
+#define DP_BENCH_DL		1
+#define DP_BENCH_DIR_MAX	2
+
+/**
+ * @brief  : Session parameters of the benchmarks
+ */
+struct dp_bench_sess_cfg {
+	uint32_t sdf_filters;
+	uint32_t qer_pct;
+	uint32_t urr_pct;
+	uint32_t mbr_kbps;
+	uint64_t urr_vol_thresh;
+	/* Filters matching no packet distinct per session */
+	uint8_t distinct_sdf;
+	/* Host order */
+	uint32_t enb_ip;
+	uint32_t ue_ip_start;
+	uint32_t teid_start;
+	uint32_t enb_teid_start;
+};
+
+/**
+ * @brief  : Fill the flow description of an SDF filter matching no packet
+ * @param  : sc, session parameters
+ * @param  : idx, session index
+ * @param  : k, filter index, below sdf_filters - 1
+ * @param  : rule, flow description to fill
+ * @param  : len, size of rule
+ * @return : Returns nothing
+ */
+void
+dp_bench_sess_sdf(const struct dp_bench_sess_cfg *sc, uint32_t idx,
+		uint32_t k, char *rule, size_t len);
+
+/**
+ * @brief  : Fill the Session Establishment Request of a session
+ * @param  : sc, session parameters
+ * @param  : req, request
+ * @param  : idx, session index
+ * @return : Returns nothing
+ */
+void
+dp_bench_sess_req(const struct dp_bench_sess_cfg *sc,
+		pfcp_sess_estab_req_t *req, uint32_t idx);
+
+#endif /* _DP_BENCH_SESS_H_ */
@@ -0,0 +1,1205 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Microbenchmarks of the DP fast path functions, built from the DP objects
+ * in place of up_main.c with MBENCH=1, see README.txt.
+ *
+ * The sessions are installed with process_up_session_estab_req, as done on
+ * a Session Establishment Request, then the UL and DL functions are called
+ * in the order of wb_pkt_handler/eb_pkt_handler on pre-built bursts of
+ * GTP-U and SGi packets. Every function call is timed on its own and
+ * reported in cycles per packet of the burst.
+ *
+ * With --lookup the session table alone is measured instead: the TEID
+ * table is filled with session data as on a session setup, then looked up
+ * with the bulk lookup of the UL handler, in lookups per second.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <arpa/inet.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+#include <rte_malloc.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_hash_crc.h>
+
+#include "gw_adapter.h"
+
+#include "up_main.h"
+#include "gtpu.h"
+#include "up_rcu.h"
+#include "up_acl.h"
+#include "up_adj.h"
+#include "up_urr.h"
+#include "up_mtr.h"
+#include "up_clock.h"
+#include "up_twheel.h"
+#include "pfcp_up_llist.h"
+#include "pfcp_up_sess.h"
+#include "pfcp_messages_encoder.h"
+#include "pfcp_messages_decoder.h"
+#include "config_validater.h"
+#ifdef USE_CSID
+#include "csid_struct.h"
+#endif /* USE_CSID */
+#include "dp_bench_sess.h"
+
+#define LOGGER_JSON_PATH "../config/log.json"
+
+/* Defaults of the options */
+#define MBENCH_SESSIONS		10000
+#define MBENCH_BURST		32
+#define MBENCH_BURSTS		1024
+#define MBENCH_ITERATIONS	100
+#define MBENCH_PKT_SIZE		64
+
+/* Bytes of the frame saved and restored before each call chain, covers
+ * every header written by the fast path */
+#define MBENCH_RESTORE_LEN	128
+
+/* Max wait of the ACL builder after the session install, in msec */
+#define MBENCH_ACL_WAIT_MS	60000
+
+/* Free entries of the TEID table of the lookup benchmark, in % */
+#define MBENCH_LKUP_HEADROOM	25
+
+/* Samples of the timer overhead calibration */
+#define MBENCH_CAL_LOOPS	1000
+
+/* Peers of the benchmark traffic, host order */
+#define MBENCH_ENB_IP		IPv4(11, 7, 1, 101)
+#define MBENCH_UE_IP_START	IPv4(16, 0, 0, 1)
+#define MBENCH_SERVER_IP	IPv4(13, 7, 1, 110)
+#define MBENCH_TEID_START	1
+#define MBENCH_ENB_TEID_START	1
+
+/* Inner and SGi UDP ports */
+#define MBENCH_UE_PORT		5000
+#define MBENCH_SERVER_PORT	6000
+
+/**
+ * @brief  : Timed functions, in the order of the UL and DL handlers
+ */
+enum mbench_fn {
+	MBENCH_SESS,
+	MBENCH_USAGE_UL,
+	MBENCH_DECAP,
+	MBENCH_ACL,
+	MBENCH_QER,
+	MBENCH_MTR,
+	MBENCH_ENCAP,
+	MBENCH_NEXTHOP,
+	MBENCH_USAGE_DL,
+	MBENCH_FN_MAX
+};
+
+/* Functions called per direction, in call order */
+static const uint8_t mbench_chain[DP_BENCH_DIR_MAX][MBENCH_FN_MAX] = {
+	[DP_BENCH_UL] = {MBENCH_SESS, MBENCH_USAGE_UL, MBENCH_DECAP, MBENCH_ACL,
+		MBENCH_QER, MBENCH_MTR, MBENCH_NEXTHOP, MBENCH_FN_MAX},
+	[DP_BENCH_DL] = {MBENCH_SESS, MBENCH_ACL, MBENCH_QER, MBENCH_MTR,
+		MBENCH_ENCAP, MBENCH_NEXTHOP, MBENCH_USAGE_DL, MBENCH_FN_MAX},
+};
+
+static const char *fn_name[DP_BENCH_DIR_MAX][MBENCH_FN_MAX] = {
+	[DP_BENCH_UL] = {
+		[MBENCH_SESS] = "ul_sess_info_get",
+		[MBENCH_USAGE_UL] = "update_usage",
+		[MBENCH_DECAP] = "gtpu_decap",
+		[MBENCH_ACL] = "acl_sdf_lookup",
+		[MBENCH_QER] = "qer_gating",
+		[MBENCH_MTR] = "qer_policing",
+		[MBENCH_NEXTHOP] = "update_nexthop_info",
+	},
+	[DP_BENCH_DL] = {
+		[MBENCH_SESS] = "dl_sess_info_get",
+		[MBENCH_ACL] = "acl_sdf_lookup",
+		[MBENCH_QER] = "qer_gating",
+		[MBENCH_MTR] = "qer_policing",
+		[MBENCH_ENCAP] = "gtpu_encap",
+		[MBENCH_NEXTHOP] = "update_nexthop_info",
+		[MBENCH_USAGE_DL] = "update_usage",
+	},
+};
+
+static const char *dir_name[DP_BENCH_DIR_MAX] = {"UL", "DL"};
+
+/**
+ * @brief  : Microbenchmark parameters
+ */
+struct mbench_cfg {
+	uint32_t sessions;
+	struct dp_bench_sess_cfg sess;
+	/* Share of the packets matching an installed session, in % */
+	uint32_t hit_pct;
+	uint32_t burst;
+	uint32_t bursts;
+	uint32_t iterations;
+	uint32_t pkt_size;
+	/* Sessions of the lookup benchmark, 0 to run the functions */
+	uint32_t lkup_sessions;
+	/* Read the cold record of the session data found on each lookup */
+	uint8_t touch_cold;
+};
+
+/**
+ * @brief  : Pre-built bursts of one direction
+ */
+struct mbench_pkts {
+	struct rte_mbuf **m;
+	/* Frame start, data offset and length of every packet as built */
+	uint8_t (*frame)[MBENCH_RESTORE_LEN];
+	uint16_t *data_off;
+	uint16_t *data_len;
+	/* Packets matching an installed session */
+	uint64_t hits;
+};
+
+/**
+ * @brief  : Measurement of one direction
+ */
+struct mbench_res {
+	uint64_t cycles[MBENCH_FN_MAX];
+	/* Packets left in the burst mask after the call */
+	uint64_t pkts_out[MBENCH_FN_MAX];
+	uint64_t calls;
+};
+
+static struct mbench_cfg cfg = {
+	.sessions = MBENCH_SESSIONS,
+	.sess = {
+		.sdf_filters = 1,
+		.qer_pct = 0,
+		.urr_pct = 0,
+		.mbr_kbps = 10000000,
+		.urr_vol_thresh = 0,
+		.enb_ip = MBENCH_ENB_IP,
+		.ue_ip_start = MBENCH_UE_IP_START,
+		.teid_start = MBENCH_TEID_START,
+		.enb_teid_start = MBENCH_ENB_TEID_START,
+	},
+	.hit_pct = 100,
+	.burst = MBENCH_BURST,
+	.bursts = MBENCH_BURSTS,
+	.iterations = MBENCH_ITERATIONS,
+	.pkt_size = MBENCH_PKT_SIZE,
+};
+
+static struct mbench_pkts pkts[DP_BENCH_DIR_MAX];
+static struct mbench_res res[DP_BENCH_DIR_MAX];
+
+/* Cycles taken by the timer itself, removed from every call */
+static uint64_t tsc_overhead;
+
+/* Keeps the reads of the lookup benchmark from being optimized out */
+static volatile uint64_t lkup_sink;
+
+static const struct ether_addr mbench_enb_mac = {
+	.addr_bytes = {0x02, 0x00, 0x00, 0x00, 0x01, 0x01}
+};
+static const struct ether_addr mbench_gw_mac = {
+	.addr_bytes = {0x02, 0x00, 0x00, 0x00, 0x01, 0x02}
+};
+
+/* Globals of up_main.c, not linked in the microbenchmarks */
+uint32_t start_time;
+int clSystemLog = STANDARD_LOGID;
+#ifdef USE_CSID
+uint16_t local_csid = 0;
+#endif /* USE_CSID */
+teidri_info *upf_teidri_allocated_list = NULL;
+teidri_info *upf_teidri_free_list = NULL;
+teidri_info *upf_teidri_blocked_list = NULL;
+
+extern struct in_addr dp_comm_ip;
+extern struct rte_hash *arp_hash_handle[NUM_SPGW_PORTS];
+#ifdef USE_REST
+extern struct rte_hash *conn_hash_handle;
+#endif /* USE_REST */
+
+/**
+ * @brief  : Print the usage of the microbenchmarks
+ * @param  : prgname, program name
+ * @return : Returns nothing
+ */
+static void
+mbench_usage(const char *prgname)
+{
+	fprintf(stderr, "Usage: %s [EAL options] -- [options]\n"
+		"  -s, --sessions N     sessions installed (%u)\n"
+		"  -h, --hit-pct P      %% of the packets of an installed session (100)\n"
+		"  -f, --sdf-filters N  SDF filters per PDR, 1..%u (1)\n"
+		"  -d, --distinct-sdf   filters matching no packet distinct per session\n"
+		"  -q, --qer-pct P      %% of the sessions with an MBR QER (0)\n"
+		"  -u, --urr-pct P      %% of the sessions with volume URRs (0)\n"
+		"  -b, --burst N        packets per burst, 1..%u (%u)\n"
+		"  -n, --bursts N       pre-built bursts per direction (%u)\n"
+		"  -i, --iterations N   passes over the bursts (%u)\n"
+		"  -z, --pkt-size N     inner IP packet size (%u)\n"
+		"  -L, --lookup N       session lookup benchmark on N sessions\n"
+		"  -c, --touch-cold     lookups also read the cold session record\n",
+		prgname, MBENCH_SESSIONS, DP_BENCH_SDF_MAX, MAX_BURST_SZ,
+		MBENCH_BURST, MBENCH_BURSTS, MBENCH_ITERATIONS, MBENCH_PKT_SIZE);
+}
+
+/**
+ * @brief  : Parse the options of the microbenchmarks
+ * @param  : argc, number of arguments after the EAL ones
+ * @param  : argv, arguments after the EAL ones
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_parse_args(int argc, char **argv)
+{
+	int opt = 0;
+	int option_index = 0;
+	static struct option mbench_opts[] = {
+		{"sessions", required_argument, 0, 's'},
+		{"hit-pct", required_argument, 0, 'h'},
+		{"sdf-filters", required_argument, 0, 'f'},
+		{"distinct-sdf", no_argument, 0, 'd'},
+		{"qer-pct", required_argument, 0, 'q'},
+		{"urr-pct", required_argument, 0, 'u'},
+		{"burst", required_argument, 0, 'b'},
+		{"bursts", required_argument, 0, 'n'},
+		{"iterations", required_argument, 0, 'i'},
+		{"pkt-size", required_argument, 0, 'z'},
+		{"lookup", required_argument, 0, 'L'},
+		{"touch-cold", no_argument, 0, 'c'},
+		{NULL, 0, 0, 0}
+	};
+
+	while ((opt = getopt_long(argc, argv, "s:h:f:dq:u:b:n:i:z:L:c",
+					mbench_opts, &option_index)) != EOF) {
+		switch (opt) {
+		case 's':
+			cfg.sessions = strtoul(optarg, NULL, 0);
+			break;
+		case 'h':
+			cfg.hit_pct = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			cfg.sess.sdf_filters = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			cfg.sess.distinct_sdf = 1;
+			break;
+		case 'q':
+			cfg.sess.qer_pct = strtoul(optarg, NULL, 0);
+			break;
+		case 'u':
+			cfg.sess.urr_pct = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			cfg.burst = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			cfg.bursts = strtoul(optarg, NULL, 0);
+			break;
+		case 'i':
+			cfg.iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'z':
+			cfg.pkt_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'L':
+			cfg.lkup_sessions = strtoul(optarg, NULL, 0);
+			break;
+		case 'c':
+			cfg.touch_cold = 1;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if (cfg.sessions == 0 || cfg.hit_pct > 100 ||
+			cfg.sess.sdf_filters == 0 ||
+			cfg.sess.sdf_filters > DP_BENCH_SDF_MAX ||
+			(cfg.sess.distinct_sdf && (cfg.sess.sdf_filters < 2 ||
+				cfg.sessions > DP_BENCH_DISTINCT_SESS_MAX)) ||
+			cfg.sess.qer_pct > 100 || cfg.sess.urr_pct > 100 ||
+			cfg.burst == 0 || cfg.burst > MAX_BURST_SZ ||
+			cfg.bursts == 0 || cfg.iterations == 0 ||
+			cfg.pkt_size < IPV4_HDR_LEN + UDP_HDR_LEN ||
+			cfg.pkt_size > ETHER_MTU - IPV4_HDR_LEN - UDP_HDR_LEN -
+			GTPU_HDR_SIZE)
+		return -1;
+
+	return 0;
+}
+
+#ifdef USE_REST
+/**
+ * @brief  : Register the eNB as a known peer, the session install then
+ *           starts no heartbeat timer and sends no ARP request for it
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_peer_add(void)
+{
+	peerData *peer = NULL;
+	node_address_t enb = {0};
+
+	enb.ip_type = IPV4_TYPE;
+	enb.ipv4_addr = htonl(cfg.sess.enb_ip);
+
+	peer = rte_zmalloc(NULL, sizeof(peerData), RTE_CACHE_LINE_SIZE);
+	if (peer == NULL)
+		return -1;
+	peer->dstIP = enb;
+
+	if (rte_hash_add_key_data(conn_hash_handle, &enb, peer) < 0) {
+		rte_free(peer);
+		return -1;
+	}
+
+	return 0;
+}
+#endif /* USE_REST */
+
+/**
+ * @brief  : Install the sessions, through the PFCP encoder and decoder as
+ *           for a request received from the CP
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_sess_install(void)
+{
+	int len = 0;
+	uint32_t idx = 0;
+	uint64_t tsc = rte_rdtsc();
+	uint64_t estab_tsc = 0;
+	uint64_t estab_cycles = 0;
+	uint64_t build_tsc = 0;
+	double hz = rte_get_tsc_hz();
+	peer_addr_t peer = {0};
+	static uint8_t buf[PFCP_MSG_LEN];
+	static pfcp_sess_estab_req_t req;
+	static pfcp_sess_estab_rsp_t rsp;
+
+	peer.type = IPV4_TYPE;
+	peer.ipv4.sin_family = AF_INET;
+	peer.ipv4.sin_addr = dp_comm_ip;
+
+	for (idx = 0; idx < cfg.sessions; idx++) {
+		dp_bench_sess_req(&cfg.sess, &req, idx);
+		len = encode_pfcp_sess_estab_req_t(&req, buf);
+
+		memset(&req, 0, sizeof(req));
+		memset(&rsp, 0, sizeof(rsp));
+		if (decode_pfcp_sess_estab_req_t(buf, &req) != len) {
+			fprintf(stderr, "DP_MBENCH: Failed to decode session %u\n", idx);
+			return -1;
+		}
+
+		estab_tsc = rte_rdtsc();
+		if (process_up_session_estab_req(&req, &rsp, &peer) != 0) {
+			fprintf(stderr, "DP_MBENCH: Failed to install session %u\n", idx);
+			return -1;
+		}
+		estab_cycles += rte_rdtsc() - estab_tsc;
+	}
+
+	/* The ACL tables are built in the background, after the handler */
+	build_tsc = rte_rdtsc();
+	if (up_acl_build_wait(MBENCH_ACL_WAIT_MS) < 0) {
+		fprintf(stderr, "DP_MBENCH: ACL tables not built after %u msec\n",
+				MBENCH_ACL_WAIT_MS);
+		return -1;
+	}
+
+	printf("DP_MBENCH: %u sessions installed in %.2f sec, %.0f cycles per "
+			"establishment, ACL builds done %.2f sec after the last one\n",
+			cfg.sessions, (rte_rdtsc() - tsc) / hz,
+			(double)estab_cycles / cfg.sessions,
+			(rte_rdtsc() - build_tsc) / hz);
+
+	return 0;
+}
+
+/**
+ * @brief  : Time the SDF rule to ACL table lookup of get_acl_table_indx on
+ *           the DL filters matching no packet of the installed sessions
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_sdf_lookup(void)
+{
+	uint32_t k = 0;
+	uint32_t idx = 0;
+	uint32_t rules = 0;
+	uint64_t tsc = 0;
+	uint64_t cycles = 0;
+	struct sdf_pkt_filter pkt_filter = {0};
+
+	if (cfg.sess.sdf_filters < 2)
+		return 0;
+
+	for (idx = 0; idx < cfg.sessions; idx++) {
+		for (k = 0; k + 1 < cfg.sess.sdf_filters; k++) {
+			memset(&pkt_filter, 0, sizeof(pkt_filter));
+			pkt_filter.precedence = DP_BENCH_PRECEDENCE;
+			pkt_filter.rule_ip_type = RULE_IPV4;
+			dp_bench_sess_sdf(&cfg.sess, idx, k, pkt_filter.u.rule_str,
+					sizeof(pkt_filter.u.rule_str));
+
+			/* SESS_MODIFY looks up the table without a reference */
+			tsc = rte_rdtsc();
+			if (get_acl_table_indx(&pkt_filter, SESS_MODIFY) <= 0) {
+				fprintf(stderr, "DP_MBENCH: No ACL table for SDF filter %u "
+						"of session %u\n", k, idx);
+				return -1;
+			}
+			cycles += rte_rdtsc() - tsc;
+			rules++;
+		}
+	}
+
+	printf("DP_MBENCH: get_acl_table_indx, %u lookups, %.0f cycles per "
+			"lookup\n", rules, (double)cycles / rules);
+
+	return 0;
+}
+
+/**
+ * @brief  : Add a complete ARP entry, no epc_arp_init in the
+ *           microbenchmarks
+ * @param  : port, port of the next hop
+ * @param  : key, next hop key
+ * @param  : hw_addr, next hop mac address
+ * @return : Returns the entry in case of success , NULL otherwise
+ */
+static struct arp_entry_data *
+mbench_arp_add(uint8_t port, struct arp_ip_key *key,
+		const struct ether_addr *hw_addr)
+{
+	char name[RTE_HASH_NAMESIZE] = {0};
+	struct arp_entry_data *arp = NULL;
+	struct rte_hash_parameters arp_params = {
+		.name = name,
+		.entries = 64,
+		.key_len = sizeof(struct arp_ip_key),
+		.hash_func = rte_jhash,
+		.socket_id = rte_socket_id()
+	};
+
+	if (arp_hash_handle[port] == NULL) {
+		snprintf(name, sizeof(name), "MBENCH_ARP_%u", port);
+		arp_hash_handle[port] = rte_hash_create(&arp_params);
+		if (arp_hash_handle[port] == NULL)
+			return NULL;
+	}
+
+	arp = rte_zmalloc(NULL, sizeof(*arp), RTE_CACHE_LINE_SIZE);
+	if (arp == NULL)
+		return NULL;
+	arp->ip_type.ipv4 = PRESENT;
+	arp->ipv4 = key->ip_addr.ipv4;
+	ether_addr_copy(hw_addr, &arp->eth_addr);
+	arp->status = COMPLETE;
+	arp->port = port;
+
+	if (rte_hash_add_key_data(arp_hash_handle[port], key, arp) < 0) {
+		rte_free(arp);
+		return NULL;
+	}
+
+	return arp;
+}
+
+/**
+ * @brief  : Resolve the next hops of both directions, as the mct core
+ *           does on ARP replies: the eNB adjacency of the DL FARs and the
+ *           SGi next hop of the UL packets
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_nexthop_init(void)
+{
+	uint8_t port = 0;
+	struct up_adj *adj = NULL;
+	struct arp_ip_key key = {0};
+	struct arp_entry_data *arp = NULL;
+	uint32_t route_gen = rte_atomic32_read(&up_adj_route_gen);
+
+	/* DL, the FARs share the adjacency of the eNB */
+	key.ip_type.ipv4 = PRESENT;
+	key.ip_addr.ipv4 = htonl(cfg.sess.enb_ip);
+	up_adj_nexthop_key(app.wb_port, &key);
+	adj = up_adj_get(app.wb_port, &key);
+	if (adj == NULL)
+		return -1;
+	arp = mbench_arp_add(app.wb_port, &key, &mbench_enb_mac);
+	if (arp == NULL)
+		return -1;
+	up_adj_update(adj, arp, route_gen, htons(ETHER_TYPE_IPv4));
+
+	/* UL, the port gateway or the ARP entry of the server */
+	port = app.eb_port;
+	memset(&key, 0, sizeof(key));
+	key.ip_type.ipv4 = PRESENT;
+	key.ip_addr.ipv4 = htonl(MBENCH_SERVER_IP);
+	up_adj_nexthop_key(port, &key);
+	arp = mbench_arp_add(port, &key, &mbench_gw_mac);
+	if (arp == NULL)
+		return -1;
+
+	adj = up_adj_gw(port);
+	if ((adj != NULL) && up_adj_match(adj, port, &key))
+		up_adj_update(adj, arp, route_gen, htons(ETHER_TYPE_IPv4));
+
+	return 0;
+}
+
+/**
+ * @brief  : Build the packets of one direction, each of a random session,
+ *           installed for hit_pct of them
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @param  : pool, mbuf pool
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_pkts_build(uint8_t dir, struct rte_mempool *pool)
+{
+	uint32_t i = 0;
+	uint32_t idx = 0;
+	uint16_t len = 0;
+	uint8_t *frame = NULL;
+	struct ether_hdr *eth = NULL;
+	struct ipv4_hdr *ip = NULL;
+	struct udp_hdr *udp = NULL;
+	struct gtpu_hdr *gtpu = NULL;
+	struct mbench_pkts *p = &pkts[dir];
+	uint32_t cnt = cfg.burst * cfg.bursts;
+
+	p->m = rte_zmalloc(NULL, cnt * sizeof(*p->m), RTE_CACHE_LINE_SIZE);
+	p->frame = rte_zmalloc(NULL, cnt * sizeof(*p->frame), RTE_CACHE_LINE_SIZE);
+	p->data_off = rte_zmalloc(NULL, cnt * sizeof(uint16_t), 0);
+	p->data_len = rte_zmalloc(NULL, cnt * sizeof(uint16_t), 0);
+	if (p->m == NULL || p->frame == NULL || p->data_off == NULL ||
+			p->data_len == NULL)
+		return -1;
+
+	if (rte_pktmbuf_alloc_bulk(pool, p->m, cnt) != 0)
+		return -1;
+
+	for (i = 0; i < cnt; i++) {
+		/* Misses are on the TEIDs/UE IPs after the installed ones */
+		idx = rte_rand() % cfg.sessions;
+		if ((rte_rand() % 100) < cfg.hit_pct)
+			p->hits++;
+		else
+			idx += cfg.sessions;
+
+		frame = rte_pktmbuf_mtod(p->m[i], uint8_t *);
+		eth = (struct ether_hdr *)frame;
+		eth->ether_type = htons(ETHER_TYPE_IPv4);
+		ip = (struct ipv4_hdr *)(eth + 1);
+		len = ETH_HDR_LEN;
+
+		if (dir == DP_BENCH_UL) {
+			p->m[i]->port = app.wb_port;
+			ether_addr_copy(&mbench_enb_mac, &eth->s_addr);
+			ether_addr_copy(&app.wb_ether_addr, &eth->d_addr);
+			ip->version_ihl = IPv4_VERSION |
+				(IPV4_HDR_LEN / IPV4_IHL_MULTIPLIER);
+			ip->total_length = htons(IPV4_HDR_LEN + UDP_HDR_LEN +
+					GTPU_HDR_SIZE + cfg.pkt_size);
+			ip->time_to_live = 64;
+			ip->next_proto_id = IPPROTO_UDP;
+			ip->src_addr = htonl(cfg.sess.enb_ip);
+			ip->dst_addr = htonl(app.wb_ip);
+			ip->hdr_checksum = rte_ipv4_cksum(ip);
+			udp = (struct udp_hdr *)(ip + 1);
+			udp->src_port = htons(UDP_PORT_GTPU);
+			udp->dst_port = htons(UDP_PORT_GTPU);
+			udp->dgram_len = htons(UDP_HDR_LEN + GTPU_HDR_SIZE +
+					cfg.pkt_size);
+			gtpu = (struct gtpu_hdr *)(udp + 1);
+			gtpu->version = GTPU_VERSION;
+			gtpu->pt = GTP_PROTOCOL_TYPE_GTP;
+			gtpu->msgtype = GTP_GPDU;
+			gtpu->msglen = htons(cfg.pkt_size);
+			gtpu->teid = htonl(cfg.sess.teid_start + idx);
+			ip = (struct ipv4_hdr *)(gtpu + 1);
+			len += IPV4_HDR_LEN + UDP_HDR_LEN + GTPU_HDR_SIZE;
+		} else {
+			p->m[i]->port = app.eb_port;
+			ether_addr_copy(&mbench_gw_mac, &eth->s_addr);
+			ether_addr_copy(&app.eb_ether_addr, &eth->d_addr);
+		}
+
+		/* Inner packet of the UL, SGi packet of the DL */
+		ip->version_ihl = IPv4_VERSION | (IPV4_HDR_LEN / IPV4_IHL_MULTIPLIER);
+		ip->total_length = htons(cfg.pkt_size);
+		ip->time_to_live = 64;
+		ip->next_proto_id = IPPROTO_UDP;
+		udp = (struct udp_hdr *)(ip + 1);
+		udp->dgram_len = htons(cfg.pkt_size - IPV4_HDR_LEN);
+		if (dir == DP_BENCH_UL) {
+			ip->src_addr = htonl(cfg.sess.ue_ip_start + idx);
+			ip->dst_addr = htonl(MBENCH_SERVER_IP);
+			udp->src_port = htons(MBENCH_UE_PORT);
+			udp->dst_port = htons(MBENCH_SERVER_PORT);
+		} else {
+			ip->src_addr = htonl(MBENCH_SERVER_IP);
+			ip->dst_addr = htonl(cfg.sess.ue_ip_start + idx);
+			udp->src_port = htons(MBENCH_SERVER_PORT);
+			udp->dst_port = htons(MBENCH_UE_PORT);
+		}
+		ip->hdr_checksum = rte_ipv4_cksum(ip);
+		len += cfg.pkt_size;
+
+		p->m[i]->data_len = len;
+		p->m[i]->pkt_len = len;
+		p->data_off[i] = p->m[i]->data_off;
+		p->data_len[i] = len;
+		rte_memcpy(p->frame[i], frame, RTE_MIN(len, MBENCH_RESTORE_LEN));
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Put a burst back in its built state, not timed
+ * @param  : p, packets of the direction
+ * @param  : first, index of the first packet of the burst
+ * @return : Returns nothing
+ */
+static void
+mbench_burst_restore(struct mbench_pkts *p, uint32_t first)
+{
+	uint32_t i = 0;
+	struct rte_mbuf *m = NULL;
+
+	for (i = first; i < first + cfg.burst; i++) {
+		m = p->m[i];
+		m->data_off = p->data_off[i];
+		m->data_len = p->data_len[i];
+		m->pkt_len = p->data_len[i];
+		rte_memcpy(rte_pktmbuf_mtod(m, uint8_t *), p->frame[i],
+				RTE_MIN(p->data_len[i], MBENCH_RESTORE_LEN));
+	}
+}
+
+/**
+ * @brief  : Select the PDR of the ACL precedence, as get_pdr_info, not timed
+ * @param  : sess_data, session information
+ * @param  : pdr, selected PDRs
+ * @param  : precedence, ACL precedence of the packets
+ * @param  : n, number of packets
+ * @param  : pkts_mask, packet mask
+ * @param  : fd_pkts_mask, packet mask of the filtered packets
+ * @return : Returns nothing
+ */
+static void
+mbench_pdr_select(pfcp_session_datat_t **sess_data, pdr_info_t **pdr,
+		uint32_t **precedence, uint32_t n, uint64_t *pkts_mask,
+		uint64_t *fd_pkts_mask)
+{
+	uint32_t j = 0;
+
+	for (j = 0; j < n; j++) {
+		if (ISSET_BIT(*pkts_mask, j) && ISSET_BIT(*fd_pkts_mask, j) &&
+				(precedence[j] != NULL)) {
+			pdr[j] = get_pdr_by_prcdnc(sess_data[j], *precedence[j]);
+			if (pdr[j] == NULL)
+				RESET_BIT(*pkts_mask, j);
+		} else if (ISSET_BIT(*fd_pkts_mask, j)) {
+			RESET_BIT(*pkts_mask, j);
+		}
+	}
+}
+
+/**
+ * @brief  : Account the cycles of a call and the packets it left
+ * @param  : r, measurement of the direction
+ * @param  : fn, timed function
+ * @param  : tsc, TSC before the call, set to the TSC after the call
+ * @param  : pkts_mask, packet mask after the call
+ * @return : Returns nothing
+ */
+static inline void
+mbench_account(struct mbench_res *r, uint8_t fn, uint64_t *tsc,
+		uint64_t pkts_mask)
+{
+	uint64_t now = rte_rdtsc_precise();
+	uint64_t cycles = now - *tsc;
+
+	r->cycles[fn] += (cycles > tsc_overhead) ? cycles - tsc_overhead : 0;
+	r->pkts_out[fn] += __builtin_popcountll(pkts_mask);
+	*tsc = now;
+}
+
+/**
+ * @brief  : Run the UL functions on a burst, in the order of wb_pkt_handler
+ * @param  : m, burst
+ * @param  : r, measurement, NULL for the warm-up
+ * @return : Returns nothing
+ */
+static void
+mbench_ul(struct rte_mbuf **m, struct mbench_res *r)
+{
+	uint32_t j = 0;
+	uint32_t n = cfg.burst;
+	uint64_t tsc = 0;
+	uint64_t pkts_mask = (~0LLU) >> (64 - n);
+	uint64_t fwd_pkts_mask = 0;
+	uint64_t snd_err_pkts_mask = 0;
+	uint64_t decap_pkts_mask = 0;
+	uint64_t pkts_queue_mask = 0;
+	uint32_t prcdnc_val[MAX_BURST_SZ];
+	uint32_t *precedence[MAX_BURST_SZ] = {NULL};
+	pdr_info_t *pdr[MAX_BURST_SZ] = {NULL};
+	pdr_info_t *pdr_li[MAX_BURST_SZ] = {NULL};
+	pfcp_session_datat_t *sess_data[MAX_BURST_SZ] = {NULL};
+	struct mbench_res warmup;
+
+	if (r == NULL)
+		r = &warmup;
+
+	tsc = rte_rdtsc_precise();
+	ul_sess_info_get(m, n, &pkts_mask, &snd_err_pkts_mask, &fwd_pkts_mask,
+			&decap_pkts_mask, &sess_data[0]);
+	mbench_account(r, MBENCH_SESS, &tsc, pkts_mask);
+
+	for (j = 0; j < n; j++) {
+		if (ISSET_BIT(decap_pkts_mask, j))
+			pdr_li[j] = sess_data[j]->pdrs;
+	}
+
+	tsc = rte_rdtsc_precise();
+	update_usage(m, n, &decap_pkts_mask, pdr_li, UPLINK);
+	mbench_account(r, MBENCH_USAGE_UL, &tsc, decap_pkts_mask);
+
+	gtpu_decap(m, n, &pkts_mask, &decap_pkts_mask);
+	mbench_account(r, MBENCH_DECAP, &tsc, pkts_mask);
+
+	acl_sdf_lookup(m, n, &pkts_mask, &decap_pkts_mask, &sess_data[0],
+			&precedence[0], &prcdnc_val[0]);
+	mbench_account(r, MBENCH_ACL, &tsc, pkts_mask);
+
+	mbench_pdr_select(&sess_data[0], &pdr[0], &precedence[0], n,
+			&pkts_mask, &decap_pkts_mask);
+
+	tsc = rte_rdtsc_precise();
+	qer_gating(&pdr[0], n, &pkts_mask, &decap_pkts_mask, &pkts_queue_mask,
+			UPLINK);
+	mbench_account(r, MBENCH_QER, &tsc, pkts_mask);
+
+	qer_policing(m, &pdr[0], n, &pkts_mask, &decap_pkts_mask, UPLINK);
+	mbench_account(r, MBENCH_MTR, &tsc, pkts_mask);
+
+	update_nexthop_info(m, n, &pkts_mask, app.eb_port, &pdr[0], NOT_PRESENT);
+	mbench_account(r, MBENCH_NEXTHOP, &tsc, pkts_mask);
+
+	r->calls++;
+}
+
+/**
+ * @brief  : Run the DL functions on a burst, in the order of eb_pkt_handler
+ * @param  : m, burst
+ * @param  : r, measurement, NULL for the warm-up
+ * @return : Returns nothing
+ */
+static void
+mbench_dl(struct rte_mbuf **m, struct mbench_res *r)
+{
+	uint32_t n = cfg.burst;
+	uint64_t tsc = 0;
+	uint64_t pkts_mask = (~0LLU) >> (64 - n);
+	uint64_t fwd_pkts_mask = 0;
+	uint64_t snd_err_pkts_mask = 0;
+	uint64_t encap_pkts_mask = 0;
+	uint64_t pkts_queue_mask = 0;
+	uint32_t prcdnc_val[MAX_BURST_SZ];
+	uint32_t *precedence[MAX_BURST_SZ] = {NULL};
+	pdr_info_t *pdr[MAX_BURST_SZ] = {NULL};
+	pfcp_session_datat_t *sess_data[MAX_BURST_SZ] = {NULL};
+	struct mbench_res warmup;
+
+	if (r == NULL)
+		r = &warmup;
+
+	tsc = rte_rdtsc_precise();
+	dl_sess_info_get(m, n, &pkts_mask, &sess_data[0], &pkts_queue_mask,
+			&snd_err_pkts_mask, &fwd_pkts_mask, &encap_pkts_mask);
+	mbench_account(r, MBENCH_SESS, &tsc, pkts_mask);
+
+	acl_sdf_lookup(m, n, &pkts_mask, &encap_pkts_mask, &sess_data[0],
+			&precedence[0], &prcdnc_val[0]);
+	mbench_account(r, MBENCH_ACL, &tsc, pkts_mask);
+
+	mbench_pdr_select(&sess_data[0], &pdr[0], &precedence[0], n,
+			&pkts_mask, &encap_pkts_mask);
+
+	tsc = rte_rdtsc_precise();
+	qer_gating(&pdr[0], n, &pkts_mask, &encap_pkts_mask, &pkts_queue_mask,
+			DOWNLINK);
+	mbench_account(r, MBENCH_QER, &tsc, pkts_mask);
+
+	qer_policing(m, &pdr[0], n, &pkts_mask, &encap_pkts_mask, DOWNLINK);
+	mbench_account(r, MBENCH_MTR, &tsc, pkts_mask);
+
+	gtpu_encap(&pdr[0], &sess_data[0], m, n, &pkts_mask, &encap_pkts_mask,
+			&pkts_queue_mask);
+	mbench_account(r, MBENCH_ENCAP, &tsc, pkts_mask);
+
+	update_nexthop_info(m, n, &pkts_mask, app.wb_port, &pdr[0], NOT_PRESENT);
+	mbench_account(r, MBENCH_NEXTHOP, &tsc, pkts_mask);
+
+	update_usage(m, n, &pkts_mask, pdr, DOWNLINK);
+	mbench_account(r, MBENCH_USAGE_DL, &tsc, pkts_mask);
+
+	r->calls++;
+}
+
+/**
+ * @brief  : Measure the cost of the timer alone, the min of the samples
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+mbench_calibrate(void)
+{
+	uint32_t i = 0;
+	uint64_t tsc = 0;
+	uint64_t cycles = 0;
+
+	tsc_overhead = UINT64_MAX;
+	for (i = 0; i < MBENCH_CAL_LOOPS; i++) {
+		tsc = rte_rdtsc_precise();
+		cycles = rte_rdtsc_precise() - tsc;
+		if (cycles < tsc_overhead)
+			tsc_overhead = cycles;
+	}
+}
+
+/**
+ * @brief  : Run the functions of one direction over all the bursts
+ * @param  : dir, DP_BENCH_UL or DP_BENCH_DL
+ * @param  : r, measurement, NULL for the warm-up
+ * @return : Returns nothing
+ */
+static void
+mbench_pass(uint8_t dir, struct mbench_res *r)
+{
+	uint32_t b = 0;
+	struct mbench_pkts *p = &pkts[dir];
+
+	for (b = 0; b < cfg.bursts; b++) {
+		mbench_burst_restore(p, b * cfg.burst);
+		if (dir == DP_BENCH_UL)
+			mbench_ul(&p->m[b * cfg.burst], r);
+		else
+			mbench_dl(&p->m[b * cfg.burst], r);
+	}
+}
+
+/**
+ * @brief  : Print the cycles per packet of each function
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+mbench_report(void)
+{
+	uint8_t i = 0;
+	uint8_t fn = 0;
+	uint8_t dir = 0;
+	double total = 0;
+	double n = 0;
+	const struct mbench_res *r = NULL;
+
+	printf("\n**************************\n");
+	printf("DP MICROBENCHMARKS :: %u sessions, %u%% hit, %u SDF filters, "
+			"%u%% QER, %u%% URR, burst %u, %u bytes, timer %lu cycles\n",
+			cfg.sessions, cfg.hit_pct, cfg.sess.sdf_filters,
+			cfg.sess.qer_pct, cfg.sess.urr_pct, cfg.burst, cfg.pkt_size,
+			tsc_overhead);
+	printf("**************************\n");
+
+	for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++) {
+		r = &res[dir];
+		n = (double)r->calls * cfg.burst;
+		total = 0;
+
+		printf("\n%s: %lu packets, %.1f%% of an installed session\n",
+				dir_name[dir], (uint64_t)n,
+				100.0 * pkts[dir].hits / (cfg.burst * cfg.bursts));
+		printf("  %-22s %14s %10s\n", "Function", "cycles/pkt", "out %");
+		for (i = 0; (fn = mbench_chain[dir][i]) != MBENCH_FN_MAX; i++) {
+			printf("  %-22s %14.1f %9.1f%%\n", fn_name[dir][fn],
+					r->cycles[fn] / n, 100.0 * r->pkts_out[fn] / n);
+			total += r->cycles[fn] / n;
+		}
+		printf("  %-22s %14.1f\n", "Total", total);
+	}
+	printf("\n");
+}
+
+/**
+ * @brief  : Fill a TEID table of lkup_sessions entries with session data,
+ *           in place of the DP one sized for its own session count
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_lkup_init(void)
+{
+	uint32_t idx = 0;
+	uint64_t tsc = rte_rdtsc();
+	pfcp_session_datat_t *head = NULL;
+	pfcp_session_datat_t *sess_data = NULL;
+	struct rte_hash_parameters params = {
+		.name = "MBENCH_SESS_TEID",
+		.entries = cfg.lkup_sessions +
+			cfg.lkup_sessions / 100 * MBENCH_LKUP_HEADROOM,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id()
+	};
+
+	rte_hash_free(sess_by_teid_hash);
+	sess_by_teid_hash = rte_hash_create(&params);
+	if (sess_by_teid_hash == NULL)
+		return -1;
+
+	for (idx = 0; idx < cfg.lkup_sessions; idx++) {
+		/* One session data per session, as with a single bearer */
+		head = NULL;
+		sess_data = get_sess_by_teid_entry(cfg.sess.teid_start + idx, &head,
+				SESS_CREATE);
+		if (sess_data == NULL) {
+			fprintf(stderr, "DP_MBENCH: Failed to add session %u\n", idx);
+			return -1;
+		}
+
+		sess_data->sess_state = CONNECTED;
+		sess_data->hdr_rvl = GTPU_UDP_IPv4;
+		sess_data->ipv4 = PRESENT;
+		sess_data->ue_ip_addr = cfg.sess.ue_ip_start + idx;
+		sess_data->cold->acl_table_indx[0] = 1;
+		sess_data->acl_table_count = 1;
+		sess_data_acl_sync(sess_data);
+	}
+
+	printf("DP_MBENCH: %u session data added in %.2f sec, hot %zu bytes, "
+			"cold %zu bytes\n", cfg.lkup_sessions,
+			(double)(rte_rdtsc() - tsc) / rte_get_tsc_hz(),
+			sizeof(pfcp_session_datat_t), sizeof(pfcp_session_datat_cold_t));
+
+	return 0;
+}
+
+/**
+ * @brief  : Look the sessions up in bursts of random TEIDs, hit_pct of them
+ *           installed, reading what the handlers read of each session found
+ * @param  : No param
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+mbench_lkup_run(void)
+{
+	uint32_t i = 0;
+	uint32_t j = 0;
+	uint32_t b = 0;
+	uint32_t it = 0;
+	uint32_t cnt = cfg.burst * cfg.bursts;
+	uint64_t hit_mask = 0;
+	uint64_t hits = 0;
+	uint64_t cycles = 0;
+	uint64_t tsc = 0;
+	uint64_t sum = 0;
+	double lookups = 0;
+	struct ul_bm_key *keys = NULL;
+	void *key_ptr[MAX_BURST_SZ] = {NULL};
+	pfcp_session_datat_t *sess_data[MAX_BURST_SZ] = {NULL};
+
+	keys = rte_zmalloc(NULL, cnt * sizeof(*keys), RTE_CACHE_LINE_SIZE);
+	if (keys == NULL)
+		return -1;
+
+	for (i = 0; i < cnt; i++) {
+		keys[i].teid = cfg.sess.teid_start + rte_rand() % cfg.lkup_sessions;
+		/* Misses are on the TEIDs after the installed ones */
+		if ((rte_rand() % 100) >= cfg.hit_pct)
+			keys[i].teid += cfg.lkup_sessions;
+	}
+
+	/* Pass 0 warms up and is not counted */
+	for (it = 0; it <= cfg.iterations; it++) {
+		for (b = 0; b < cfg.bursts; b++) {
+			for (j = 0; j < cfg.burst; j++)
+				key_ptr[j] = &keys[b * cfg.burst + j];
+
+			tsc = rte_rdtsc_precise();
+			if (iface_lookup_uplink_bulk_data((const void **)&key_ptr[0],
+						cfg.burst, &hit_mask, (void **)sess_data) < 0)
+				hit_mask = 0;
+
+			for (j = 0; j < cfg.burst; j++) {
+				if (!ISSET_BIT(hit_mask, j))
+					continue;
+
+				/* Hot fields of the session lookup and the SDF lookup */
+				sum += sess_data[j]->sess_state + sess_data[j]->hdr_rvl +
+					sess_data_acl_indx(sess_data[j], 0) +
+					(uintptr_t)sess_data[j]->pdr_tbl;
+				if (cfg.touch_cold)
+					sum += sess_data[j]->cold->acl_table_indx[0] +
+						sess_data[j]->cold->dl_buf.count;
+			}
+			tsc = rte_rdtsc_precise() - tsc;
+
+			if (it == 0)
+				continue;
+			cycles += (tsc > tsc_overhead) ? tsc - tsc_overhead : 0;
+			hits += __builtin_popcountll(hit_mask);
+		}
+	}
+	lkup_sink = sum;
+	rte_free(keys);
+
+	lookups = (double)cfg.iterations * cnt;
+	printf("\n**************************\n");
+	printf("DP SESSION LOOKUP :: %u sessions, %u%% hit, burst %u, %s\n",
+			cfg.lkup_sessions, cfg.hit_pct, cfg.burst,
+			cfg.touch_cold ? "hot and cold records" : "hot record");
+	printf("**************************\n");
+	printf("  %.2f M lookups/sec, %.1f cycles/lookup, %.1f%% found\n\n",
+			lookups * rte_get_tsc_hz() / (cycles ? cycles : 1) / 1e6,
+			cycles / lookups, 100.0 * hits / lookups);
+
+	return 0;
+}
+
+/**
+ * Main function.
+ */
+int main(int argc, char **argv)
+{
+	int ret = 0;
+	uint8_t dir = 0;
+	uint32_t it = 0;
+	struct rte_mempool *pool = NULL;
+
+	start_time = current_ntp_timestamp();
+
+	/* Same configuration as the DP */
+	read_cfg_file(DP_CFG_PATH);
+	init_log_module(LOGGER_JSON_PATH);
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
+
+	argc -= ret;
+	argv += ret;
+
+	if (mbench_parse_args(argc, argv) < 0) {
+		mbench_usage(argv[0]);
+		rte_exit(EXIT_FAILURE, "Invalid microbenchmark options\n");
+	}
+
+	if (up_clock_init() < 0)
+		rte_exit(EXIT_FAILURE, "Failed to init NTP clock\n");
+
+	/* The DP options are all taken from dp.cfg */
+	dp_init(1, argv);
+	clSetLogLevel(clSystemLog, (enum CLoggerLogLevel)RTE_MIN(app.log_level,
+				(uint32_t)eCLogLevelOff));
+
+	/* Tables used by the session install and the fast path, no port and
+	 * no worker is started */
+	up_rcu_init();
+	init_up_hash_tables();
+
+	if (up_acl_init() < 0 || up_adj_init() < 0 || up_tw_init() < 0 ||
+			urr_usage_init(app.urr_vol_err) < 0)
+		rte_exit(EXIT_FAILURE, "Failed to init the DP tables\n");
+
+#ifdef USE_CSID
+	init_fqcsid_hash_tables();
+#endif /* USE_CSID */
+
+	if (cfg.lkup_sessions) {
+		mbench_calibrate();
+		if (mbench_lkup_init() < 0 || mbench_lkup_run() < 0)
+			rte_exit(EXIT_FAILURE, "Failed to run the session lookups\n");
+		return 0;
+	}
+
+#ifdef USE_REST
+	echo_table_init();
+	if (mbench_peer_add() < 0)
+		rte_exit(EXIT_FAILURE, "Failed to add the eNB peer\n");
+#endif /* USE_REST */
+
+	if (mbench_sess_install() < 0)
+		rte_exit(EXIT_FAILURE, "Failed to install the sessions\n");
+
+	if (mbench_sdf_lookup() < 0)
+		rte_exit(EXIT_FAILURE, "Failed to look up the SDF rules\n");
+
+	if (mbench_nexthop_init() < 0)
+		rte_exit(EXIT_FAILURE, "Failed to resolve the next hops\n");
+
+	pool = rte_pktmbuf_pool_create("dp_mbench_pool",
+			DP_BENCH_DIR_MAX * cfg.burst * cfg.bursts, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (pool == NULL)
+		rte_exit(EXIT_FAILURE, "Failed to create the mbuf pool: %s\n",
+				rte_strerror(rte_errno));
+
+	for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++) {
+		if (mbench_pkts_build(dir, pool) < 0)
+			rte_exit(EXIT_FAILURE, "Failed to build the %s packets\n",
+					dir_name[dir]);
+	}
+
+	mbench_calibrate();
+
+	/* One pass to warm the caches and the session objects */
+	for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++)
+		mbench_pass(dir, NULL);
+
+	for (it = 0; it < cfg.iterations; it++) {
+		for (dir = 0; dir < DP_BENCH_DIR_MAX; dir++)
+			mbench_pass(dir, &res[dir]);
+	}
+
+	mbench_report();
+
+	return 0;
+}
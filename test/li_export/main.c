@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Check of the LI exporter against a local TCP sink standing for the DDF.
+ * The sink is a slow reader with a small receive buffer, so the exporter
+ * backlog builds up and writes may stop in the middle of a record; it
+ * acknowledges every record and drops the connection once in the middle
+ * of the run. Every record must reach the sink intact and in order;
+ * a record is only received twice after the reconnection.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <rte_eal.h>
+#include <rte_config.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "up_li_export.h"
+#include "gw_adapter.h"
+
+/* Number of records exported */
+#define TEST_RECORDS		20000
+/* Records received by the sink before it drops the connection */
+#define TEST_DROP_AT		5000
+/* Length of the LI header of a record */
+#define TEST_HDR_LEN		76
+/* Max payload of a record */
+#define TEST_PAYLOAD_MAX	1400
+/* The sink pauses on one record out of TEST_SLOW_EVERY */
+#define TEST_SLOW_EVERY		64
+#define TEST_SLOW_USEC		1000
+/* Receive buffer of the sink */
+#define TEST_RCVBUF		4096
+/* Max duration of the run, in seconds */
+#define TEST_TIMEOUT		30
+
+int clSystemLog;
+volatile uint8_t cl_log_level[CL_MAX_LOGID];
+
+static volatile int failed;
+
+/* Next sequence number expected by the sink */
+static uint32_t sink_expected;
+/* Last sequence number received on the connection */
+static uint32_t sink_last;
+/* Records received twice */
+static uint32_t sink_dup;
+
+/**
+ * @brief  : Logs of the exporter, minor and above
+ * @param  : logid, logid
+ * @param  : sev, Severity of logging
+ * @param  : fmt, logger string params for printing
+ * @return : Returns nothing
+ */
+void
+(clLog)(const int logid, enum CLoggerSeverity sev, const char *fmt, ...)
+{
+	va_list ap;
+
+	RTE_SET_USED(logid);
+	if (sev < eCLSeverityMinor)
+		return;
+
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+}
+
+/**
+ * @brief  : Fill a record, the payload is derived from the sequence number
+ * @param  : rec, record
+ * @param  : seq, sequence number
+ * @return : Returns nothing
+ */
+static void
+record_fill(struct li_exp_rec *rec, uint32_t seq)
+{
+	uint32_t i = 0;
+	uint32_t len = TEST_HDR_LEN + (seq % TEST_PAYLOAD_MAX) + 1;
+	uint32_t be = 0;
+
+	memset(rec->data, 0, TEST_HDR_LEN);
+	be = htonl(len);
+	memcpy(rec->data, &be, sizeof(be));
+	be = htonl(seq);
+	memcpy(&rec->data[LI_EXP_SEQ_OFF], &be, sizeof(be));
+	for (i = TEST_HDR_LEN; i < len; i++)
+		rec->data[i] = (uint8_t)(seq + i);
+
+	rec->len = len;
+}
+
+/**
+ * @brief  : Read exactly len bytes
+ * @param  : fd, socket
+ * @param  : buf, buffer
+ * @param  : len, number of bytes
+ * @return : Returns 0 in case of success , -1 on close or error
+ */
+static int
+read_full(int fd, uint8_t *buf, uint32_t len)
+{
+	ssize_t ret = 0;
+	uint32_t off = 0;
+
+	while (off < len) {
+		ret = recv(fd, buf + off, len - off, 0);
+		if (ret <= 0)
+			return -1;
+		off += ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief  : Check a record received by the sink
+ * @param  : buf, record
+ * @param  : len, record length
+ * @param  : first, set on the first record of a connection
+ * @return : Returns 0 in case of success , -1 otherwise
+ */
+static int
+record_check(const uint8_t *buf, uint32_t len, int first)
+{
+	uint32_t i = 0;
+	uint32_t seq = 0;
+
+	memcpy(&seq, &buf[LI_EXP_SEQ_OFF], sizeof(seq));
+	seq = ntohl(seq);
+
+	if (len != TEST_HDR_LEN + (seq % TEST_PAYLOAD_MAX) + 1) {
+		printf("  record %u: length %u  FAIL\n", seq, len);
+		return -1;
+	}
+
+	for (i = TEST_HDR_LEN; i < len; i++) {
+		if (buf[i] != (uint8_t)(seq + i)) {
+			printf("  record %u: payload corrupted  FAIL\n", seq);
+			return -1;
+		}
+	}
+
+	/* In order on a connection, from a record not acknowledged on a new one */
+	if ((first && (seq > sink_expected)) ||
+			(!first && (seq != sink_last + 1))) {
+		printf("  record %u: out of order, expected %u  FAIL\n", seq,
+				first ? sink_expected : sink_last + 1);
+		return -1;
+	}
+	sink_last = seq;
+
+	if (seq < sink_expected)
+		sink_dup++;
+	else
+		sink_expected++;
+
+	return 0;
+}
+
+/**
+ * @brief  : DDF sink, one connection at a time
+ * @param  : arg, listening socket
+ * @return : Returns NULL
+ */
+static void *
+sink_run(void *arg)
+{
+	int fd = -1;
+	int first = 0;
+	int lfd = *(int *)arg;
+	uint32_t len = 0;
+	uint32_t received = 0;
+	int dropped = 0;
+	uint8_t ack[LI_EXP_ACK_LEN];
+	uint8_t buf[LI_EXP_REC_SZ];
+
+	while (sink_expected < TEST_RECORDS) {
+		fd = accept(lfd, NULL, NULL);
+		if (fd < 0)
+			break;
+		first = 1;
+
+		while (read_full(fd, buf, sizeof(len)) == 0) {
+			memcpy(&len, buf, sizeof(len));
+			len = ntohl(len);
+			if ((len < TEST_HDR_LEN) || (len > LI_EXP_REC_SZ) ||
+					(read_full(fd, buf + sizeof(len),
+							len - sizeof(len)) < 0)) {
+				printf("  invalid record length %u  FAIL\n", len);
+				failed = 1;
+				break;
+			}
+
+			if (record_check(buf, len, first) < 0) {
+				failed = 1;
+				break;
+			}
+			first = 0;
+
+			/* Slow reader, the socket buffers fill up */
+			if ((len % TEST_SLOW_EVERY) == 0)
+				usleep(TEST_SLOW_USEC);
+
+			/* Dropped with records in flight, the last one not acked */
+			if (!dropped && (++received == TEST_DROP_AT)) {
+				dropped = 1;
+				break;
+			}
+
+			ack[0] = LI_EXP_ACK_LEN;
+			ack[1] = LI_EXP_ACK_TYPE;
+			memcpy(&ack[2], &buf[LI_EXP_SEQ_OFF], sizeof(uint32_t));
+			if (send(fd, ack, sizeof(ack), MSG_NOSIGNAL) != sizeof(ack))
+				break;
+		}
+
+		close(fd);
+		if (failed)
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief  : Open the listening socket of the sink on the loopback
+ * @param  : port, bound port, host order
+ * @return : Returns socket
+ */
+static int
+sink_open(uint16_t *port)
+{
+	int fd = -1;
+	int rcvbuf = TEST_RCVBUF;
+	struct sockaddr_in addr = {0};
+	socklen_t len = sizeof(addr);
+
+	fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0)
+		rte_exit(EXIT_FAILURE, "Failed to create sink socket\n");
+
+	/* Inherited by the accepted sockets */
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+			(listen(fd, 1) < 0) ||
+			(getsockname(fd, (struct sockaddr *)&addr, &len) < 0))
+		rte_exit(EXIT_FAILURE, "Failed to open sink socket\n");
+
+	*port = ntohs(addr.sin_port);
+	return fd;
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+	int lfd = -1;
+	uint16_t port = 0;
+	uint32_t seq = 0;
+	uint64_t end_tsc = 0;
+	pthread_t sink;
+	struct li_exp_rec *rec = NULL;
+	struct li_exp_stats stats = {0};
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
+
+	if (li_exp_init() < 0)
+		rte_exit(EXIT_FAILURE, "LI export init failed\n");
+
+	lfd = sink_open(&port);
+	if (pthread_create(&sink, NULL, sink_run, &lfd) != 0)
+		rte_exit(EXIT_FAILURE, "Failed to start the sink\n");
+
+	if (li_exp_target_init(LI_EXP_DDF3, "DDF3", "127.0.0.1", port, "") < 0)
+		rte_exit(EXIT_FAILURE, "LI export target init failed\n");
+
+	printf("%u records to a sink on port %u, dropped after %u records\n",
+			TEST_RECORDS, port, TEST_DROP_AT);
+
+	end_tsc = rte_rdtsc() + rte_get_tsc_hz() * TEST_TIMEOUT;
+	while (!failed && (rte_rdtsc() < end_tsc)) {
+		while ((seq < TEST_RECORDS) && li_exp_room(LI_EXP_DDF3)) {
+			rec = li_exp_rec_alloc();
+			if (rec == NULL)
+				break;
+			record_fill(rec, seq);
+			if (li_exp_enqueue(LI_EXP_DDF3, rec) < 0) {
+				li_exp_rec_free(rec);
+				break;
+			}
+			seq++;
+		}
+
+		li_exp_flush(LI_EXP_DDF3);
+
+		li_exp_stats_get(LI_EXP_DDF3, &stats);
+		if ((stats.acked == TEST_RECORDS) && (stats.backlog == 0))
+			break;
+	}
+
+	li_exp_close();
+	shutdown(lfd, SHUT_RDWR);
+	pthread_join(sink, NULL);
+	close(lfd);
+
+	printf("  received %u, %u twice, %lu acked, %lu writes, "
+			"%lu partial, %lu connects, %lu disconnects\n",
+			sink_expected, sink_dup, stats.acked, stats.writes,
+			stats.partial, stats.connects, stats.disconnects);
+
+	if ((sink_expected != TEST_RECORDS) || (stats.acked != TEST_RECORDS) ||
+			(stats.backlog != 0) || (stats.disconnects != 1)) {
+		printf("  records lost or not acknowledged  FAIL\n");
+		failed = 1;
+	}
+
+	printf("LI export test %s\n", failed ? "FAILED" : "PASSED");
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2019 Sprint
+ * Copyright (c) 2020 T-Mobile
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Simulated traffic check of the QER policing meters. The packets are not
+ * sent anywhere: each flow offers a constant bitrate on a virtual TSC and
+ * the rates enforced by the meters are compared with the configured
+ * MBR/GBR/APN-AMBR.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_eal.h>
+#include <rte_config.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "up_mtr.h"
+
+/* Simulated duration in seconds */
+#define SIM_DURATION	10
+/* Packet IP length in bytes */
+#define SIM_PKT_LEN	1000
+/* Accepted error on the measured rates, in percent */
+#define SIM_TOLERANCE	3
+/* Max number of flows of a test */
+#define SIM_MAX_FLOWS	4
+
+/**
+ * @brief  : Simulated flow
+ */
+struct sim_flow {
+	/* Offered bitrate in kbps */
+	uint64_t offered;
+	/* Flow meter, MBR/GBR of the QER */
+	struct up_mtr_dir mtr;
+	/* Bytes forwarded after the flow and the aggregate meters */
+	uint64_t fwd_bytes;
+	/* TSC of the next packet */
+	double next_tsc;
+};
+
+static int failed;
+
+/**
+ * @brief  : Convert a byte count over the simulated duration to kbps
+ * @param  : bytes, byte count
+ * @return : Returns rate in kbps
+ */
+static uint64_t
+bytes_to_kbps(uint64_t bytes)
+{
+	return (bytes * 8) / (SIM_DURATION * 1000);
+}
+
+/**
+ * @brief  : Compare a measured rate with the expected one
+ * @param  : name, name of the checked value
+ * @param  : measured, measured rate in kbps
+ * @param  : expected, expected rate in kbps
+ * @return : Returns nothing
+ */
+static void
+check_rate(const char *name, uint64_t measured, uint64_t expected)
+{
+	uint64_t delta = (measured > expected) ?
+		measured - expected : expected - measured;
+	int ok = (delta * 100 <= expected * SIM_TOLERANCE);
+
+	printf("  %-28s measured %8lu kbps, expected %8lu kbps  %s\n",
+			name, measured, expected, ok ? "OK" : "FAIL");
+	if (!ok)
+		failed = 1;
+}
+
+/**
+ * @brief  : Run the flows through their meters and the optional aggregate
+ *           meter, in time order on a virtual TSC
+ * @param  : flows, flows to run
+ * @param  : nb_flows, number of flows
+ * @param  : ambr, aggregate meter, NULL if none
+ * @return : Returns nothing
+ */
+static void
+run_flows(struct sim_flow *flows, uint32_t nb_flows, struct up_mtr_dir *ambr)
+{
+	uint32_t i = 0;
+	uint64_t hz = rte_get_tsc_hz();
+	double end_tsc = (double)hz * SIM_DURATION;
+
+	for (i = 0; i < nb_flows; i++)
+		flows[i].next_tsc = 0;
+
+	for (;;) {
+		struct sim_flow *f = NULL;
+		enum rte_meter_color color;
+
+		/* Next packet of all the flows */
+		for (i = 0; i < nb_flows; i++) {
+			if ((f == NULL) || (flows[i].next_tsc < f->next_tsc))
+				f = &flows[i];
+		}
+
+		if (f->next_tsc >= end_tsc)
+			break;
+
+		color = up_mtr_check(&f->mtr, (uint64_t)f->next_tsc, SIM_PKT_LEN);
+		if ((color != e_RTE_METER_RED) && (ambr != NULL))
+			color = up_mtr_check(ambr, (uint64_t)f->next_tsc, SIM_PKT_LEN);
+		if (color != e_RTE_METER_RED)
+			f->fwd_bytes += SIM_PKT_LEN;
+
+		f->next_tsc += (double)hz * SIM_PKT_LEN /
+			up_mtr_kbps_to_bytes(f->offered);
+	}
+}
+
+/**
+ * @brief  : Flow above its MBR, the MBR is enforced and the GBR is green
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+test_mbr_gbr(void)
+{
+	struct sim_flow flow = {0};
+
+	printf("MBR 10000 kbps, GBR 4000 kbps, offered 30000 kbps\n");
+
+	flow.offered = 30000;
+	if (up_mtr_dir_config(&flow.mtr, 10000, 4000, 0))
+		rte_exit(EXIT_FAILURE, "Meter configuration failed\n");
+
+	run_flows(&flow, 1, NULL);
+
+	check_rate("forwarded", bytes_to_kbps(flow.fwd_bytes), 10000);
+	check_rate("green", bytes_to_kbps(flow.mtr.bytes[e_RTE_METER_GREEN]), 4000);
+	check_rate("yellow", bytes_to_kbps(flow.mtr.bytes[e_RTE_METER_YELLOW]), 6000);
+	check_rate("red", bytes_to_kbps(flow.mtr.bytes[e_RTE_METER_RED]), 20000);
+}
+
+/**
+ * @brief  : Flow below its MBR, nothing is dropped
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+test_below_mbr(void)
+{
+	struct sim_flow flow = {0};
+
+	printf("MBR 5000 kbps, no GBR, offered 4000 kbps\n");
+
+	flow.offered = 4000;
+	if (up_mtr_dir_config(&flow.mtr, 5000, 0, 0))
+		rte_exit(EXIT_FAILURE, "Meter configuration failed\n");
+
+	run_flows(&flow, 1, NULL);
+
+	check_rate("forwarded", bytes_to_kbps(flow.fwd_bytes), 4000);
+	if (flow.mtr.pkts[e_RTE_METER_RED] || flow.mtr.pkts[e_RTE_METER_YELLOW]) {
+		printf("  unexpected yellow/red packets  FAIL\n");
+		failed = 1;
+	}
+}
+
+/**
+ * @brief  : Two flows within their MBR above the APN-AMBR of the session
+ * @param  : No param
+ * @return : Returns nothing
+ */
+static void
+test_ambr(void)
+{
+	uint32_t i = 0;
+	uint64_t total = 0;
+	struct up_mtr_dir ambr;
+	struct sim_flow flows[SIM_MAX_FLOWS];
+
+	printf("2 flows MBR 8000 kbps offered 6000 kbps, APN-AMBR 10000 kbps\n");
+
+	memset(&ambr, 0, sizeof(ambr));
+	memset(flows, 0, sizeof(flows));
+	if (up_mtr_dir_config(&ambr, 10000, 0, 0))
+		rte_exit(EXIT_FAILURE, "Meter configuration failed\n");
+
+	for (i = 0; i < 2; i++) {
+		flows[i].offered = 6000;
+		if (up_mtr_dir_config(&flows[i].mtr, 8000, 0, 0))
+			rte_exit(EXIT_FAILURE, "Meter configuration failed\n");
+	}
+
+	run_flows(flows, 2, &ambr);
+
+	for (i = 0; i < 2; i++)
+		total += flows[i].fwd_bytes;
+
+	check_rate("aggregate forwarded", bytes_to_kbps(total), 10000);
+	check_rate("flow 0 forwarded", bytes_to_kbps(flows[0].fwd_bytes), 5000);
+	check_rate("flow 1 forwarded", bytes_to_kbps(flows[1].fwd_bytes), 5000);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "Error with EAL initialization\n");
+
+	test_mbr_gbr();
+	test_below_mbr();
+	test_ambr();
+
+	printf("QER meter test %s\n", failed ? "FAILED" : "PASSED");
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}